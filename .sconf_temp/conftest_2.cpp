@@ -0,0 +1,26 @@
+
+#include <memory>
+
+int main(int, char **) {
+    // shared_ptr test
+    std::shared_ptr<int> intPtr = std::make_shared<int>();
+
+    // unique_ptr test
+    std::unique_ptr<int> intPtrUnique = std::unique_ptr<int>(new int(1));
+
+    // auto test
+    auto otherIntPtr = intPtr;
+    std::shared_ptr<int> fooIntPtr = otherIntPtr;
+
+    // lambda test
+    auto someFunction = [](int i){ i = i * i; };
+    someFunction(2);
+
+    // nullptr test
+    double* fooDouble = nullptr;
+    double bazDouble = 8.0;
+    fooDouble = &bazDouble;
+    bazDouble = *fooDouble;
+
+    return 0;
+}
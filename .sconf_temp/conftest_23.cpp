@@ -0,0 +1,3 @@
+
+#include "hunspell/hunspell.hxx"
+
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures ServerStanzaRouter with a large number of connected sessions,
+ * routing stanzas to full and bare JIDs.
+ *
+ * Usage: StanzaRouterBenchmark [number of sessions] [number of stanzas]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Elements/Message.h>
+
+#include <Limber/Server/ServerSession.h>
+#include <Limber/Server/ServerStanzaRouter.h>
+
+using namespace Swift;
+
+static const int resourcesPerUser = 4;
+
+namespace {
+    class BenchmarkServerSession : public ServerSession {
+        public:
+            BenchmarkServerSession(const JID& jid, int priority) : jid(jid), priority(priority), receivedStanzas(0) {}
+
+            virtual const JID& getJID() const { return jid; }
+            virtual int getPriority() const { return priority; }
+
+            virtual void sendStanza(std::shared_ptr<Stanza>) {
+                receivedStanzas++;
+            }
+
+            JID jid;
+            int priority;
+            int receivedStanzas;
+    };
+}
+
+static JID getSessionJID(int i) {
+    return JID("user" + boost::lexical_cast<std::string>(i / resourcesPerUser), "example.com", "resource" + boost::lexical_cast<std::string>(i % resourcesPerUser));
+}
+
+static void run(const std::string& name, ServerStanzaRouter& router, const std::vector<std::shared_ptr<Message> >& stanzas) {
+    int routed = 0;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < stanzas.size(); ++i) {
+        if (router.routeStanza(stanzas[i])) {
+            routed++;
+        }
+    }
+    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+    long long microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    std::cout << name << ": " << routed << "/" << stanzas.size() << " routed in " << microseconds / 1000 << "ms (" << (stanzas.empty() ? 0.0 : static_cast<double>(microseconds) / static_cast<double>(stanzas.size())) << "us per stanza)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int numberOfSessions = 100000;
+    int numberOfStanzas = 100000;
+    if (argc > 1) {
+        numberOfSessions = boost::lexical_cast<int>(argv[1]);
+    }
+    if (argc > 2) {
+        numberOfStanzas = boost::lexical_cast<int>(argv[2]);
+    }
+    if (numberOfSessions <= 0 || numberOfStanzas <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [number of sessions] [number of stanzas]" << std::endl;
+        return -1;
+    }
+
+    ServerStanzaRouter router;
+    std::vector<std::shared_ptr<BenchmarkServerSession> > sessions;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < numberOfSessions; ++i) {
+        sessions.push_back(std::make_shared<BenchmarkServerSession>(getSessionJID(i), i % resourcesPerUser));
+        router.addClientSession(sessions.back().get());
+    }
+    std::cout << "Added " << numberOfSessions << " sessions in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms" << std::endl;
+
+    std::vector<std::shared_ptr<Message> > fullJIDStanzas;
+    std::vector<std::shared_ptr<Message> > bareJIDStanzas;
+    for (int i = 0; i < numberOfStanzas; ++i) {
+        int session = (i * 7919) % numberOfSessions;
+        fullJIDStanzas.push_back(std::make_shared<Message>());
+        fullJIDStanzas.back()->setTo(getSessionJID(session));
+        bareJIDStanzas.push_back(std::make_shared<Message>());
+        bareJIDStanzas.back()->setTo(getSessionJID(session).toBare());
+    }
+
+    run("Full JID", router, fullJIDStanzas);
+    run("Bare JID", router, bareJIDStanzas);
+
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < sessions.size(); ++i) {
+        router.removeClientSession(sessions[i].get());
+    }
+    std::cout << "Removed " << numberOfSessions << " sessions in " << std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() << "ms" << std::endl;
+    return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+namespace Swift {
+    /**
+     * A queue that any number of threads can push to without taking a lock,
+     * and that a single consumer thread pops from.
+     *
+     * This is a node based queue with a dummy node (after Dmitry Vyukov's
+     * MPSC queue). A push that has not finished yet can briefly hide the
+     * items pushed after it from pop().
+     */
+    template<typename T>
+    class LockFreeQueue {
+        public:
+            LockFreeQueue() : head_(new Node()), tail_(head_.load()) {
+            }
+
+            ~LockFreeQueue() {
+                T item;
+                while (pop(item)) {
+                }
+                delete tail_;
+            }
+
+            void push(const T& item) {
+                Node* node = new Node(item);
+                Node* previous = head_.exchange(node, std::memory_order_acq_rel);
+                previous->next.store(node, std::memory_order_release);
+            }
+
+            /**
+             * Only to be called from the consumer thread.
+             */
+            bool pop(T& item) {
+                Node* tail = tail_;
+                Node* next = tail->next.load(std::memory_order_acquire);
+                if (!next) {
+                    return false;
+                }
+                item = std::move(next->item);
+                next->item = T();
+                tail_ = next;
+                delete tail;
+                return true;
+            }
+
+        private:
+            LockFreeQueue(const LockFreeQueue&);
+            LockFreeQueue& operator=(const LockFreeQueue&);
+
+            struct Node {
+                Node() : next(nullptr) {}
+                Node(const T& item) : item(item), next(nullptr) {}
+
+                T item;
+                std::atomic<Node*> next;
+            };
+
+        private:
+            std::atomic<Node*> head_;
+            Node* tail_;
+    };
+}
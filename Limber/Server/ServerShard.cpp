@@ -0,0 +1,156 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Limber/Server/ServerShard.h>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/Elements/RosterPayload.h>
+#include <Swiften/Elements/VCard.h>
+#include <Swiften/Network/Connection.h>
+
+#include <Limber/Server/ServerFromClientSession.h>
+#include <Limber/Server/ShardedServer.h>
+
+namespace Swift {
+
+ServerShard::ServerShard(ShardedServer* server, UserRegistry* userRegistry) : server_(server), userRegistry_(userRegistry), sessionCount_(0), inboxDrainScheduled_(false) {
+    thread_ = new std::thread(boost::bind(&SimpleEventLoop::run, &eventLoop_));
+}
+
+ServerShard::~ServerShard() {
+    stop();
+}
+
+void ServerShard::stop() {
+    if (thread_) {
+        eventLoop_.stop();
+        thread_->join();
+        delete thread_;
+        thread_ = nullptr;
+    }
+}
+
+void ServerShard::handleNewConnection(std::shared_ptr<Connection> connection) {
+    std::shared_ptr<ServerFromClientSession> session = std::make_shared<ServerFromClientSession>(idGenerator_.generateID(), connection, &payloadParserFactories_, &payloadSerializers_, &xmlParserFactory_, userRegistry_);
+    sessions_[session.get()].session = session;
+    sessionCount_++;
+    session->onSessionStarted.connect(boost::bind(&ServerShard::handleSessionStarted, this, session.get()));
+    session->onElementReceived.connect(boost::bind(&ServerShard::handleElementReceived, this, _1, session.get()));
+    session->onSessionFinished.connect(boost::bind(&ServerShard::handleSessionFinished, this, session.get()));
+    session->startSession();
+}
+
+void ServerShard::handleSessionStarted(ServerFromClientSession* session) {
+    SessionMap::iterator i = sessions_.find(session);
+    if (i == sessions_.end()) {
+        return;
+    }
+    i->second.routedSession = std::make_shared<ShardServerSession>(this, i->second.session);
+    server_->addClientSession(i->second.routedSession.get());
+}
+
+void ServerShard::handleSessionFinished(ServerFromClientSession* session) {
+    // Don't destroy the session while it is still emitting its signal
+    eventLoop_.postEvent(boost::bind(&ServerShard::removeSession, this, session));
+}
+
+void ServerShard::removeSession(ServerFromClientSession* session) {
+    SessionMap::iterator i = sessions_.find(session);
+    if (i == sessions_.end()) {
+        return;
+    }
+    if (i->second.routedSession) {
+        server_->removeClientSession(i->second.routedSession.get());
+    }
+    sessions_.erase(i);
+    sessionCount_--;
+}
+
+void ServerShard::handleElementReceived(std::shared_ptr<ToplevelElement> element, ServerFromClientSession* session) {
+    SessionMap::iterator i = sessions_.find(session);
+    if (i == sessions_.end()) {
+        return;
+    }
+    std::shared_ptr<Stanza> stanza(std::dynamic_pointer_cast<Stanza>(element));
+    if (!stanza) {
+        return;
+    }
+    stanza->setFrom(session->getRemoteJID());
+    if (!stanza->getTo().isValid()) {
+        stanza->setTo(JID(session->getLocalJID()));
+    }
+    if (!stanza->getTo().isValid() || stanza->getTo() == session->getLocalJID() || stanza->getTo() == session->getRemoteJID().toBare()) {
+        handleStanzaForServer(stanza, i->second);
+    }
+    else {
+        server_->routeStanza(stanza);
+    }
+}
+
+void ServerShard::handleStanzaForServer(std::shared_ptr<Stanza> stanza, SessionEntry& entry) {
+    if (std::shared_ptr<Presence> presence = std::dynamic_pointer_cast<Presence>(stanza)) {
+        if (entry.routedSession) {
+            entry.routedSession->setPriority(presence->getType() == Presence::Available ? presence->getPriority() : -1);
+        }
+    }
+    else if (std::shared_ptr<IQ> iq = std::dynamic_pointer_cast<IQ>(stanza)) {
+        if (iq->getPayload<RosterPayload>()) {
+            entry.session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), std::make_shared<RosterPayload>()));
+        }
+        if (iq->getPayload<VCard>()) {
+            if (iq->getType() == IQ::Get) {
+                std::shared_ptr<VCard> vcard(new VCard());
+                vcard->setNickname(iq->getFrom().getNode());
+                entry.session->sendElement(IQ::createResult(iq->getFrom(), iq->getID(), vcard));
+            }
+            else {
+                entry.session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::Forbidden, ErrorPayload::Cancel));
+            }
+        }
+        else {
+            entry.session->sendElement(IQ::createError(iq->getFrom(), iq->getID(), ErrorPayload::FeatureNotImplemented, ErrorPayload::Cancel));
+        }
+    }
+}
+
+void ServerShard::deliverStanza(std::weak_ptr<ServerFromClientSession> session, std::shared_ptr<Stanza> stanza) {
+    inbox_.push(InboxItem(session, stanza));
+    // Only wake up the shard if it isn't already going to drain the inbox
+    if (!inboxDrainScheduled_.exchange(true)) {
+        eventLoop_.postEvent(boost::bind(&ServerShard::drainInbox, this));
+    }
+}
+
+void ServerShard::drainInbox() {
+    inboxDrainScheduled_ = false;
+    InboxItem item;
+    while (inbox_.pop(item)) {
+        std::shared_ptr<ServerFromClientSession> session = item.first.lock();
+        if (session && sessions_.find(session.get()) != sessions_.end()) {
+            session->sendElement(item.second);
+        }
+    }
+}
+
+ServerShard::ShardServerSession::ShardServerSession(ServerShard* shard, std::shared_ptr<ServerFromClientSession> session) : shard_(shard), session_(session), jid_(session->getRemoteJID()), priority_(-1) {
+}
+
+const JID& ServerShard::ShardServerSession::getJID() const {
+    return jid_;
+}
+
+int ServerShard::ShardServerSession::getPriority() const {
+    return priority_;
+}
+
+void ServerShard::ShardServerSession::sendStanza(std::shared_ptr<Stanza> stanza) {
+    shard_->deliverStanza(session_, stanza);
+}
+
+}
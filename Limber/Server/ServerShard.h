@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/asio/io_service.hpp>
+
+#include <Swiften/Base/IDGenerator.h>
+#include <Swiften/Elements/Stanza.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+
+#include <Limber/Server/LockFreeQueue.h>
+#include <Limber/Server/ServerSession.h>
+
+namespace Swift {
+    class Connection;
+    class ServerFromClientSession;
+    class ShardedServer;
+    class ToplevelElement;
+    class UserRegistry;
+
+    /**
+     * A thread that owns an event loop, an I/O service, and the client
+     * sessions on the connections that were handed to it.
+     *
+     * Stanzas for sessions of other shards are passed to them through
+     * deliverStanza(), which can be called from any thread.
+     */
+    class ServerShard {
+        public:
+            ServerShard(ShardedServer* server, UserRegistry* userRegistry);
+            ~ServerShard();
+
+            /**
+             * Stops the event loop of this shard, and waits for it to finish.
+             */
+            void stop();
+
+            std::shared_ptr<boost::asio::io_service> getIOService() const {
+                return ioServiceThread_.getIOService();
+            }
+
+            EventLoop* getEventLoop() {
+                return &eventLoop_;
+            }
+
+            /**
+             * Starts a session on the connection. Must be called from the
+             * event loop of this shard.
+             */
+            void handleNewConnection(std::shared_ptr<Connection> connection);
+
+            void deliverStanza(std::weak_ptr<ServerFromClientSession> session, std::shared_ptr<Stanza> stanza);
+
+            size_t getSessionCount() const {
+                return sessionCount_;
+            }
+
+        private:
+            class ShardServerSession : public ServerSession {
+                public:
+                    ShardServerSession(ServerShard* shard, std::shared_ptr<ServerFromClientSession> session);
+
+                    virtual const JID& getJID() const;
+                    virtual int getPriority() const;
+                    virtual void sendStanza(std::shared_ptr<Stanza>);
+
+                    void setPriority(int priority) {
+                        priority_ = priority;
+                    }
+
+                private:
+                    ServerShard* shard_;
+                    std::weak_ptr<ServerFromClientSession> session_;
+                    JID jid_;
+                    std::atomic<int> priority_;
+            };
+
+            struct SessionEntry {
+                std::shared_ptr<ServerFromClientSession> session;
+                std::shared_ptr<ShardServerSession> routedSession;
+            };
+
+            typedef std::unordered_map<ServerFromClientSession*, SessionEntry> SessionMap;
+            typedef std::pair<std::weak_ptr<ServerFromClientSession>, std::shared_ptr<Stanza> > InboxItem;
+
+            void handleSessionStarted(ServerFromClientSession* session);
+            void handleSessionFinished(ServerFromClientSession* session);
+            void removeSession(ServerFromClientSession* session);
+            void handleElementReceived(std::shared_ptr<ToplevelElement> element, ServerFromClientSession* session);
+            void handleStanzaForServer(std::shared_ptr<Stanza> stanza, SessionEntry& entry);
+            void drainInbox();
+
+        private:
+            ShardedServer* server_;
+            UserRegistry* userRegistry_;
+            SimpleEventLoop eventLoop_;
+            BoostIOServiceThread ioServiceThread_;
+            IDGenerator idGenerator_;
+            PlatformXMLParserFactory xmlParserFactory_;
+            FullPayloadParserFactoryCollection payloadParserFactories_;
+            FullPayloadSerializerCollection payloadSerializers_;
+            SessionMap sessions_;
+            std::atomic<size_t> sessionCount_;
+            LockFreeQueue<InboxItem> inbox_;
+            std::atomic<bool> inboxDrainScheduled_;
+            std::thread* thread_;
+    };
+}
@@ -9,68 +9,86 @@
 #include <algorithm>
 #include <cassert>
 
+#include <boost/functional/hash.hpp>
+
 #include <Swiften/Base/Algorithm.h>
 
 #include <Limber/Server/ServerSession.h>
 
 namespace Swift {
 
-namespace {
-    struct PriorityLessThan {
-        bool operator()(const ServerSession* s1, const ServerSession* s2) const {
-            return s1->getPriority() < s2->getPriority();
-        }
-    };
-
-    struct HasJID {
-        HasJID(const JID& jid) : jid(jid) {}
-        bool operator()(const ServerSession* session) const {
-            return session->getJID().equals(jid, JID::WithResource);
-        }
-        JID jid;
-    };
-}
-
 ServerStanzaRouter::ServerStanzaRouter() {
 }
 
 bool ServerStanzaRouter::routeStanza(std::shared_ptr<Stanza> stanza) {
-    JID to = stanza->getTo();
+    const JID& to = stanza->getTo();
     assert(to.isValid());
 
     // For a full JID, first try to route to a session with the full JID
     if (!to.isBare()) {
-        std::vector<ServerSession*>::const_iterator i = std::find_if(clientSessions_.begin(), clientSessions_.end(), HasJID(to));
-        if (i != clientSessions_.end()) {
-            (*i)->sendStanza(stanza);
+        FullJIDSessionMap::const_iterator i = fullJIDSessions_.find(to);
+        if (i != fullJIDSessions_.end()) {
+            i->second->sendStanza(stanza);
             return true;
         }
     }
 
-    // Look for candidate sessions
-    to = to.toBare();
-    std::vector<ServerSession*> candidateSessions;
-    for (std::vector<ServerSession*>::const_iterator i = clientSessions_.begin(); i != clientSessions_.end(); ++i) {
-        if ((*i)->getJID().equals(to, JID::WithoutResource) && (*i)->getPriority() >= 0) {
-            candidateSessions.push_back(*i);
+    // Find the candidate session with the highest priority. Sessions can
+    // change their priority at any time, so this is only decided here.
+    BareJIDSessionsMap::const_iterator i = bareJIDSessions_.find(to.toBare());
+    if (i == bareJIDSessions_.end()) {
+        return false;
+    }
+    ServerSession* bestSession = nullptr;
+    for (std::vector<ServerSession*>::const_iterator j = i->second.begin(); j != i->second.end(); ++j) {
+        if ((*j)->getPriority() >= 0 && (!bestSession || (*j)->getPriority() > bestSession->getPriority())) {
+            bestSession = *j;
         }
     }
-    if (candidateSessions.empty()) {
+    if (!bestSession) {
         return false;
     }
-
-    // Find the session with the highest priority
-    std::vector<ServerSession*>::const_iterator i = std::max_element(clientSessions_.begin(), clientSessions_.end(), PriorityLessThan());
-    (*i)->sendStanza(stanza);
+    bestSession->sendStanza(stanza);
     return true;
 }
 
 void ServerStanzaRouter::addClientSession(ServerSession* clientSession) {
-    clientSessions_.push_back(clientSession);
+    const JID& jid = clientSession->getJID();
+    // If there already is a session with the same full JID, it keeps getting its stanzas
+    fullJIDSessions_.insert(std::make_pair(jid, clientSession));
+    bareJIDSessions_[jid.toBare()].push_back(clientSession);
 }
 
 void ServerStanzaRouter::removeClientSession(ServerSession* clientSession) {
-    erase(clientSessions_, clientSession);
+    const JID& jid = clientSession->getJID();
+    BareJIDSessionsMap::iterator i = bareJIDSessions_.find(jid.toBare());
+    if (i == bareJIDSessions_.end()) {
+        return;
+    }
+    std::vector<ServerSession*>& sessions = i->second;
+    erase(sessions, clientSession);
+
+    FullJIDSessionMap::iterator j = fullJIDSessions_.find(jid);
+    if (j != fullJIDSessions_.end() && j->second == clientSession) {
+        fullJIDSessions_.erase(j);
+        for (std::vector<ServerSession*>::const_iterator k = sessions.begin(); k != sessions.end(); ++k) {
+            if ((*k)->getJID() == jid) {
+                fullJIDSessions_.insert(std::make_pair(jid, *k));
+                break;
+            }
+        }
+    }
+    if (sessions.empty()) {
+        bareJIDSessions_.erase(i);
+    }
+}
+
+size_t ServerStanzaRouter::JIDHash::operator()(const JID& jid) const {
+    size_t seed = 0;
+    boost::hash_combine(seed, jid.getNode());
+    boost::hash_combine(seed, jid.getDomain());
+    boost::hash_combine(seed, jid.getResource());
+    return seed;
 }
 
 }
@@ -6,8 +6,9 @@
 
 #pragma once
 
-#include <map>
 #include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include <Swiften/Elements/Stanza.h>
 #include <Swiften/JID/JID.h>
@@ -25,6 +26,15 @@ namespace Swift {
             void removeClientSession(ServerSession*);
 
         private:
-            std::vector<ServerSession*> clientSessions_;
+            struct JIDHash {
+                size_t operator()(const JID& jid) const;
+            };
+
+            typedef std::unordered_map<JID, ServerSession*, JIDHash> FullJIDSessionMap;
+            typedef std::unordered_map<JID, std::vector<ServerSession*>, JIDHash> BareJIDSessionsMap;
+
+        private:
+            FullJIDSessionMap fullJIDSessions_;
+            BareJIDSessionsMap bareJIDSessions_;
     };
 }
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Limber/Server/ShardedServer.h>
+
+#include <cassert>
+#include <future>
+
+#include <boost/asio/ip/v6_only.hpp>
+#include <boost/asio/placeholders.hpp>
+#include <boost/bind.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+#include <boost/system/system_error.hpp>
+
+#include <Swiften/Base/Log.h>
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/Network/BoostConnection.h>
+
+#include <Limber/Server/ServerShard.h>
+
+namespace Swift {
+
+ShardedServer::ShardedServer(UserRegistry* userRegistry, int port, size_t numberOfShards) : port_(port), nextShard_(0), acceptorThread_(new BoostIOServiceThread()), acceptor_(nullptr) {
+    assert(numberOfShards > 0);
+    for (size_t i = 0; i < numberOfShards; ++i) {
+        shards_.push_back(new ServerShard(this, userRegistry));
+    }
+}
+
+ShardedServer::~ShardedServer() {
+    if (acceptor_) {
+        // The acceptor is used from the acceptor thread, so close it there
+        std::promise<void> acceptorClosed;
+        acceptorThread_->getIOService()->post(boost::bind(&ShardedServer::closeAcceptor, this, &acceptorClosed));
+        acceptorClosed.get_future().wait();
+    }
+    delete acceptorThread_;
+    // Stop all shards before destroying any, since they route to each other
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        shards_[i]->stop();
+    }
+    for (size_t i = 0; i < shards_.size(); ++i) {
+        delete shards_[i];
+    }
+}
+
+bool ShardedServer::start() {
+    assert(!acceptor_);
+    try {
+        boost::asio::ip::tcp::endpoint endpoint(boost::asio::ip::tcp::v6(), boost::numeric_cast<unsigned short>(port_));
+        acceptor_ = new boost::asio::ip::tcp::acceptor(*acceptorThread_->getIOService(), endpoint);
+        boost::system::error_code ec;
+        acceptor_->set_option(boost::asio::ip::v6_only(false), ec);
+        SWIFT_LOG_ASSERT(ec, warning) << "IPv4/IPv6 dual-stack support is not supported on this platform." << std::endl;
+        acceptNextConnection();
+    }
+    catch (const boost::system::system_error& e) {
+        SWIFT_LOG(error) << "Unable to listen on port " << port_ << ": " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void ShardedServer::closeAcceptor(std::promise<void>* acceptorClosed) {
+    acceptor_->close();
+    delete acceptor_;
+    acceptor_ = nullptr;
+    acceptorClosed->set_value();
+}
+
+void ShardedServer::acceptNextConnection() {
+    ServerShard* shard = shards_[nextShard_];
+    nextShard_ = (nextShard_ + 1) % shards_.size();
+    std::shared_ptr<BoostConnection> connection = BoostConnection::create(shard->getIOService(), shard->getEventLoop());
+    acceptor_->async_accept(connection->getSocket(), boost::bind(&ShardedServer::handleAccept, this, connection, shard, boost::asio::placeholders::error));
+}
+
+void ShardedServer::handleAccept(std::shared_ptr<BoostConnection> connection, ServerShard* shard, const boost::system::error_code& error) {
+    if (error) {
+        if (error != boost::asio::error::operation_aborted) {
+            SWIFT_LOG(error) << "Stopped accepting connections: " << error.message() << std::endl;
+        }
+        return;
+    }
+    // The session has to exist before the connection can post any data to the shard
+    shard->getEventLoop()->postEvent(boost::bind(&ServerShard::handleNewConnection, shard, connection));
+    connection->listen();
+    acceptNextConnection();
+}
+
+bool ShardedServer::routeStanza(std::shared_ptr<Stanza> stanza) {
+    std::lock_guard<std::mutex> lock(routerMutex_);
+    return router_.routeStanza(stanza);
+}
+
+void ShardedServer::addClientSession(ServerSession* session) {
+    std::lock_guard<std::mutex> lock(routerMutex_);
+    router_.addClientSession(session);
+}
+
+void ShardedServer::removeClientSession(ServerSession* session) {
+    std::lock_guard<std::mutex> lock(routerMutex_);
+    router_.removeClientSession(session);
+}
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <future>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <Swiften/Elements/Stanza.h>
+#include <Swiften/Network/BoostIOServiceThread.h>
+
+#include <Limber/Server/ServerStanzaRouter.h>
+
+namespace Swift {
+    class BoostConnection;
+    class ServerSession;
+    class ServerShard;
+    class UserRegistry;
+
+    /**
+     * A client-to-server listener that spreads its connections over a number
+     * of \ref ServerShard threads.
+     *
+     * Connections are handed to the shards round-robin. Client sessions of all
+     * shards are registered in a single \ref ServerStanzaRouter, which passes
+     * routed stanzas on to the shard owning the destination session.
+     */
+    class ShardedServer {
+        public:
+            ShardedServer(UserRegistry* userRegistry, int port, size_t numberOfShards);
+            ~ShardedServer();
+
+            bool start();
+
+            /**
+             * These can be called from any shard.
+             */
+            bool routeStanza(std::shared_ptr<Stanza> stanza);
+            void addClientSession(ServerSession* session);
+            void removeClientSession(ServerSession* session);
+
+            size_t getShardCount() const {
+                return shards_.size();
+            }
+
+        private:
+            void closeAcceptor(std::promise<void>* acceptorClosed);
+            void acceptNextConnection();
+            void handleAccept(std::shared_ptr<BoostConnection> connection, ServerShard* shard, const boost::system::error_code& error);
+
+        private:
+            int port_;
+            std::vector<ServerShard*> shards_;
+            size_t nextShard_;
+            BoostIOServiceThread* acceptorThread_;
+            boost::asio::ip::tcp::acceptor* acceptor_;
+            std::mutex routerMutex_;
+            ServerStanzaRouter router_;
+    };
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Limber/Server/LockFreeQueue.h>
+
+using namespace Swift;
+
+class LockFreeQueueTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(LockFreeQueueTest);
+        CPPUNIT_TEST(testPop_Empty);
+        CPPUNIT_TEST(testPop_InOrder);
+        CPPUNIT_TEST(testPush_FromMultipleThreads);
+        CPPUNIT_TEST(testDestructor_ReleasesItems);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testPop_Empty() {
+            LockFreeQueue<int> testling;
+            int item;
+
+            CPPUNIT_ASSERT(!testling.pop(item));
+        }
+
+        void testPop_InOrder() {
+            LockFreeQueue<int> testling;
+            testling.push(1);
+            testling.push(2);
+            int item;
+
+            CPPUNIT_ASSERT(testling.pop(item));
+            CPPUNIT_ASSERT_EQUAL(1, item);
+            testling.push(3);
+            CPPUNIT_ASSERT(testling.pop(item));
+            CPPUNIT_ASSERT_EQUAL(2, item);
+            CPPUNIT_ASSERT(testling.pop(item));
+            CPPUNIT_ASSERT_EQUAL(3, item);
+            CPPUNIT_ASSERT(!testling.pop(item));
+        }
+
+        void testPush_FromMultipleThreads() {
+            LockFreeQueue<int> testling;
+            std::vector<std::thread*> threads;
+            for (int i = 0; i < numberOfThreads; ++i) {
+                threads.push_back(new std::thread(&LockFreeQueueTest::pushItems, &testling, i));
+            }
+
+            std::vector<int> nextItems(numberOfThreads, 0);
+            int received = 0;
+            while (received < numberOfThreads * itemsPerThread) {
+                int item;
+                if (testling.pop(item)) {
+                    // Items of a single thread come out in the order they were pushed
+                    CPPUNIT_ASSERT_EQUAL(nextItems[item / itemsPerThread], item % itemsPerThread);
+                    nextItems[item / itemsPerThread]++;
+                    received++;
+                }
+            }
+            for (size_t i = 0; i < threads.size(); ++i) {
+                threads[i]->join();
+                delete threads[i];
+            }
+            int item;
+            CPPUNIT_ASSERT(!testling.pop(item));
+        }
+
+        void testDestructor_ReleasesItems() {
+            std::shared_ptr<int> item = std::make_shared<int>(1);
+            {
+                LockFreeQueue<std::shared_ptr<int> > testling;
+                testling.push(item);
+                testling.push(item);
+                std::shared_ptr<int> popped;
+                testling.pop(popped);
+            }
+
+            CPPUNIT_ASSERT(item.unique());
+        }
+
+    private:
+        static void pushItems(LockFreeQueue<int>* queue, int thread) {
+            for (int i = 0; i < itemsPerThread; ++i) {
+                queue->push(thread * itemsPerThread + i);
+            }
+        }
+
+    private:
+        static const int numberOfThreads = 4;
+        static const int itemsPerThread = 10000;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LockFreeQueueTest);
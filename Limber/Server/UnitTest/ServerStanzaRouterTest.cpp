@@ -23,6 +23,9 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRouteStanza_BareJIDWithMultipleSessions);
         CPPUNIT_TEST(testRouteStanza_BareJIDWithOnlyNegativePriorities);
         CPPUNIT_TEST(testRouteStanza_BareJIDWithChangingPresence);
+        CPPUNIT_TEST(testRouteStanza_BareJIDWithHigherPrioritySessionOfOtherUser);
+        CPPUNIT_TEST(testRouteStanza_AfterRemoveClientSession);
+        CPPUNIT_TEST(testRouteStanza_AfterRemoveClientSessionWithSameFullJID);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -124,6 +127,53 @@ class ServerStanzaRouterTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session2.sentStanzas.size()));
         }
 
+        void testRouteStanza_BareJIDWithHigherPrioritySessionOfOtherUser() {
+            ServerStanzaRouter testling;
+            MockServerSession session1(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session1);
+            MockServerSession session2(JID("baz@bar.com/Bla"), 8);
+            testling.addClientSession(&session2);
+
+            bool result = testling.routeStanza(createMessageTo("foo@bar.com"));
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session1.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session2.sentStanzas.size()));
+        }
+
+        void testRouteStanza_AfterRemoveClientSession() {
+            ServerStanzaRouter testling;
+            MockServerSession session1(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session1);
+            MockServerSession session2(JID("foo@bar.com/Baz"), 8);
+            testling.addClientSession(&session2);
+
+            testling.removeClientSession(&session2);
+            bool result = testling.routeStanza(createMessageTo("foo@bar.com/Baz"));
+
+            CPPUNIT_ASSERT(result);
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session1.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(session2.sentStanzas.size()));
+
+            testling.removeClientSession(&session1);
+            CPPUNIT_ASSERT(!testling.routeStanza(createMessageTo("foo@bar.com")));
+        }
+
+        void testRouteStanza_AfterRemoveClientSessionWithSameFullJID() {
+            ServerStanzaRouter testling;
+            MockServerSession session1(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session1);
+            MockServerSession session2(JID("foo@bar.com/Bla"), 1);
+            testling.addClientSession(&session2);
+
+            testling.routeStanza(createMessageTo("foo@bar.com/Bla"));
+            testling.removeClientSession(&session1);
+            testling.routeStanza(createMessageTo("foo@bar.com/Bla"));
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session1.sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(session2.sentStanzas.size()));
+        }
+
     private:
         std::shared_ptr<Message> createMessageTo(const std::string& recipient) {
             std::shared_ptr<Message> message(new Message());
@@ -1,12 +1,15 @@
 /*
- * Copyright (c) 2013-2014 Isode Limited.
+ * Copyright (c) 2013-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <boost/uuid/random_generator.hpp>
+
 #include <Sluift/LuaElementConvertors.h>
+#include <Swiften/Base/IDGenerator.h>
 #include <Swiften/EventLoop/SimpleEventLoop.h>
 #include <Swiften/Network/BoostNetworkFactories.h>
 #include <Swiften/TLS/PlatformTLSFactories.h>
@@ -27,6 +30,8 @@ namespace Swift {
         SimpleEventLoop eventLoop;
         BoostNetworkFactories networkFactories;
         PlatformTLSFactories tlsFactories;
+        IDGenerator idGenerator;
+        boost::uuids::random_generator uuidGenerator;
         int coreLibIndex;
         int moduleLibIndex;
         sig_atomic_t interruptRequested;
@@ -12,10 +12,11 @@
 #include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/numeric/conversion/cast.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_io.hpp>
 
 #include <lua.hpp>
 
-#include <Swiften/Base/IDGenerator.h>
 #include <Swiften/Base/foreach.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/Crypto/CryptoProvider.h>
@@ -154,7 +155,15 @@ SLUIFT_LUA_FUNCTION_WITH_HELP(
         Sluift, new_uuid,
         "Generates a new UUID", "", ""
 ) {
-    lua_pushstring(L, IDGenerator().generateID().c_str());
+    lua_pushstring(L, boost::uuids::to_string(Sluift::globals.uuidGenerator()).c_str());
+    return 1;
+}
+
+SLUIFT_LUA_FUNCTION_WITH_HELP(
+        Sluift, new_id,
+        "Generates a new random ID, as used for stanzas. It is shorter than a UUID.", "", ""
+) {
+    lua_pushstring(L, Sluift::globals.idGenerator.generateID().c_str());
     return 1;
 }
 
@@ -185,6 +185,7 @@ MUCController::~MUCController() {
     }
     chatWindow_->setTabComplete(nullptr);
     delete completer_;
+    cancelHistoryRequests();
 }
 
 void MUCController::cancelReplaces() {
@@ -239,7 +240,7 @@ void MUCController::handleBareJIDCapsChanged(const JID& /*jid*/) {
     Tristate support = Yes;
     bool any = false;
     foreach (const std::string& nick, currentOccupants_) {
-        DiscoInfo::ref disco = entityCapsProvider_->getCaps(toJID_.toBare().toString() + "/" + nick);
+        std::shared_ptr<const DiscoInfo> disco = entityCapsProvider_->getCaps(toJID_.toBare().toString() + "/" + nick);
         if (disco && disco->hasFeature(DiscoInfo::MessageCorrectionFeature)) {
             any = true;
         } else {
@@ -264,16 +265,76 @@ void MUCController::rejoin() {
         }
         //FIXME: check for received activity
 #ifdef SWIFT_EXPERIMENTAL_HISTORY
-        if (lastActivity_ == boost::posix_time::not_a_date_time && historyController_) {
-            lastActivity_ = historyController_->getLastTimeStampFromMUC(selfJID_, toJID_);
+        if (historyController_) {
+            loadJoinContext();
+            return;
         }
 #endif
-        if (lastActivity_ == boost::posix_time::not_a_date_time) {
-            muc_->joinAs(nick_);
-        }
-        else {
-            muc_->joinWithContextSince(nick_, lastActivity_);
-        }
+        join();
+    }
+}
+
+/**
+ * Loads the last activity in the room and the messages logged around it
+ * before joining, so the room only has to send what the logs are missing.
+ * The history is queried asynchronously, so the join happens once the
+ * responses arrive.
+ */
+void MUCController::loadJoinContext() {
+    cancelHistoryRequests();
+    if (lastActivity_ == boost::posix_time::not_a_date_time) {
+        lastTimeStampRequest_ = historyController_->createLastTimeStampFromMUCRequest(selfJID_, toJID_);
+        lastTimeStampRequest_->onResponse.connect(boost::bind(&MUCController::handleLastTimeStampResponse, this, _1));
+        lastTimeStampRequest_->send();
+    } else {
+        handleLastTimeStampResponse(lastActivity_);
+    }
+}
+
+void MUCController::handleLastTimeStampResponse(const boost::posix_time::ptime& timeStamp) {
+    lastTimeStampRequest_.reset();
+    if (parting_) {
+        return;
+    }
+    if (lastActivity_ == boost::posix_time::not_a_date_time) {
+        lastActivity_ = timeStamp;
+    }
+    if (lastActivity_ == boost::posix_time::not_a_date_time) {
+        joinContext_.clear();
+        join();
+        return;
+    }
+    joinContextRequest_ = historyController_->createMUCContextRequest(selfJID_, toJID_, lastActivity_);
+    joinContextRequest_->onResponse.connect(boost::bind(&MUCController::handleJoinContextResponse, this, _1));
+    joinContextRequest_->send();
+}
+
+void MUCController::handleJoinContextResponse(const std::vector<HistoryMessage>& messages) {
+    joinContextRequest_.reset();
+    if (parting_) {
+        return;
+    }
+    joinContext_ = messages;
+    join();
+}
+
+void MUCController::cancelHistoryRequests() {
+    if (lastTimeStampRequest_) {
+        lastTimeStampRequest_->onResponse.disconnect_all_slots();
+        lastTimeStampRequest_.reset();
+    }
+    if (joinContextRequest_) {
+        joinContextRequest_->onResponse.disconnect_all_slots();
+        joinContextRequest_.reset();
+    }
+}
+
+void MUCController::join() {
+    if (lastActivity_ == boost::posix_time::not_a_date_time) {
+        muc_->joinAs(nick_);
+    }
+    else {
+        muc_->joinWithContextSince(nick_, lastActivity_);
     }
 }
 
@@ -1064,12 +1125,7 @@ void MUCController::logMessage(const std::string& message, const JID& fromJID, c
 }
 
 void MUCController::addRecentLogs() {
-    if (!historyController_) {
-        return;
-    }
-
-    joinContext_ = historyController_->getMUCContext(selfJID_, toJID_, lastActivity_);
-
+    // The context was loaded from the history before joining
     foreach (const HistoryMessage& message, joinContext_) {
         bool senderIsSelf = nick_ == message.getFromJID().getResource();
 
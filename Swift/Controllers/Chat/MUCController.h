@@ -18,6 +18,7 @@
 #include <Swiften/Elements/DiscoInfo.h>
 #include <Swiften/Elements/MUCOccupant.h>
 #include <Swiften/Elements/Message.h>
+#include <Swiften/History/HistoryStorage.h>
 #include <Swiften/JID/JID.h>
 #include <Swiften/MUC/MUC.h>
 #include <Swiften/Network/Timer.h>
@@ -129,6 +130,11 @@ namespace Swift {
             void handleInviteToMUCWindowDismissed();
             void handleInviteToMUCWindowCompleted();
             void handleUIEvent(std::shared_ptr<UIEvent> event);
+            void loadJoinContext();
+            void handleLastTimeStampResponse(const boost::posix_time::ptime& timeStamp);
+            void handleJoinContextResponse(const std::vector<HistoryMessage>& messages);
+            void cancelHistoryRequests();
+            void join();
             void addRecentLogs();
             void checkDuplicates(std::shared_ptr<Message> newMessage);
             void setNick(const std::string& nick);
@@ -163,6 +169,8 @@ namespace Swift {
             boost::optional<std::string> password_;
             XMPPRoster* xmppRoster_;
             std::vector<HistoryMessage> joinContext_;
+            HistoryTimeStampRequest::ref lastTimeStampRequest_;
+            HistoryMessagesRequest::ref joinContextRequest_;
             size_t renameCounter_;
             bool isImpromptu_;
             bool isImpromptuAlreadyConfigured_;
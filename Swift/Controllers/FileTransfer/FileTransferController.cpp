@@ -19,9 +19,13 @@
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/Log.h>
-#include <Swiften/FileTransfer/FileReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
 #include <Swiften/FileTransfer/FileTransferManager.h>
+#include <Swiften/FileTransfer/FileTransferOptions.h>
 #include <Swiften/FileTransfer/OutgoingJingleFileTransfer.h>
+#include <Swiften/FileTransfer/ParallelIncomingFileTransfer.h>
+#include <Swiften/FileTransfer/PartialFileStorage.h>
 
 #include <Swift/Controllers/Intl.h>
 #include <Swift/Controllers/UIInterfaces/ChatWindow.h>
@@ -29,12 +33,12 @@
 namespace Swift {
 
 FileTransferController::FileTransferController(const JID& receipient, const std::string& filename, FileTransferManager* fileTransferManager) :
-    sending(true), otherParty(receipient), filename(filename), ftManager(fileTransferManager), ftProgressInfo(nullptr), chatWindow(nullptr), currentState(FileTransfer::State::WaitingForStart) {
+    sending(true), otherParty(receipient), filename(filename), ftManager(fileTransferManager), partialFileStorage(nullptr), ftProgressInfo(nullptr), chatWindow(nullptr), currentState(FileTransfer::State::WaitingForStart) {
 
 }
 
-FileTransferController::FileTransferController(IncomingFileTransfer::ref transfer) :
-    sending(false), otherParty(transfer->getSender()), filename(transfer->getFileName()), transfer(transfer), ftManager(nullptr), ftProgressInfo(nullptr), chatWindow(nullptr), currentState(FileTransfer::State::WaitingForStart) {
+FileTransferController::FileTransferController(IncomingFileTransfer::ref transfer, PartialFileStorage* partialFileStorage) :
+    sending(false), otherParty(transfer->getSender()), filename(transfer->getFileName()), transfer(transfer), ftManager(nullptr), partialFileStorage(partialFileStorage), ftProgressInfo(nullptr), chatWindow(nullptr), currentState(FileTransfer::State::WaitingForStart) {
     transfer->onStateChanged.connect(boost::bind(&FileTransferController::handleFileTransferStateChange, this, _1));
 }
 
@@ -83,8 +87,8 @@ boost::uintmax_t FileTransferController::getSize() const {
 
 void FileTransferController::start(std::string& description) {
     SWIFT_LOG(debug) << "FileTransferController::start" << std::endl;
-    fileReadStream = std::make_shared<FileReadBytestream>(boost::filesystem::path(filename));
-    OutgoingFileTransfer::ref outgoingTransfer = ftManager->createOutgoingFileTransfer(otherParty, boost::filesystem::path(filename), description, fileReadStream);
+    fileReadStream = std::make_shared<FileDescriptorReadBytestream>(boost::filesystem::path(filename));
+    OutgoingFileTransfer::ref outgoingTransfer = ftManager->createOutgoingFileTransfer(otherParty, boost::filesystem::path(filename), description, fileReadStream, FileTransferOptions().withHashingInBackground(true));
     if (outgoingTransfer) {
         ftProgressInfo = new FileTransferProgressInfo(outgoingTransfer->getFileSizeInBytes());
         ftProgressInfo->onProgressPercentage.connect(boost::bind(&FileTransferController::handleProgressPercentageChange, this, _1));
@@ -101,17 +105,52 @@ void FileTransferController::accept(std::string& file) {
     SWIFT_LOG(debug) << "FileTransferController::accept" << std::endl;
     IncomingFileTransfer::ref incomingTransfer = std::dynamic_pointer_cast<IncomingFileTransfer>(transfer);
     if (incomingTransfer) {
-        fileWriteStream = std::make_shared<FileWriteBytestream>(boost::filesystem::path(file));
-
         ftProgressInfo = new FileTransferProgressInfo(transfer->getFileSizeInBytes());
         ftProgressInfo->onProgressPercentage.connect(boost::bind(&FileTransferController::handleProgressPercentageChange, this, _1));
         transfer->onProcessedBytes.connect(boost::bind(&FileTransferProgressInfo::setBytesProcessed, ftProgressInfo, _1));
-        incomingTransfer->accept(fileWriteStream);
+
+        ParallelIncomingFileTransfer::ref parallelTransfer = std::dynamic_pointer_cast<ParallelIncomingFileTransfer>(incomingTransfer);
+        if (partialFileStorage && !parallelTransfer) {
+            // The storage writes the file into place once it is complete
+            partialFileStorageConnection = partialFileStorage->onTransferFinished.connect(boost::bind(&FileTransferController::handlePartialFileStored, this, _1, _2));
+            partialFileStorage->accept(incomingTransfer, boost::filesystem::path(file), FileTransferOptions().withHashingInBackground(true));
+            return;
+        }
+
+        std::shared_ptr<WriteBytestream> stream;
+        if (parallelTransfer) {
+            // The ranges are written at their offsets, and the file is not
+            // truncated, so don't leave old data behind.
+            boost::system::error_code error;
+            boost::filesystem::remove(boost::filesystem::path(file), error);
+            rangesWriteStream = std::make_shared<FileDescriptorWriteBytestream>(boost::filesystem::path(file));
+            stream = rangesWriteStream;
+        } else if (transfer->getRangeLength() != transfer->getFileSizeInBytes()) {
+            // A single range is written into place in the file
+            rangesWriteStream = std::make_shared<FileDescriptorWriteBytestream>(boost::filesystem::path(file), transfer->getRangeOffset());
+            stream = rangesWriteStream;
+        } else if (transfer->getFileSizeInBytes() > 0) {
+            mappedFileWriteStream = std::make_shared<MappedFileWriteBytestream>(boost::filesystem::path(file), transfer->getFileSizeInBytes());
+            stream = mappedFileWriteStream;
+        } else {
+            // A file can only be mapped with the size it is going to have,
+            // so a file of unknown size is written as it comes in.
+            fileWriteStream = std::make_shared<FileWriteBytestream>(boost::filesystem::path(file));
+            stream = fileWriteStream;
+        }
+        incomingTransfer->accept(stream, FileTransferOptions().withHashingInBackground(true));
     } else {
         std::cerr << "Expected an incoming transfer in this situation!" << std::endl;
     }
 }
 
+void FileTransferController::handlePartialFileStored(IncomingFileTransfer::ref storedTransfer, boost::optional<FileTransferError> error) {
+    if (storedTransfer == transfer && error && currentState.type == FileTransfer::State::Finished) {
+        // All data was received, but it could not be written to the file
+        chatWindow->setFileTransferStatus(uiID, ChatWindow::FTFailed);
+    }
+}
+
 void FileTransferController::cancel() {
     if (transfer) {
         transfer->cancel();
@@ -138,9 +177,15 @@ void FileTransferController::handleFileTransferStateChange(FileTransfer::State s
             return;
         case FileTransfer::State::Finished:
             chatWindow->setFileTransferStatus(uiID, ChatWindow::Finished);
+            if (mappedFileWriteStream) {
+                mappedFileWriteStream->close();
+            }
             if (fileWriteStream) {
                 fileWriteStream->close();
             }
+            if (rangesWriteStream) {
+                rangesWriteStream->close();
+            }
             return;
         case FileTransfer::State::Failed:
             chatWindow->setFileTransferStatus(uiID, ChatWindow::FTFailed);
@@ -16,10 +16,15 @@
 #include <string>
 
 #include <boost/cstdint.hpp>
+#include <boost/optional.hpp>
+#include <boost/signals2.hpp>
 
-#include <Swiften/FileTransfer/FileReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
 #include <Swiften/FileTransfer/FileTransfer.h>
+#include <Swiften/FileTransfer/FileTransferError.h>
 #include <Swiften/FileTransfer/FileWriteBytestream.h>
+#include <Swiften/FileTransfer/MappedFileWriteBytestream.h>
 #include <Swiften/FileTransfer/IncomingFileTransfer.h>
 #include <Swiften/JID/JID.h>
 
@@ -29,6 +34,7 @@ namespace Swift {
 
 class FileTransferManager;
 class ChatWindow;
+class PartialFileStorage;
 
 class FileTransferController {
 public:
@@ -38,9 +44,10 @@ public:
     FileTransferController(const JID&, const std::string&, FileTransferManager*);
 
     /**
-     * For incoming file transfers.
+     * For incoming file transfers. If \p partialFileStorage is given, the file is received
+     * through it, so that the transfer is resumed when the file is sent again after an interruption.
      */
-    FileTransferController(IncomingFileTransfer::ref transfer);
+    FileTransferController(IncomingFileTransfer::ref transfer, PartialFileStorage* partialFileStorage = nullptr);
     ~FileTransferController();
 
     std::string setChatWindow(ChatWindow*, std::string nickname);
@@ -62,15 +69,20 @@ public:
 private:
     void handleFileTransferStateChange(FileTransfer::State);
     void handleProgressPercentageChange(int percentage);
+    void handlePartialFileStored(IncomingFileTransfer::ref transfer, boost::optional<FileTransferError> error);
 
 private:
     bool sending;
     JID otherParty;
     std::string filename;
     FileTransfer::ref transfer;
-    std::shared_ptr<FileReadBytestream> fileReadStream;
+    std::shared_ptr<FileDescriptorReadBytestream> fileReadStream;
+    std::shared_ptr<MappedFileWriteBytestream> mappedFileWriteStream;
     std::shared_ptr<FileWriteBytestream> fileWriteStream;
+    std::shared_ptr<FileDescriptorWriteBytestream> rangesWriteStream;
     FileTransferManager* ftManager;
+    PartialFileStorage* partialFileStorage;
+    boost::signals2::scoped_connection partialFileStorageConnection;
     FileTransferProgressInfo* ftProgressInfo;
     ChatWindow* chatWindow;
     std::string uiID;
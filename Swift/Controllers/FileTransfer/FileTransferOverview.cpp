@@ -22,7 +22,7 @@
 
 namespace Swift {
 
-FileTransferOverview::FileTransferOverview(FileTransferManager* ftm) : fileTransferManager(ftm) {
+FileTransferOverview::FileTransferOverview(FileTransferManager* ftm, PartialFileStorage* partialFileStorage) : fileTransferManager(ftm), partialFileStorage(partialFileStorage) {
     fileTransferManager->onIncomingFileTransfer.connect(boost::bind(&FileTransferOverview::handleIncomingFileTransfer, this, _1));
     onNewFileTransferController.connect(boost::bind(&FileTransferOverview::handleNewFileTransferController, this, _1));
 }
@@ -43,7 +43,7 @@ void FileTransferOverview::sendFile(const JID& jid, const std::string& filename)
 }
 
 void FileTransferOverview::handleIncomingFileTransfer(IncomingFileTransfer::ref transfer) {
-    FileTransferController* controller = new FileTransferController(transfer);
+    FileTransferController* controller = new FileTransferController(transfer, partialFileStorage);
     onNewFileTransferController(controller);
 }
 
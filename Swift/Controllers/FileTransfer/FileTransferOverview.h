@@ -22,10 +22,14 @@ namespace Swift {
 
 class ChatsManager;
 class FileTransferManager;
+class PartialFileStorage;
 
 class FileTransferOverview {
 public:
-    FileTransferOverview(FileTransferManager*);
+    /**
+     * Incoming files are received through \p partialFileStorage if it is given.
+     */
+    FileTransferOverview(FileTransferManager*, PartialFileStorage* partialFileStorage = nullptr);
     ~FileTransferOverview();
 
     void sendFile(const JID&, const std::string&);
@@ -44,6 +48,7 @@ private:
 private:
     std::vector<FileTransferController*> fileTransfers;
     FileTransferManager *fileTransferManager;
+    PartialFileStorage* partialFileStorage;
 };
 
 }
@@ -38,29 +38,33 @@ void HistoryController::addMessage(const std::string& message, const JID& fromJI
     onNewMessage(historyMessage);
 }
 
-std::vector<HistoryMessage> HistoryController::getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    return localHistory_->getMessagesFromDate(selfJID, contactJID, type, date);
+HistoryMessagesRequest::ref HistoryController::createMessagesFromDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
+    return localHistory_->createMessagesFromDateRequest(selfJID, contactJID, type, date);
 }
 
-std::vector<HistoryMessage> HistoryController::getMUCContext(const JID& selfJID, const JID& mucJID, const boost::posix_time::ptime& timeStamp) const {
-    boost::posix_time::ptime localTime = boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local(timeStamp);
-    return getMessagesFromDate(selfJID, mucJID, HistoryMessage::Groupchat, localTime.date());
+HistoryMessagesRequest::ref HistoryController::createMessagesFromPreviousDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
+    return localHistory_->createMessagesFromPreviousDateRequest(selfJID, contactJID, type, date);
+}
+
+HistoryMessagesRequest::ref HistoryController::createMessagesFromNextDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
+    return localHistory_->createMessagesFromNextDateRequest(selfJID, contactJID, type, date);
 }
 
-std::vector<HistoryMessage> HistoryController::getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    return localHistory_->getMessagesFromPreviousDate(selfJID, contactJID, type, date);
+HistoryMessagesRequest::ref HistoryController::createMessagesPageRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) const {
+    return localHistory_->createMessagesPageRequest(selfJID, contactJID, type, date, limit, beforeID, afterID);
 }
 
-std::vector<HistoryMessage> HistoryController::getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    return localHistory_->getMessagesFromNextDate(selfJID, contactJID, type, date);
+HistoryContactsRequest::ref HistoryController::createContactsRequest(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
+    return localHistory_->createContactsRequest(selfJID, type, keyword);
 }
 
-ContactsMap HistoryController::getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
-    return localHistory_->getContacts(selfJID, type, keyword);
+HistoryMessagesRequest::ref HistoryController::createMUCContextRequest(const JID& selfJID, const JID& mucJID, const boost::posix_time::ptime& timeStamp) const {
+    boost::posix_time::ptime localTime = boost::date_time::c_local_adjustor<boost::posix_time::ptime>::utc_to_local(timeStamp);
+    return createMessagesFromDateRequest(selfJID, mucJID, HistoryMessage::Groupchat, localTime.date());
 }
 
-boost::posix_time::ptime HistoryController::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) {
-    return localHistory_->getLastTimeStampFromMUC(selfJID, mucJID);
+HistoryTimeStampRequest::ref HistoryController::createLastTimeStampFromMUCRequest(const JID& selfJID, const JID& mucJID) const {
+    return localHistory_->createLastTimeStampFromMUCRequest(selfJID, mucJID);
 }
 
 }
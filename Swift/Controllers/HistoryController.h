@@ -29,13 +29,13 @@ namespace Swift {
             ~HistoryController();
 
             void addMessage(const std::string& message, const JID& fromJID, const JID& toJID, HistoryMessage::Type type, const boost::posix_time::ptime& timeStamp);
-            std::vector<HistoryMessage> getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
-            std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
-            std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
-            ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword = std::string()) const;
-            std::vector<HistoryMessage> getMUCContext(const JID& selfJID, const JID& mucJID, const boost::posix_time::ptime& timeStamp) const;
-
-            boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID);
+            HistoryMessagesRequest::ref createMessagesFromDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
+            HistoryMessagesRequest::ref createMessagesFromPreviousDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
+            HistoryMessagesRequest::ref createMessagesFromNextDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
+            HistoryMessagesRequest::ref createMessagesPageRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) const;
+            HistoryContactsRequest::ref createContactsRequest(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword = std::string()) const;
+            HistoryMessagesRequest::ref createMUCContextRequest(const JID& selfJID, const JID& mucJID, const boost::posix_time::ptime& timeStamp) const;
+            HistoryTimeStampRequest::ref createLastTimeStampFromMUCRequest(const JID& selfJID, const JID& mucJID) const;
 
             boost::signals2::signal<void (const HistoryMessage&)> onNewMessage;
 
@@ -12,6 +12,8 @@
 
 #include <Swift/Controllers/HistoryViewController.h>
 
+#include <algorithm>
+
 #include <Swiften/Avatars/AvatarManager.h>
 #include <Swiften/Base/Path.h>
 #include <Swiften/Base/foreach.h>
@@ -26,6 +28,7 @@
 
 namespace Swift {
     static const std::string category[] = { "Contacts", "MUC", "Contacts" };
+    static const size_t messagesPageSize = 100;
 
 HistoryViewController::HistoryViewController(
         const JID& selfJID,
@@ -44,13 +47,15 @@ HistoryViewController::HistoryViewController(
             historyWindowFactory_(historyWindowFactory),
             historyWindow_(nullptr),
             selectedItem_(nullptr),
-            currentResultDate_(boost::gregorian::not_a_date_time) {
+            currentResultDate_(boost::gregorian::not_a_date_time),
+            bottomReached_(false) {
     uiEventStream_->onUIEvent.connect(boost::bind(&HistoryViewController::handleUIEvent, this, _1));
 
     roster_ = new Roster(false, true);
 }
 
 HistoryViewController::~HistoryViewController() {
+    cancelRequests();
     uiEventStream_->onUIEvent.disconnect(boost::bind(&HistoryViewController::handleUIEvent, this, _1));
     if (historyWindow_) {
         historyWindow_->onSelectedContactChanged.disconnect(boost::bind(&HistoryViewController::handleSelectedContactChanged, this, _1));
@@ -111,21 +116,21 @@ void HistoryViewController::handleSelectedContactChanged(RosterItem* newContact)
 
     JID contactJID = contact->getJID();
 
-    std::vector<HistoryMessage> messages;
+    bool found = false;
     for (int it = HistoryMessage::Chat; it <= HistoryMessage::PrivateMessage; it++) {
         HistoryMessage::Type type = static_cast<HistoryMessage::Type>(it);
 
         if (contacts_[type].count(contactJID)) {
             currentResultDate_ = *contacts_[type][contactJID].rbegin();
             selectedItemType_ = type;
-            messages = historyController_->getMessagesFromDate(selfJID_, contactJID, type, currentResultDate_);
+            found = true;
         }
     }
 
     historyWindow_->setDate(currentResultDate_);
 
-    foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, false);
+    if (found) {
+        showFirstPage(currentResultDate_);
     }
 }
 
@@ -140,10 +145,11 @@ void HistoryViewController::handleNewMessage(const HistoryMessage& message) {
         displayJID = contactJID.toBare();
     }
 
-    // check current conversation
-    if (selectedItem_ && selectedItem_->getJID() == displayJID) {
+    // check current conversation; if there are pages left to show, the message will be part of those
+    if (selectedItem_ && selectedItem_->getJID() == displayJID && bottomReached_) {
         if (historyWindow_->getLastVisibleDate() == message.getTime().date()) {
             addNewMessage(message, false);
+            liveMessages_.push_back(message);
         }
     }
 
@@ -174,24 +180,39 @@ void HistoryViewController::handleReturnPressed(const std::string& keyword) {
     for (int it = HistoryMessage::Chat; it <= HistoryMessage::PrivateMessage; it++) {
         HistoryMessage::Type type = static_cast<HistoryMessage::Type>(it);
 
-        contacts_[type] = historyController_->getContacts(selfJID_, type, keyword);
+        HistoryContactsRequest::ref request = historyController_->createContactsRequest(selfJID_, type, keyword);
+        request->onResponse.connect(boost::bind(&HistoryViewController::handleContactsResponse, this, type, request.get(), _1));
+        contactsRequests_.push_back(request);
+        request->send();
+    }
+}
 
-        for (ContactsMap::const_iterator contact = contacts_[type].begin(); contact != contacts_[type].end(); contact++) {
-            const JID& jid = contact->first;
-            std::string nick;
-            if (type == HistoryMessage::PrivateMessage) {
-                nick = jid.toString();
-            }
-            else {
-                nick = nickResolver_->jidToNick(jid);
-            }
-            roster_->addContact(jid, jid, nick, category[type], avatarManager_->getAvatarPath(jid));
+void HistoryViewController::handleContactsResponse(HistoryMessage::Type type, HistoryContactsRequest* request, const ContactsMap& contacts) {
+    // The request keeps itself alive while it emits its response
+    for (std::vector<HistoryContactsRequest::ref>::iterator i = contactsRequests_.begin(); i != contactsRequests_.end(); ++i) {
+        if (i->get() == request) {
+            contactsRequests_.erase(i);
+            break;
+        }
+    }
 
-            Presence::ref presence = getPresence(jid, type == HistoryMessage::Groupchat);
+    contacts_[type] = contacts;
 
-            if (presence.get()) {
-                roster_->applyOnItem(SetPresence(presence, JID::WithoutResource), jid);
-            }
+    for (ContactsMap::const_iterator contact = contacts_[type].begin(); contact != contacts_[type].end(); contact++) {
+        const JID& jid = contact->first;
+        std::string nick;
+        if (type == HistoryMessage::PrivateMessage) {
+            nick = jid.toString();
+        }
+        else {
+            nick = nickResolver_->jidToNick(jid);
+        }
+        roster_->addContact(jid, jid, nick, category[type], avatarManager_->getAvatarPath(jid));
+
+        Presence::ref presence = getPresence(jid, type == HistoryMessage::Groupchat);
+
+        if (presence.get()) {
+            roster_->applyOnItem(SetPresence(presence, JID::WithoutResource), jid);
         }
     }
 }
@@ -201,12 +222,12 @@ void HistoryViewController::handleScrollReachedTop(const boost::gregorian::date&
         return;
     }
 
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromPreviousDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date);
-
-    foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, true);
+    if (topMessageID_) {
+        sendMessagesRequest(historyController_->createMessagesPageRequest(selfJID_, selectedItem_->getJID(), selectedItemType_, boost::gregorian::date(boost::gregorian::not_a_date_time), messagesPageSize, topMessageID_, boost::optional<long long>()), true);
+    }
+    else {
+        sendMessagesRequest(historyController_->createMessagesFromPreviousDateRequest(selfJID_, selectedItem_->getJID(), selectedItemType_, date), true);
     }
-    historyWindow_->resetConversationViewTopInsertPoint();
 }
 
 void HistoryViewController::handleScrollReachedBottom(const boost::gregorian::date& date) {
@@ -214,10 +235,68 @@ void HistoryViewController::handleScrollReachedBottom(const boost::gregorian::da
         return;
     }
 
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromNextDate(selfJID_, selectedItem_->getJID(), selectedItemType_, date);
+    if (bottomMessageID_) {
+        sendMessagesRequest(historyController_->createMessagesPageRequest(selfJID_, selectedItem_->getJID(), selectedItemType_, boost::gregorian::date(boost::gregorian::not_a_date_time), messagesPageSize, boost::optional<long long>(), bottomMessageID_), false);
+    }
+    else {
+        sendMessagesRequest(historyController_->createMessagesFromNextDateRequest(selfJID_, selectedItem_->getJID(), selectedItemType_, date), false);
+    }
+}
+
+void HistoryViewController::showFirstPage(const boost::gregorian::date& date) {
+    topMessageID_ = boost::optional<long long>();
+    bottomMessageID_ = boost::optional<long long>();
+    bottomReached_ = false;
+    liveMessages_.clear();
+    sendMessagesRequest(historyController_->createMessagesPageRequest(selfJID_, selectedItem_->getJID(), selectedItemType_, date, messagesPageSize, boost::optional<long long>(), boost::optional<long long>()), false);
+}
+
+void HistoryViewController::sendMessagesRequest(HistoryMessagesRequest::ref request, bool addAtTheTop) {
+    // Only the latest request is of interest, responses to earlier ones would be shown in the wrong place
+    if (messagesRequest_) {
+        messagesRequest_->onResponse.disconnect_all_slots();
+    }
+    messagesRequest_ = request;
+    messagesRequest_->onResponse.connect(boost::bind(&HistoryViewController::handleMessagesResponse, this, _1, addAtTheTop));
+    messagesRequest_->send();
+}
+
+void HistoryViewController::handleMessagesResponse(const std::vector<HistoryMessage>& messages, bool addAtTheTop) {
+    messagesRequest_.reset();
 
     foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, false);
+        if (!addAtTheTop) {
+            // skip messages that were already shown when they were received
+            std::vector<HistoryMessage>::iterator liveMessage = std::find(liveMessages_.begin(), liveMessages_.end(), message);
+            if (liveMessage != liveMessages_.end()) {
+                liveMessages_.erase(liveMessage);
+                continue;
+            }
+        }
+        addNewMessage(message, addAtTheTop);
+    }
+    if (addAtTheTop) {
+        historyWindow_->resetConversationViewTopInsertPoint();
+    }
+
+    // Remember the outermost shown messages to continue paging from there
+    if (!messages.empty()) {
+        if (addAtTheTop || !topMessageID_) {
+            topMessageID_ = messages.front().getID();
+        }
+        if (!addAtTheTop || !bottomMessageID_) {
+            bottomMessageID_ = messages.back().getID();
+        }
+
+        // Pages cross date boundaries, so follow the date of the messages that were just loaded
+        boost::gregorian::date date = (addAtTheTop ? messages.front() : messages.back()).getTime().date();
+        if (date != currentResultDate_) {
+            currentResultDate_ = date;
+            historyWindow_->setDate(currentResultDate_);
+        }
+    }
+    if (!addAtTheTop) {
+        bottomReached_ = messages.size() < messagesPageSize;
     }
 }
 
@@ -226,20 +305,18 @@ void HistoryViewController::handleNextButtonClicked() {
         return;
     }
 
-    std::set<boost::gregorian::date>::iterator date = contacts_[selectedItemType_][selectedItem_->getJID()].find(currentResultDate_);
+    // The current date follows the paging, so it need not be one of the dates with results
+    std::set<boost::gregorian::date>::iterator date = contacts_[selectedItemType_][selectedItem_->getJID()].upper_bound(currentResultDate_);
 
-    if (*date == *contacts_[selectedItemType_][selectedItem_->getJID()].rbegin()) {
+    if (date == contacts_[selectedItemType_][selectedItem_->getJID()].end()) {
         return;
     }
 
     historyWindow_->resetConversationView();
-    currentResultDate_ = *(++date);
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
+    currentResultDate_ = *date;
     historyWindow_->setDate(currentResultDate_);
 
-    foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, false);
-    }
+    showFirstPage(currentResultDate_);
 }
 
 void HistoryViewController::handlePreviousButtonClicked() {
@@ -247,7 +324,7 @@ void HistoryViewController::handlePreviousButtonClicked() {
         return;
     }
 
-    std::set<boost::gregorian::date>::iterator date = contacts_[selectedItemType_][selectedItem_->getJID()].find(currentResultDate_);
+    std::set<boost::gregorian::date>::iterator date = contacts_[selectedItemType_][selectedItem_->getJID()].lower_bound(currentResultDate_);
 
     if (date == contacts_[selectedItemType_][selectedItem_->getJID()].begin()) {
         return;
@@ -255,15 +332,28 @@ void HistoryViewController::handlePreviousButtonClicked() {
 
     historyWindow_->resetConversationView();
     currentResultDate_ = *(--date);
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
     historyWindow_->setDate(currentResultDate_);
 
-    foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, false);
+    showFirstPage(currentResultDate_);
+}
+
+void HistoryViewController::cancelRequests() {
+    foreach (HistoryContactsRequest::ref request, contactsRequests_) {
+        request->onResponse.disconnect_all_slots();
+    }
+    contactsRequests_.clear();
+    if (messagesRequest_) {
+        messagesRequest_->onResponse.disconnect_all_slots();
+        messagesRequest_.reset();
     }
 }
 
 void HistoryViewController::reset() {
+    cancelRequests();
+    topMessageID_ = boost::optional<long long>();
+    bottomMessageID_ = boost::optional<long long>();
+    bottomReached_ = false;
+    liveMessages_.clear();
     roster_->removeAll();
     contacts_.clear();
     selectedItem_ = nullptr;
@@ -302,13 +392,9 @@ void HistoryViewController::handleCalendarClicked(const boost::gregorian::date&
     }
     currentResultDate_ = newDate;
     historyWindow_->resetConversationView();
-
-    std::vector<HistoryMessage> messages = historyController_->getMessagesFromDate(selfJID_, selectedItem_->getJID(), selectedItemType_, currentResultDate_);
     historyWindow_->setDate(currentResultDate_);
 
-    foreach (const HistoryMessage& message, messages) {
-        addNewMessage(message, false);
-    }
+    showFirstPage(currentResultDate_);
 }
 
 void HistoryViewController::handlePresenceChanged(Presence::ref presence) {
@@ -14,8 +14,10 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <boost/bind.hpp>
+#include <boost/optional.hpp>
 #include <boost/signals2.hpp>
 
 #include <Swiften/History/HistoryStorage.h>
@@ -51,8 +53,13 @@ namespace Swift {
             void handleCalendarClicked(const boost::gregorian::date& date);
             void handlePresenceChanged(Presence::ref presence);
             void handleAvatarChanged(const JID& jid);
+            void handleContactsResponse(HistoryMessage::Type type, HistoryContactsRequest* request, const ContactsMap& contacts);
+            void handleMessagesResponse(const std::vector<HistoryMessage>& messages, bool addAtTheTop);
 
             void addNewMessage(const HistoryMessage& message, bool addAtTheTop);
+            void sendMessagesRequest(HistoryMessagesRequest::ref request, bool addAtTheTop);
+            void showFirstPage(const boost::gregorian::date& date);
+            void cancelRequests();
             void reset();
             Presence::ref getPresence(const JID& jid, bool isMUC);
 
@@ -71,5 +78,11 @@ namespace Swift {
             ContactRosterItem* selectedItem_;
             HistoryMessage::Type selectedItemType_;
             boost::gregorian::date currentResultDate_;
+            std::vector<HistoryContactsRequest::ref> contactsRequests_;
+            HistoryMessagesRequest::ref messagesRequest_;
+            boost::optional<long long> topMessageID_;
+            boost::optional<long long> bottomMessageID_;
+            bool bottomReached_;
+            std::vector<HistoryMessage> liveMessages_;
     };
 }
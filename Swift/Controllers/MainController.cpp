@@ -347,7 +347,7 @@ void MainController::handleConnected() {
     if (freshLogin) {
         profileController_ = new ProfileController(client_->getVCardManager(), uiFactory_, uiEventStream_);
         showProfileController_ = new ShowProfileController(client_->getVCardManager(), uiFactory_, uiEventStream_);
-        ftOverview_ = new FileTransferOverview(client_->getFileTransferManager());
+        ftOverview_ = new FileTransferOverview(client_->getFileTransferManager(), storages_->getPartialFileStorage());
         fileTransferListController_->setFileTransferOverview(ftOverview_);
         rosterController_ = new RosterController(boundJID_, client_->getRoster(), client_->getAvatarManager(), uiFactory_, client_->getNickManager(), client_->getNickResolver(), client_->getPresenceOracle(), client_->getSubscriptionManager(), eventController_, uiEventStream_, client_->getIQRouter(), settings_, client_->getEntityCapsProvider(), ftOverview_, client_->getClientBlockListManager(), client_->getVCardManager());
         rosterController_->onChangeStatusRequest.connect(boost::bind(&MainController::handleChangeStatusRequest, this, _1, _2));
@@ -398,6 +398,7 @@ void MainController::handleConnected() {
         discoInfo.addFeature(DiscoInfo::JingleFTFeature);
         discoInfo.addFeature(DiscoInfo::JingleTransportsIBBFeature);
         discoInfo.addFeature(DiscoInfo::JingleTransportsS5BFeature);
+        discoInfo.addFeature(DiscoInfo::JingleFTParallelRangesFeature);
 #endif
 #ifdef SWIFT_EXPERIMENTAL_WB
         discoInfo.addFeature(DiscoInfo::WhiteboardFeature);
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Replays the initial presence burst of a login with a large roster, and
+ * measures how long it takes to get it into the contact list, both when
+ * every presence is processed on its own and when presences received
+ * together are processed as a batch.
+ *
+ * Usage: PresenceBurstBenchmark [number of contacts] [presences per read]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Client/DummyStanzaChannel.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/Presence/PresenceOracle.h>
+#include <Swiften/Roster/XMPPRosterImpl.h>
+
+#include <Swift/Controllers/Roster/ItemOperations/SetPresence.h>
+#include <Swift/Controllers/Roster/Roster.h>
+
+using namespace Swift;
+
+static const int numberOfGroups = 20;
+
+static int childrenChangedCount = 0;
+
+static JID getContactJID(int i) {
+    return JID("contact" + boost::lexical_cast<std::string>(i) + "@example.com");
+}
+
+static void handleChildrenChanged() {
+    childrenChangedCount++;
+}
+
+static void applyPresence(Roster* roster, PresenceOracle* oracle, Presence::ref presence) {
+    Presence::ref accountPresence = oracle->getAccountPresence(presence->getFrom().toBare());
+    if (!accountPresence) {
+        accountPresence = Presence::create();
+        accountPresence->setFrom(presence->getFrom());
+        accountPresence->setType(Presence::Unavailable);
+    }
+    roster->applyOnItems(SetPresence(accountPresence));
+}
+
+static void applyPresences(Roster* roster, PresenceOracle* oracle, const std::vector<Presence::ref>& presences) {
+    roster->beginUpdates();
+    foreach (Presence::ref presence, presences) {
+        applyPresence(roster, oracle, presence);
+    }
+    roster->endUpdates();
+}
+
+static void run(const std::string& name, bool batched, int numberOfContacts, int presencesPerRead) {
+    DummyStanzaChannel stanzaChannel;
+    XMPPRosterImpl xmppRoster;
+    PresenceOracle oracle(&stanzaChannel, &xmppRoster);
+    Roster roster;
+    for (int i = 0; i < numberOfContacts; ++i) {
+        roster.addContact(getContactJID(i), JID(), "Contact " + boost::lexical_cast<std::string>(i), "Group " + boost::lexical_cast<std::string>(i % numberOfGroups), "");
+    }
+    if (batched) {
+        oracle.onPresencesChanged.connect(boost::bind(&applyPresences, &roster, &oracle, _1));
+    }
+    else {
+        oracle.onPresenceChange.connect(boost::bind(&applyPresence, &roster, &oracle, _1));
+    }
+    roster.onChildrenChanged.connect(boost::bind(&handleChildrenChanged));
+    childrenChangedCount = 0;
+
+    std::vector<Presence::ref> presences;
+    for (int i = 0; i < numberOfContacts; ++i) {
+        Presence::ref presence = Presence::create();
+        presence->setFrom(JID(getContactJID(i).toString() + "/resource"));
+        presence->setShow(i % 3 == 0 ? StatusShow::Away : StatusShow::Online);
+        presences.push_back(presence);
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < presences.size(); ++i) {
+        if (i % static_cast<size_t>(presencesPerRead) == 0) {
+            stanzaChannel.onStanzaBatchStarted();
+        }
+        stanzaChannel.onPresenceReceived(presences[i]);
+        if ((i + 1) % static_cast<size_t>(presencesPerRead) == 0 || i + 1 == presences.size()) {
+            stanzaChannel.onStanzaBatchFinished();
+        }
+    }
+    std::chrono::steady_clock::duration duration = std::chrono::steady_clock::now() - start;
+
+    std::cout << name << ": " << std::chrono::duration_cast<std::chrono::milliseconds>(duration).count() << "ms, " << childrenChangedCount << " contact list change notifications" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int numberOfContacts = 5000;
+    int presencesPerRead = 50;
+    if (argc > 1) {
+        numberOfContacts = boost::lexical_cast<int>(argv[1]);
+    }
+    if (argc > 2) {
+        presencesPerRead = boost::lexical_cast<int>(argv[2]);
+    }
+    if (numberOfContacts <= 0 || presencesPerRead <= 0) {
+        std::cerr << "Usage: " << argv[0] << " [number of contacts] [presences per read]" << std::endl;
+        return -1;
+    }
+
+    std::cout << "Replaying presence of " << numberOfContacts << " contacts, " << presencesPerRead << " per read" << std::endl;
+    run("Per presence", false, numberOfContacts, presencesPerRead);
+    run("Batched", true, numberOfContacts, presencesPerRead);
+    return 0;
+}
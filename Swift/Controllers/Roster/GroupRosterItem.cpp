@@ -5,13 +5,15 @@
  */
 
 #include <Swift/Controllers/Roster/GroupRosterItem.h>
+#include <algorithm>
+#include <iostream>
+
 #include <boost/bind.hpp>
 //#include <boost/algorithm.hpp>
-#include <iostream>
 
 namespace Swift {
 
-GroupRosterItem::GroupRosterItem(const std::string& name, GroupRosterItem* parent, bool sortByStatus) : RosterItem(name, parent), sortByStatus_(sortByStatus), manualSort_(false) {
+GroupRosterItem::GroupRosterItem(const std::string& name, GroupRosterItem* parent, bool sortByStatus) : RosterItem(name, parent), sortByStatus_(sortByStatus), manualSort_(false), updatesDeferred_(false), updatePending_(false) {
     expanded_ = true;
 }
 
@@ -51,6 +53,16 @@ void GroupRosterItem::setExpanded(bool expanded) {
     }
 }
 
+void GroupRosterItem::setUpdatesDeferred(bool deferred) {
+    updatesDeferred_ = deferred;
+    if (!deferred && updatePending_) {
+        updatePending_ = false;
+        sortDisplayed();
+        onChildrenChanged();
+        onDataChanged();
+    }
+}
+
 const std::vector<RosterItem*>& GroupRosterItem::getChildren() const {
     return children_;
 }
@@ -193,21 +205,42 @@ void GroupRosterItem::setDisplayed(RosterItem* item, bool displayed) {
     }
     if (displayed) {
         displayedChildren_.push_back(item);
-        sortDisplayed();
     } else {
         displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), item), displayedChildren_.end());
     }
+    if (updatesDeferred_) {
+        updatePending_ = true;
+        return;
+    }
+    if (displayed) {
+        sortDisplayed();
+    }
     onChildrenChanged();
     onDataChanged();
 }
 
 void GroupRosterItem::handleDataChanged(RosterItem* /*item*/) {
+    if (updatesDeferred_) {
+        updatePending_ = true;
+        return;
+    }
     if (sortDisplayed()) {
         onChildrenChanged();
     }
 }
 
 void GroupRosterItem::handleChildrenChanged(GroupRosterItem* group) {
+    if (updatesDeferred_) {
+        bool found = std::find(displayedChildren_.begin(), displayedChildren_.end(), group) != displayedChildren_.end();
+        if (group->getDisplayedChildren().empty()) {
+            displayedChildren_.erase(std::remove(displayedChildren_.begin(), displayedChildren_.end(), group), displayedChildren_.end());
+        }
+        else if (!found) {
+            displayedChildren_.push_back(group);
+        }
+        updatePending_ = true;
+        return;
+    }
     size_t oldSize = getDisplayedChildren().size();
     if (group->getDisplayedChildren().size() > 0) {
         bool found = false;
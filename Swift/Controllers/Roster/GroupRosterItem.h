@@ -33,6 +33,11 @@ class GroupRosterItem : public RosterItem {
         boost::signals2::signal<void (bool)> onExpandedChanged;
         void setManualSort(const std::string& manualSortValue);
         virtual const std::string& getSortableDisplayName() const;
+        /**
+         * While updates are deferred, changes to children don't cause a resort
+         * or a change signal. These are done once when deferring is turned off.
+         */
+        void setUpdatesDeferred(bool deferred);
     private:
         void handleChildrenChanged(GroupRosterItem* group);
         void handleDataChanged(RosterItem* item);
@@ -44,6 +49,8 @@ class GroupRosterItem : public RosterItem {
         bool sortByStatus_;
         bool manualSort_;
         std::string manualSortValue_;
+        bool updatesDeferred_;
+        bool updatePending_;
 };
 
 }
@@ -6,6 +6,7 @@
 
 #include <Swift/Controllers/Roster/Roster.h>
 
+#include <cassert>
 #include <deque>
 #include <set>
 #include <string>
@@ -22,7 +23,7 @@
 
 namespace Swift {
 
-Roster::Roster(bool sortByStatus, bool fullJIDMapping) : blockingSupported_(false) {
+Roster::Roster(bool sortByStatus, bool fullJIDMapping) : blockingSupported_(false), updateDepth_(0) {
     sortByStatus_ = sortByStatus;
     fullJIDMapping_ = fullJIDMapping;
     root_ = new GroupRosterItem("Dummy-Root", nullptr, sortByStatus_);
@@ -81,6 +82,7 @@ GroupRosterItem* Roster::getGroup(const std::string& groupName) {
         }
     }
     GroupRosterItem* group = new GroupRosterItem(groupName, root_, sortByStatus_);
+    group->setUpdatesDeferred(updateDepth_ > 0);
     root_->addChild(group);
     group->onChildrenChanged.connect(boost::bind(&Roster::handleChildrenChanged, this, group));
     group->onDataChanged.connect(boost::bind(&Roster::handleDataChanged, this, group));
@@ -102,6 +104,35 @@ void Roster::removeGroup(const std::string& group) {
     root_->removeGroupChild(group);
 }
 
+void Roster::beginUpdates() {
+    if (updateDepth_++ > 0) {
+        return;
+    }
+    root_->setUpdatesDeferred(true);
+    foreach (RosterItem* item, root_->getChildren()) {
+        GroupRosterItem* group = dynamic_cast<GroupRosterItem*>(item);
+        if (group) {
+            group->setUpdatesDeferred(true);
+        }
+    }
+}
+
+void Roster::endUpdates() {
+    assert(updateDepth_ > 0);
+    if (--updateDepth_ > 0) {
+        return;
+    }
+    /* Groups first, so that the root only needs to be resorted once */
+    std::vector<RosterItem*> children = root_->getChildren();
+    foreach (RosterItem* item, children) {
+        GroupRosterItem* group = dynamic_cast<GroupRosterItem*>(item);
+        if (group) {
+            group->setUpdatesDeferred(false);
+        }
+    }
+    root_->setUpdatesDeferred(false);
+}
+
 void Roster::handleDataChanged(RosterItem* item) {
     onDataChanged(item);
 }
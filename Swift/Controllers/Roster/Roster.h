@@ -54,6 +54,13 @@ class Roster {
         GroupRosterItem* getGroup(const std::string& groupName);
         void setBlockingSupported(bool isSupported);
 
+        /**
+         * Groups aren't resorted, and don't signal changes to their children,
+         * between beginUpdates() and the matching endUpdates(). Calls can be nested.
+         */
+        void beginUpdates();
+        void endUpdates();
+
     private:
         void handleDataChanged(RosterItem* item);
         void handleChildrenChanged(GroupRosterItem* item);
@@ -67,6 +74,7 @@ class Roster {
         bool fullJIDMapping_;
         bool sortByStatus_;
         bool blockingSupported_;
+        int updateDepth_;
 };
 
 }
@@ -84,7 +84,7 @@ RosterController::RosterController(const JID& jid, XMPPRoster* xmppRoster, Avata
 
     vcardManager_->onOwnVCardChanged.connect(boost::bind(&RosterController::handleOwnVCardChanged, this, _1));
     avatarManager_->onAvatarChanged.connect(boost::bind(&RosterController::handleAvatarChanged, this, _1));
-    presenceOracle_->onPresenceChange.connect(boost::bind(&RosterController::handlePresenceChanged, this, _1));
+    presenceOracle_->onPresencesChanged.connect(boost::bind(&RosterController::handlePresencesChanged, this, _1));
     mainWindow_->setMyAvatarPath(pathToString(avatarManager_->getAvatarPath(myJID_.toBare())));
 
     nickManager_->onOwnNickChanged.connect(boost::bind(&MainWindow::setMyNick, mainWindow_, _1));
@@ -381,6 +381,14 @@ void RosterController::handleAvatarChanged(const JID& jid) {
     }
 }
 
+void RosterController::handlePresencesChanged(const std::vector<Presence::ref>& presences) {
+    roster_->beginUpdates();
+    foreach (Presence::ref presence, presences) {
+        handlePresenceChanged(presence);
+    }
+    roster_->endUpdates();
+}
+
 void RosterController::handlePresenceChanged(Presence::ref presence) {
     if (presence->getFrom().equals(myJID_, JID::WithResource)) {
         ownContact_->applyPresence(presence);
@@ -400,7 +408,7 @@ std::set<std::string> RosterController::getGroups() const {
 }
 
 void RosterController::handleOnCapsChanged(const JID& jid) {
-    DiscoInfo::ref info = entityCapsManager_->getCaps(jid);
+    std::shared_ptr<const DiscoInfo> info = entityCapsManager_->getCaps(jid);
     if (info) {
         std::set<ContactRosterItem::Feature> features;
         if (FileTransferManager::isSupportedBy(info)) {
@@ -9,6 +9,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <boost/signals2.hpp>
 
@@ -58,6 +59,7 @@ namespace Swift {
             boost::signals2::signal<void ()> onSignOutRequest;
             void handleOwnVCardChanged(VCard::ref vcard);
             void handleAvatarChanged(const JID& jid);
+            void handlePresencesChanged(const std::vector<Presence::ref>& presences);
             void handlePresenceChanged(Presence::ref presence);
             void setEnabled(bool enabled);
 
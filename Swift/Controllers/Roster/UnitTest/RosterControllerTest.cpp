@@ -46,7 +46,7 @@ using namespace Swift;
 #define CHILDREN mainWindow_->roster->getRoot()->getChildren()
 
 class DummyCapsProvider : public CapsProvider {
-        DiscoInfo::ref getCaps(const std::string&) const {return DiscoInfo::ref(new DiscoInfo());}
+        std::shared_ptr<const DiscoInfo> getCaps(const std::string&) const {return std::shared_ptr<const DiscoInfo>(new DiscoInfo());}
 };
 
 class RosterControllerTest : public CppUnit::TestFixture {
@@ -6,6 +6,8 @@
 
 #include <memory>
 
+#include <boost/bind.hpp>
+
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
 
@@ -23,6 +25,7 @@ class RosterTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testRemoveSecondContactSameBare);
         CPPUNIT_TEST(testApplyPresenceLikeMUC);
         CPPUNIT_TEST(testReSortLikeMUC);
+        CPPUNIT_TEST(testUpdatesDeferred);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -31,6 +34,7 @@ class RosterTest : public CppUnit::TestFixture {
             jid2_ = JID("b@c.d");
             jid3_ = JID("c@d.e");
             roster_ = new Roster();
+            childrenChangedCount_ = 0;
         }
 
         void tearDown() {
@@ -135,8 +139,40 @@ class RosterTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("group1"), kids[1]->getDisplayName());
         }
 
+        void testUpdatesDeferred() {
+            roster_->addContact(jid1_, JID(), "Bert", "group1", "");
+            roster_->addContact(jid2_, JID(), "Cookie", "group1", "");
+            roster_->addContact(jid3_, JID(), "Ernie", "group1", "");
+            roster_->onChildrenChanged.connect(boost::bind(&RosterTest::handleChildrenChanged, this));
+            GroupRosterItem* group = roster_->getGroup("group1");
+
+            roster_->beginUpdates();
+            std::shared_ptr<Presence> presence(new Presence());
+            presence->setFrom(jid3_);
+            roster_->applyOnItems(SetPresence(presence));
+            presence = std::make_shared<Presence>();
+            presence->setFrom(jid2_);
+            roster_->applyOnItems(SetPresence(presence));
+
+            CPPUNIT_ASSERT_EQUAL(0, childrenChangedCount_);
+            CPPUNIT_ASSERT_EQUAL(std::string("Bert"), group->getDisplayedChildren()[0]->getDisplayName());
+
+            roster_->endUpdates();
+
+            CPPUNIT_ASSERT(childrenChangedCount_ > 0);
+            CPPUNIT_ASSERT_EQUAL(std::string("Cookie"), group->getDisplayedChildren()[0]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("Ernie"), group->getDisplayedChildren()[1]->getDisplayName());
+            CPPUNIT_ASSERT_EQUAL(std::string("Bert"), group->getDisplayedChildren()[2]->getDisplayName());
+        }
+
+    private:
+        void handleChildrenChanged() {
+            childrenChangedCount_++;
+        }
+
     private:
         Roster *roster_;
+        int childrenChangedCount_;
         JID jid1_;
         JID jid2_;
         JID jid3_;
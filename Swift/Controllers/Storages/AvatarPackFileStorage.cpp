@@ -0,0 +1,424 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swift/Controllers/Storages/AvatarPackFileStorage.h>
+
+#include <cassert>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <Swiften/Base/Log.h>
+#include <Swiften/Base/String.h>
+#include <Swiften/Base/foreach.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/StringCodecs/Hexify.h>
+
+/*
+ * Each record in the pack consists of a header, the hash of the avatar, and
+ * the avatar data. The header is the record magic, followed by the length of
+ * the hash (1 byte) and the length of the data (4 bytes, big endian).
+ * Records are only ever appended; a record that was not completely written
+ * is dropped when the pack is loaded.
+ */
+
+namespace Swift {
+
+static const char packRecordMagic[] = { 'S', 'A', 'V', '1' };
+static const size_t packRecordMagicSize = sizeof(packRecordMagic);
+static const size_t packRecordHeaderSize = packRecordMagicSize + 1 + 4;
+
+AvatarPackFileStorage::AvatarPackFileStorage(const boost::filesystem::path& avatarsDir, const boost::filesystem::path& avatarsFile, const boost::filesystem::path& packFile, const boost::filesystem::path& cacheDir, CryptoProvider* crypto, size_t maximumCacheSize) : avatarsDir(avatarsDir), avatarsFile(avatarsFile), packFile(packFile), cacheDir(cacheDir), crypto(crypto), maximumCacheSize(maximumCacheSize), jidAvatarsFileEntries(0), packSize(0), cacheSize(0) {
+    try {
+        if (!boost::filesystem::exists(packFile.parent_path())) {
+            boost::filesystem::create_directories(packFile.parent_path());
+        }
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+    }
+    loadJIDAvatars();
+    loadPack();
+    importLegacyAvatars();
+
+    std::set<std::string> usedAvatars;
+    foreach (const JIDAvatarMap::value_type& jidAvatar, jidAvatars) {
+        usedAvatars.insert(jidAvatar.second);
+    }
+    boost::uintmax_t unusedPackSize = 0;
+    foreach (const PackIndex::value_type& entry, index) {
+        if (usedAvatars.find(entry.first) == usedAvatars.end()) {
+            unusedPackSize += entry.second.size;
+        }
+    }
+    if (unusedPackSize > 1024 * 1024 && unusedPackSize > packSize / 2) {
+        compact();
+    }
+}
+
+AvatarPackFileStorage::~AvatarPackFileStorage() {
+}
+
+bool AvatarPackFileStorage::hasAvatar(const std::string& hash) const {
+    return index.find(hash) != index.end();
+}
+
+void AvatarPackFileStorage::addAvatar(const std::string& hash, const ByteArray& avatar) {
+    assert(Hexify::hexify(crypto->getSHA1Hash(avatar)) == hash);
+
+    if (hasAvatar(hash)) {
+        return;
+    }
+    if (appendToPack(hash, avatar)) {
+        addToCache(hash, avatar);
+    }
+}
+
+ByteArray AvatarPackFileStorage::getAvatar(const std::string& hash) const {
+    std::map<std::string, CacheList::iterator>::const_iterator cached = cacheIndex.find(hash);
+    if (cached != cacheIndex.end()) {
+        cache.splice(cache.begin(), cache, cached->second);
+        return cached->second->second;
+    }
+
+    PackIndex::const_iterator i = index.find(hash);
+    if (i == index.end()) {
+        return ByteArray();
+    }
+    const PackEntry& entry = i->second;
+    if (!packMapping.isOpen() || entry.offset + entry.size > packMapping.getSize()) {
+        if (!packMapping.open(packFile)) {
+            std::cerr << "Error mapping avatar pack" << std::endl;
+            return ByteArray();
+        }
+        if (entry.offset + entry.size > packMapping.getSize()) {
+            return ByteArray();
+        }
+    }
+    const unsigned char* data = packMapping.getData() + entry.offset;
+    ByteArray avatar(data, data + entry.size);
+    addToCache(hash, avatar);
+    return avatar;
+}
+
+boost::filesystem::path AvatarPackFileStorage::getAvatarPath(const std::string& hash) const {
+    if (!hasAvatar(hash)) {
+        return boost::filesystem::path();
+    }
+    boost::filesystem::path path = cacheDir / hash;
+    if (extractedAvatars.find(hash) != extractedAvatars.end()) {
+        return path;
+    }
+    try {
+        if (!isExtracted(path, hash)) {
+            if (!boost::filesystem::exists(cacheDir)) {
+                boost::filesystem::create_directories(cacheDir);
+            }
+            // Write to a temporary file first, so a file with the avatar's name is always complete
+            boost::filesystem::path extractedPath = path;
+            extractedPath += ".tmp";
+            ByteArray avatar = getAvatar(hash);
+            boost::filesystem::ofstream file(extractedPath, boost::filesystem::ofstream::binary|boost::filesystem::ofstream::out|boost::filesystem::ofstream::trunc);
+            file.write(reinterpret_cast<const char*>(vecptr(avatar)), static_cast<std::streamsize>(avatar.size()));
+            file.close();
+            if (!file) {
+                std::cerr << "Error extracting avatar" << std::endl;
+                boost::filesystem::remove(extractedPath);
+                return boost::filesystem::path();
+            }
+            boost::filesystem::rename(extractedPath, path);
+        }
+        extractedAvatars.insert(hash);
+        return path;
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return boost::filesystem::path();
+    }
+}
+
+void AvatarPackFileStorage::setAvatarForJID(const JID& jid, const std::string& hash) {
+    std::pair<JIDAvatarMap::iterator, bool> r = jidAvatars.insert(std::make_pair(jid, hash));
+    if (r.second) {
+        appendJIDAvatar(jid, hash);
+    }
+    else if (r.first->second != hash) {
+        r.first->second = hash;
+        appendJIDAvatar(jid, hash);
+    }
+}
+
+bool AvatarPackFileStorage::isExtracted(const boost::filesystem::path& path, const std::string& hash) const {
+    PackIndex::const_iterator i = index.find(hash);
+    if (i == index.end() || !boost::filesystem::is_regular_file(path) || boost::filesystem::file_size(path) != i->second.size) {
+        return false;
+    }
+    ByteArray avatar;
+    readByteArrayFromFile(avatar, path);
+    return Hexify::hexify(crypto->getSHA1Hash(avatar)) == hash;
+}
+
+std::string AvatarPackFileStorage::getAvatarForJID(const JID& jid) const {
+    JIDAvatarMap::const_iterator i = jidAvatars.find(jid);
+    return i == jidAvatars.end() ? "" : i->second;
+}
+
+void AvatarPackFileStorage::compact() {
+    if (!packMapping.open(packFile)) {
+        return;
+    }
+    std::set<std::string> usedAvatars;
+    foreach (const JIDAvatarMap::value_type& jidAvatar, jidAvatars) {
+        usedAvatars.insert(jidAvatar.second);
+    }
+
+    boost::filesystem::path compactedPackFile = packFile;
+    compactedPackFile += ".tmp";
+    try {
+        boost::filesystem::ofstream file(compactedPackFile, boost::filesystem::ofstream::binary|boost::filesystem::ofstream::out|boost::filesystem::ofstream::trunc);
+        foreach (const PackIndex::value_type& entry, index) {
+            if (usedAvatars.find(entry.first) == usedAvatars.end()) {
+                continue;
+            }
+            if (entry.second.offset + entry.second.size > packMapping.getSize()) {
+                continue;
+            }
+            boost::uintmax_t recordOffset = entry.second.offset - entry.first.size() - packRecordHeaderSize;
+            file.write(reinterpret_cast<const char*>(packMapping.getData() + recordOffset), static_cast<std::streamsize>(packRecordHeaderSize + entry.first.size() + entry.second.size));
+        }
+        file.close();
+        if (!file) {
+            std::cerr << "Error writing avatar pack" << std::endl;
+            boost::filesystem::remove(compactedPackFile);
+            return;
+        }
+        packMapping.close();
+        boost::filesystem::rename(compactedPackFile, packFile);
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return;
+    }
+
+    cache.clear();
+    cacheIndex.clear();
+    cacheSize = 0;
+    loadPack();
+
+    // Extracted files of avatars that are no longer in the pack are not needed anymore
+    try {
+        if (boost::filesystem::is_directory(cacheDir)) {
+            std::vector<boost::filesystem::path> unusedFiles;
+            for (boost::filesystem::directory_iterator i(cacheDir); i != boost::filesystem::directory_iterator(); ++i) {
+                if (!hasAvatar(i->path().filename().string())) {
+                    unusedFiles.push_back(i->path());
+                }
+            }
+            foreach (const boost::filesystem::path& path, unusedFiles) {
+                boost::filesystem::remove(path);
+                extractedAvatars.erase(path.filename().string());
+            }
+        }
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+    }
+}
+
+void AvatarPackFileStorage::loadJIDAvatars() {
+    if (!boost::filesystem::exists(avatarsFile)) {
+        return;
+    }
+    try {
+        boost::filesystem::ifstream file(avatarsFile);
+        std::string line;
+        if (file.is_open()) {
+            while (!file.eof()) {
+                getline(file, line);
+                std::pair<std::string, std::string> r = String::getSplittedAtFirst(line, ' ');
+                JID jid(r.second);
+                if (jid.isValid()) {
+                    // Later entries override earlier ones
+                    jidAvatars[jid] = r.first;
+                    ++jidAvatarsFileEntries;
+                }
+                else if (!r.first.empty() || !r.second.empty()) {
+                    std::cerr << "Invalid entry in avatars file: " << r.second << std::endl;
+                }
+            }
+        }
+    }
+    catch (...) {
+        std::cerr << "Error reading avatars file" << std::endl;
+    }
+}
+
+void AvatarPackFileStorage::saveJIDAvatars() {
+    boost::filesystem::path newAvatarsFile = avatarsFile;
+    newAvatarsFile += ".tmp";
+    try {
+        boost::filesystem::ofstream file(newAvatarsFile);
+        for (JIDAvatarMap::const_iterator i = jidAvatars.begin(); i != jidAvatars.end(); ++i) {
+            file << i->second << " " << i->first.toString() << std::endl;
+        }
+        file.close();
+        if (file) {
+            boost::filesystem::rename(newAvatarsFile, avatarsFile);
+            jidAvatarsFileEntries = jidAvatars.size();
+        }
+    }
+    catch (...) {
+        std::cerr << "Error writing avatars file" << std::endl;
+    }
+}
+
+void AvatarPackFileStorage::appendJIDAvatar(const JID& jid, const std::string& hash) {
+    if (jidAvatarsFileEntries >= 2 * jidAvatars.size() + 16) {
+        saveJIDAvatars();
+        return;
+    }
+    try {
+        boost::filesystem::ofstream file(avatarsFile, boost::filesystem::ofstream::out|boost::filesystem::ofstream::app);
+        file << hash << " " << jid.toString() << std::endl;
+        file.close();
+        ++jidAvatarsFileEntries;
+    }
+    catch (...) {
+        std::cerr << "Error writing avatars file" << std::endl;
+    }
+}
+
+void AvatarPackFileStorage::loadPack() {
+    index.clear();
+    packSize = 0;
+    if (!boost::filesystem::exists(packFile) || !packMapping.open(packFile)) {
+        packMapping.close();
+        return;
+    }
+
+    const unsigned char* data = packMapping.getData();
+    size_t size = packMapping.getSize();
+    size_t offset = 0;
+    while (offset + packRecordHeaderSize <= size) {
+        const unsigned char* header = data + offset;
+        if (memcmp(header, packRecordMagic, packRecordMagicSize) != 0) {
+            break;
+        }
+        size_t hashSize = header[packRecordMagicSize];
+        size_t avatarSize = (static_cast<size_t>(header[packRecordMagicSize + 1]) << 24)
+                | (static_cast<size_t>(header[packRecordMagicSize + 2]) << 16)
+                | (static_cast<size_t>(header[packRecordMagicSize + 3]) << 8)
+                | static_cast<size_t>(header[packRecordMagicSize + 4]);
+        size_t avatarOffset = offset + packRecordHeaderSize + hashSize;
+        if (avatarOffset > size || avatarSize > size - avatarOffset) {
+            break;
+        }
+        std::string hash(reinterpret_cast<const char*>(header + packRecordHeaderSize), hashSize);
+        index.insert(std::make_pair(hash, PackEntry(avatarOffset, avatarSize)));
+        offset = avatarOffset + avatarSize;
+    }
+    packSize = offset;
+
+    if (offset < size) {
+        SWIFT_LOG(warning) << "Dropping incomplete data at the end of the avatar pack" << std::endl;
+        packMapping.close();
+        try {
+            boost::filesystem::resize_file(packFile, offset);
+        }
+        catch (const boost::filesystem::filesystem_error& e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+        }
+    }
+}
+
+bool AvatarPackFileStorage::appendToPack(const std::string& hash, const ByteArray& avatar) {
+    if (hash.size() > 0xFF || avatar.size() > 0xFFFFFFFFU) {
+        return false;
+    }
+    unsigned char header[packRecordHeaderSize];
+    memcpy(header, packRecordMagic, packRecordMagicSize);
+    header[packRecordMagicSize] = static_cast<unsigned char>(hash.size());
+    header[packRecordMagicSize + 1] = static_cast<unsigned char>((avatar.size() >> 24) & 0xFF);
+    header[packRecordMagicSize + 2] = static_cast<unsigned char>((avatar.size() >> 16) & 0xFF);
+    header[packRecordMagicSize + 3] = static_cast<unsigned char>((avatar.size() >> 8) & 0xFF);
+    header[packRecordMagicSize + 4] = static_cast<unsigned char>(avatar.size() & 0xFF);
+
+    try {
+        boost::filesystem::ofstream file(packFile, boost::filesystem::ofstream::binary|boost::filesystem::ofstream::out|boost::filesystem::ofstream::app);
+        file.write(reinterpret_cast<const char*>(header), static_cast<std::streamsize>(packRecordHeaderSize));
+        file.write(hash.data(), static_cast<std::streamsize>(hash.size()));
+        file.write(reinterpret_cast<const char*>(vecptr(avatar)), static_cast<std::streamsize>(avatar.size()));
+        file.close();
+        if (!file) {
+            std::cerr << "Error writing avatar pack" << std::endl;
+            return false;
+        }
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return false;
+    }
+
+    boost::uintmax_t avatarOffset = packSize + packRecordHeaderSize + hash.size();
+    index.insert(std::make_pair(hash, PackEntry(avatarOffset, avatar.size())));
+    packSize = avatarOffset + avatar.size();
+    return true;
+}
+
+void AvatarPackFileStorage::importLegacyAvatars() {
+    if (!boost::filesystem::exists(avatarsDir)) {
+        return;
+    }
+    foreach (const JIDAvatarMap::value_type& jidAvatar, jidAvatars) {
+        const std::string& hash = jidAvatar.second;
+        if (hash.empty()) {
+            continue;
+        }
+        boost::filesystem::path path = avatarsDir / hash;
+        try {
+            if (!boost::filesystem::is_regular_file(path)) {
+                continue;
+            }
+            if (!hasAvatar(hash)) {
+                ByteArray avatar;
+                readByteArrayFromFile(avatar, path);
+                if (Hexify::hexify(crypto->getSHA1Hash(avatar)) == hash) {
+                    appendToPack(hash, avatar);
+                }
+            }
+            // Once an avatar is in the pack, its legacy file is no longer needed
+            if (hasAvatar(hash)) {
+                boost::filesystem::remove(path);
+            }
+        }
+        catch (const boost::filesystem::filesystem_error& e) {
+            std::cerr << "ERROR: " << e.what() << std::endl;
+        }
+    }
+
+    // Only removes the directory when all avatars in it were imported
+    boost::system::error_code error;
+    boost::filesystem::remove(avatarsDir, error);
+}
+
+void AvatarPackFileStorage::addToCache(const std::string& hash, const ByteArray& avatar) const {
+    if (avatar.size() > maximumCacheSize || cacheIndex.find(hash) != cacheIndex.end()) {
+        return;
+    }
+    cache.push_front(std::make_pair(hash, avatar));
+    cacheIndex[hash] = cache.begin();
+    cacheSize += avatar.size();
+    while (cacheSize > maximumCacheSize) {
+        cacheSize -= cache.back().second.size();
+        cacheIndex.erase(cache.back().first);
+        cache.pop_back();
+    }
+}
+
+}
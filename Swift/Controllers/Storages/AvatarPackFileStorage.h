@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Avatars/AvatarStorage.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/MemoryMappedFile.h>
+#include <Swiften/JID/JID.h>
+
+namespace Swift {
+    class CryptoProvider;
+
+    /**
+     * An avatar storage that keeps all avatars in a single append-only pack
+     * file, instead of one file per avatar.
+     *
+     * The pack is read through a memory mapping, and an index of the pack is
+     * kept in memory, together with a bounded cache of recently used avatars.
+     * Changes to the JID to avatar mapping are appended to the avatars file,
+     * which is only rewritten when it has grown too much.
+     *
+     * The pack is the only place avatars are stored. Callers that can should
+     * use getAvatar(); for callers that need a file, getAvatarPath() extracts
+     * the avatar to the cache directory. Extracted files are kept across
+     * sessions, and are only written again when they are missing or their
+     * contents no longer match their hash.
+     * Avatars stored in the avatars directory by \ref AvatarFileStorage for
+     * JIDs in the avatars file are added to the pack on construction, and
+     * removed from the avatars directory once they are in the pack.
+     *
+     * Since unused avatars are dropped when the pack is compacted, a pack
+     * should not be shared between different avatars files.
+     */
+    class AvatarPackFileStorage : public AvatarStorage {
+        public:
+            AvatarPackFileStorage(const boost::filesystem::path& avatarsDir, const boost::filesystem::path& avatarsFile, const boost::filesystem::path& packFile, const boost::filesystem::path& cacheDir, CryptoProvider* crypto, size_t maximumCacheSize = 4 * 1024 * 1024);
+            virtual ~AvatarPackFileStorage();
+
+            virtual bool hasAvatar(const std::string& hash) const;
+            virtual void addAvatar(const std::string& hash, const ByteArray& avatar);
+            virtual ByteArray getAvatar(const std::string& hash) const;
+
+            virtual boost::filesystem::path getAvatarPath(const std::string& hash) const;
+
+            virtual void setAvatarForJID(const JID& jid, const std::string& hash);
+            virtual std::string getAvatarForJID(const JID& jid) const;
+
+            /**
+             * Rewrites the pack with only the avatars that are still used by a JID,
+             * and removes the extracted files of the dropped avatars.
+             */
+            void compact();
+
+        private:
+            struct PackEntry {
+                PackEntry(boost::uintmax_t offset, size_t size) : offset(offset), size(size) {}
+
+                boost::uintmax_t offset;
+                size_t size;
+            };
+            typedef std::map<std::string, PackEntry> PackIndex;
+            typedef std::map<JID, std::string> JIDAvatarMap;
+            typedef std::list<std::pair<std::string, ByteArray> > CacheList;
+
+            void loadJIDAvatars();
+            void saveJIDAvatars();
+            void appendJIDAvatar(const JID& jid, const std::string& hash);
+            void loadPack();
+            bool appendToPack(const std::string& hash, const ByteArray& avatar);
+            void importLegacyAvatars();
+            bool isExtracted(const boost::filesystem::path& path, const std::string& hash) const;
+            void addToCache(const std::string& hash, const ByteArray& avatar) const;
+
+        private:
+            boost::filesystem::path avatarsDir;
+            boost::filesystem::path avatarsFile;
+            boost::filesystem::path packFile;
+            boost::filesystem::path cacheDir;
+            CryptoProvider* crypto;
+            size_t maximumCacheSize;
+
+            JIDAvatarMap jidAvatars;
+            size_t jidAvatarsFileEntries;
+
+            PackIndex index;
+            boost::uintmax_t packSize;
+            mutable MemoryMappedFile packMapping;
+
+            mutable CacheList cache;
+            mutable std::map<std::string, CacheList::iterator> cacheIndex;
+            mutable size_t cacheSize;
+
+            mutable std::set<std::string> extractedAvatars;
+    };
+}
@@ -19,11 +19,11 @@ typedef GenericPayloadPersister<DiscoInfo, DiscoInfoParser, DiscoInfoSerializer>
 CapsFileStorage::CapsFileStorage(const boost::filesystem::path& path) : path(path) {
 }
 
-DiscoInfo::ref CapsFileStorage::getDiscoInfo(const std::string& hash) const {
+std::shared_ptr<const DiscoInfo> CapsFileStorage::getDiscoInfo(const std::string& hash) const {
     return DiscoInfoPersister().loadPayloadGeneric(getCapsPath(hash));
 }
 
-void CapsFileStorage::setDiscoInfo(const std::string& hash, DiscoInfo::ref discoInfo) {
+void CapsFileStorage::setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) {
     DiscoInfo::ref bareDiscoInfo(new DiscoInfo(*discoInfo.get()));
     bareDiscoInfo->setNode("");
     DiscoInfoPersister().savePayload(bareDiscoInfo, getCapsPath(hash));
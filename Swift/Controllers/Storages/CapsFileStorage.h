@@ -17,8 +17,8 @@ namespace Swift {
         public:
             CapsFileStorage(const boost::filesystem::path& path);
 
-            virtual DiscoInfo::ref getDiscoInfo(const std::string& hash) const;
-            virtual void setDiscoInfo(const std::string& hash, DiscoInfo::ref discoInfo);
+            virtual std::shared_ptr<const DiscoInfo> getDiscoInfo(const std::string& hash) const;
+            virtual void setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo);
 
         private:
             boost::filesystem::path getCapsPath(const std::string& hash) const;
@@ -7,34 +7,45 @@
 #include <Swift/Controllers/Storages/FileStorages.h>
 
 #include <Swiften/Base/Path.h>
+#include <Swiften/Disco/CachingCapsStorage.h>
+#include <Swiften/FileTransfer/PartialFileStorage.h>
 #include <Swiften/History/SQLiteHistoryStorage.h>
 
-#include <Swift/Controllers/Storages/AvatarFileStorage.h>
+#include <Swift/Controllers/Storages/AvatarPackFileStorage.h>
 #include <Swift/Controllers/Storages/CapsFileStorage.h>
 #include <Swift/Controllers/Storages/RosterFileStorage.h>
 #include <Swift/Controllers/Storages/VCardFileStorage.h>
 
 namespace Swift {
 
-FileStorages::FileStorages(const boost::filesystem::path& baseDir, const JID& jid, CryptoProvider* crypto) {
+FileStorages::FileStorages(const boost::filesystem::path& baseDir, const JID& jid, CryptoProvider* crypto, EventLoop* eventLoop, TimerFactory* timerFactory) {
     boost::filesystem::path profile = stringToPath(jid.toBare());
-    vcardStorage = new VCardFileStorage(baseDir / profile / "vcards", crypto);
-    capsStorage = new CapsFileStorage(baseDir / "caps");
-    avatarStorage = new AvatarFileStorage(baseDir / "avatars", baseDir / profile / "avatars", crypto);
+    vcardStorage = new VCardFileStorage(baseDir / profile / "vcards", crypto, timerFactory);
+    capsFileStorage = new CapsFileStorage(baseDir / "caps");
+    capsStorage = new CachingCapsStorage(capsFileStorage);
+    avatarStorage = new AvatarPackFileStorage(baseDir / "avatars", baseDir / profile / "avatars", baseDir / profile / "avatars.pack", baseDir / profile / "avatars.cache", crypto);
     rosterStorage = new RosterFileStorage(baseDir / profile / "roster.xml");
 #ifdef SWIFT_EXPERIMENTAL_HISTORY
-    historyStorage = new SQLiteHistoryStorage(baseDir / "history.db");
+    historyStorage = new SQLiteHistoryStorage(baseDir / "history.db", eventLoop);
 #else
+    (void) eventLoop;
     historyStorage = nullptr;
 #endif
+#ifdef SWIFT_EXPERIMENTAL_FT
+    partialFileStorage = new PartialFileStorage(baseDir / profile / "partial-transfers", crypto);
+#else
+    partialFileStorage = nullptr;
+#endif
 }
 
 FileStorages::~FileStorages() {
     delete rosterStorage;
     delete avatarStorage;
     delete capsStorage;
+    delete capsFileStorage;
     delete vcardStorage;
     delete historyStorage;
+    delete partialFileStorage;
 }
 
 VCardStorage* FileStorages::getVCardStorage() const {
@@ -61,4 +72,8 @@ HistoryStorage* FileStorages::getHistoryStorage() const {
 #endif
 }
 
+PartialFileStorage* FileStorages::getPartialFileStorage() const {
+    return partialFileStorage;
+}
+
 }
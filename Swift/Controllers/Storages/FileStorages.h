@@ -12,12 +12,16 @@
 
 namespace Swift {
     class VCardFileStorage;
-    class AvatarFileStorage;
+    class AvatarPackFileStorage;
     class CapsFileStorage;
+    class CachingCapsStorage;
     class RosterFileStorage;
     class HistoryStorage;
+    class PartialFileStorage;
     class JID;
     class CryptoProvider;
+    class EventLoop;
+    class TimerFactory;
 
     /**
      * A storages implementation that stores all controller data on disk.
@@ -30,15 +34,21 @@ namespace Swift {
              * All data will be stored relative to a base directory, and
              * for some controllers, in a subdirectory for the given profile.
              * The data is stored in the following places:
-             * - Avatars: $basedir/avatars
+             * - Avatars: $basedir/$profile/avatars.pack, extracted for display to
+             *   $basedir/$profile/avatars.cache. Avatars from $basedir/avatars are
+             *   moved into the pack.
              * - VCards:  $basedir/$profile/vcards
              * - Entity capabilities: $basedir/caps
+             * - Interrupted incoming file transfers: $basedir/$profile/partial-transfers
              *
              * \param baseDir the base dir to store data relative to
              * \param jid the subdir in which profile-specific data will be stored.
              *   The bare JID will be used as the subdir name.
+             * \param eventLoop if given, history queries are run on a worker thread
+             *   and their results are delivered on this event loop.
+             * \param timerFactory if given, VCard writes are deferred and batched.
              */
-            FileStorages(const boost::filesystem::path& baseDir, const JID& jid, CryptoProvider*);
+            FileStorages(const boost::filesystem::path& baseDir, const JID& jid, CryptoProvider*, EventLoop* eventLoop = nullptr, TimerFactory* timerFactory = nullptr);
             ~FileStorages();
 
             virtual VCardStorage* getVCardStorage() const;
@@ -46,12 +56,15 @@ namespace Swift {
             virtual CapsStorage* getCapsStorage() const;
             virtual RosterStorage* getRosterStorage() const;
             virtual HistoryStorage* getHistoryStorage() const;
+            virtual PartialFileStorage* getPartialFileStorage() const;
 
         private:
             VCardFileStorage* vcardStorage;
-            AvatarFileStorage* avatarStorage;
-            CapsFileStorage* capsStorage;
+            AvatarPackFileStorage* avatarStorage;
+            CapsFileStorage* capsFileStorage;
+            CachingCapsStorage* capsStorage;
             RosterFileStorage* rosterStorage;
             HistoryStorage* historyStorage;
+            PartialFileStorage* partialFileStorage;
     };
 }
@@ -11,17 +11,21 @@
 
 namespace Swift {
     class CryptoProvider;
+    class EventLoop;
+    class TimerFactory;
 
     class FileStoragesFactory : public StoragesFactory {
         public:
-            FileStoragesFactory(const boost::filesystem::path& basePath, CryptoProvider* crypto) : basePath(basePath), crypto(crypto) {}
+            FileStoragesFactory(const boost::filesystem::path& basePath, CryptoProvider* crypto, EventLoop* eventLoop = nullptr, TimerFactory* timerFactory = nullptr) : basePath(basePath), crypto(crypto), eventLoop(eventLoop), timerFactory(timerFactory) {}
 
             virtual Storages* createStorages(const JID& profile) const {
-                return new FileStorages(basePath, profile, crypto);
+                return new FileStorages(basePath, profile, crypto, eventLoop, timerFactory);
             }
 
         private:
             boost::filesystem::path basePath;
             CryptoProvider* crypto;
+            EventLoop* eventLoop;
+            TimerFactory* timerFactory;
     };
 }
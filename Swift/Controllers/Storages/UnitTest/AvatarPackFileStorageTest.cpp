@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/JID/JID.h>
+#include <Swiften/StringCodecs/Hexify.h>
+
+#include <Swift/Controllers/Storages/AvatarPackFileStorage.h>
+
+using namespace Swift;
+
+class AvatarPackFileStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(AvatarPackFileStorageTest);
+        CPPUNIT_TEST(testAddAvatar);
+        CPPUNIT_TEST(testAddAvatar_Duplicate);
+        CPPUNIT_TEST(testGetAvatar_AfterReload);
+        CPPUNIT_TEST(testGetAvatar_IncompleteRecordIsDropped);
+        CPPUNIT_TEST(testGetAvatarPath);
+        CPPUNIT_TEST(testGetAvatarPath_KeepsUnchangedFile);
+        CPPUNIT_TEST(testGetAvatarPath_RewritesChangedFile);
+        CPPUNIT_TEST(testGetAvatarPath_UnknownAvatar);
+        CPPUNIT_TEST(testSetAvatarForJID_AfterReload);
+        CPPUNIT_TEST(testCompact);
+        CPPUNIT_TEST(testLegacyAvatarIsImported);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+            baseDir = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("avatar_pack_file_storage_test_%%%%%%%%%%%%%%%%");
+            avatarsDir = baseDir / "avatars";
+            avatarsFile = baseDir / "profile" / "avatars";
+            packFile = baseDir / "profile" / "avatars.pack";
+            cacheDir = baseDir / "profile" / "avatars.cache";
+            avatar1 = createByteArray("avatar1");
+            hash1 = Hexify::hexify(crypto->getSHA1Hash(avatar1));
+            avatar2 = createByteArray("avatar2");
+            hash2 = Hexify::hexify(crypto->getSHA1Hash(avatar2));
+        }
+
+        void tearDown() {
+            boost::filesystem::remove_all(baseDir);
+        }
+
+        void testAddAvatar() {
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+
+            testling->addAvatar(hash1, avatar1);
+
+            CPPUNIT_ASSERT(testling->hasAvatar(hash1));
+            CPPUNIT_ASSERT(!testling->hasAvatar(hash2));
+            CPPUNIT_ASSERT_EQUAL(avatar1, testling->getAvatar(hash1));
+            CPPUNIT_ASSERT(!boost::filesystem::exists(avatarsDir / hash1));
+        }
+
+        void testAddAvatar_Duplicate() {
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+            testling->addAvatar(hash1, avatar1);
+            boost::uintmax_t packSize = boost::filesystem::file_size(packFile);
+
+            testling->addAvatar(hash1, avatar1);
+
+            CPPUNIT_ASSERT_EQUAL(packSize, boost::filesystem::file_size(packFile));
+        }
+
+        void testGetAvatar_AfterReload() {
+            createTestling()->addAvatar(hash1, avatar1);
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+            testling->addAvatar(hash2, avatar2);
+
+            CPPUNIT_ASSERT_EQUAL(avatar1, testling->getAvatar(hash1));
+            CPPUNIT_ASSERT_EQUAL(avatar2, testling->getAvatar(hash2));
+        }
+
+        void testGetAvatar_IncompleteRecordIsDropped() {
+            {
+                std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+                testling->addAvatar(hash1, avatar1);
+                testling->addAvatar(hash2, avatar2);
+            }
+            boost::filesystem::resize_file(packFile, boost::filesystem::file_size(packFile) - 1);
+
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+
+            CPPUNIT_ASSERT_EQUAL(avatar1, testling->getAvatar(hash1));
+            CPPUNIT_ASSERT(!testling->hasAvatar(hash2));
+            testling->addAvatar(hash2, avatar2);
+            CPPUNIT_ASSERT_EQUAL(avatar2, createTestling()->getAvatar(hash2));
+        }
+
+        void testGetAvatarPath() {
+            boost::filesystem::path path;
+            {
+                std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+                testling->addAvatar(hash1, avatar1);
+
+                path = testling->getAvatarPath(hash1);
+
+                CPPUNIT_ASSERT_EQUAL(cacheDir, path.parent_path());
+                CPPUNIT_ASSERT_EQUAL(path, testling->getAvatarPath(hash1));
+                CPPUNIT_ASSERT_EQUAL(avatar1, readFile(path));
+            }
+            CPPUNIT_ASSERT_EQUAL(avatar1, readFile(path));
+            CPPUNIT_ASSERT_EQUAL(path, createTestling()->getAvatarPath(hash1));
+        }
+
+        void testGetAvatarPath_KeepsUnchangedFile() {
+            boost::filesystem::path path;
+            {
+                std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+                testling->addAvatar(hash1, avatar1);
+                path = testling->getAvatarPath(hash1);
+            }
+            std::time_t writeTime = boost::filesystem::last_write_time(path) - 3600;
+            boost::filesystem::last_write_time(path, writeTime);
+
+            createTestling()->getAvatarPath(hash1);
+
+            CPPUNIT_ASSERT_EQUAL(writeTime, boost::filesystem::last_write_time(path));
+        }
+
+        void testGetAvatarPath_RewritesChangedFile() {
+            boost::filesystem::path path;
+            {
+                std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+                testling->addAvatar(hash1, avatar1);
+                path = testling->getAvatarPath(hash1);
+            }
+            {
+                boost::filesystem::ofstream file(path, boost::filesystem::ofstream::binary|boost::filesystem::ofstream::out|boost::filesystem::ofstream::trunc);
+                file << "avatar9";
+            }
+
+            CPPUNIT_ASSERT_EQUAL(path, createTestling()->getAvatarPath(hash1));
+            CPPUNIT_ASSERT_EQUAL(avatar1, readFile(path));
+        }
+
+        void testGetAvatarPath_UnknownAvatar() {
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+
+            CPPUNIT_ASSERT(testling->getAvatarPath(hash1).empty());
+        }
+
+        void testSetAvatarForJID_AfterReload() {
+            {
+                std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+                testling->setAvatarForJID(JID("alice@wonderland.lit"), hash1);
+                testling->setAvatarForJID(JID("bob@wonderland.lit"), hash1);
+                testling->setAvatarForJID(JID("alice@wonderland.lit"), hash2);
+            }
+
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+
+            CPPUNIT_ASSERT_EQUAL(hash2, testling->getAvatarForJID(JID("alice@wonderland.lit")));
+            CPPUNIT_ASSERT_EQUAL(hash1, testling->getAvatarForJID(JID("bob@wonderland.lit")));
+            CPPUNIT_ASSERT_EQUAL(std::string(), testling->getAvatarForJID(JID("carol@wonderland.lit")));
+        }
+
+        void testCompact() {
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+            testling->addAvatar(hash1, avatar1);
+            testling->addAvatar(hash2, avatar2);
+            testling->setAvatarForJID(JID("alice@wonderland.lit"), hash2);
+            boost::filesystem::path path1 = testling->getAvatarPath(hash1);
+            boost::filesystem::path path2 = testling->getAvatarPath(hash2);
+            boost::uintmax_t packSize = boost::filesystem::file_size(packFile);
+
+            testling->compact();
+
+            CPPUNIT_ASSERT(boost::filesystem::file_size(packFile) < packSize);
+            CPPUNIT_ASSERT(!testling->hasAvatar(hash1));
+            CPPUNIT_ASSERT(!boost::filesystem::exists(path1));
+            CPPUNIT_ASSERT(boost::filesystem::exists(path2));
+            CPPUNIT_ASSERT_EQUAL(avatar2, testling->getAvatar(hash2));
+            CPPUNIT_ASSERT_EQUAL(avatar2, createTestling()->getAvatar(hash2));
+        }
+
+        void testLegacyAvatarIsImported() {
+            boost::filesystem::create_directories(avatarsDir);
+            boost::filesystem::create_directories(avatarsFile.parent_path());
+            {
+                boost::filesystem::ofstream file(avatarsDir / hash1, boost::filesystem::ofstream::binary|boost::filesystem::ofstream::out);
+                file.write(reinterpret_cast<const char*>(vecptr(avatar1)), static_cast<std::streamsize>(avatar1.size()));
+            }
+            {
+                boost::filesystem::ofstream file(avatarsFile);
+                file << hash1 << " alice@wonderland.lit" << std::endl;
+            }
+
+            std::shared_ptr<AvatarPackFileStorage> testling = createTestling();
+
+            CPPUNIT_ASSERT(testling->hasAvatar(hash1));
+            CPPUNIT_ASSERT(boost::filesystem::exists(packFile));
+            CPPUNIT_ASSERT_EQUAL(avatar1, testling->getAvatar(hash1));
+            CPPUNIT_ASSERT(!boost::filesystem::exists(avatarsDir / hash1));
+        }
+
+    private:
+        std::shared_ptr<AvatarPackFileStorage> createTestling() {
+            return std::make_shared<AvatarPackFileStorage>(avatarsDir, avatarsFile, packFile, cacheDir, crypto.get());
+        }
+
+        static ByteArray readFile(const boost::filesystem::path& path) {
+            ByteArray result;
+            readByteArrayFromFile(result, path);
+            return result;
+        }
+
+    private:
+        std::shared_ptr<CryptoProvider> crypto;
+        boost::filesystem::path baseDir;
+        boost::filesystem::path avatarsDir;
+        boost::filesystem::path avatarsFile;
+        boost::filesystem::path packFile;
+        boost::filesystem::path cacheDir;
+        ByteArray avatar1;
+        std::string hash1;
+        ByteArray avatar2;
+        std::string hash2;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(AvatarPackFileStorageTest);
@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/filesystem.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/Elements/VCard.h>
+#include <Swiften/JID/JID.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/StringCodecs/Hexify.h>
+
+#include <Swift/Controllers/Storages/VCardFileStorage.h>
+
+using namespace Swift;
+
+class VCardFileStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(VCardFileStorageTest);
+        CPPUNIT_TEST(testSetVCard_WithoutTimer);
+        CPPUNIT_TEST(testSetVCard_WrittenWhenTimerFires);
+        CPPUNIT_TEST(testSetVCard_WrittenOnDestruction);
+        CPPUNIT_TEST(testGetVCard_ReturnsCopy);
+        CPPUNIT_TEST(testGetPhotoHash_AfterReload);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+            timerFactory = std::make_shared<DummyTimerFactory>();
+            vcardsPath = boost::filesystem::unique_path("vcard_file_storage_test_%%%%%%%%%%%%%%%%");
+            vcardFile = vcardsPath / "alice@wonderland.lit.xml";
+        }
+
+        void tearDown() {
+            boost::filesystem::remove_all(vcardsPath);
+        }
+
+        void testSetVCard_WithoutTimer() {
+            VCardFileStorage testling(vcardsPath, crypto.get());
+
+            testling.setVCard(JID("alice@wonderland.lit"), createVCard("Alice"));
+
+            CPPUNIT_ASSERT(boost::filesystem::exists(vcardFile));
+            CPPUNIT_ASSERT(boost::filesystem::exists(vcardsPath / "phashes"));
+        }
+
+        void testSetVCard_WrittenWhenTimerFires() {
+            VCardFileStorage testling(vcardsPath, crypto.get(), timerFactory.get());
+
+            testling.setVCard(JID("alice@wonderland.lit"), createVCard("Alice"));
+            testling.setVCard(JID("alice@wonderland.lit"), createVCard("Alice In Wonderland"));
+
+            CPPUNIT_ASSERT(!boost::filesystem::exists(vcardFile));
+            CPPUNIT_ASSERT_EQUAL(std::string("Alice In Wonderland"), testling.getVCard(JID("alice@wonderland.lit"))->getFullName());
+
+            timerFactory->setTime(10000);
+
+            CPPUNIT_ASSERT(boost::filesystem::exists(vcardFile));
+            CPPUNIT_ASSERT(boost::filesystem::exists(vcardsPath / "phashes"));
+            VCardFileStorage reloaded(vcardsPath, crypto.get());
+            CPPUNIT_ASSERT_EQUAL(std::string("Alice In Wonderland"), reloaded.getVCard(JID("alice@wonderland.lit"))->getFullName());
+        }
+
+        void testSetVCard_WrittenOnDestruction() {
+            {
+                VCardFileStorage testling(vcardsPath, crypto.get(), timerFactory.get());
+                testling.setVCard(JID("alice@wonderland.lit"), createVCard("Alice"));
+            }
+
+            CPPUNIT_ASSERT(boost::filesystem::exists(vcardFile));
+        }
+
+        void testGetVCard_ReturnsCopy() {
+            VCardFileStorage testling(vcardsPath, crypto.get(), timerFactory.get());
+            testling.setVCard(JID("alice@wonderland.lit"), createVCard("Alice"));
+            timerFactory->setTime(10000);
+
+            testling.getVCard(JID("alice@wonderland.lit"))->setFullName("Bob");
+
+            CPPUNIT_ASSERT_EQUAL(std::string("Alice"), testling.getVCard(JID("alice@wonderland.lit"))->getFullName());
+        }
+
+        void testGetPhotoHash_AfterReload() {
+            VCard::ref vcard = createVCard("Alice");
+            vcard->setPhoto(createByteArray("photo"));
+            {
+                VCardFileStorage testling(vcardsPath, crypto.get(), timerFactory.get());
+                testling.setVCard(JID("alice@wonderland.lit"), vcard);
+            }
+
+            VCardFileStorage testling(vcardsPath, crypto.get());
+
+            CPPUNIT_ASSERT_EQUAL(Hexify::hexify(crypto->getSHA1Hash(createByteArray("photo"))), testling.getPhotoHash(JID("alice@wonderland.lit")));
+        }
+
+    private:
+        VCard::ref createVCard(const std::string& fullName) {
+            VCard::ref vcard = std::make_shared<VCard>();
+            vcard->setFullName(fullName);
+            return vcard;
+        }
+
+    private:
+        std::shared_ptr<CryptoProvider> crypto;
+        std::shared_ptr<DummyTimerFactory> timerFactory;
+        boost::filesystem::path vcardsPath;
+        boost::filesystem::path vcardFile;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(VCardFileStorageTest);
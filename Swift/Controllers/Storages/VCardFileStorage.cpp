@@ -8,6 +8,7 @@
 
 #include <iostream>
 
+#include <boost/bind.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/filesystem/fstream.hpp>
 
@@ -18,6 +19,7 @@
 #include <Swiften/Elements/VCard.h>
 #include <Swiften/Entity/GenericPayloadPersister.h>
 #include <Swiften/JID/JID.h>
+#include <Swiften/Network/TimerFactory.h>
 #include <Swiften/Parser/PayloadParsers/UnitTest/PayloadParserTester.h>
 #include <Swiften/Parser/PayloadParsers/VCardParser.h>
 #include <Swiften/Serializer/PayloadSerializers/VCardSerializer.h>
@@ -27,8 +29,14 @@ using namespace Swift;
 
 typedef GenericPayloadPersister<VCard, VCardParser, VCardSerializer> VCardPersister;
 
-VCardFileStorage::VCardFileStorage(boost::filesystem::path dir, CryptoProvider* crypto) : VCardStorage(crypto), vcardsPath(dir), crypto(crypto) {
+static const int flushDelayMilliseconds = 2000;
+
+VCardFileStorage::VCardFileStorage(boost::filesystem::path dir, CryptoProvider* crypto, TimerFactory* timerFactory, size_t maximumCacheSize) : VCardStorage(crypto), vcardsPath(dir), crypto(crypto), flushScheduled(false), photoHashesChanged(false), maximumCacheSize(maximumCacheSize) {
     cacheFile = vcardsPath / "phashes";
+    if (timerFactory) {
+        flushTimer = timerFactory->createTimer(flushDelayMilliseconds);
+        flushTimer->onTick.connect(boost::bind(&VCardFileStorage::handleFlushTimerTick, this));
+    }
     if (boost::filesystem::exists(cacheFile)) {
         try {
             boost::filesystem::ifstream file(cacheFile);
@@ -53,8 +61,28 @@ VCardFileStorage::VCardFileStorage(boost::filesystem::path dir, CryptoProvider*
     }
 }
 
+VCardFileStorage::~VCardFileStorage() {
+    if (flushTimer) {
+        flushTimer->stop();
+        flushTimer->onTick.disconnect(boost::bind(&VCardFileStorage::handleFlushTimerTick, this));
+    }
+    flush();
+}
+
 std::shared_ptr<VCard> VCardFileStorage::getVCard(const JID& jid) const {
-    std::shared_ptr<VCard> result = VCardPersister().loadPayloadGeneric(getVCardPath(jid));
+    std::map<JID, VCard::ref>::const_iterator pending = pendingVCards.find(jid);
+    if (pending != pendingVCards.end()) {
+        return pending->second ? std::make_shared<VCard>(*pending->second) : pending->second;
+    }
+    std::shared_ptr<VCard> result = getCachedVCard(jid);
+    if (!result) {
+        result = VCardPersister().loadPayloadGeneric(getVCardPath(jid));
+        if (result) {
+            addToCache(jid, result);
+            // Hand out a copy, so changes by the caller don't end up in the cache
+            result = std::make_shared<VCard>(*result);
+        }
+    }
     getAndUpdatePhotoHash(jid, result);
     return result;
 }
@@ -70,10 +98,68 @@ boost::posix_time::ptime VCardFileStorage::getVCardWriteTime(const JID& jid) con
 
 void VCardFileStorage::setVCard(const JID& jid, VCard::ref v) {
     vcardWriteTimes[jid] = boost::posix_time::second_clock::universal_time();
-    VCardPersister().savePayload(v, getVCardPath(jid));
+    VCard::ref vcard = v ? std::make_shared<VCard>(*v) : VCard::ref();
+    addToCache(jid, vcard);
+    if (flushTimer) {
+        pendingVCards[jid] = vcard;
+        scheduleFlush();
+    }
+    else {
+        VCardPersister().savePayload(vcard, getVCardPath(jid));
+    }
     getAndUpdatePhotoHash(jid, v);
 }
 
+void VCardFileStorage::flush() {
+    flushScheduled = false;
+    for (std::map<JID, VCard::ref>::const_iterator i = pendingVCards.begin(); i != pendingVCards.end(); ++i) {
+        VCardPersister().savePayload(i->second, getVCardPath(i->first));
+    }
+    pendingVCards.clear();
+    if (photoHashesChanged) {
+        savePhotoHashes();
+    }
+}
+
+void VCardFileStorage::scheduleFlush() const {
+    if (!flushScheduled) {
+        flushScheduled = true;
+        flushTimer->start();
+    }
+}
+
+void VCardFileStorage::handleFlushTimerTick() {
+    flush();
+}
+
+VCard::ref VCardFileStorage::getCachedVCard(const JID& jid) const {
+    std::map<JID, CacheList::iterator>::const_iterator i = cacheIndex.find(jid);
+    if (i == cacheIndex.end()) {
+        return VCard::ref();
+    }
+    cache.splice(cache.begin(), cache, i->second);
+    VCard::ref vcard = i->second->second;
+    return vcard ? std::make_shared<VCard>(*vcard) : vcard;
+}
+
+void VCardFileStorage::addToCache(const JID& jid, VCard::ref vcard) const {
+    if (maximumCacheSize == 0) {
+        return;
+    }
+    std::map<JID, CacheList::iterator>::iterator i = cacheIndex.find(jid);
+    if (i != cacheIndex.end()) {
+        i->second->second = vcard;
+        cache.splice(cache.begin(), cache, i->second);
+        return;
+    }
+    cache.push_front(std::make_pair(jid, vcard));
+    cacheIndex[jid] = cache.begin();
+    if (cache.size() > maximumCacheSize) {
+        cacheIndex.erase(cache.back().first);
+        cache.pop_back();
+    }
+}
+
 boost::filesystem::path VCardFileStorage::getVCardPath(const JID& jid) const {
     try {
         std::string file(jid.toString());
@@ -103,23 +189,33 @@ std::string VCardFileStorage::getAndUpdatePhotoHash(const JID& jid, VCard::ref v
         hash = Hexify::hexify(crypto->getSHA1Hash(vCard->getPhoto()));
     }
     std::pair<PhotoHashMap::iterator, bool> r = photoHashes.insert(std::make_pair(jid, hash));
-    if (r.second) {
-        savePhotoHashes();
+    if (!r.second && r.first->second == hash) {
+        return hash;
+    }
+    r.first->second = hash;
+    if (flushTimer) {
+        photoHashesChanged = true;
+        scheduleFlush();
     }
-    else if (r.first->second != hash) {
-        r.first->second = hash;
+    else {
         savePhotoHashes();
     }
     return hash;
 }
 
 void VCardFileStorage::savePhotoHashes() const {
+    photoHashesChanged = false;
+    boost::filesystem::path newCacheFile = cacheFile;
+    newCacheFile += ".tmp";
     try {
-        boost::filesystem::ofstream file(cacheFile);
+        boost::filesystem::ofstream file(newCacheFile);
         for (PhotoHashMap::const_iterator i = photoHashes.begin(); i != photoHashes.end(); ++i) {
             file << i->second << " " << i->first.toString() << std::endl;
         }
         file.close();
+        if (file) {
+            boost::filesystem::rename(newCacheFile, cacheFile);
+        }
     }
     catch (...) {
         std::cerr << "Error writing vcards file" << std::endl;
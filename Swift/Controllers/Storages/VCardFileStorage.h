@@ -6,20 +6,33 @@
 
 #pragma once
 
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
 
 #include <boost/filesystem/path.hpp>
 
+#include <Swiften/Network/Timer.h>
 #include <Swiften/VCards/VCardStorage.h>
 
 namespace Swift {
     class CryptoProvider;
+    class TimerFactory;
 
+    /**
+     * Stores VCards as one file per JID, together with a file of the photo
+     * hashes of all JIDs.
+     *
+     * If a timer factory is given, writes are deferred and coalesced, and
+     * only written out when the flush timer fires, when flush() is called,
+     * or on destruction. Without a timer factory, every change is written
+     * out immediately.
+     */
     class VCardFileStorage : public VCardStorage {
         public:
-            VCardFileStorage(boost::filesystem::path dir, CryptoProvider* crypto);
+            VCardFileStorage(boost::filesystem::path dir, CryptoProvider* crypto, TimerFactory* timerFactory = nullptr, size_t maximumCacheSize = 256);
+            virtual ~VCardFileStorage();
 
             virtual VCard::ref getVCard(const JID& jid) const;
             virtual boost::posix_time::ptime getVCardWriteTime(const JID& jid) const;
@@ -27,11 +40,23 @@ namespace Swift {
 
             virtual std::string getPhotoHash(const JID&) const;
 
+            /**
+             * Writes out all pending changes.
+             */
+            void flush();
+
         private:
+            typedef std::list<std::pair<JID, VCard::ref> > CacheList;
+
             boost::filesystem::path getVCardPath(const JID&) const;
 
             std::string getAndUpdatePhotoHash(const JID& jid, VCard::ref vcard) const;
             void savePhotoHashes() const;
+            void scheduleFlush() const;
+            void handleFlushTimerTick();
+
+            VCard::ref getCachedVCard(const JID& jid) const;
+            void addToCache(const JID& jid, VCard::ref vcard) const;
 
         private:
             boost::filesystem::path vcardsPath;
@@ -40,5 +65,14 @@ namespace Swift {
             typedef std::map<JID, std::string> PhotoHashMap;
             mutable PhotoHashMap photoHashes;
             std::map<JID, boost::posix_time::ptime> vcardWriteTimes;
+
+            Timer::ref flushTimer;
+            mutable bool flushScheduled;
+            std::map<JID, VCard::ref> pendingVCards;
+            mutable bool photoHashesChanged;
+
+            size_t maximumCacheSize;
+            mutable CacheList cache;
+            mutable std::map<JID, CacheList::iterator> cacheIndex;
     };
 }
@@ -6,19 +6,101 @@
 
 #include <Swiften/Base/IDGenerator.h>
 
-#include <boost/lexical_cast.hpp>
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include <random>
+
+#include <boost/cstdint.hpp>
 
 namespace Swift {
 
+static const char alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+static const size_t idLength = 15;
+static const size_t charactersPerNumber = 10;
+
+// The number of IDs generated from one seed. They use 128 numbers of the
+// generator, and show at most 60 bits of each, which is far from the 312
+// full numbers that would give away its state.
+static const size_t idsPerSeed = 64;
+
+namespace {
+    boost::uint64_t mix(boost::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * Spreads 128 bits read from std::random_device over the whole state of
+     * the generator. This does what std::seed_seq does, but about 20 times
+     * faster, which matters as the generator is seeded so often.
+     */
+    class EntropySeedSequence {
+        public:
+            typedef boost::uint32_t result_type;
+
+            EntropySeedSequence(std::random_device& device) {
+                low = (static_cast<boost::uint64_t>(device()) << 32) | device();
+                high = (static_cast<boost::uint64_t>(device()) << 32) | device();
+            }
+
+            template<typename Iterator>
+            void generate(Iterator begin, Iterator end) const {
+                boost::uint64_t value = 0;
+                for (boost::uint64_t i = 0; begin != end; ++i, ++begin) {
+                    if (i % 2 == 0) {
+                        value = mix(low + (i + 1) * 0x9E3779B97F4A7C15ULL) ^ mix(high ^ i);
+                    }
+                    *begin = static_cast<result_type>(value);
+                    value >>= 32;
+                }
+            }
+
+        private:
+            boost::uint64_t low;
+            boost::uint64_t high;
+    };
+}
+
+struct IDGenerator::RandomState {
+    RandomState() : remainingIDs(0) {
+    }
+
+    void seed() {
+        EntropySeedSequence seed(device);
+        generator.seed(seed);
+        remainingIDs = idsPerSeed;
+    }
+
+    std::random_device device;
+    std::mt19937_64 generator;
+    size_t remainingIDs;
+};
+
 IDGenerator::IDGenerator() {
 }
 
+IDGenerator::~IDGenerator() {
+}
+
 std::string IDGenerator::generateID() {
-    static boost::uuids::random_generator generator;
-    return boost::lexical_cast<std::string>(generator());
+    if (!state) {
+        state.reset(new RandomState());
+    }
+    if (state->remainingIDs == 0) {
+        state->seed();
+    }
+    --state->remainingIDs;
+
+    char id[idLength];
+    boost::uint64_t bits = 0;
+    for (size_t i = 0; i < idLength; ++i) {
+        // Every random number provides 6 bits for each of 10 characters
+        if (i % charactersPerNumber == 0) {
+            bits = state->generator();
+        }
+        id[i] = alphabet[bits & 0x3f];
+        bits >>= 6;
+    }
+    return std::string(id, idLength);
 }
 
 }
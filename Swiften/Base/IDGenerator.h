@@ -1,20 +1,49 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <memory>
 #include <string>
 
 #include <Swiften/Base/API.h>
 
 namespace Swift {
+    /**
+     * Generates random IDs, e.g. for stanzas and sessions.
+     *
+     * IDs come from an std::mt19937_64 that is seeded again from
+     * std::random_device (normally the system's secure random source)
+     * after every few IDs. The IDs generated from one seed reveal far too
+     * little of the generator state to predict the IDs after them, so IDs
+     * can't be guessed from the ones seen before, while most IDs still only
+     * cost a few generator steps.
+     *
+     * Every generator has its own random state, so different generators can
+     * be used from different threads at the same time. A single generator
+     * must not be shared between threads.
+     *
+     * The random state is only created when the first ID is generated, so
+     * generators that are never used (or subclasses that don't use it) are
+     * cheap to construct.
+     */
     class SWIFTEN_API IDGenerator {
         public:
             IDGenerator();
+            ~IDGenerator();
 
+            /**
+             * Returns a new ID of 15 characters from the base64url alphabet,
+             * carrying 90 random bits. IDs are short enough for std::string
+             * to store them without allocating memory.
+             */
             std::string generateID();
+
+        private:
+            struct RandomState;
+            std::unique_ptr<RandomState> state;
     };
 }
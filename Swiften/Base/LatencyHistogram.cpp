@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Base/LatencyHistogram.h>
+
+#include <algorithm>
+
+namespace Swift {
+
+const size_t LatencyHistogram::BucketCount;
+
+LatencyHistogram::LatencyHistogram() : count(0), total(Duration::zero()), maximum(Duration::zero()) {
+    buckets.fill(0);
+}
+
+void LatencyHistogram::add(Duration duration) {
+    boost::uint64_t microseconds = static_cast<boost::uint64_t>(std::max<std::chrono::microseconds::rep>(0, std::chrono::duration_cast<std::chrono::microseconds>(duration).count()));
+    size_t bucket = 0;
+    while (microseconds > 0 && bucket < BucketCount - 1) {
+        microseconds >>= 1;
+        ++bucket;
+    }
+    ++buckets[bucket];
+    ++count;
+    total += duration;
+    maximum = std::max(maximum, duration);
+}
+
+LatencyHistogram::Duration LatencyHistogram::getBucketUpperBound(size_t bucket) {
+    if (bucket >= BucketCount - 1) {
+        return Duration::max();
+    }
+    return std::chrono::duration_cast<Duration>(std::chrono::microseconds(1LL << bucket));
+}
+
+LatencyHistogram::Duration LatencyHistogram::getPercentile(double percentile) const {
+    if (count == 0) {
+        return Duration::zero();
+    }
+    boost::uint64_t rank = static_cast<boost::uint64_t>(percentile / 100.0 * static_cast<double>(count) + 0.5);
+    rank = std::max<boost::uint64_t>(1, std::min(rank, count));
+    boost::uint64_t seen = 0;
+    for (size_t i = 0; i < BucketCount; ++i) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(getBucketUpperBound(i), maximum);
+        }
+    }
+    return maximum;
+}
+
+}
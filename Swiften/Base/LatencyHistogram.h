@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <chrono>
+
+#include <boost/cstdint.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * A histogram of durations with buckets that double in size.
+     *
+     * Bucket 0 holds durations below 1 microsecond, and bucket i holds
+     * durations below 2^i microseconds. The last bucket holds all durations
+     * that do not fit in the other buckets.
+     *
+     * Adding a duration is constant time and does not allocate, so
+     * histograms can be kept on hot paths.
+     */
+    class SWIFTEN_API LatencyHistogram {
+        public:
+            typedef std::chrono::steady_clock::duration Duration;
+            static const size_t BucketCount = 24;
+
+            LatencyHistogram();
+
+            void add(Duration duration);
+
+            boost::uint64_t getCount() const {
+                return count;
+            }
+
+            Duration getTotal() const {
+                return total;
+            }
+
+            Duration getMaximum() const {
+                return maximum;
+            }
+
+            boost::uint64_t getBucket(size_t bucket) const {
+                return buckets[bucket];
+            }
+
+            /**
+             * Returns the (exclusive) upper bound of a bucket.
+             * The last bucket has no upper bound, and returns Duration::max().
+             */
+            static Duration getBucketUpperBound(size_t bucket);
+
+            /**
+             * Returns an upper bound for the given percentile (between 0 and 100)
+             * of the added durations, or 0 if no durations were added.
+             */
+            Duration getPercentile(double percentile) const;
+
+        private:
+            std::array<boost::uint64_t, BucketCount> buckets;
+            boost::uint64_t count;
+            Duration total;
+            Duration maximum;
+    };
+}
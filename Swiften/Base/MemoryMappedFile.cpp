@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Base/MemoryMappedFile.h>
+
+#include <Swiften/Base/Platform.h>
+
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Swift {
+
+MemoryMappedFile::MemoryMappedFile() : open_(false), mode_(ReadOnly), data_(nullptr), size_(0), mapping_(nullptr), mappingSize_(0)
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+        , mappingHandle_(nullptr)
+#endif
+{
+}
+
+MemoryMappedFile::~MemoryMappedFile() {
+    close();
+}
+
+bool MemoryMappedFile::open(const boost::filesystem::path& path, boost::uintmax_t offset, size_t length, Mode mode) {
+    close();
+    mode_ = mode;
+
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+    HANDLE file = CreateFileW(path.wstring().c_str(), mode == ReadWrite ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize) || offset > static_cast<boost::uintmax_t>(fileSize.QuadPart)) {
+        CloseHandle(file);
+        return false;
+    }
+    boost::uintmax_t available = static_cast<boost::uintmax_t>(fileSize.QuadPart) - offset;
+    size_ = static_cast<size_t>(length == 0 || length > available ? available : length);
+    if (size_ == 0) {
+        CloseHandle(file);
+        open_ = true;
+        return true;
+    }
+
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    boost::uintmax_t alignedOffset = offset - (offset % systemInfo.dwAllocationGranularity);
+    mappingSize_ = static_cast<size_t>(offset - alignedOffset) + size_;
+
+    mappingHandle_ = CreateFileMappingW(file, NULL, mode == ReadWrite ? PAGE_READWRITE : PAGE_READONLY, 0, 0, NULL);
+    CloseHandle(file);
+    if (!mappingHandle_) {
+        return false;
+    }
+    mapping_ = MapViewOfFile(mappingHandle_, mode == ReadWrite ? FILE_MAP_WRITE : FILE_MAP_READ, static_cast<DWORD>(alignedOffset >> 32), static_cast<DWORD>(alignedOffset & 0xFFFFFFFF), mappingSize_);
+    if (!mapping_) {
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+        return false;
+    }
+#else
+    int file = ::open(path.string().c_str(), mode == ReadWrite ? O_RDWR : O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat fileStatus;
+    if (fstat(file, &fileStatus) != 0 || offset > static_cast<boost::uintmax_t>(fileStatus.st_size)) {
+        ::close(file);
+        return false;
+    }
+    boost::uintmax_t available = static_cast<boost::uintmax_t>(fileStatus.st_size) - offset;
+    size_ = static_cast<size_t>(length == 0 || length > available ? available : length);
+    if (size_ == 0) {
+        ::close(file);
+        open_ = true;
+        return true;
+    }
+
+    boost::uintmax_t pageSize = static_cast<boost::uintmax_t>(sysconf(_SC_PAGESIZE));
+    boost::uintmax_t alignedOffset = offset - (offset % pageSize);
+    mappingSize_ = static_cast<size_t>(offset - alignedOffset) + size_;
+
+    void* mapping = mmap(nullptr, mappingSize_, mode == ReadWrite ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, static_cast<off_t>(alignedOffset));
+    ::close(file);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    mapping_ = mapping;
+#endif
+
+    data_ = static_cast<unsigned char*>(mapping_) + (offset - alignedOffset);
+    open_ = true;
+    return true;
+}
+
+void MemoryMappedFile::close() {
+    if (mapping_) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+        UnmapViewOfFile(mapping_);
+        CloseHandle(mappingHandle_);
+        mappingHandle_ = nullptr;
+#else
+        munmap(mapping_, mappingSize_);
+#endif
+    }
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+    open_ = false;
+    mode_ = ReadOnly;
+}
+
+}
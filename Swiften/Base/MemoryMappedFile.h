@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/noncopyable.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * A memory mapping of a region of a file.
+     *
+     * The region does not need to be aligned to page boundaries.
+     */
+    class SWIFTEN_API MemoryMappedFile : public boost::noncopyable {
+        public:
+            enum Mode {
+                ReadOnly,
+                ReadWrite
+            };
+
+            MemoryMappedFile();
+            ~MemoryMappedFile();
+
+            /**
+             * Maps \p length bytes of \p path, starting at \p offset. A length of 0
+             * maps everything up to the end of the file.
+             * Any previous mapping is closed first.
+             *
+             * The mapping never extends the file, so a file mapped for writing
+             * needs to be resized to its final size first.
+             */
+            bool open(const boost::filesystem::path& path, boost::uintmax_t offset = 0, size_t length = 0, Mode mode = ReadOnly);
+            void close();
+
+            bool isOpen() const {
+                return open_;
+            }
+
+            const unsigned char* getData() const {
+                return data_;
+            }
+
+            /**
+             * Returns nullptr if the file is not mapped for writing.
+             */
+            unsigned char* getWritableData() const {
+                return mode_ == ReadWrite ? data_ : nullptr;
+            }
+
+            size_t getSize() const {
+                return size_;
+            }
+
+        private:
+            bool open_;
+            Mode mode_;
+            unsigned char* data_;
+            size_t size_;
+            void* mapping_;
+            size_t mappingSize_;
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+            void* mappingHandle_;
+#endif
+    };
+}
@@ -17,6 +17,8 @@ class IDGeneratorTest : public CppUnit::TestFixture
 {
         CPPUNIT_TEST_SUITE(IDGeneratorTest);
         CPPUNIT_TEST(testGenerate);
+        CPPUNIT_TEST(testGenerate_Format);
+        CPPUNIT_TEST(testGenerate_DifferentGenerators);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -34,6 +36,21 @@ class IDGeneratorTest : public CppUnit::TestFixture
             }
         }
 
+        void testGenerate_Format() {
+            IDGenerator testling;
+            std::string id = testling.generateID();
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(15), id.size());
+            CPPUNIT_ASSERT_EQUAL(std::string::npos, id.find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"));
+        }
+
+        void testGenerate_DifferentGenerators() {
+            for (unsigned int i = 0; i < 26*4; ++i) {
+                std::string id = IDGenerator().generateID();
+                CPPUNIT_ASSERT(generatedIDs_.insert(id).second);
+            }
+        }
+
     private:
         std::set<std::string> generatedIDs_;
 };
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <chrono>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/LatencyHistogram.h>
+
+using namespace Swift;
+
+class LatencyHistogramTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(LatencyHistogramTest);
+        CPPUNIT_TEST(testAdd);
+        CPPUNIT_TEST(testAdd_Overflow);
+        CPPUNIT_TEST(testGetPercentile);
+        CPPUNIT_TEST(testGetPercentile_Empty);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testAdd() {
+            LatencyHistogram testling;
+
+            testling.add(std::chrono::nanoseconds(500));
+            testling.add(std::chrono::microseconds(1));
+            testling.add(std::chrono::microseconds(3));
+            testling.add(std::chrono::microseconds(4));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(4), testling.getCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), testling.getBucket(0));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), testling.getBucket(1));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), testling.getBucket(2));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), testling.getBucket(3));
+            CPPUNIT_ASSERT(std::chrono::nanoseconds(8500) == testling.getTotal());
+            CPPUNIT_ASSERT(std::chrono::microseconds(4) == testling.getMaximum());
+        }
+
+        void testAdd_Overflow() {
+            LatencyHistogram testling;
+
+            testling.add(std::chrono::hours(1));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), testling.getBucket(LatencyHistogram::BucketCount - 1));
+        }
+
+        void testGetPercentile() {
+            LatencyHistogram testling;
+            for (int i = 0; i < 90; ++i) {
+                testling.add(std::chrono::microseconds(10));
+            }
+            for (int i = 0; i < 10; ++i) {
+                testling.add(std::chrono::milliseconds(5));
+            }
+
+            CPPUNIT_ASSERT(std::chrono::microseconds(16) == testling.getPercentile(50));
+            CPPUNIT_ASSERT(std::chrono::microseconds(16) == testling.getPercentile(90));
+            CPPUNIT_ASSERT(std::chrono::milliseconds(5) == testling.getPercentile(99));
+        }
+
+        void testGetPercentile_Empty() {
+            LatencyHistogram testling;
+
+            CPPUNIT_ASSERT(LatencyHistogram::Duration::zero() == testling.getPercentile(50));
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(LatencyHistogramTest);
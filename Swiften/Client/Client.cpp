@@ -92,7 +92,8 @@ Client::Client(const JID& jid, const SafeString& password, NetworkFactories* net
             getNetworkFactories()->getDomainNameResolver(),
             getNetworkFactories()->getNetworkEnvironment(),
             getNetworkFactories()->getNATTraverser(),
-            getNetworkFactories()->getCryptoProvider());
+            getNetworkFactories()->getCryptoProvider(),
+            getNetworkFactories()->getEventLoop());
 #else
     fileTransferManager = new DummyFileTransferManager();
 #endif
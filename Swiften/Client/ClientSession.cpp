@@ -6,6 +6,7 @@
 
 #include <Swiften/Client/ClientSession.h>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/bind.hpp>
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_io.hpp>
@@ -38,7 +39,7 @@
 #include <Swiften/Elements/ResourceBind.h>
 #include <Swiften/SASL/PLAINClientAuthenticator.h>
 #include <Swiften/SASL/EXTERNALClientAuthenticator.h>
-#include <Swiften/SASL/SCRAMSHA1ClientAuthenticator.h>
+#include <Swiften/SASL/SCRAMClientAuthenticator.h>
 #include <Swiften/SASL/DIGESTMD5ClientAuthenticator.h>
 #include <Swiften/Crypto/CryptoProvider.h>
 #include <Swiften/Session/SessionStream.h>
@@ -76,7 +77,8 @@ ClientSession::ClientSession(
             authenticator(nullptr),
             certificateTrustChecker(nullptr),
             singleSignOn(false),
-            authenticationPort(-1) {
+            authenticationPort(-1),
+            scramKeyCache(nullptr) {
 #ifdef SWIFTEN_PLATFORM_WIN32
 if (WindowsRegistry::isFIPSEnabled()) {
     SWIFT_LOG(info) << "Windows is running in FIPS-140 mode. Some authentication methods will be unavailable." << std::endl;
@@ -92,6 +94,8 @@ void ClientSession::start() {
     stream->onElementReceived.connect(boost::bind(&ClientSession::handleElement, shared_from_this(), _1));
     stream->onClosed.connect(boost::bind(&ClientSession::handleStreamClosed, shared_from_this(), _1));
     stream->onTLSEncrypted.connect(boost::bind(&ClientSession::handleTLSEncrypted, shared_from_this()));
+    stream->onElementBatchStarted.connect(boost::bind(&ClientSession::handleElementBatchStarted, shared_from_this()));
+    stream->onElementBatchFinished.connect(boost::bind(&ClientSession::handleElementBatchFinished, shared_from_this()));
 
     assert(state == Initial);
     state = WaitingForStreamStart;
@@ -207,6 +211,12 @@ void ClientSession::handleElement(std::shared_ptr<ToplevelElement> element) {
             stream->writeElement(std::make_shared<CompressRequest>("zlib"));
         }
         else if (streamFeatures->hasAuthenticationMechanisms()) {
+            ByteArray finishMessage;
+            if (stream->isTLSEncrypted()) {
+                finishMessage = stream->getTLSFinishMessage();
+            }
+            bool scramPlus = false;
+            std::string scramAlgorithm = getSCRAMAlgorithm(*streamFeatures, !finishMessage.empty(), scramPlus);
 #ifdef SWIFTEN_PLATFORM_WIN32
             if (singleSignOn) {
                 const boost::optional<std::string> authenticationHostname = streamFeatures->getAuthenticationHostname();
@@ -248,19 +258,14 @@ void ClientSession::handleElement(std::shared_ptr<ToplevelElement> element) {
                 state = Authenticating;
                 stream->writeElement(std::make_shared<AuthRequest>("EXTERNAL", createSafeByteArray("")));
             }
-            else if (streamFeatures->hasAuthenticationMechanism("SCRAM-SHA-1") || streamFeatures->hasAuthenticationMechanism("SCRAM-SHA-1-PLUS")) {
+            else if (!scramAlgorithm.empty()) {
                 std::ostringstream s;
-                ByteArray finishMessage;
-                bool plus = streamFeatures->hasAuthenticationMechanism("SCRAM-SHA-1-PLUS");
-                if (stream->isTLSEncrypted()) {
-                    finishMessage = stream->getTLSFinishMessage();
-                    plus &= !finishMessage.empty();
-                }
                 s << boost::uuids::random_generator()();
-                SCRAMSHA1ClientAuthenticator* scramAuthenticator = new SCRAMSHA1ClientAuthenticator(s.str(), plus, idnConverter, crypto);
+                SCRAMClientAuthenticator* scramAuthenticator = new SCRAMClientAuthenticator(scramAlgorithm, s.str(), scramPlus, idnConverter, crypto);
                 if (!finishMessage.empty()) {
                     scramAuthenticator->setTLSChannelBindingData(finishMessage);
                 }
+                scramAuthenticator->setKeyCache(scramKeyCache);
                 authenticator = scramAuthenticator;
                 state = WaitingForCredentials;
                 onNeedCredentials();
@@ -394,6 +399,27 @@ void ClientSession::continueSessionInitialization() {
     }
 }
 
+std::string ClientSession::getSCRAMAlgorithm(const StreamFeatures& streamFeatures, bool channelBinding, bool& plus) const {
+    static const char* algorithms[] = { "sha-256", "sha-1" };
+    // Channel binding protects against a man in the middle, so it is
+    // preferred over a stronger hash.
+    if (channelBinding) {
+        for (const char* algorithm : algorithms) {
+            if (streamFeatures.hasAuthenticationMechanism("SCRAM-" + boost::to_upper_copy(std::string(algorithm)) + "-PLUS") && SCRAMClientAuthenticator::isAlgorithmSupported(algorithm, crypto)) {
+                plus = true;
+                return algorithm;
+            }
+        }
+    }
+    for (const char* algorithm : algorithms) {
+        if (streamFeatures.hasAuthenticationMechanism("SCRAM-" + boost::to_upper_copy(std::string(algorithm))) && SCRAMClientAuthenticator::isAlgorithmSupported(algorithm, crypto)) {
+            plus = false;
+            return algorithm;
+        }
+    }
+    return "";
+}
+
 bool ClientSession::checkState(State state) {
     if (this->state != state) {
         finishSession(Error::UnexpectedElementError);
@@ -410,6 +436,14 @@ void ClientSession::sendCredentials(const SafeByteArray& password) {
     stream->writeElement(std::make_shared<AuthRequest>(authenticator->getName(), authenticator->getResponse()));
 }
 
+void ClientSession::handleElementBatchStarted() {
+    onStanzaBatchStarted();
+}
+
+void ClientSession::handleElementBatchFinished() {
+    onStanzaBatchFinished();
+}
+
 void ClientSession::handleTLSEncrypted() {
     CHECK_STATE_OR_RETURN(Encrypting);
 
@@ -462,6 +496,8 @@ void ClientSession::handleStreamClosed(std::shared_ptr<Swift::Error> streamError
     stream->onElementReceived.disconnect(boost::bind(&ClientSession::handleElement, shared_from_this(), _1));
     stream->onClosed.disconnect(boost::bind(&ClientSession::handleStreamClosed, shared_from_this(), _1));
     stream->onTLSEncrypted.disconnect(boost::bind(&ClientSession::handleTLSEncrypted, shared_from_this()));
+    stream->onElementBatchStarted.disconnect(boost::bind(&ClientSession::handleElementBatchStarted, shared_from_this()));
+    stream->onElementBatchFinished.disconnect(boost::bind(&ClientSession::handleElementBatchFinished, shared_from_this()));
 
     if (previousState == Finishing) {
         onFinished(error_);
@@ -24,6 +24,8 @@ namespace Swift {
     class CertificateTrustChecker;
     class IDNConverter;
     class CryptoProvider;
+    class SCRAMKeyCache;
+    class StreamFeatures;
 
     class SWIFTEN_API ClientSession : public std::enable_shared_from_this<ClientSession> {
         public:
@@ -138,6 +140,15 @@ namespace Swift {
                 authenticationPort = i;
             }
 
+            /**
+             * Sets the cache for the keys derived from the password during
+             * SCRAM authentication, which can be shared by successive
+             * sessions of a client to speed up reconnecting.
+             */
+            void setSCRAMKeyCache(SCRAMKeyCache* cache) {
+                scramKeyCache = cache;
+            }
+
         public:
             boost::signals2::signal<void ()> onNeedCredentials;
             boost::signals2::signal<void ()> onInitialized;
@@ -145,6 +156,14 @@ namespace Swift {
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaReceived;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
 
+            /**
+             * Emitted around all stanzas that were received in a single read
+             * from the stream, so that bursts (such as initial presence) can
+             * be processed in one go.
+             */
+            boost::signals2::signal<void ()> onStanzaBatchStarted;
+            boost::signals2::signal<void ()> onStanzaBatchFinished;
+
         private:
             ClientSession(
                     const JID& jid,
@@ -164,10 +183,13 @@ namespace Swift {
             void handleElement(std::shared_ptr<ToplevelElement>);
             void handleStreamStart(const ProtocolHeader&);
             void handleStreamClosed(std::shared_ptr<Swift::Error>);
+            void handleElementBatchStarted();
+            void handleElementBatchFinished();
 
             void handleTLSEncrypted();
 
             bool checkState(State);
+            std::string getSCRAMAlgorithm(const StreamFeatures&, bool channelBinding, bool& plus) const;
             void continueSessionInitialization();
 
             void requestAck();
@@ -197,5 +219,6 @@ namespace Swift {
             CertificateTrustChecker* certificateTrustChecker;
             bool singleSignOn;
             int authenticationPort;
+            SCRAMKeyCache* scramKeyCache;
     };
 }
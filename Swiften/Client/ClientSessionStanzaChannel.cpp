@@ -18,6 +18,8 @@ ClientSessionStanzaChannel::~ClientSessionStanzaChannel() {
         session->onStanzaReceived.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
         session->onStanzaAcked.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
         session->onInitialized.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
+        session->onStanzaBatchStarted.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchStarted, this));
+        session->onStanzaBatchFinished.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchFinished, this));
         session.reset();
     }
 }
@@ -29,6 +31,8 @@ void ClientSessionStanzaChannel::setSession(std::shared_ptr<ClientSession> sessi
     session->onFinished.connect(boost::bind(&ClientSessionStanzaChannel::handleSessionFinished, this, _1));
     session->onStanzaReceived.connect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
     session->onStanzaAcked.connect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
+    session->onStanzaBatchStarted.connect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchStarted, this));
+    session->onStanzaBatchFinished.connect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchFinished, this));
 }
 
 void ClientSessionStanzaChannel::sendIQ(std::shared_ptr<IQ> iq) {
@@ -60,6 +64,8 @@ void ClientSessionStanzaChannel::handleSessionFinished(std::shared_ptr<Error>) {
     session->onStanzaReceived.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanza, this, _1));
     session->onStanzaAcked.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaAcked, this, _1));
     session->onInitialized.disconnect(boost::bind(&ClientSessionStanzaChannel::handleSessionInitialized, this));
+    session->onStanzaBatchStarted.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchStarted, this));
+    session->onStanzaBatchFinished.disconnect(boost::bind(&ClientSessionStanzaChannel::handleStanzaBatchFinished, this));
     session.reset();
 
     onAvailableChanged(false);
@@ -105,6 +111,14 @@ void ClientSessionStanzaChannel::handleStanzaAcked(std::shared_ptr<Stanza> stanz
 }
 
 
+void ClientSessionStanzaChannel::handleStanzaBatchStarted() {
+    onStanzaBatchStarted();
+}
+
+void ClientSessionStanzaChannel::handleStanzaBatchFinished() {
+    onStanzaBatchFinished();
+}
+
 void ClientSessionStanzaChannel::handleSessionInitialized() {
     onAvailableChanged(true);
 }
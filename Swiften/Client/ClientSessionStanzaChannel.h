@@ -42,6 +42,8 @@ namespace Swift {
             void handleSessionFinished(std::shared_ptr<Error> error);
             void handleStanza(std::shared_ptr<Stanza> stanza);
             void handleStanzaAcked(std::shared_ptr<Stanza> stanza);
+            void handleStanzaBatchStarted();
+            void handleStanzaBatchFinished();
             void handleSessionInitialized();
 
         private:
@@ -24,6 +24,7 @@
 #include <Swiften/Network/ProxyProvider.h>
 #include <Swiften/Network/SOCKS5ProxiedConnectionFactory.h>
 #include <Swiften/Queries/IQRouter.h>
+#include <Swiften/SASL/SCRAMKeyCache.h>
 #include <Swiften/Session/BOSHSessionStream.h>
 #include <Swiften/Session/BasicSessionStream.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
@@ -33,6 +34,7 @@
 namespace Swift {
 
 CoreClient::CoreClient(const JID& jid, const SafeByteArray& password, NetworkFactories* networkFactories) : jid_(jid), password_(password), networkFactories(networkFactories), disconnectRequested_(false), certificateTrustChecker(nullptr) {
+    scramKeyCache_ = new SCRAMKeyCache();
     stanzaChannel_ = new ClientSessionStanzaChannel();
     stanzaChannel_->onMessageReceived.connect(boost::bind(&CoreClient::handleMessageReceived, this, _1));
     stanzaChannel_->onPresenceReceived.connect(boost::bind(&CoreClient::handlePresenceReceived, this, _1));
@@ -46,6 +48,7 @@ CoreClient::CoreClient(const JID& jid, const SafeByteArray& password, NetworkFac
 CoreClient::~CoreClient() {
     forceReset();
     delete iqRouter_;
+    delete scramKeyCache_;
 
     stanzaChannel_->onAvailableChanged.disconnect(boost::bind(&CoreClient::handleStanzaChannelAvailableChanged, this, _1));
     stanzaChannel_->onMessageReceived.disconnect(boost::bind(&CoreClient::handleMessageReceived, this, _1));
@@ -161,6 +164,7 @@ void CoreClient::bindSessionToStream() {
     session_->setAllowPLAINOverNonTLS(options.allowPLAINWithoutTLS);
     session_->setSingleSignOn(options.singleSignOn);
     session_->setAuthenticationPort(options.manualPort);
+    session_->setSCRAMKeyCache(scramKeyCache_);
     switch(options.useTLS) {
         case ClientOptions::UseTLSWhenAvailable:
             session_->setUseTLS(ClientSession::UseTLSWhenAvailable);
@@ -423,6 +427,10 @@ bool CoreClient::isStreamEncrypted() const {
     return sessionStream_->isTLSEncrypted();
 }
 
+StreamStatistics CoreClient::getStreamStatistics() const {
+    return sessionStream_ ? sessionStream_->getStatistics() : StreamStatistics();
+}
+
 StanzaChannel* CoreClient::getStanzaChannel() const {
     return stanzaChannel_;
 }
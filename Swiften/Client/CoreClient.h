@@ -17,6 +17,7 @@
 #include <Swiften/Client/ClientOptions.h>
 #include <Swiften/Entity/Entity.h>
 #include <Swiften/JID/JID.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 #include <Swiften/TLS/CertificateWithKey.h>
 
 namespace Swift {
@@ -36,6 +37,7 @@ namespace Swift {
     class CertificateTrustChecker;
     class NetworkFactories;
     class ClientSessionStanzaChannel;
+    class SCRAMKeyCache;
 
     /**
      * The central class for communicating with an XMPP server.
@@ -131,6 +133,16 @@ namespace Swift {
              */
             bool isStreamEncrypted() const;
 
+            /**
+             * Returns a snapshot of the counters of the layers of the
+             * current stream (e.g. the number of bytes sent and received,
+             * the TLS handshake time, and the time spent parsing).
+             *
+             * The counters are reset for every new connection. If there is
+             * no connection, no layers are set.
+             */
+            StreamStatistics getStreamStatistics() const;
+
             StanzaChannel* getStanzaChannel() const;
 
             /**
@@ -238,5 +250,6 @@ namespace Swift {
             CertificateWithKey::ref certificate_;
             bool disconnectRequested_;
             CertificateTrustChecker* certificateTrustChecker;
+            SCRAMKeyCache* scramKeyCache_;
     };
 }
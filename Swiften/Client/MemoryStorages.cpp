@@ -61,5 +61,8 @@ HistoryStorage* MemoryStorages::getHistoryStorage() const {
 #endif
 }
 
+PartialFileStorage* MemoryStorages::getPartialFileStorage() const {
+    return nullptr;
+}
 
 }
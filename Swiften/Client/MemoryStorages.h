@@ -27,6 +27,7 @@ namespace Swift {
             virtual CapsStorage* getCapsStorage() const;
             virtual RosterStorage* getRosterStorage() const;
             virtual HistoryStorage* getHistoryStorage() const;
+            virtual PartialFileStorage* getPartialFileStorage() const;
 
         private:
             VCardMemoryStorage* vcardStorage;
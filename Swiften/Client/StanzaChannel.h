@@ -29,5 +29,12 @@ namespace Swift {
             boost::signals2::signal<void (std::shared_ptr<Message>)> onMessageReceived;
             boost::signals2::signal<void (std::shared_ptr<Presence>) > onPresenceReceived;
             boost::signals2::signal<void (std::shared_ptr<Stanza>)> onStanzaAcked;
+
+            /**
+             * Emitted before and after a batch of stanzas that arrived
+             * together. Channels that do not batch never emit these.
+             */
+            boost::signals2::signal<void ()> onStanzaBatchStarted;
+            boost::signals2::signal<void ()> onStanzaBatchFinished;
     };
 }
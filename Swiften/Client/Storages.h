@@ -14,6 +14,7 @@ namespace Swift {
     class CapsStorage;
     class RosterStorage;
     class HistoryStorage;
+    class PartialFileStorage;
 
     /**
      * An interface to hold storage classes for different
@@ -28,5 +29,11 @@ namespace Swift {
             virtual CapsStorage* getCapsStorage() const = 0;
             virtual RosterStorage* getRosterStorage() const = 0;
             virtual HistoryStorage* getHistoryStorage() const = 0;
+
+            /**
+             * Returns the storage through which incoming files are received,
+             * or nullptr if interrupted file transfers are not kept.
+             */
+            virtual PartialFileStorage* getPartialFileStorage() const = 0;
     };
 }
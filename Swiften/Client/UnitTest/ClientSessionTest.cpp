@@ -51,6 +51,9 @@ class ClientSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testStart_StreamFeaturesWithoutResourceBindingFails);
         CPPUNIT_TEST(testAuthenticate);
         CPPUNIT_TEST(testAuthenticate_Unauthorized);
+        CPPUNIT_TEST(testAuthenticate_SCRAMPrefersSHA256);
+        CPPUNIT_TEST(testAuthenticate_SCRAMPrefersChannelBinding);
+        CPPUNIT_TEST(testAuthenticate_SCRAMWithoutChannelBindingData);
         CPPUNIT_TEST(testAuthenticate_NoValidAuthMechanisms);
         CPPUNIT_TEST(testAuthenticate_PLAINOverNonTLS);
         CPPUNIT_TEST(testAuthenticate_RequireTLS);
@@ -219,6 +222,54 @@ class ClientSessionTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(sessionFinishedError);
         }
 
+        void testAuthenticate_SCRAMPrefersSHA256() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->start();
+            server->receiveStreamStart();
+            server->sendStreamStart();
+            server->sendStreamFeaturesWithSCRAMAuthentication();
+            CPPUNIT_ASSERT(needCredentials);
+            CPPUNIT_ASSERT_EQUAL(ClientSession::WaitingForCredentials, session->getState());
+            session->sendCredentials(createSafeByteArray("mypass"));
+            server->receiveAuthRequest("SCRAM-SHA-256");
+
+            session->finish();
+        }
+
+        void testAuthenticate_SCRAMPrefersChannelBinding() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->setCertificateTrustChecker(blindCertificateTrustChecker);
+            server->tlsFinishMessage = createByteArray("finished");
+            session->start();
+            server->receiveStreamStart();
+            server->sendStreamStart();
+            server->sendStreamFeaturesWithStartTLS();
+            server->receiveStartTLS();
+            server->sendTLSProceed();
+            server->onTLSEncrypted();
+            server->receiveStreamStart();
+            server->sendStreamStart();
+            server->sendStreamFeaturesWithSCRAMPlusAuthentication();
+            CPPUNIT_ASSERT_EQUAL(ClientSession::WaitingForCredentials, session->getState());
+            session->sendCredentials(createSafeByteArray("mypass"));
+            server->receiveAuthRequest("SCRAM-SHA-1-PLUS");
+
+            session->finish();
+        }
+
+        void testAuthenticate_SCRAMWithoutChannelBindingData() {
+            std::shared_ptr<ClientSession> session(createSession());
+            session->start();
+            server->receiveStreamStart();
+            server->sendStreamStart();
+            server->sendStreamFeaturesWithSCRAMPlusAuthentication();
+            CPPUNIT_ASSERT_EQUAL(ClientSession::WaitingForCredentials, session->getState());
+            session->sendCredentials(createSafeByteArray("mypass"));
+            server->receiveAuthRequest("SCRAM-SHA-256");
+
+            session->finish();
+        }
+
         void testAuthenticate_PLAINOverNonTLS() {
             std::shared_ptr<ClientSession> session(createSession());
             session->setAllowPLAINOverNonTLS(false);
@@ -431,7 +482,7 @@ class ClientSessionTest : public CppUnit::TestFixture {
                 }
 
                 virtual ByteArray getTLSFinishMessage() const {
-                    return ByteArray();
+                    return tlsFinishMessage;
                 }
 
                 virtual Certificate::ref getPeerCertificate() const {
@@ -513,6 +564,20 @@ class ClientSessionTest : public CppUnit::TestFixture {
                     onElementReceived(streamFeatures);
                 }
 
+                void sendStreamFeaturesWithSCRAMAuthentication() {
+                    std::shared_ptr<StreamFeatures> streamFeatures(new StreamFeatures());
+                    streamFeatures->addAuthenticationMechanism("SCRAM-SHA-1");
+                    streamFeatures->addAuthenticationMechanism("SCRAM-SHA-256");
+                    onElementReceived(streamFeatures);
+                }
+
+                void sendStreamFeaturesWithSCRAMPlusAuthentication() {
+                    std::shared_ptr<StreamFeatures> streamFeatures(new StreamFeatures());
+                    streamFeatures->addAuthenticationMechanism("SCRAM-SHA-1-PLUS");
+                    streamFeatures->addAuthenticationMechanism("SCRAM-SHA-256");
+                    onElementReceived(streamFeatures);
+                }
+
                 void sendStreamFeaturesWithEXTERNALAuthentication() {
                     std::shared_ptr<StreamFeatures> streamFeatures(new StreamFeatures());
                     streamFeatures->addAuthenticationMechanism("EXTERNAL");
@@ -617,6 +682,7 @@ class ClientSessionTest : public CppUnit::TestFixture {
                 bool available;
                 bool canTLSEncrypt;
                 bool tlsEncrypted;
+                ByteArray tlsFinishMessage;
                 bool compressed;
                 bool whitespacePingEnabled;
                 std::string bindID;
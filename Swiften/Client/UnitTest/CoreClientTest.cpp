@@ -0,0 +1,189 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cassert>
+#include <memory>
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Client/ClientOptions.h>
+#include <Swiften/Client/CoreClient.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/IDN/IDNConverter.h>
+#include <Swiften/IDN/PlatformIDNConverter.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+#include <Swiften/Network/NetworkFactories.h>
+#include <Swiften/Network/ProxyProvider.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+
+using namespace Swift;
+
+class CoreClientTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(CoreClientTest);
+        CPPUNIT_TEST(testGetStreamStatistics_NotConnected);
+        CPPUNIT_TEST(testGetStreamStatistics_Connected);
+        CPPUNIT_TEST(testGetStreamStatistics_AfterDisconnect);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            networkFactories = new TestNetworkFactories();
+            networkFactories->resolver.addAddress("example.com", HostAddress("10.0.0.1"));
+            client = new CoreClient(JID("alice@example.com/resource"), createSafeByteArray("password"), networkFactories);
+        }
+
+        void tearDown() {
+            delete client;
+            networkFactories->eventLoop.processEvents();
+            delete networkFactories;
+        }
+
+        void testGetStreamStatistics_NotConnected() {
+            StreamStatistics statistics = client->getStreamStatistics();
+
+            CPPUNIT_ASSERT(!statistics.connection);
+            CPPUNIT_ASSERT(!statistics.tls);
+            CPPUNIT_ASSERT(!statistics.compression);
+            CPPUNIT_ASSERT(!statistics.xmpp);
+        }
+
+        void testGetStreamStatistics_Connected() {
+            connect();
+            std::shared_ptr<MockConnection> connection = networkFactories->connectionFactory.connection;
+            CPPUNIT_ASSERT(connection);
+            SafeByteArray streamHeader = createSafeByteArray("<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='example.com' id='s1' version='1.0'>");
+            connection->onDataRead(std::make_shared<SafeByteArray>(streamHeader));
+
+            StreamStatistics statistics = client->getStreamStatistics();
+
+            CPPUNIT_ASSERT(statistics.connection);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(connection->dataWritten.size()), statistics.connection->bytesWritten);
+            CPPUNIT_ASSERT(statistics.connection->writes > 0);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(streamHeader.size()), statistics.connection->bytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.connection->reads);
+            CPPUNIT_ASSERT(statistics.xmpp);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(streamHeader.size()), statistics.xmpp->bytesParsed);
+            CPPUNIT_ASSERT(!statistics.tls);
+            CPPUNIT_ASSERT(!statistics.compression);
+
+            disconnect();
+        }
+
+        void testGetStreamStatistics_AfterDisconnect() {
+            connect();
+            disconnect();
+
+            StreamStatistics statistics = client->getStreamStatistics();
+
+            CPPUNIT_ASSERT(!statistics.connection);
+            CPPUNIT_ASSERT(!statistics.xmpp);
+        }
+
+    private:
+        void connect() {
+            ClientOptions options;
+            options.manualHostname = "example.com";
+            options.manualPort = 5222;
+            options.proxyType = ClientOptions::NoProxy;
+            client->connect(options);
+            networkFactories->eventLoop.processEvents();
+        }
+
+        void disconnect() {
+            client->disconnect();
+            networkFactories->eventLoop.processEvents();
+        }
+
+        class MockConnection : public Connection, public EventOwner, public std::enable_shared_from_this<MockConnection> {
+            public:
+                MockConnection(EventLoop* eventLoop) : eventLoop(eventLoop) {}
+
+                void listen() { assert(false); }
+
+                void connect(const HostAddressPort&) {
+                    eventLoop->postEvent(boost::bind(boost::ref(onConnectFinished), false), shared_from_this());
+                }
+
+                void disconnect() {
+                    eventLoop->postEvent(boost::bind(boost::ref(onDisconnected), boost::optional<Error>()), shared_from_this());
+                }
+
+                void write(const SafeByteArray& data) {
+                    append(dataWritten, data);
+                }
+
+                HostAddressPort getLocalAddress() const { return HostAddressPort(); }
+                HostAddressPort getRemoteAddress() const { return HostAddressPort(); }
+
+                EventLoop* eventLoop;
+                SafeByteArray dataWritten;
+        };
+
+        class MockConnectionFactory : public ConnectionFactory {
+            public:
+                MockConnectionFactory(EventLoop* eventLoop) : eventLoop(eventLoop) {}
+
+                std::shared_ptr<Connection> createConnection() {
+                    connection = std::make_shared<MockConnection>(eventLoop);
+                    return connection;
+                }
+
+                EventLoop* eventLoop;
+                std::shared_ptr<MockConnection> connection;
+        };
+
+        class NoProxyProvider : public ProxyProvider {
+            public:
+                virtual HostAddressPort getHTTPConnectProxy() const { return HostAddressPort(); }
+                virtual HostAddressPort getSOCKS5Proxy() const { return HostAddressPort(); }
+        };
+
+        class TestNetworkFactories : public NetworkFactories {
+            public:
+                TestNetworkFactories() : resolver(&eventLoop), connectionFactory(&eventLoop), idnConverter(PlatformIDNConverter::create()), crypto(PlatformCryptoProvider::create()) {}
+
+                virtual TimerFactory* getTimerFactory() const { return const_cast<DummyTimerFactory*>(&timerFactory); }
+                virtual ConnectionFactory* getConnectionFactory() const { return const_cast<MockConnectionFactory*>(&connectionFactory); }
+                virtual DomainNameResolver* getDomainNameResolver() const { return const_cast<StaticDomainNameResolver*>(&resolver); }
+                virtual ConnectionServerFactory* getConnectionServerFactory() const { return nullptr; }
+                virtual NATTraverser* getNATTraverser() const { return nullptr; }
+                virtual NetworkEnvironment* getNetworkEnvironment() const { return nullptr; }
+                virtual XMLParserFactory* getXMLParserFactory() const { return const_cast<PlatformXMLParserFactory*>(&xmlParserFactory); }
+                virtual TLSContextFactory* getTLSContextFactory() const { return nullptr; }
+                virtual ProxyProvider* getProxyProvider() const { return const_cast<NoProxyProvider*>(&proxyProvider); }
+                virtual EventLoop* getEventLoop() const { return const_cast<DummyEventLoop*>(&eventLoop); }
+                virtual IDNConverter* getIDNConverter() const { return idnConverter.get(); }
+                virtual CryptoProvider* getCryptoProvider() const { return crypto.get(); }
+
+                DummyEventLoop eventLoop;
+                DummyTimerFactory timerFactory;
+                StaticDomainNameResolver resolver;
+                MockConnectionFactory connectionFactory;
+                PlatformXMLParserFactory xmlParserFactory;
+                NoProxyProvider proxyProvider;
+                std::unique_ptr<IDNConverter> idnConverter;
+                std::unique_ptr<CryptoProvider> crypto;
+        };
+
+    private:
+        TestNetworkFactories* networkFactories;
+        CoreClient* client;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CoreClientTest);
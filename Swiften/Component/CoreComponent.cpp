@@ -166,4 +166,8 @@ void CoreComponent::sendData(const std::string& data) {
     sessionStream_->writeData(data);
 }
 
+StreamStatistics CoreComponent::getStreamStatistics() const {
+    return sessionStream_ ? sessionStream_->getStatistics() : StreamStatistics();
+}
+
 }
@@ -24,6 +24,7 @@
 #include <Swiften/JID/JID.h>
 #include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
 #include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 
 namespace Swift {
     class EventLoop;
@@ -73,6 +74,12 @@ namespace Swift {
                 return jid_;
             }
 
+            /**
+             * Returns a snapshot of the counters of the layers of the
+             * current stream, or no layers if there is no connection.
+             */
+            StreamStatistics getStreamStatistics() const;
+
         public:
             boost::signals2::signal<void (const ComponentError&)> onError;
             boost::signals2::signal<void ()> onConnected;
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cassert>
+#include <memory>
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Component/CoreComponent.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/HostAddress.h>
+#include <Swiften/Network/HostAddressPort.h>
+#include <Swiften/Network/NetworkFactories.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+
+using namespace Swift;
+
+class CoreComponentTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(CoreComponentTest);
+        CPPUNIT_TEST(testGetStreamStatistics_NotConnected);
+        CPPUNIT_TEST(testGetStreamStatistics_Connected);
+        CPPUNIT_TEST(testGetStreamStatistics_AfterDisconnect);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            networkFactories = new TestNetworkFactories();
+            networkFactories->resolver.addAddress("example.com", HostAddress("10.0.0.1"));
+            component = new CoreComponent(JID("component.example.com"), "secret", networkFactories);
+        }
+
+        void tearDown() {
+            delete component;
+            networkFactories->eventLoop.processEvents();
+            delete networkFactories;
+        }
+
+        void testGetStreamStatistics_NotConnected() {
+            StreamStatistics statistics = component->getStreamStatistics();
+
+            CPPUNIT_ASSERT(!statistics.connection);
+            CPPUNIT_ASSERT(!statistics.tls);
+            CPPUNIT_ASSERT(!statistics.compression);
+            CPPUNIT_ASSERT(!statistics.xmpp);
+        }
+
+        void testGetStreamStatistics_Connected() {
+            connect();
+            std::shared_ptr<MockConnection> connection = networkFactories->connectionFactory.connection;
+            CPPUNIT_ASSERT(connection);
+            SafeByteArray streamHeader = createSafeByteArray("<stream:stream xmlns='jabber:component:accept' xmlns:stream='http://etherx.jabber.org/streams' from='component.example.com' id='s1'>");
+            connection->onDataRead(std::make_shared<SafeByteArray>(streamHeader));
+
+            StreamStatistics statistics = component->getStreamStatistics();
+
+            CPPUNIT_ASSERT(statistics.connection);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(connection->dataWritten.size()), statistics.connection->bytesWritten);
+            CPPUNIT_ASSERT(statistics.connection->writes > 0);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(streamHeader.size()), statistics.connection->bytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.connection->reads);
+            CPPUNIT_ASSERT(statistics.xmpp);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(streamHeader.size()), statistics.xmpp->bytesParsed);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.xmpp->elementsSerialized);
+            CPPUNIT_ASSERT(!statistics.tls);
+            CPPUNIT_ASSERT(!statistics.compression);
+
+            disconnect();
+        }
+
+        void testGetStreamStatistics_AfterDisconnect() {
+            connect();
+            disconnect();
+
+            StreamStatistics statistics = component->getStreamStatistics();
+
+            CPPUNIT_ASSERT(!statistics.connection);
+            CPPUNIT_ASSERT(!statistics.xmpp);
+        }
+
+    private:
+        void connect() {
+            component->connect("example.com", 5347);
+            networkFactories->eventLoop.processEvents();
+        }
+
+        void disconnect() {
+            component->disconnect();
+            networkFactories->eventLoop.processEvents();
+        }
+
+        class MockConnection : public Connection, public EventOwner, public std::enable_shared_from_this<MockConnection> {
+            public:
+                MockConnection(EventLoop* eventLoop) : eventLoop(eventLoop) {}
+
+                void listen() { assert(false); }
+
+                void connect(const HostAddressPort&) {
+                    eventLoop->postEvent(boost::bind(boost::ref(onConnectFinished), false), shared_from_this());
+                }
+
+                void disconnect() {
+                    eventLoop->postEvent(boost::bind(boost::ref(onDisconnected), boost::optional<Error>()), shared_from_this());
+                }
+
+                void write(const SafeByteArray& data) {
+                    append(dataWritten, data);
+                }
+
+                HostAddressPort getLocalAddress() const { return HostAddressPort(); }
+                HostAddressPort getRemoteAddress() const { return HostAddressPort(); }
+
+                EventLoop* eventLoop;
+                SafeByteArray dataWritten;
+        };
+
+        class MockConnectionFactory : public ConnectionFactory {
+            public:
+                MockConnectionFactory(EventLoop* eventLoop) : eventLoop(eventLoop) {}
+
+                std::shared_ptr<Connection> createConnection() {
+                    connection = std::make_shared<MockConnection>(eventLoop);
+                    return connection;
+                }
+
+                EventLoop* eventLoop;
+                std::shared_ptr<MockConnection> connection;
+        };
+
+        class TestNetworkFactories : public NetworkFactories {
+            public:
+                TestNetworkFactories() : resolver(&eventLoop), connectionFactory(&eventLoop), crypto(PlatformCryptoProvider::create()) {}
+
+                virtual TimerFactory* getTimerFactory() const { return const_cast<DummyTimerFactory*>(&timerFactory); }
+                virtual ConnectionFactory* getConnectionFactory() const { return const_cast<MockConnectionFactory*>(&connectionFactory); }
+                virtual DomainNameResolver* getDomainNameResolver() const { return const_cast<StaticDomainNameResolver*>(&resolver); }
+                virtual ConnectionServerFactory* getConnectionServerFactory() const { return nullptr; }
+                virtual NATTraverser* getNATTraverser() const { return nullptr; }
+                virtual NetworkEnvironment* getNetworkEnvironment() const { return nullptr; }
+                virtual XMLParserFactory* getXMLParserFactory() const { return const_cast<PlatformXMLParserFactory*>(&xmlParserFactory); }
+                virtual TLSContextFactory* getTLSContextFactory() const { return nullptr; }
+                virtual ProxyProvider* getProxyProvider() const { return nullptr; }
+                virtual EventLoop* getEventLoop() const { return const_cast<DummyEventLoop*>(&eventLoop); }
+                virtual IDNConverter* getIDNConverter() const { return nullptr; }
+                virtual CryptoProvider* getCryptoProvider() const { return crypto.get(); }
+
+                DummyEventLoop eventLoop;
+                DummyTimerFactory timerFactory;
+                StaticDomainNameResolver resolver;
+                MockConnectionFactory connectionFactory;
+                PlatformXMLParserFactory xmlParserFactory;
+                std::unique_ptr<CryptoProvider> crypto;
+        };
+
+    private:
+        TestNetworkFactories* networkFactories;
+        CoreComponent* component;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CoreComponentTest);
@@ -8,7 +8,62 @@
 
 #include <memory>
 
+#include <Swiften/Base/Concat.h>
+
 using namespace Swift;
 
 CryptoProvider::~CryptoProvider() {
 }
+
+Hash* CryptoProvider::createHash(const std::string& algorithm) {
+    if (algorithm == "sha-1") {
+        return createSHA1();
+    }
+    if (algorithm == "md5") {
+        return createMD5();
+    }
+    return nullptr;
+}
+
+ByteArray CryptoProvider::getHMAC(const std::string& algorithm, const SafeByteArray& key, const ByteArray& data) {
+    if (algorithm == "sha-1") {
+        return getHMACSHA1(key, data);
+    }
+    if (algorithm != "md5" && algorithm != "sha-224" && algorithm != "sha-256") {
+        return ByteArray();
+    }
+    std::unique_ptr<Hash> hash(createHash(algorithm));
+    if (!hash) {
+        return ByteArray();
+    }
+
+    const size_t blockSize = 64;
+    SafeByteArray paddedKey(key);
+    if (paddedKey.size() > blockSize) {
+        paddedKey = createSafeByteArray(hash->update(key).getHash());
+        hash.reset(createHash(algorithm));
+    }
+    paddedKey.resize(blockSize, 0x0);
+
+    SafeByteArray innerKey(paddedKey);
+    SafeByteArray outerKey(paddedKey);
+    for (size_t i = 0; i < blockSize; ++i) {
+        innerKey[i] ^= 0x36;
+        outerKey[i] ^= 0x5c;
+    }
+    ByteArray innerHash = hash->update(innerKey).update(data).getHash();
+    hash.reset(createHash(algorithm));
+    return hash->update(outerKey).update(innerHash).getHash();
+}
+
+ByteArray CryptoProvider::getPBKDF2(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations) {
+    ByteArray u = getHMAC(algorithm, password, concat(salt, createByteArray("\0\0\0\1", 4)));
+    ByteArray result(u);
+    for (int i = 1; i < iterations; ++i) {
+        u = getHMAC(algorithm, password, u);
+        for (size_t j = 0; j < u.size(); ++j) {
+            result[j] ^= u[j];
+        }
+    }
+    return result;
+}
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <string>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/SafeByteArray.h>
@@ -24,6 +26,37 @@ namespace Swift {
             virtual ByteArray getHMACSHA1(const ByteArray& key, const ByteArray& data) = 0;
             virtual bool isMD5AllowedForCrypto() const = 0;
 
+            /**
+             * Creates a hash for an algorithm named as in XEP-0300 (e.g.
+             * "sha-1", "sha-256", "sha3-256" or "blake2b-512").
+             *
+             * Returns nullptr if the algorithm is not supported. The default
+             * implementation only supports "sha-1" and "md5".
+             */
+            virtual Hash* createHash(const std::string& algorithm);
+
+            /**
+             * Computes the HMAC of data with a hash algorithm named as in
+             * createHash().
+             *
+             * Returns an empty ByteArray if the algorithm is not supported.
+             * The default implementation builds the HMAC on createHash(),
+             * and supports the algorithms with a 64 byte block size ("md5",
+             * "sha-1", "sha-224" and "sha-256").
+             */
+            virtual ByteArray getHMAC(const std::string& algorithm, const SafeByteArray& key, const ByteArray& data);
+
+            /**
+             * Derives a key from a password with PBKDF2 (RFC 2898), using
+             * HMAC with a hash algorithm named as in createHash(). The
+             * derived key is as long as the hash.
+             *
+             * Returns an empty ByteArray if the algorithm is not supported.
+             * The default implementation calls getHMAC() for every
+             * iteration.
+             */
+            virtual ByteArray getPBKDF2(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations);
+
             // Convenience
             template<typename T> ByteArray getSHA1Hash(const T& data) {
                 return std::shared_ptr<Hash>(createSHA1())->update(data).getHash();
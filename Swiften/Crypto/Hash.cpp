@@ -1,12 +1,26 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #include <Swiften/Crypto/Hash.h>
 
+#include <algorithm>
+#include <cassert>
+
 using namespace Swift;
 
 Hash::~Hash() {
 }
+
+Hash& Hash::updateBytes(const unsigned char* data, size_t size) {
+    return update(createByteArray(data, size));
+}
+
+bool Hash::getHashAndReset(unsigned char* digest, size_t size) {
+    std::vector<unsigned char> result = getHash();
+    assert(result.size() <= size);
+    std::copy(result.begin(), result.begin() + static_cast<std::ptrdiff_t>(std::min(result.size(), size)), digest);
+    return false;
+}
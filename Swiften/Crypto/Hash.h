@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015 Isode Limited.
+ * Copyright (c) 2013-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -21,5 +21,20 @@ namespace Swift {
             virtual Hash& update(const SafeByteArray& data) = 0;
 
             virtual std::vector<unsigned char> getHash() = 0;
+
+            /**
+             * Adds size bytes starting at data to the hash.
+             */
+            virtual Hash& updateBytes(const unsigned char* data, size_t size);
+
+            /**
+             * Writes the hash to digest, which has room for size bytes, and
+             * starts a new hash, so that this object can be reused.
+             *
+             * Returns false if the hash cannot be restarted, in which case
+             * the object can not be used anymore. The default implementation
+             * copies the result of getHash(), and returns false.
+             */
+            virtual bool getHashAndReset(unsigned char* digest, size_t size);
     };
 }
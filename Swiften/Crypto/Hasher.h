@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
+
+namespace Swift {
+    /**
+     * Hashes data into a fixed size digest, and can be reused for any
+     * number of hashes.
+     *
+     * Unlike CryptoProvider::getSHA1Hash(), a hasher creates its Hash only
+     * once, and does not allocate memory for every hash it computes (as
+     * long as the crypto provider supports restarting hashes).
+     */
+    template<size_t DigestSize, Hash* (CryptoProvider::*CreateHash)()>
+    class Hasher {
+        public:
+            typedef std::array<unsigned char, DigestSize> Digest;
+
+            explicit Hasher(CryptoProvider* crypto) : crypto(crypto), hash((crypto->*CreateHash)()) {
+            }
+
+            Hasher& update(const unsigned char* data, size_t size) {
+                hash->updateBytes(data, size);
+                return *this;
+            }
+
+            Hasher& update(const ByteArray& data) {
+                return update(vecptr(data), data.size());
+            }
+
+            Hasher& update(const SafeByteArray& data) {
+                return update(vecptr(data), data.size());
+            }
+
+            Hasher& update(const std::string& data) {
+                return update(reinterpret_cast<const unsigned char*>(data.data()), data.size());
+            }
+
+            /**
+             * Returns the hash of the data passed to update() since the
+             * previous call, and starts a new hash.
+             */
+            Digest getHash() {
+                Digest digest;
+                if (!hash->getHashAndReset(digest.data(), digest.size())) {
+                    hash.reset((crypto->*CreateHash)());
+                }
+                return digest;
+            }
+
+            // Convenience
+            template<typename T> Digest getHash(const T& data) {
+                return update(data).getHash();
+            }
+
+        private:
+            CryptoProvider* crypto;
+            std::unique_ptr<Hash> hash;
+    };
+
+    typedef Hasher<20, &CryptoProvider::createSHA1> SHA1Hasher;
+    typedef Hasher<16, &CryptoProvider::createMD5> MD5Hasher;
+}
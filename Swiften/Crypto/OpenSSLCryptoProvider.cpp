@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013 Isode Limited.
+ * Copyright (c) 2013-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -7,8 +7,9 @@
 #include <Swiften/Crypto/OpenSSLCryptoProvider.h>
 
 #include <openssl/sha.h>
-#include <openssl/md5.h>
 #include <openssl/hmac.h>
+#include <openssl/evp.h>
+#include <openssl/opensslv.h>
 #include <cassert>
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -20,15 +21,25 @@
 using namespace Swift;
 
 namespace {
-    class SHA1Hash : public Hash {
+    class EVPHash : public Hash {
         public:
-            SHA1Hash() : finalized(false) {
-                if (!SHA1_Init(&context)) {
+            EVPHash(const EVP_MD* md) : md(md), finalized(false) {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+                context = EVP_MD_CTX_new();
+#else
+                context = EVP_MD_CTX_create();
+#endif
+                if (!EVP_DigestInit_ex(context, md, nullptr)) {
                     assert(false);
                 }
             }
 
-            ~SHA1Hash() {
+            ~EVPHash() {
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+                EVP_MD_CTX_free(context);
+#else
+                EVP_MD_CTX_destroy(context);
+#endif
             }
 
             virtual Hash& update(const ByteArray& data) SWIFTEN_OVERRIDE {
@@ -41,67 +52,93 @@ namespace {
 
             virtual std::vector<unsigned char> getHash() SWIFTEN_OVERRIDE {
                 assert(!finalized);
-                std::vector<unsigned char> result(SHA_DIGEST_LENGTH);
-                SHA1_Final(vecptr(result), &context);
+                std::vector<unsigned char> result(EVP_MAX_MD_SIZE);
+                unsigned int size = 0;
+                if (!EVP_DigestFinal_ex(context, vecptr(result), &size)) {
+                    assert(false);
+                }
+                finalized = true;
+                result.resize(size);
                 return result;
             }
 
-        private:
-            template<typename ContainerType>
-            Hash& updateInternal(const ContainerType& data) {
+            virtual Hash& updateBytes(const unsigned char* data, size_t size) SWIFTEN_OVERRIDE {
                 assert(!finalized);
-                if (!SHA1_Update(&context, vecptr(data), data.size())) {
+                if (!EVP_DigestUpdate(context, data, size)) {
                     assert(false);
                 }
                 return *this;
             }
 
-        private:
-            SHA_CTX context;
-            bool finalized;
-    };
-
-    class MD5Hash : public Hash {
-        public:
-            MD5Hash() : finalized(false) {
-                if (!MD5_Init(&context)) {
-                    assert(false);
-                }
-            }
-
-            ~MD5Hash() {
-            }
-
-            virtual Hash& update(const ByteArray& data) SWIFTEN_OVERRIDE {
-                return updateInternal(data);
-            }
-
-            virtual Hash& update(const SafeByteArray& data) SWIFTEN_OVERRIDE {
-                return updateInternal(data);
-            }
-
-            virtual std::vector<unsigned char> getHash() SWIFTEN_OVERRIDE {
+            virtual bool getHashAndReset(unsigned char* digest, size_t size) SWIFTEN_OVERRIDE {
                 assert(!finalized);
-                std::vector<unsigned char> result(MD5_DIGEST_LENGTH);
-                MD5_Final(vecptr(result), &context);
-                return result;
+                assert(static_cast<size_t>(EVP_MD_size(md)) <= size);
+                unsigned int digestSize = 0;
+                if (size < static_cast<size_t>(EVP_MD_size(md)) || !EVP_DigestFinal_ex(context, digest, &digestSize)) {
+                    finalized = true;
+                    return false;
+                }
+                if (!EVP_DigestInit_ex(context, md, nullptr)) {
+                    finalized = true;
+                    return false;
+                }
+                return true;
             }
 
         private:
             template<typename ContainerType>
             Hash& updateInternal(const ContainerType& data) {
                 assert(!finalized);
-                if (!MD5_Update(&context, vecptr(data), data.size())) {
+                if (!EVP_DigestUpdate(context, vecptr(data), data.size())) {
                     assert(false);
                 }
                 return *this;
             }
 
         private:
-            MD5_CTX context;
+            const EVP_MD* md;
+            EVP_MD_CTX* context;
             bool finalized;
     };
 
+    const EVP_MD* getDigest(const std::string& algorithm) {
+        if (algorithm == "sha-224") {
+            return EVP_sha224();
+        }
+        if (algorithm == "sha-256") {
+            return EVP_sha256();
+        }
+        if (algorithm == "sha-384") {
+            return EVP_sha384();
+        }
+        if (algorithm == "sha-512") {
+            return EVP_sha512();
+        }
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+        if (algorithm == "sha3-256") {
+            return EVP_sha3_256();
+        }
+        if (algorithm == "sha3-512") {
+            return EVP_sha3_512();
+        }
+#endif
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L && !defined(OPENSSL_NO_BLAKE2)
+        if (algorithm == "blake2b-512") {
+            return EVP_blake2b512();
+        }
+#endif
+        return nullptr;
+    }
+
+    const EVP_MD* getHMACDigest(const std::string& algorithm) {
+        if (algorithm == "sha-1") {
+            return EVP_sha1();
+        }
+        if (algorithm == "md5") {
+            return EVP_md5();
+        }
+        return getDigest(algorithm);
+    }
 
     template<typename T>
     ByteArray getHMACSHA1Internal(const T& key, const ByteArray& data) {
@@ -119,11 +156,11 @@ OpenSSLCryptoProvider::~OpenSSLCryptoProvider() {
 }
 
 Hash* OpenSSLCryptoProvider::createSHA1() {
-    return new SHA1Hash();
+    return new EVPHash(EVP_sha1());
 }
 
 Hash* OpenSSLCryptoProvider::createMD5() {
-    return new MD5Hash();
+    return new EVPHash(EVP_md5());
 }
 
 ByteArray OpenSSLCryptoProvider::getHMACSHA1(const SafeByteArray& key, const ByteArray& data) {
@@ -138,3 +175,40 @@ bool OpenSSLCryptoProvider::isMD5AllowedForCrypto() const {
     return true;
 }
 
+Hash* OpenSSLCryptoProvider::createHash(const std::string& algorithm) {
+    if (const EVP_MD* md = getDigest(algorithm)) {
+        return new EVPHash(md);
+    }
+    return CryptoProvider::createHash(algorithm);
+}
+
+
+ByteArray OpenSSLCryptoProvider::getHMAC(const std::string& algorithm, const SafeByteArray& key, const ByteArray& data) {
+    const EVP_MD* md = getHMACDigest(algorithm);
+    if (!md) {
+        return ByteArray();
+    }
+    // HMAC() fails on a null key, which vecptr() returns for empty buffers
+    static const unsigned char empty = 0;
+    unsigned int len = EVP_MAX_MD_SIZE;
+    std::vector<unsigned char> result(len);
+    if (!HMAC(md, key.empty() ? &empty : vecptr(key), boost::numeric_cast<int>(key.size()), data.empty() ? &empty : vecptr(data), data.size(), vecptr(result), &len)) {
+        return ByteArray();
+    }
+    result.resize(len);
+    return result;
+}
+
+ByteArray OpenSSLCryptoProvider::getPBKDF2(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations) {
+    const EVP_MD* md = getHMACDigest(algorithm);
+    if (!md || iterations <= 0) {
+        return ByteArray();
+    }
+    // PKCS5_PBKDF2_HMAC keys the HMAC only once, and reuses its inner and
+    // outer state for every iteration.
+    std::vector<unsigned char> result(static_cast<size_t>(EVP_MD_size(md)));
+    if (!PKCS5_PBKDF2_HMAC(reinterpret_cast<const char*>(vecptr(password)), boost::numeric_cast<int>(password.size()), vecptr(salt), boost::numeric_cast<int>(salt.size()), iterations, md, boost::numeric_cast<int>(result.size()), vecptr(result))) {
+        return ByteArray();
+    }
+    return result;
+}
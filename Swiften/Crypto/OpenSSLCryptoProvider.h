@@ -20,5 +20,8 @@ namespace Swift {
             virtual ByteArray getHMACSHA1(const SafeByteArray& key, const ByteArray& data) SWIFTEN_OVERRIDE;
             virtual ByteArray getHMACSHA1(const ByteArray& key, const ByteArray& data) SWIFTEN_OVERRIDE;
             virtual bool isMD5AllowedForCrypto() const SWIFTEN_OVERRIDE;
+            virtual Hash* createHash(const std::string& algorithm) SWIFTEN_OVERRIDE;
+            virtual ByteArray getHMAC(const std::string& algorithm, const SafeByteArray& key, const ByteArray& data) SWIFTEN_OVERRIDE;
+            virtual ByteArray getPBKDF2(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations) SWIFTEN_OVERRIDE;
     };
 }
@@ -21,6 +21,8 @@
 #include <Swiften/Crypto/CommonCryptoCryptoProvider.h>
 #endif
 #include <Swiften/Crypto/Hash.h>
+#include <Swiften/Crypto/Hasher.h>
+#include <Swiften/StringCodecs/Hexify.h>
 
 using namespace Swift;
 
@@ -39,9 +41,30 @@ class CryptoProviderTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testGetMD5Hash_Alphabet);
         CPPUNIT_TEST(testMD5Incremental);
 
+        CPPUNIT_TEST(testSHA1Hasher);
+        CPPUNIT_TEST(testSHA1Hasher_Reuse);
+        CPPUNIT_TEST(testSHA1Hasher_UpdateBytes);
+        CPPUNIT_TEST(testMD5Hasher_Empty);
+
         CPPUNIT_TEST(testGetHMACSHA1);
         CPPUNIT_TEST(testGetHMACSHA1_KeyLongerThanBlockSize);
 
+        CPPUNIT_TEST(testGetHMAC_SHA256);
+        CPPUNIT_TEST(testGetHMAC_SHA256_KeyLongerThanBlockSize);
+        CPPUNIT_TEST(testGetHMAC_SHA256_Empty);
+        CPPUNIT_TEST(testGetHMAC_DefaultImplementation);
+        CPPUNIT_TEST(testGetHMAC_Unknown);
+
+        CPPUNIT_TEST(testGetPBKDF2_SHA1);
+        CPPUNIT_TEST(testGetPBKDF2_SHA256);
+        CPPUNIT_TEST(testGetPBKDF2_DefaultImplementation);
+
+        CPPUNIT_TEST(testCreateHash_SHA1);
+        CPPUNIT_TEST(testCreateHash_SHA256);
+        CPPUNIT_TEST(testCreateHash_SHA3_256);
+        CPPUNIT_TEST(testCreateHash_BLAKE2b512);
+        CPPUNIT_TEST(testCreateHash_Unknown);
+
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -116,6 +139,47 @@ class CryptoProviderTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(createByteArray("\xd1\x74\xab\x98\xd2\x77\xd9\xf5\xa5\x61\x1c\x2c\x9f\x41\x9d\x9f", 16), result);
         }
 
+
+        ////////////////////////////////////////////////////////////
+        // Hasher
+        ////////////////////////////////////////////////////////////
+
+        void testSHA1Hasher() {
+            SHA1Hasher testling(provider);
+
+            SHA1Hasher::Digest result = testling.getHash(createByteArray("client/pc//Exodus 0.9.1<http://jabber.org/protocol/caps<http://jabber.org/protocol/disco#info<http://jabber.org/protocol/disco#items<http://jabber.org/protocol/muc<"));
+
+            CPPUNIT_ASSERT_EQUAL(std::string("4206b23ca6b0a643d20d89b04ff58cf78b8096ed"), Hexify::hexify(createByteArray(result.data(), result.size())));
+        }
+
+        void testSHA1Hasher_Reuse() {
+            SHA1Hasher testling(provider);
+            testling.getHash(createByteArray("foo"));
+
+            SHA1Hasher::Digest result = testling.getHash(createByteArray("client/pc//Exodus 0.9.1<http://jabber.org/protocol/caps<http://jabber.org/protocol/disco#info<http://jabber.org/protocol/disco#items<http://jabber.org/protocol/muc<"));
+
+            CPPUNIT_ASSERT_EQUAL(std::string("4206b23ca6b0a643d20d89b04ff58cf78b8096ed"), Hexify::hexify(createByteArray(result.data(), result.size())));
+        }
+
+        void testSHA1Hasher_UpdateBytes() {
+            SHA1Hasher testling(provider);
+            const unsigned char data[] = { 'a', 'b', 'c' };
+            testling.update(data, 1);
+            testling.update(data + 1, 2);
+
+            SHA1Hasher::Digest result = testling.getHash();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("a9993e364706816aba3e25717850c26c9cd0d89d"), Hexify::hexify(createByteArray(result.data(), result.size())));
+        }
+
+        void testMD5Hasher_Empty() {
+            MD5Hasher testling(provider);
+
+            MD5Hasher::Digest result = testling.getHash();
+
+            CPPUNIT_ASSERT_EQUAL(std::string("d41d8cd98f00b204e9800998ecf8427e"), Hexify::hexify(createByteArray(result.data(), result.size())));
+        }
+
         void testMD5Incremental() {
             std::shared_ptr<Hash> testling = std::shared_ptr<Hash>(provider->createMD5());
             testling->update(createByteArray("ABCDEFGHIJKLMNOPQRSTUVWXYZ"));
@@ -141,6 +205,98 @@ class CryptoProviderTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(createByteArray("\xd6""n""\x8f""P|1""\xd3"",""\x6"" ""\xb9\xe3""gg""\x8e\xcf"" ]+""\xa"), result);
         }
 
+
+        ////////////////////////////////////////////////////////////
+        // HMAC (test vectors from RFC 4231)
+        ////////////////////////////////////////////////////////////
+
+        void testGetHMAC_SHA256() {
+            ByteArray result(provider->getHMAC("sha-256", createSafeByteArray("Jefe"), createByteArray("what do ya want for nothing?")));
+            CPPUNIT_ASSERT_EQUAL(std::string("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"), Hexify::hexify(result));
+        }
+
+        void testGetHMAC_SHA256_KeyLongerThanBlockSize() {
+            ByteArray result(provider->getHMAC("sha-256", SafeByteArray(131, 0xaa), createByteArray("Test Using Larger Than Block-Size Key - Hash Key First")));
+            CPPUNIT_ASSERT_EQUAL(std::string("60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"), Hexify::hexify(result));
+        }
+
+        void testGetHMAC_SHA256_Empty() {
+            ByteArray result(provider->getHMAC("sha-256", SafeByteArray(), ByteArray()));
+            CPPUNIT_ASSERT_EQUAL(std::string("b613679a0814d9ec772f95d778c35fc5ff1697c493715653c6c712144292c5ad"), Hexify::hexify(result));
+        }
+
+        void testGetHMAC_DefaultImplementation() {
+            ByteArray result(provider->CryptoProvider::getHMAC("sha-256", createSafeByteArray("Jefe"), createByteArray("what do ya want for nothing?")));
+            CPPUNIT_ASSERT_EQUAL(std::string("5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843"), Hexify::hexify(result));
+
+            result = provider->CryptoProvider::getHMAC("sha-256", SafeByteArray(131, 0xaa), createByteArray("Test Using Larger Than Block-Size Key - Hash Key First"));
+            CPPUNIT_ASSERT_EQUAL(std::string("60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54"), Hexify::hexify(result));
+        }
+
+        void testGetHMAC_Unknown() {
+            CPPUNIT_ASSERT(provider->getHMAC("unknown", createSafeByteArray("Jefe"), createByteArray("foo")).empty());
+        }
+
+
+        ////////////////////////////////////////////////////////////
+        // PBKDF2
+        ////////////////////////////////////////////////////////////
+
+        void testGetPBKDF2_SHA1() {
+            ByteArray result(provider->getPBKDF2("sha-1", createSafeByteArray("password"), createByteArray("salt"), 4096));
+            CPPUNIT_ASSERT_EQUAL(std::string("4b007901b765489abead49d926f721d065a429c1"), Hexify::hexify(result));
+        }
+
+        void testGetPBKDF2_SHA256() {
+            ByteArray result(provider->getPBKDF2("sha-256", createSafeByteArray("password"), createByteArray("salt"), 4096));
+            CPPUNIT_ASSERT_EQUAL(std::string("c5e478d59288c841aa530db6845c4c8d962893a001ce4e11a4963873aa98134a"), Hexify::hexify(result));
+        }
+
+        void testGetPBKDF2_DefaultImplementation() {
+            ByteArray result(provider->CryptoProvider::getPBKDF2("sha-256", createSafeByteArray("password"), createByteArray("salt"), 2));
+            CPPUNIT_ASSERT_EQUAL(std::string("ae4d0c95af6b46d32d0adff928f06dd02a303f8ef3c251dfd6e2d85a95474c43"), Hexify::hexify(result));
+        }
+
+
+        ////////////////////////////////////////////////////////////
+        // XEP-0300 hashes
+        ////////////////////////////////////////////////////////////
+
+        void testCreateHash_SHA1() {
+            std::shared_ptr<Hash> testling = std::shared_ptr<Hash>(provider->createHash("sha-1"));
+
+            CPPUNIT_ASSERT(testling);
+            CPPUNIT_ASSERT_EQUAL(std::string("a9993e364706816aba3e25717850c26c9cd0d89d"), Hexify::hexify(testling->update(createByteArray("abc")).getHash()));
+        }
+
+        // Not all providers support the algorithms below
+        void testCreateHash_SHA256() {
+            std::shared_ptr<Hash> testling = std::shared_ptr<Hash>(provider->createHash("sha-256"));
+            if (testling) {
+                testling->update(createByteArray("a"));
+                testling->update(createByteArray("bc"));
+                CPPUNIT_ASSERT_EQUAL(std::string("ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"), Hexify::hexify(testling->getHash()));
+            }
+        }
+
+        void testCreateHash_SHA3_256() {
+            std::shared_ptr<Hash> testling = std::shared_ptr<Hash>(provider->createHash("sha3-256"));
+            if (testling) {
+                CPPUNIT_ASSERT_EQUAL(std::string("3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532"), Hexify::hexify(testling->update(createByteArray("abc")).getHash()));
+            }
+        }
+
+        void testCreateHash_BLAKE2b512() {
+            std::shared_ptr<Hash> testling = std::shared_ptr<Hash>(provider->createHash("blake2b-512"));
+            if (testling) {
+                CPPUNIT_ASSERT_EQUAL(std::string("ba80a53f981c4d0d6a2797b69f12f6e94c212f14685ac4b74b12bb6fdbffa2d17d87c5392aab792dc252d5de4533cc9518d38aa8dbf1925ab92386edd4009923"), Hexify::hexify(testling->update(createByteArray("abc")).getHash()));
+            }
+        }
+
+        void testCreateHash_Unknown() {
+            CPPUNIT_ASSERT(!provider->createHash("foo-256"));
+        }
+
     private:
         CryptoProviderType* provider;
 };
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Disco/CachingCapsStorage.h>
+
+namespace Swift {
+
+CachingCapsStorage::CachingCapsStorage(CapsStorage* storage, size_t maximumSize) : storage(storage), maximumSize(maximumSize), hitCount(0), negativeHitCount(0), loadCount(0) {
+}
+
+CachingCapsStorage::~CachingCapsStorage() {
+}
+
+std::shared_ptr<const DiscoInfo> CachingCapsStorage::getDiscoInfo(const std::string& hash) const {
+    std::map<std::string, CacheList::iterator>::const_iterator i = cacheIndex.find(hash);
+    if (i != cacheIndex.end()) {
+        cache.splice(cache.begin(), cache, i->second);
+        ++hitCount;
+        if (!i->second->second) {
+            ++negativeHitCount;
+        }
+        return i->second->second;
+    }
+    ++loadCount;
+    std::shared_ptr<const DiscoInfo> discoInfo = storage->getDiscoInfo(hash);
+    addToCache(hash, discoInfo);
+    return discoInfo;
+}
+
+void CachingCapsStorage::setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) {
+    storage->setDiscoInfo(hash, discoInfo);
+    addToCache(hash, discoInfo);
+}
+
+void CachingCapsStorage::addToCache(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) const {
+    if (maximumSize == 0) {
+        return;
+    }
+    std::map<std::string, CacheList::iterator>::iterator i = cacheIndex.find(hash);
+    if (i != cacheIndex.end()) {
+        i->second->second = discoInfo;
+        cache.splice(cache.begin(), cache, i->second);
+        return;
+    }
+    cache.push_front(std::make_pair(hash, discoInfo));
+    cacheIndex[hash] = cache.begin();
+    if (cache.size() > maximumSize) {
+        cacheIndex.erase(cache.back().first);
+        cache.pop_back();
+    }
+}
+
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <list>
+#include <map>
+#include <string>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Disco/CapsStorage.h>
+
+namespace Swift {
+    /**
+     * A bounded in-memory cache in front of another CapsStorage.
+     *
+     * Unknown hashes are cached as well, so repeated lookups of a hash
+     * that is not stored do not go to the underlying storage either.
+     * The returned DiscoInfo objects are shared between all callers, so they
+     * are only handed out as const.
+     */
+    class SWIFTEN_API CachingCapsStorage : public CapsStorage {
+        public:
+            CachingCapsStorage(CapsStorage* storage, size_t maximumSize = 512);
+            virtual ~CachingCapsStorage();
+
+            virtual std::shared_ptr<const DiscoInfo> getDiscoInfo(const std::string& hash) const;
+            virtual void setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo);
+
+            /**
+             * The number of lookups answered from the cache, including those
+             * of unknown hashes.
+             */
+            size_t getHitCount() const {
+                return hitCount;
+            }
+
+            /**
+             * The number of lookups answered from the cache for unknown hashes.
+             */
+            size_t getNegativeHitCount() const {
+                return negativeHitCount;
+            }
+
+            /**
+             * The number of lookups that went to the underlying storage.
+             */
+            size_t getLoadCount() const {
+                return loadCount;
+            }
+
+        private:
+            typedef std::list<std::pair<std::string, std::shared_ptr<const DiscoInfo>> > CacheList;
+
+            void addToCache(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) const;
+
+        private:
+            CapsStorage* storage;
+            size_t maximumSize;
+            mutable CacheList cache;
+            mutable std::map<std::string, CacheList::iterator> cacheIndex;
+            mutable size_t hitCount;
+            mutable size_t negativeHitCount;
+            mutable size_t loadCount;
+    };
+}
@@ -9,7 +9,6 @@
 #include <algorithm>
 
 #include <Swiften/Base/foreach.h>
-#include <Swiften/Crypto/CryptoProvider.h>
 #include <Swiften/Elements/DiscoInfo.h>
 #include <Swiften/Elements/FormField.h>
 #include <Swiften/StringCodecs/Base64.h>
@@ -22,7 +21,7 @@ namespace {
 
 namespace Swift {
 
-CapsInfoGenerator::CapsInfoGenerator(const std::string& node, CryptoProvider* crypto) : node_(node), crypto_(crypto) {
+CapsInfoGenerator::CapsInfoGenerator(const std::string& node, CryptoProvider* crypto) : node_(node), hasher_(crypto) {
 }
 
 CapsInfo CapsInfoGenerator::generateCapsInfo(const DiscoInfo& discoInfo) const {
@@ -57,7 +56,8 @@ CapsInfo CapsInfoGenerator::generateCapsInfo(const DiscoInfo& discoInfo) const {
         }
     }
 
-    std::string version(Base64::encode(crypto_->getSHA1Hash(createByteArray(serializedCaps))));
+    SHA1Hasher::Digest digest = hasher_.getHash(serializedCaps);
+    std::string version(Base64::encode(createByteArray(digest.data(), digest.size())));
     return CapsInfo(node_, version, "sha-1");
 }
 
@@ -9,12 +9,21 @@
 #include <string>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Crypto/Hasher.h>
 #include <Swiften/Elements/CapsInfo.h>
 
 namespace Swift {
     class DiscoInfo;
     class CryptoProvider;
 
+    /**
+     * Generates the entity capabilities (XEP-0115) of disco information.
+     *
+     * A generator reuses its hasher for every call to generateCapsInfo(), so
+     * it is not thread-safe (not even for const calls), cannot be copied, and
+     * must not be used from within itself. Keep one generator around instead
+     * of creating one per call.
+     */
     class SWIFTEN_API CapsInfoGenerator {
         public:
             CapsInfoGenerator(const std::string& node, CryptoProvider* crypto);
@@ -23,6 +32,6 @@ namespace Swift {
 
         private:
             std::string node_;
-            CryptoProvider* crypto_;
+            mutable SHA1Hasher hasher_;
     };
 }
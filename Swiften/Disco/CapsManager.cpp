@@ -10,14 +10,13 @@
 
 #include <Swiften/Base/Log.h>
 #include <Swiften/Client/StanzaChannel.h>
-#include <Swiften/Disco/CapsInfoGenerator.h>
 #include <Swiften/Disco/CapsStorage.h>
 #include <Swiften/Disco/GetDiscoInfoRequest.h>
 #include <Swiften/Elements/CapsInfo.h>
 
 namespace Swift {
 
-CapsManager::CapsManager(CapsStorage* capsStorage, StanzaChannel* stanzaChannel, IQRouter* iqRouter, CryptoProvider* crypto) : iqRouter(iqRouter), crypto(crypto), capsStorage(capsStorage), warnOnInvalidHash(true) {
+CapsManager::CapsManager(CapsStorage* capsStorage, StanzaChannel* stanzaChannel, IQRouter* iqRouter, CryptoProvider* crypto) : iqRouter(iqRouter), capsInfoGenerator("", crypto), capsStorage(capsStorage), warnOnInvalidHash(true) {
     stanzaChannel->onPresenceReceived.connect(boost::bind(&CapsManager::handlePresenceReceived, this, _1));
     stanzaChannel->onAvailableChanged.connect(boost::bind(&CapsManager::handleStanzaChannelAvailableChanged, this, _1));
 }
@@ -51,7 +50,7 @@ void CapsManager::handleStanzaChannelAvailableChanged(bool available) {
 
 void CapsManager::handleDiscoInfoReceived(const JID& from, const std::string& hash, DiscoInfo::ref discoInfo, ErrorPayload::ref error) {
     requestedDiscoInfos.erase(hash);
-    if (error || !discoInfo || CapsInfoGenerator("", crypto).generateCapsInfo(*discoInfo.get()).getVersion() != hash) {
+    if (error || !discoInfo || capsInfoGenerator.generateCapsInfo(*discoInfo.get()).getVersion() != hash) {
         if (warnOnInvalidHash && !error &&  discoInfo) {
             SWIFT_LOG(warning) << "Caps from " << from.toString() << " do not verify" << std::endl;
         }
@@ -76,7 +75,7 @@ void CapsManager::requestDiscoInfo(const JID& jid, const std::string& node, cons
     request->send();
 }
 
-DiscoInfo::ref CapsManager::getCaps(const std::string& hash) const {
+std::shared_ptr<const DiscoInfo> CapsManager::getCaps(const std::string& hash) const {
     return capsStorage->getDiscoInfo(hash);
 }
 
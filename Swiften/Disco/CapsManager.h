@@ -12,6 +12,7 @@
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
+#include <Swiften/Disco/CapsInfoGenerator.h>
 #include <Swiften/Disco/CapsProvider.h>
 #include <Swiften/Elements/CapsInfo.h>
 #include <Swiften/Elements/DiscoInfo.h>
@@ -29,7 +30,7 @@ namespace Swift {
         public:
             CapsManager(CapsStorage*, StanzaChannel*, IQRouter*, CryptoProvider*);
 
-            DiscoInfo::ref getCaps(const std::string&) const;
+            std::shared_ptr<const DiscoInfo> getCaps(const std::string&) const;
 
             // Mainly for testing purposes
             void setWarnOnInvalidHash(bool b) {
@@ -44,7 +45,7 @@ namespace Swift {
 
         private:
             IQRouter* iqRouter;
-            CryptoProvider* crypto;
+            CapsInfoGenerator capsInfoGenerator;
             CapsStorage* capsStorage;
             bool warnOnInvalidHash;
             std::set<std::string> requestedDiscoInfos;
@@ -18,22 +18,22 @@ namespace Swift {
         public:
             CapsMemoryStorage() {}
 
-            virtual DiscoInfo::ref getDiscoInfo(const std::string& hash) const {
+            virtual std::shared_ptr<const DiscoInfo> getDiscoInfo(const std::string& hash) const {
                 CapsMap::const_iterator i = caps.find(hash);
                 if (i != caps.end()) {
                     return i->second;
                 }
                 else {
-                    return DiscoInfo::ref();
+                    return std::shared_ptr<const DiscoInfo>();
                 }
             }
 
-            virtual void setDiscoInfo(const std::string& hash, DiscoInfo::ref discoInfo) {
+            virtual void setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) {
                 caps[hash] = discoInfo;
             }
 
         private:
-            typedef std::map<std::string, DiscoInfo::ref> CapsMap;
+            typedef std::map<std::string, std::shared_ptr<const DiscoInfo>> CapsMap;
             CapsMap caps;
     };
 }
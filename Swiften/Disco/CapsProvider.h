@@ -19,7 +19,7 @@ namespace Swift {
         public:
             virtual ~CapsProvider() {}
 
-            virtual DiscoInfo::ref getCaps(const std::string&) const = 0;
+            virtual std::shared_ptr<const DiscoInfo> getCaps(const std::string&) const = 0;
 
             boost::signals2::signal<void (const std::string&)> onCapsAvailable;
     };
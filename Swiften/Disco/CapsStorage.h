@@ -16,7 +16,7 @@ namespace Swift {
         public:
             virtual ~CapsStorage();
 
-            virtual DiscoInfo::ref getDiscoInfo(const std::string&) const = 0;
-            virtual void setDiscoInfo(const std::string&, DiscoInfo::ref) = 0;
+            virtual std::shared_ptr<const DiscoInfo> getDiscoInfo(const std::string&) const = 0;
+            virtual void setDiscoInfo(const std::string&, std::shared_ptr<const DiscoInfo>) = 0;
     };
 }
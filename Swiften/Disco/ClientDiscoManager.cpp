@@ -12,7 +12,7 @@
 
 namespace Swift {
 
-ClientDiscoManager::ClientDiscoManager(IQRouter* iqRouter, PresenceSender* presenceSender, CryptoProvider* crypto) : crypto(crypto) {
+ClientDiscoManager::ClientDiscoManager(IQRouter* iqRouter, PresenceSender* presenceSender, CryptoProvider* crypto) : crypto(crypto), capsInfoGenerator(new CapsInfoGenerator("", crypto)) {
     discoInfoResponder = new DiscoInfoResponder(iqRouter);
     discoInfoResponder->start();
     this->presenceSender = new PayloadAddingPresenceSender(presenceSender);
@@ -25,11 +25,11 @@ ClientDiscoManager::~ClientDiscoManager() {
 }
 
 void ClientDiscoManager::setCapsNode(const std::string& node) {
-    capsNode = node;
+    capsInfoGenerator.reset(new CapsInfoGenerator(node, crypto));
 }
 
 void ClientDiscoManager::setDiscoInfo(const DiscoInfo& discoInfo) {
-    capsInfo = CapsInfo::ref(new CapsInfo(CapsInfoGenerator(capsNode, crypto).generateCapsInfo(discoInfo)));
+    capsInfo = CapsInfo::ref(new CapsInfo(capsInfoGenerator->generateCapsInfo(discoInfo)));
     discoInfoResponder->clearDiscoInfo();
     discoInfoResponder->setDiscoInfo(discoInfo);
     discoInfoResponder->setDiscoInfo(capsInfo->getNode() + "#" + capsInfo->getVersion(), discoInfo);
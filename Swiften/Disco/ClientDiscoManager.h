@@ -1,11 +1,14 @@
 /*
- * Copyright (c) 2010-2013 Isode Limited.
+ * Copyright (c) 2010-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
 
 #pragma once
 
+#include <memory>
+#include <string>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Elements/CapsInfo.h>
 #include <Swiften/Elements/DiscoInfo.h>
@@ -17,6 +20,7 @@ namespace Swift {
     class PayloadAddingPresenceSender;
     class PresenceSender;
     class CryptoProvider;
+    class CapsInfoGenerator;
 
     /**
      * Class responsible for managing outgoing disco information for a client.
@@ -71,7 +75,7 @@ namespace Swift {
             PayloadAddingPresenceSender* presenceSender;
             CryptoProvider* crypto;
             DiscoInfoResponder* discoInfoResponder;
-            std::string capsNode;
+            std::unique_ptr<CapsInfoGenerator> capsInfoGenerator;
             CapsInfo::ref capsInfo;
     };
 }
@@ -8,12 +8,12 @@
 
 namespace Swift {
 
-DiscoInfo::ref DummyEntityCapsProvider::getCaps(const JID& jid) const {
+std::shared_ptr<const DiscoInfo> DummyEntityCapsProvider::getCaps(const JID& jid) const {
     std::map<JID, DiscoInfo::ref>::const_iterator i = caps.find(jid);
     if (i != caps.end()) {
         return i->second;
     }
-    return DiscoInfo::ref();
+    return std::shared_ptr<const DiscoInfo>();
 }
 
 }
@@ -17,7 +17,7 @@ namespace Swift {
             DummyEntityCapsProvider() {
             }
 
-            DiscoInfo::ref getCaps(const JID& jid) const;
+            std::shared_ptr<const DiscoInfo> getCaps(const JID& jid) const;
 
             std::map<JID, DiscoInfo::ref> caps;
     };
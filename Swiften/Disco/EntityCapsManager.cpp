@@ -30,7 +30,7 @@ void EntityCapsManager::handlePresenceReceived(std::shared_ptr<Presence> presenc
         std::map<JID, std::string>::iterator i = caps.find(from);
         if (i == caps.end() || i->second != hash) {
             caps.insert(std::make_pair(from, hash));
-            DiscoInfo::ref disco = capsProvider->getCaps(hash);
+            std::shared_ptr<const DiscoInfo> disco = capsProvider->getCaps(hash);
             if (disco) {
                 onCapsChanged(from);
             }
@@ -68,12 +68,12 @@ void EntityCapsManager::handleCapsAvailable(const std::string& hash) {
     }
 }
 
-DiscoInfo::ref EntityCapsManager::getCaps(const JID& jid) const {
+std::shared_ptr<const DiscoInfo> EntityCapsManager::getCaps(const JID& jid) const {
     std::map<JID, std::string>::const_iterator i = caps.find(jid);
     if (i != caps.end()) {
         return capsProvider->getCaps(i->second);
     }
-    return DiscoInfo::ref();
+    return std::shared_ptr<const DiscoInfo>();
 }
 
 }
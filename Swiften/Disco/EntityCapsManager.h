@@ -33,7 +33,7 @@ namespace Swift {
             /**
              * Returns the service discovery information of the given JID.
              */
-            DiscoInfo::ref getCaps(const JID&) const;
+            std::shared_ptr<const DiscoInfo> getCaps(const JID&) const;
 
         private:
             void handlePresenceReceived(std::shared_ptr<Presence>);
@@ -25,7 +25,7 @@ namespace Swift {
             /**
              * Returns the service discovery information of the given JID.
              */
-            virtual DiscoInfo::ref getCaps(const JID&) const = 0;
+            virtual std::shared_ptr<const DiscoInfo> getCaps(const JID&) const = 0;
 
             /**
              * Emitted when the capabilities of a JID changes.
@@ -6,12 +6,11 @@
 
 #include <Swiften/Disco/FeatureOracle.h>
 
-#include <algorithm>
-#include <iterator>
 #include <vector>
 
 #include <Swiften/Base/foreach.h>
 #include <Swiften/Disco/EntityCapsProvider.h>
+#include <Swiften/Elements/FeatureSet.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/FileTransfer/FileTransferManager.h>
 #include <Swiften/JID/JID.h>
@@ -24,7 +23,7 @@ FeatureOracle::FeatureOracle(EntityCapsProvider* capsProvider, PresenceOracle* p
 }
 
 Tristate FeatureOracle::isFileTransferSupported(const JID& jid) {
-    DiscoInfo::ref discoInfo = getDiscoResultForJID(jid);
+    std::shared_ptr<const DiscoInfo> discoInfo = getDiscoResultForJID(jid);
     if (discoInfo) {
         return FileTransferManager::isSupportedBy(discoInfo) ? Yes : No;
     }
@@ -41,40 +40,23 @@ Tristate FeatureOracle::isMessageCorrectionSupported(const JID& jid) {
     return isFeatureSupported(jid, DiscoInfo::MessageCorrectionFeature);
 }
 
-DiscoInfo::ref FeatureOracle::getDiscoResultForJID(const JID& jid) {
-    DiscoInfo::ref discoInfo;
+std::shared_ptr<const DiscoInfo> FeatureOracle::getDiscoResultForJID(const JID& jid) {
+    std::shared_ptr<const DiscoInfo> discoInfo;
     if (jid.isBare()) {
         // Calculate the common subset of disco features of all available results and return that.
-        std::vector<Presence::ref> availablePresences =  presenceOracle_->getAllPresence(jid);
-
-        bool commonFeaturesInitialized = false;
-        std::vector<std::string> commonFeatures;
-        foreach(Presence::ref presence, availablePresences) {
-            DiscoInfo::ref presenceDiscoInfo = capsProvider_->getCaps(presence->getFrom());
-            if (presenceDiscoInfo) {
-                std::vector<std::string> features = presenceDiscoInfo->getFeatures();
-                if (!commonFeaturesInitialized) {
-                    commonFeatures = features;
-                    commonFeaturesInitialized = true;
-                }
-                else {
-                    std::vector<std::string> featuresToRemove;
-                    foreach(const std::string& feature, commonFeatures) {
-                        if (std::find(features.begin(), features.end(), feature) == features.end()) {
-                            featuresToRemove.push_back(feature);
-                        }
-                    }
-                    foreach(const std::string& featureToRemove, featuresToRemove) {
-                        commonFeatures.erase(std::remove(commonFeatures.begin(), commonFeatures.end(), featureToRemove), commonFeatures.end());
-                    }
+        std::shared_ptr<const DiscoInfo> firstDiscoInfo;
+        FeatureSet commonFeatures;
+        getCommonFeaturesForJID(jid, commonFeatures, firstDiscoInfo);
+
+        DiscoInfo::ref commonDiscoInfo = std::make_shared<DiscoInfo>();
+        if (firstDiscoInfo) {
+            foreach(const std::string& feature, firstDiscoInfo->getFeatures()) {
+                if (commonFeatures.contains(feature)) {
+                    commonDiscoInfo->addFeature(feature);
                 }
             }
         }
-        discoInfo = std::make_shared<DiscoInfo>();
-
-        foreach(const std::string& commonFeature, commonFeatures) {
-            discoInfo->addFeature(commonFeature);
-        }
+        discoInfo = commonDiscoInfo;
     }
     else {
         // Return the disco result of the full JID.
@@ -84,8 +66,42 @@ DiscoInfo::ref FeatureOracle::getDiscoResultForJID(const JID& jid) {
     return discoInfo;
 }
 
+void FeatureOracle::getCommonFeaturesForJID(const JID& jid, FeatureSet& commonFeatures, std::shared_ptr<const DiscoInfo>& firstDiscoInfo) {
+    std::vector<Presence::ref> availablePresences = presenceOracle_->getAllPresence(jid);
+    foreach(Presence::ref presence, availablePresences) {
+        std::shared_ptr<const DiscoInfo> presenceDiscoInfo = capsProvider_->getCaps(presence->getFrom());
+        if (presenceDiscoInfo) {
+            if (!firstDiscoInfo) {
+                firstDiscoInfo = presenceDiscoInfo;
+                commonFeatures = presenceDiscoInfo->getFeatureSet();
+            }
+            else {
+                commonFeatures.intersect(presenceDiscoInfo->getFeatureSet());
+            }
+        }
+    }
+}
+
 Tristate FeatureOracle::isFeatureSupported(const JID& jid, const std::string& feature) {
-    DiscoInfo::ref discoInfo = getDiscoResultForJID(jid);
+    if (jid.isBare()) {
+        // A bare JID supports a feature if all its available resources with
+        // caps do. This only needs a lookup in each resource's feature set,
+        // not their intersection.
+        bool hasDiscoInfo = false;
+        std::vector<Presence::ref> availablePresences = presenceOracle_->getAllPresence(jid);
+        foreach(Presence::ref presence, availablePresences) {
+            std::shared_ptr<const DiscoInfo> presenceDiscoInfo = capsProvider_->getCaps(presence->getFrom());
+            if (presenceDiscoInfo) {
+                const FeatureSet& features = presenceDiscoInfo->getFeatureSet();
+                if (!features.contains(feature)) {
+                    return No;
+                }
+                hasDiscoInfo = true;
+            }
+        }
+        return hasDiscoInfo ? Yes : No;
+    }
+    std::shared_ptr<const DiscoInfo> discoInfo = getDiscoResultForJID(jid);
     if (discoInfo) {
         return discoInfo->hasFeature(feature) ? Yes : No;
     }
@@ -95,5 +111,3 @@ Tristate FeatureOracle::isFeatureSupported(const JID& jid, const std::string& fe
 }
 
 }
-
-
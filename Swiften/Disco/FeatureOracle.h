@@ -13,6 +13,7 @@
 namespace Swift {
 
 class EntityCapsProvider;
+class FeatureSet;
 class JID;
 class PresenceOracle;
 
@@ -34,7 +35,13 @@ class SWIFTEN_API FeatureOracle {
          * @param jid The JID to return the DiscoInfo::ref for.
          * @return DiscoResult::ref
          */
-        DiscoInfo::ref getDiscoResultForJID(const JID& jid);
+        std::shared_ptr<const DiscoInfo> getDiscoResultForJID(const JID& jid);
+
+        /**
+         * @brief getCommonFeaturesForJID computes the features supported by all available resources of a bare jid.
+         * @param firstDiscoInfo Set to the first DiscoInfo found, or left empty if no resource has one.
+         */
+        void getCommonFeaturesForJID(const JID& jid, FeatureSet& commonFeatures, std::shared_ptr<const DiscoInfo>& firstDiscoInfo);
 
         Tristate isFeatureSupported(const JID& jid, const std::string& feature);
 
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <map>
+#include <string>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Disco/CachingCapsStorage.h>
+#include <Swiften/Disco/CapsStorage.h>
+#include <Swiften/Elements/DiscoInfo.h>
+
+using namespace Swift;
+
+class CachingCapsStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(CachingCapsStorageTest);
+        CPPUNIT_TEST(testGetDiscoInfo_LoadsOnce);
+        CPPUNIT_TEST(testGetDiscoInfo_UnknownHashLoadsOnce);
+        CPPUNIT_TEST(testSetDiscoInfo_StoresAndReplacesNegativeEntry);
+        CPPUNIT_TEST(testGetDiscoInfo_EvictsLeastRecentlyUsed);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            storage = new CountingCapsStorage();
+            DiscoInfo::ref discoInfo = std::make_shared<DiscoInfo>();
+            discoInfo->addFeature("http://swift.im/feature1");
+            discoInfo1 = discoInfo;
+            discoInfo = std::make_shared<DiscoInfo>();
+            discoInfo->addFeature("http://swift.im/feature2");
+            discoInfo2 = discoInfo;
+        }
+
+        void tearDown() {
+            delete storage;
+        }
+
+        void testGetDiscoInfo_LoadsOnce() {
+            storage->caps["hash1"] = discoInfo1;
+            CachingCapsStorage testling(storage);
+
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, testling.getDiscoInfo("hash1"));
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, testling.getDiscoInfo("hash1"));
+
+            CPPUNIT_ASSERT_EQUAL(1, storage->loads);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getLoadCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getHitCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), testling.getNegativeHitCount());
+        }
+
+        void testGetDiscoInfo_UnknownHashLoadsOnce() {
+            CachingCapsStorage testling(storage);
+
+            CPPUNIT_ASSERT(!testling.getDiscoInfo("hash1"));
+            CPPUNIT_ASSERT(!testling.getDiscoInfo("hash1"));
+
+            CPPUNIT_ASSERT_EQUAL(1, storage->loads);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), testling.getNegativeHitCount());
+        }
+
+        void testSetDiscoInfo_StoresAndReplacesNegativeEntry() {
+            CachingCapsStorage testling(storage);
+            testling.getDiscoInfo("hash1");
+
+            testling.setDiscoInfo("hash1", discoInfo1);
+
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, storage->caps["hash1"]);
+            CPPUNIT_ASSERT_EQUAL(discoInfo1, testling.getDiscoInfo("hash1"));
+            CPPUNIT_ASSERT_EQUAL(1, storage->loads);
+        }
+
+        void testGetDiscoInfo_EvictsLeastRecentlyUsed() {
+            storage->caps["hash1"] = discoInfo1;
+            storage->caps["hash2"] = discoInfo2;
+            CachingCapsStorage testling(storage, 2);
+            testling.getDiscoInfo("hash1");
+            testling.getDiscoInfo("hash2");
+            testling.getDiscoInfo("hash1");
+
+            testling.getDiscoInfo("hash3");
+            testling.getDiscoInfo("hash1");
+            testling.getDiscoInfo("hash2");
+
+            CPPUNIT_ASSERT_EQUAL(4, storage->loads);
+        }
+
+    private:
+        class CountingCapsStorage : public CapsStorage {
+            public:
+                CountingCapsStorage() : loads(0) {}
+
+                virtual std::shared_ptr<const DiscoInfo> getDiscoInfo(const std::string& hash) const {
+                    ++loads;
+                    std::map<std::string, std::shared_ptr<const DiscoInfo>>::const_iterator i = caps.find(hash);
+                    return i != caps.end() ? i->second : std::shared_ptr<const DiscoInfo>();
+                }
+
+                virtual void setDiscoInfo(const std::string& hash, std::shared_ptr<const DiscoInfo> discoInfo) {
+                    caps[hash] = discoInfo;
+                }
+
+                std::map<std::string, std::shared_ptr<const DiscoInfo>> caps;
+                mutable int loads;
+        };
+
+    private:
+        CountingCapsStorage* storage;
+        std::shared_ptr<const DiscoInfo> discoInfo1;
+        std::shared_ptr<const DiscoInfo> discoInfo2;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CachingCapsStorageTest);
@@ -163,7 +163,7 @@ class CapsManagerTest : public CppUnit::TestFixture {
             sendPresenceWithCaps(user1, capsInfo1);
             sendDiscoInfoResult(discoInfo1);
 
-            std::shared_ptr<DiscoInfo> discoInfo(storage->getDiscoInfo(capsInfo1->getVersion()));
+            std::shared_ptr<const DiscoInfo> discoInfo(storage->getDiscoInfo(capsInfo1->getVersion()));
             CPPUNIT_ASSERT(discoInfo);
             CPPUNIT_ASSERT(discoInfo->hasFeature("http://swift.im/feature1"));
         }
@@ -173,7 +173,7 @@ class CapsManagerTest : public CppUnit::TestFixture {
             sendPresenceWithCaps(user1, capsInfo1);
             sendDiscoInfoResult(discoInfo2);
 
-            std::shared_ptr<DiscoInfo> discoInfo(storage->getDiscoInfo(capsInfo1->getVersion()));
+            std::shared_ptr<const DiscoInfo> discoInfo(storage->getDiscoInfo(capsInfo1->getVersion()));
             CPPUNIT_ASSERT(!discoInfo);
         }
 
@@ -40,13 +40,15 @@ class EntityCapsManagerTest : public CppUnit::TestFixture {
             capsProvider = new DummyCapsProvider();
 
             user1 = JID("user1@bar.com/bla");
-            discoInfo1 = std::make_shared<DiscoInfo>();
-            discoInfo1->addFeature("http://swift.im/feature1");
+            DiscoInfo::ref discoInfo = std::make_shared<DiscoInfo>();
+            discoInfo->addFeature("http://swift.im/feature1");
+            discoInfo1 = discoInfo;
             capsInfo1 = std::make_shared<CapsInfo>(CapsInfoGenerator("http://node1.im", crypto.get()).generateCapsInfo(*discoInfo1.get()));
             capsInfo1alt = std::make_shared<CapsInfo>(CapsInfoGenerator("http://node2.im", crypto.get()).generateCapsInfo(*discoInfo1.get()));
             user2 = JID("user2@foo.com/baz");
-            discoInfo2 = std::make_shared<DiscoInfo>();
-            discoInfo2->addFeature("http://swift.im/feature2");
+            discoInfo = std::make_shared<DiscoInfo>();
+            discoInfo->addFeature("http://swift.im/feature2");
+            discoInfo2 = discoInfo;
             capsInfo2 = std::make_shared<CapsInfo>(CapsInfoGenerator("http://node2.im", crypto.get()).generateCapsInfo(*discoInfo2.get()));
             user3 = JID("user3@foo.com/baz");
             legacyCapsInfo = std::make_shared<CapsInfo>("http://swift.im", "ver1", "");
@@ -165,26 +167,26 @@ class EntityCapsManagerTest : public CppUnit::TestFixture {
 
     private:
         struct DummyCapsProvider : public CapsProvider {
-            virtual DiscoInfo::ref getCaps(const std::string& hash) const {
-                std::map<std::string, DiscoInfo::ref>::const_iterator i = caps.find(hash);
+            virtual std::shared_ptr<const DiscoInfo> getCaps(const std::string& hash) const {
+                std::map<std::string, std::shared_ptr<const DiscoInfo>>::const_iterator i = caps.find(hash);
                 if (i != caps.end()) {
                     return i->second;
                 }
-                return DiscoInfo::ref();
+                return std::shared_ptr<const DiscoInfo>();
             }
 
-            std::map<std::string, DiscoInfo::ref> caps;
+            std::map<std::string, std::shared_ptr<const DiscoInfo>> caps;
         };
 
     private:
         DummyStanzaChannel* stanzaChannel;
         DummyCapsProvider* capsProvider;
         JID user1;
-        std::shared_ptr<DiscoInfo> discoInfo1;
+        std::shared_ptr<const DiscoInfo> discoInfo1;
         std::shared_ptr<CapsInfo> capsInfo1;
         std::shared_ptr<CapsInfo> capsInfo1alt;
         JID user2;
-        std::shared_ptr<DiscoInfo> discoInfo2;
+        std::shared_ptr<const DiscoInfo> discoInfo2;
         std::shared_ptr<CapsInfo> capsInfo2;
         std::shared_ptr<CapsInfo> legacyCapsInfo;
         JID user3;
@@ -6,7 +6,7 @@
 
 #include <Swiften/Elements/DiscoInfo.h>
 
-#include <algorithm>
+#include <Swiften/Elements/FeatureSet.h>
 
 namespace Swift {
 
@@ -20,6 +20,7 @@ const std::string DiscoInfo::JingleFeature = std::string("urn:xmpp:jingle:1");
 const std::string DiscoInfo::JingleFTFeature = std::string("urn:xmpp:jingle:apps:file-transfer:4");
 const std::string DiscoInfo::JingleTransportsIBBFeature = std::string("urn:xmpp:jingle:transports:ibb:1");
 const std::string DiscoInfo::JingleTransportsS5BFeature = std::string("urn:xmpp:jingle:transports:s5b:1");
+const std::string DiscoInfo::JingleFTParallelRangesFeature = std::string("http://swift.im/jingle-ft-parallel-ranges");
 const std::string DiscoInfo::Bytestream = std::string("http://jabber.org/protocol/bytestreams");
 const std::string DiscoInfo::MessageDeliveryReceiptsFeature = std::string("urn:xmpp:receipts");
 const std::string DiscoInfo::WhiteboardFeature = std::string("http://swift.im/whiteboard");
@@ -46,7 +47,18 @@ bool DiscoInfo::Identity::operator<(const Identity& other) const {
 }
 
 bool DiscoInfo::hasFeature(const std::string& feature) const {
-    return std::find(features_.begin(), features_.end(), feature) != features_.end();
+    return getFeatureSet().contains(feature);
+}
+
+const FeatureSet& DiscoInfo::getFeatureSet() const {
+    if (!featureSet_) {
+        std::shared_ptr<FeatureSet> featureSet = std::make_shared<FeatureSet>();
+        for (std::vector<std::string>::const_iterator i = features_.begin(); i != features_.end(); ++i) {
+            featureSet->add(*i);
+        }
+        featureSet_ = featureSet;
+    }
+    return *featureSet_;
 }
 
 }
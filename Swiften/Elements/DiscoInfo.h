@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -14,6 +15,8 @@
 #include <Swiften/Elements/Payload.h>
 
 namespace Swift {
+    class FeatureSet;
+
     /**
      * disco#info from XEP-0030
      */
@@ -31,6 +34,7 @@ namespace Swift {
             static const std::string JingleFTFeature;
             static const std::string JingleTransportsIBBFeature;
             static const std::string JingleTransportsS5BFeature;
+            static const std::string JingleFTParallelRangesFeature;
             static const std::string Bytestream;
             static const std::string MessageDeliveryReceiptsFeature;
             static const std::string WhiteboardFeature;
@@ -93,10 +97,17 @@ namespace Swift {
 
             void addFeature(const std::string& feature) {
                 features_.push_back(feature);
+                featureSet_.reset();
             }
 
             bool hasFeature(const std::string& feature) const;
 
+            /**
+             * Returns the features as a \ref FeatureSet, which is computed
+             * on first use and kept until the features change.
+             */
+            const FeatureSet& getFeatureSet() const;
+
             void addExtension(Form::ref form) {
                 extensions_.push_back(form);
             }
@@ -110,5 +121,6 @@ namespace Swift {
             std::vector<Identity> identities_;
             std::vector<std::string> features_;
             std::vector<Form::ref> extensions_;
+            mutable std::shared_ptr<const FeatureSet> featureSet_;
     };
 }
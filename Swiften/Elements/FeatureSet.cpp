@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/Elements/FeatureSet.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+#include <Swiften/Elements/DiscoInfo.h>
+
+namespace Swift {
+
+namespace {
+    const size_t noFeatureID = static_cast<size_t>(-1);
+
+    /**
+     * The features that get a bit in a FeatureSet: the ones DiscoInfo has a
+     * constant for. There can be at most 64 of them.
+     * The table holds the addresses of the constants, which are fixed before
+     * any code runs; the strings themselves are only read when the registry
+     * is built on first use.
+     */
+    const std::string* const knownFeatures[] = {
+        &DiscoInfo::ChatStatesFeature,
+        &DiscoInfo::SecurityLabelsFeature,
+        &DiscoInfo::SecurityLabelsCatalogFeature,
+        &DiscoInfo::JabberSearchFeature,
+        &DiscoInfo::CommandsFeature,
+        &DiscoInfo::MessageCorrectionFeature,
+        &DiscoInfo::JingleFeature,
+        &DiscoInfo::JingleFTFeature,
+        &DiscoInfo::JingleTransportsIBBFeature,
+        &DiscoInfo::JingleTransportsS5BFeature,
+        &DiscoInfo::Bytestream,
+        &DiscoInfo::MessageDeliveryReceiptsFeature,
+        &DiscoInfo::WhiteboardFeature,
+        &DiscoInfo::BlockingCommandFeature,
+        &DiscoInfo::MessageCarbonsFeature,
+        &DiscoInfo::JingleFTParallelRangesFeature,
+    };
+
+    class FeatureRegistry {
+        public:
+            FeatureRegistry() {
+                static_assert(sizeof(knownFeatures) / sizeof(knownFeatures[0]) <= 64, "Too many known features");
+                for (size_t i = 0; i < sizeof(knownFeatures) / sizeof(knownFeatures[0]); ++i) {
+                    ids_.insert(std::make_pair(*knownFeatures[i], i));
+                }
+            }
+
+            size_t getID(const std::string& feature) const {
+                std::unordered_map<std::string, size_t>::const_iterator i = ids_.find(feature);
+                return i == ids_.end() ? noFeatureID : i->second;
+            }
+
+        private:
+            std::unordered_map<std::string, size_t> ids_;
+    };
+
+    // Built once and never changed afterwards, so lookups need no lock
+    const FeatureRegistry& getFeatureRegistry() {
+        static const FeatureRegistry registry;
+        return registry;
+    }
+}
+
+FeatureSet::FeatureSet() : bits_(0) {
+}
+
+void FeatureSet::add(const std::string& feature) {
+    size_t id = getFeatureRegistry().getID(feature);
+    if (id == noFeatureID) {
+        std::vector<std::string>::iterator i = std::lower_bound(otherFeatures_.begin(), otherFeatures_.end(), feature);
+        if (i == otherFeatures_.end() || *i != feature) {
+            otherFeatures_.insert(i, feature);
+        }
+        return;
+    }
+    bits_ |= static_cast<boost::uint64_t>(1) << id;
+}
+
+bool FeatureSet::contains(const std::string& feature) const {
+    size_t id = getFeatureRegistry().getID(feature);
+    if (id == noFeatureID) {
+        return std::binary_search(otherFeatures_.begin(), otherFeatures_.end(), feature);
+    }
+    return (bits_ & (static_cast<boost::uint64_t>(1) << id)) != 0;
+}
+
+void FeatureSet::intersect(const FeatureSet& other) {
+    bits_ &= other.bits_;
+    if (!otherFeatures_.empty()) {
+        std::vector<std::string> commonFeatures;
+        std::set_intersection(otherFeatures_.begin(), otherFeatures_.end(), other.otherFeatures_.begin(), other.otherFeatures_.end(), std::back_inserter(commonFeatures));
+        otherFeatures_.swap(commonFeatures);
+    }
+}
+
+bool FeatureSet::isEmpty() const {
+    return bits_ == 0 && otherFeatures_.empty();
+}
+
+}
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/cstdint.hpp>
+
+#include <Swiften/Base/API.h>
+
+namespace Swift {
+    /**
+     * A set of disco features.
+     *
+     * Features that \ref DiscoInfo has a constant for are stored as bits in
+     * a single word, so lookups and intersections are cheap. Other features,
+     * such as those only advertised by remote entities, are stored in a
+     * sorted list.
+     */
+    class SWIFTEN_API FeatureSet {
+        public:
+            FeatureSet();
+
+            void add(const std::string& feature);
+            bool contains(const std::string& feature) const;
+
+            /**
+             * Removes all features that are not in \p other.
+             */
+            void intersect(const FeatureSet& other);
+
+            bool isEmpty() const;
+
+        private:
+            boost::uint64_t bits_;
+            std::vector<std::string> otherFeatures_;
+    };
+}
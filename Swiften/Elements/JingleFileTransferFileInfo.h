@@ -28,7 +28,7 @@ namespace Swift {
 
         public:
             JingleFileTransferFileInfo(const std::string& name = "", const std::string& description = "", unsigned long long size = 0, const boost::posix_time::ptime &date = boost::posix_time::ptime()) :
-                name_(name), description_(description), size_(size), date_(date), supportsRangeRequests_(false), rangeOffset_(0) {
+                name_(name), description_(description), size_(size), date_(date), supportsRangeRequests_(false), rangeOffset_(0), rangeLength_(0) {
             }
 
         public:
@@ -92,6 +92,19 @@ namespace Swift {
                 return rangeOffset_;
             }
 
+            /**
+             * Sets the number of bytes of the range. 0 means that the range
+             * extends to the end of the file.
+             */
+            void setRangeLength(const boost::uintmax_t length) {
+                supportsRangeRequests_ = true;
+                rangeLength_ = length;
+            }
+
+            boost::uintmax_t getRangeLength() const {
+                return rangeLength_;
+            }
+
             void addHash(const HashElement& hash) {
                 hashes_[hash.getAlgorithm()] = hash.getHashValue();
             }
@@ -116,6 +129,7 @@ namespace Swift {
             boost::posix_time::ptime date_;
             bool supportsRangeRequests_;
             boost::uintmax_t rangeOffset_;
+            boost::uintmax_t rangeLength_;
             HashElementMap hashes_;
     };
 }
@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Elements/DiscoInfo.h>
+#include <Swiften/Elements/FeatureSet.h>
+
+using namespace Swift;
+
+class FeatureSetTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(FeatureSetTest);
+        CPPUNIT_TEST(testContains);
+        CPPUNIT_TEST(testIntersect);
+        CPPUNIT_TEST(testIntersect_WithSmallerSet);
+        CPPUNIT_TEST(testIntersect_UnknownFeatures);
+        CPPUNIT_TEST(testDiscoInfoHasFeature_AfterAddFeature);
+        CPPUNIT_TEST(testDiscoInfoHasFeature_FeatureWithoutConstant);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void testContains() {
+            FeatureSet testling;
+            testling.add("urn:xmpp:receipts");
+
+            CPPUNIT_ASSERT(testling.contains("urn:xmpp:receipts"));
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:carbons:2"));
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:feature-set-test:never-added"));
+            CPPUNIT_ASSERT(!testling.isEmpty());
+        }
+
+        void testIntersect() {
+            FeatureSet testling;
+            testling.add("urn:xmpp:receipts");
+            testling.add("urn:xmpp:carbons:2");
+            FeatureSet other;
+            other.add("urn:xmpp:carbons:2");
+            other.add("urn:xmpp:blocking");
+
+            testling.intersect(other);
+
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:receipts"));
+            CPPUNIT_ASSERT(testling.contains("urn:xmpp:carbons:2"));
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:blocking"));
+        }
+
+        void testIntersect_WithSmallerSet() {
+            FeatureSet testling;
+            for (int i = 0; i < 200; ++i) {
+                testling.add("urn:xmpp:feature-set-test:" + std::to_string(i));
+            }
+            FeatureSet other;
+
+            testling.intersect(other);
+
+            CPPUNIT_ASSERT(testling.isEmpty());
+        }
+
+        void testIntersect_UnknownFeatures() {
+            FeatureSet testling;
+            testling.add("urn:xmpp:feature-set-test:1");
+            testling.add("urn:xmpp:feature-set-test:2");
+            testling.add("urn:xmpp:receipts");
+            FeatureSet other;
+            other.add("urn:xmpp:feature-set-test:2");
+            other.add("urn:xmpp:feature-set-test:3");
+            other.add("urn:xmpp:receipts");
+
+            testling.intersect(other);
+
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:feature-set-test:1"));
+            CPPUNIT_ASSERT(testling.contains("urn:xmpp:feature-set-test:2"));
+            CPPUNIT_ASSERT(!testling.contains("urn:xmpp:feature-set-test:3"));
+            CPPUNIT_ASSERT(testling.contains("urn:xmpp:receipts"));
+        }
+
+        void testDiscoInfoHasFeature_AfterAddFeature() {
+            DiscoInfo discoInfo;
+            discoInfo.addFeature("urn:xmpp:receipts");
+            CPPUNIT_ASSERT(!discoInfo.hasFeature("urn:xmpp:carbons:2"));
+
+            discoInfo.addFeature("urn:xmpp:carbons:2");
+
+            CPPUNIT_ASSERT(discoInfo.hasFeature("urn:xmpp:receipts"));
+            CPPUNIT_ASSERT(discoInfo.hasFeature("urn:xmpp:carbons:2"));
+        }
+
+        void testDiscoInfoHasFeature_FeatureWithoutConstant() {
+            DiscoInfo discoInfo;
+            discoInfo.addFeature(DiscoInfo::ChatStatesFeature);
+            discoInfo.addFeature("http://jabber.org/protocol/muc");
+
+            CPPUNIT_ASSERT(discoInfo.hasFeature("http://jabber.org/protocol/muc"));
+            CPPUNIT_ASSERT(discoInfo.hasFeature(DiscoInfo::ChatStatesFeature));
+            CPPUNIT_ASSERT(!discoInfo.hasFeature("http://jabber.org/protocol/muc#user"));
+        }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FeatureSetTest);
@@ -29,9 +29,18 @@ void PayloadPersister::savePayload(std::shared_ptr<Payload> payload, const boost
         if (!boost::filesystem::exists(path.parent_path())) {
             boost::filesystem::create_directories(path.parent_path());
         }
-        boost::filesystem::ofstream file(path);
+        // Write to a temporary file first, so a crash never leaves a truncated file behind
+        boost::filesystem::path newPath = path;
+        newPath += ".tmp";
+        boost::filesystem::ofstream file(newPath);
         file << getSerializer()->serialize(payload);
         file.close();
+        if (file) {
+            boost::filesystem::rename(newPath, path);
+        }
+        else {
+            SWIFT_LOG(error) << "Error writing " << path << std::endl;
+        }
     }
     catch (const boost::filesystem::filesystem_error& e) {
         SWIFT_LOG(error) << e.what() << std::endl;
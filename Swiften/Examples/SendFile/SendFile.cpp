@@ -18,7 +18,7 @@
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/EventLoop/EventLoop.h>
 #include <Swiften/EventLoop/SimpleEventLoop.h>
-#include <Swiften/FileTransfer/FileReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
 #include <Swiften/FileTransfer/FileTransferManager.h>
 #include <Swiften/FileTransfer/OutgoingFileTransfer.h>
 #include <Swiften/FileTransfer/OutgoingFileTransferManager.h>
@@ -67,7 +67,7 @@ class FileSender {
         void handleCapsChanged(JID jid) {
             if (jid.toBare() == recipient) {
                 // create ReadBytestream from file
-                std::shared_ptr<FileReadBytestream> fileStream = std::make_shared<FileReadBytestream>(file);
+                std::shared_ptr<FileDescriptorReadBytestream> fileStream = std::make_shared<FileDescriptorReadBytestream>(file);
 
                 outgoingFileTransfer = client->getFileTransferManager()->createOutgoingFileTransfer(recipient, file, "Some File!", fileStream);
 
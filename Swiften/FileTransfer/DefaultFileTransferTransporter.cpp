@@ -53,7 +53,8 @@ DefaultFileTransferTransporter::DefaultFileTransferTransporter(
             s5bServerManager(s5bServerManager),
             s5bProxy(s5bProxy),
             crypto(crypto),
-            router(router) {
+            router(router),
+            inBandWindowSize(options.getInBandWindowSize()) {
 
     localCandidateGenerator = new LocalJingleTransportCandidateGenerator(
             s5bServerManager,
@@ -158,6 +159,7 @@ std::shared_ptr<TransportSession> DefaultFileTransferTransporter::createIBBSendS
     std::shared_ptr<IBBSendSession> ibbSession = std::make_shared<IBBSendSession>(
             sessionID, initiator, responder, stream, router);
     ibbSession->setBlockSize(blockSize);
+    ibbSession->setWindowSize(inBandWindowSize);
     return std::make_shared<IBBSendTransportSession>(ibbSession);
 }
 
@@ -107,6 +107,7 @@ namespace Swift {
             RemoteJingleTransportCandidateSelector* remoteCandidateSelector;
             std::string s5bSessionID;
             std::shared_ptr<SOCKS5BytestreamClientSession> remoteS5BClientSession;
+            unsigned int inBandWindowSize;
     };
 }
 
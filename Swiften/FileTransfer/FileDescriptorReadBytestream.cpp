@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <Swiften/Base/Platform.h>
+#include <Swiften/FileTransfer/BytestreamException.h>
+
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Swift {
+
+FileDescriptorReadBytestream::FileDescriptorReadBytestream(const boost::filesystem::path& file) : fileDescriptor(-1), size(0), position(0) {
+    open(file);
+}
+
+FileDescriptorReadBytestream::FileDescriptorReadBytestream(const boost::filesystem::path& file, boost::uint64_t offset, boost::uint64_t length) : fileDescriptor(-1), size(0), position(0) {
+    open(file);
+    position = std::min(offset, size);
+    if (length < size - position) {
+        size = position + length;
+    }
+}
+
+void FileDescriptorReadBytestream::open(const boost::filesystem::path& file) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+    fileDescriptor = _wopen(file.wstring().c_str(), _O_RDONLY | _O_BINARY);
+    struct _stat64 fileStatus;
+    if (fileDescriptor >= 0 && _fstat64(fileDescriptor, &fileStatus) == 0) {
+        size = static_cast<boost::uint64_t>(fileStatus.st_size);
+    }
+#else
+    fileDescriptor = ::open(file.string().c_str(), O_RDONLY);
+    struct stat fileStatus;
+    if (fileDescriptor >= 0 && fstat(fileDescriptor, &fileStatus) == 0) {
+        size = static_cast<boost::uint64_t>(fileStatus.st_size);
+    }
+#endif
+}
+
+FileDescriptorReadBytestream::~FileDescriptorReadBytestream() {
+    if (fileDescriptor >= 0) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+        _close(fileDescriptor);
+#else
+        ::close(fileDescriptor);
+#endif
+    }
+}
+
+std::shared_ptr<ByteArray> FileDescriptorReadBytestream::read(size_t size) {
+    std::shared_ptr<ByteArray> result = std::make_shared<ByteArray>();
+    result->resize(boost::numeric_cast<size_t>(std::min<boost::uint64_t>(size, getRemainingSize())));
+    if (!result->empty()) {
+        result->resize(readAt(vecptr(*result), result->size(), position));
+        position += result->size();
+    }
+    onRead(*result);
+    return result;
+}
+
+bool FileDescriptorReadBytestream::isFinished() const {
+    return fileDescriptor >= 0 && position >= size;
+}
+
+void FileDescriptorReadBytestream::skip(size_t size) {
+    if (!onRead.empty()) {
+        skipBuffer.resize(size);
+        skipBuffer.resize(readAt(vecptr(skipBuffer), size, position));
+        onRead(skipBuffer);
+    }
+    position += size;
+}
+
+size_t FileDescriptorReadBytestream::readAt(unsigned char* data, size_t size, boost::uint64_t offset) const {
+    if (fileDescriptor < 0) {
+        throw BytestreamException();
+    }
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+    if (_lseeki64(fileDescriptor, boost::numeric_cast<__int64>(offset), SEEK_SET) < 0) {
+        throw BytestreamException();
+    }
+    int result = _read(fileDescriptor, data, boost::numeric_cast<unsigned int>(size));
+#else
+    ssize_t result = pread(fileDescriptor, data, size, boost::numeric_cast<off_t>(offset));
+#endif
+    if (result < 0 || (result == 0 && size > 0)) {
+        // Also fail if the file got shorter than it was when it was opened
+        throw BytestreamException();
+    }
+    return static_cast<size_t>(result);
+}
+
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/FileTransfer/ReadBytestream.h>
+
+namespace Swift {
+    /**
+     * A bytestream reading from a file through a file descriptor.
+     *
+     * Transports that can send from the file themselves (see
+     * Connection::writeFile()) use getFileDescriptor() and getPosition(),
+     * and call skip() for the data they sent. The data is only read into
+     * memory if something is connected to onRead.
+     */
+    class SWIFTEN_API FileDescriptorReadBytestream : public ReadBytestream {
+        public:
+            FileDescriptorReadBytestream(const boost::filesystem::path& file);
+
+            /**
+             * Reads at most \p length bytes of \p file, starting at \p offset.
+             */
+            FileDescriptorReadBytestream(const boost::filesystem::path& file, boost::uint64_t offset, boost::uint64_t length);
+            virtual ~FileDescriptorReadBytestream();
+
+            /**
+             * Throws BytestreamException if the file cannot be read.
+             */
+            virtual std::shared_ptr< std::vector<unsigned char> > read(size_t size);
+            virtual bool isFinished() const;
+
+            /**
+             * Returns -1 if the file could not be opened.
+             */
+            int getFileDescriptor() const {
+                return fileDescriptor;
+            }
+
+            boost::uint64_t getPosition() const {
+                return position;
+            }
+
+            boost::uint64_t getRemainingSize() const {
+                return size - position;
+            }
+
+            /**
+             * Advances the stream by \p size bytes, which were read directly
+             * from the file descriptor.
+             *
+             * Throws BytestreamException if the data cannot be read for onRead.
+             */
+            void skip(size_t size);
+
+        private:
+            void open(const boost::filesystem::path& file);
+            size_t readAt(unsigned char* data, size_t size, boost::uint64_t offset) const;
+
+        private:
+            int fileDescriptor;
+            boost::uint64_t size;
+            boost::uint64_t position;
+            ByteArray skipBuffer;
+    };
+}
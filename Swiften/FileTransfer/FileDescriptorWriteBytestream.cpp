@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+
+#include <cerrno>
+
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <Swiften/Base/Platform.h>
+
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Swift {
+
+FileDescriptorWriteBytestream::FileDescriptorWriteBytestream(const boost::filesystem::path& file, boost::uint64_t offset) : fileDescriptor(-1), position(offset) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+    fileDescriptor = _wopen(file.wstring().c_str(), _O_WRONLY | _O_CREAT | _O_BINARY, _S_IREAD | _S_IWRITE);
+#else
+    fileDescriptor = ::open(file.string().c_str(), O_WRONLY | O_CREAT, 0644);
+#endif
+}
+
+FileDescriptorWriteBytestream::~FileDescriptorWriteBytestream() {
+    close();
+}
+
+bool FileDescriptorWriteBytestream::write(const std::vector<unsigned char>& data) {
+    if (!writeAt(position, data)) {
+        return false;
+    }
+    position += data.size();
+    onWrite(data);
+    return true;
+}
+
+bool FileDescriptorWriteBytestream::writeAt(boost::uint64_t offset, const std::vector<unsigned char>& data) {
+    if (fileDescriptor < 0) {
+        return false;
+    }
+    size_t written = 0;
+    while (written < data.size()) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+        if (_lseeki64(fileDescriptor, boost::numeric_cast<__int64>(offset + written), SEEK_SET) < 0) {
+            return false;
+        }
+        int result = _write(fileDescriptor, &data[written], boost::numeric_cast<unsigned int>(data.size() - written));
+#else
+        ssize_t result = pwrite(fileDescriptor, &data[written], data.size() - written, boost::numeric_cast<off_t>(offset + written));
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+#endif
+        if (result <= 0) {
+            return false;
+        }
+        written += static_cast<size_t>(result);
+    }
+    return true;
+}
+
+void FileDescriptorWriteBytestream::close() {
+    if (fileDescriptor >= 0) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+        _close(fileDescriptor);
+#else
+        ::close(fileDescriptor);
+#endif
+        fileDescriptor = -1;
+    }
+}
+
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/FileTransfer/WriteBytestream.h>
+
+namespace Swift {
+    /**
+     * A bytestream writing to a file at a given offset, through a file
+     * descriptor.
+     *
+     * The file is created if it does not exist, but is never truncated, so
+     * several of these bytestreams can write different ranges of the same
+     * file at the same time.
+     */
+    class SWIFTEN_API FileDescriptorWriteBytestream : public WriteBytestream {
+        public:
+            FileDescriptorWriteBytestream(const boost::filesystem::path& file, boost::uint64_t offset = 0);
+            virtual ~FileDescriptorWriteBytestream();
+
+            /**
+             * Returns false if the file could not be opened or written.
+             */
+            virtual bool write(const std::vector<unsigned char>&);
+
+            /**
+             * Writes data at \p offset, without moving the position of the
+             * bytestream, or emitting \ref onWrite.
+             *
+             * Returns false if the file could not be opened or written.
+             */
+            bool writeAt(boost::uint64_t offset, const std::vector<unsigned char>&);
+
+            boost::uint64_t getPosition() const {
+                return position;
+            }
+
+            void close();
+
+        private:
+            int fileDescriptor;
+            boost::uint64_t position;
+    };
+}
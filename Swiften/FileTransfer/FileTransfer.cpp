@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2015 Isode Limited.
+ * Copyright (c) 2013-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -8,7 +8,7 @@
 
 using namespace Swift;
 
-FileTransfer::FileTransfer() : fileSizeInBytes_(0), state_(State::Initial) {
+FileTransfer::FileTransfer() : fileSizeInBytes_(0), rangeOffset_(0), rangeLength_(0), state_(State::Initial) {
 }
 
 FileTransfer::~FileTransfer() {
@@ -23,4 +23,11 @@ void FileTransfer::setFileInfo(const std::string& name, boost::uintmax_t size, c
     filename_ = name;
     fileSizeInBytes_ = size;
     description_ = description;
+    rangeOffset_ = 0;
+    rangeLength_ = size;
+}
+
+void FileTransfer::setRange(boost::uintmax_t offset, boost::uintmax_t length) {
+    rangeOffset_ = offset;
+    rangeLength_ = length;
 }
@@ -63,6 +63,21 @@ namespace Swift {
                 return fileSizeInBytes_;
             }
 
+            /**
+             * Returns the offset in the file of the data that is transferred.
+             */
+            boost::uintmax_t getRangeOffset() const {
+                return rangeOffset_;
+            }
+
+            /**
+             * Returns the number of bytes that are transferred. This is the
+             * file size, unless only a range of the file is transferred.
+             */
+            boost::uintmax_t getRangeLength() const {
+                return rangeLength_;
+            }
+
             const State& getState() const {
                 return state_;
             }
@@ -79,11 +94,14 @@ namespace Swift {
         protected:
             void setState(const State& state);
             void setFileInfo(const std::string& name, boost::uintmax_t size, const std::string& description);
+            void setRange(boost::uintmax_t offset, boost::uintmax_t length);
 
         private:
             boost::uintmax_t fileSizeInBytes_;
             std::string filename_;
             std::string description_;
+            boost::uintmax_t rangeOffset_;
+            boost::uintmax_t rangeLength_;
             State state_;
     };
 }
@@ -11,7 +11,7 @@ namespace Swift {
 FileTransferManager::~FileTransferManager() {
 }
 
-bool FileTransferManager::isSupportedBy(const DiscoInfo::ref info) {
+bool FileTransferManager::isSupportedBy(std::shared_ptr<const DiscoInfo> info) {
     if (info) {
         return info->hasFeature(DiscoInfo::JingleFeature)
                         && info->hasFeature(DiscoInfo::JingleFTFeature)
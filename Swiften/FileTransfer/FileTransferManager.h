@@ -32,6 +32,13 @@ namespace Swift {
         public:
             virtual ~FileTransferManager();
 
+            /**
+             * The file is read from \p bytestream, or from \p filepath if
+             * \p bytestream is empty. In the latter case, when more than one
+             * parallel stream is set in the options, and the recipient
+             * advertises \ref DiscoInfo::JingleFTParallelRangesFeature, a
+             * large file is sent in ranges.
+             */
             virtual OutgoingFileTransfer::ref createOutgoingFileTransfer(
                     const JID& to,
                     const boost::filesystem::path& filepath,
@@ -47,7 +54,7 @@ namespace Swift {
                     std::shared_ptr<ReadBytestream> bytestream,
                     const FileTransferOptions& = FileTransferOptions()) = 0;
 
-            static bool isSupportedBy(const DiscoInfo::ref info);
+            static bool isSupportedBy(std::shared_ptr<const DiscoInfo> info);
 
             boost::signals2::signal<void (IncomingFileTransfer::ref)> onIncomingFileTransfer;
     };
@@ -12,6 +12,8 @@
 
 #include <Swiften/FileTransfer/FileTransferManagerImpl.h>
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/filesystem.hpp>
@@ -24,8 +26,11 @@
 #include <Swiften/Elements/JingleFileTransferFileInfo.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/FileTransfer/DefaultFileTransferTransporterFactory.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
 #include <Swiften/FileTransfer/IncomingFileTransferManager.h>
 #include <Swiften/FileTransfer/OutgoingFileTransferManager.h>
+#include <Swiften/FileTransfer/ParallelIncomingFileTransfer.h>
+#include <Swiften/FileTransfer/ParallelOutgoingFileTransfer.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamProxiesManager.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamServerManager.h>
@@ -39,6 +44,8 @@
 
 namespace Swift {
 
+static const boost::uintmax_t MINIMUM_PARALLEL_RANGE_SIZE = 4 * 1024 * 1024;
+
 FileTransferManagerImpl::FileTransferManagerImpl(
         const JID& ownJID,
         JingleSessionManager* jingleSessionManager,
@@ -51,7 +58,8 @@ FileTransferManagerImpl::FileTransferManagerImpl(
         DomainNameResolver* domainNameResolver,
         NetworkEnvironment* networkEnvironment,
         NATTraverser* natTraverser,
-        CryptoProvider* crypto) :
+        CryptoProvider* crypto,
+        EventLoop* eventLoop) :
             iqRouter(router),
             capsProvider(capsProvider),
             presenceOracle(presOracle) {
@@ -74,16 +82,19 @@ FileTransferManagerImpl::FileTransferManagerImpl(
             iqRouter,
             transporterFactory,
             timerFactory,
-            crypto);
+            crypto,
+            eventLoop);
     incomingFTManager = new IncomingFileTransferManager(
             jingleSessionManager,
             transporterFactory,
             timerFactory,
-            crypto);
-    incomingFTManager->onIncomingFileTransfer.connect(onIncomingFileTransfer);
+            crypto,
+            eventLoop);
+    incomingFTManager->onIncomingFileTransfer.connect(boost::bind(&FileTransferManagerImpl::handleIncomingFileTransfer, this, _1));
 }
 
 FileTransferManagerImpl::~FileTransferManagerImpl() {
+    incomingFTManager->onIncomingFileTransfer.disconnect(boost::bind(&FileTransferManagerImpl::handleIncomingFileTransfer, this, _1));
     delete incomingFTManager;
     delete outgoingFTManager;
     delete transporterFactory;
@@ -110,7 +121,7 @@ boost::optional<JID> FileTransferManagerImpl::highestPriorityJIDSupportingFileTr
     foreach(Presence::ref pres, presences) {
         if (pres->getPriority() > priority) {
             // look up caps from the jid
-            DiscoInfo::ref info = capsProvider->getCaps(pres->getFrom());
+            std::shared_ptr<const DiscoInfo> info = capsProvider->getCaps(pres->getFrom());
             if (isSupportedBy(info)) {
                 priority = pres->getPriority();
                 fullReceipientJID = pres->getFrom();
@@ -135,7 +146,77 @@ OutgoingFileTransfer::ref FileTransferManagerImpl::createOutgoingFileTransfer(
 
     boost::uintmax_t sizeInBytes = boost::filesystem::file_size(filepath);
     boost::posix_time::ptime lastModified = boost::posix_time::from_time_t(boost::filesystem::last_write_time(filepath));
-    return createOutgoingFileTransfer(to, filename, description, sizeInBytes, lastModified, bytestream, config);
+    // A given bytestream can only be read from start to end, so the file is
+    // only split into ranges when it is read from the file itself, and when
+    // the recipient puts the ranges back together.
+    boost::uintmax_t ranges = std::min<boost::uintmax_t>(config.getParallelStreams(), sizeInBytes / MINIMUM_PARALLEL_RANGE_SIZE);
+    if (ranges <= 1 || bytestream || !supportsParallelRanges(to)) {
+        if (!bytestream) {
+            bytestream = std::make_shared<FileDescriptorReadBytestream>(filepath);
+        }
+        return createOutgoingFileTransfer(to, filename, description, sizeInBytes, lastModified, bytestream, config);
+    }
+
+    boost::uintmax_t rangeSize = (sizeInBytes + ranges - 1) / ranges;
+    std::vector<OutgoingFileTransfer::ref> transfers;
+    for (boost::uintmax_t offset = 0; offset < sizeInBytes; offset += rangeSize) {
+        boost::uintmax_t length = std::min(rangeSize, sizeInBytes - offset);
+        JingleFileTransferFileInfo fileInfo = createFileInfo(filename, description, sizeInBytes, lastModified);
+        fileInfo.setRangeOffset(offset);
+        fileInfo.setRangeLength(length);
+        OutgoingFileTransfer::ref transfer = createOutgoingFileTransfer(to, fileInfo, std::make_shared<FileDescriptorReadBytestream>(filepath, offset, length), config);
+        if (!transfer) {
+            return OutgoingFileTransfer::ref();
+        }
+        transfers.push_back(transfer);
+    }
+    return std::make_shared<ParallelOutgoingFileTransfer>(transfers, filename, sizeInBytes, description);
+}
+
+void FileTransferManagerImpl::handleIncomingFileTransfer(IncomingFileTransfer::ref transfer) {
+    // Only a sender that advertises parallel ranges splits a file over
+    // several transfers. A range from any other sender is transferred on its
+    // own.
+    if (transfer->getRangeLength() == transfer->getFileSizeInBytes() || !supportsParallelRanges(transfer->getSender())) {
+        onIncomingFileTransfer(transfer);
+        return;
+    }
+
+    // A range of a file that is sent in parallel. All ranges of the file are
+    // collected in one transfer, which is only announced once.
+    for (std::vector<std::weak_ptr<ParallelIncomingFileTransfer> >::iterator i = parallelIncomingTransfers.begin(); i != parallelIncomingTransfers.end(); ) {
+        ParallelIncomingFileTransfer::ref parallelTransfer = i->lock();
+        if (!parallelTransfer || parallelTransfer->isComplete()) {
+            i = parallelIncomingTransfers.erase(i);
+            continue;
+        }
+        if (parallelTransfer->isRangeOfSameFile(transfer)) {
+            if (parallelTransfer->addTransfer(transfer)) {
+                return;
+            }
+            // The other ranges were declined or failed already
+            if (parallelTransfer->getState().type == FileTransfer::State::Canceled || parallelTransfer->getState().type == FileTransfer::State::Failed) {
+                transfer->cancel();
+                return;
+            }
+        }
+        ++i;
+    }
+
+    ParallelIncomingFileTransfer::ref parallelTransfer = std::make_shared<ParallelIncomingFileTransfer>(transfer);
+    if (!parallelTransfer->isComplete()) {
+        parallelIncomingTransfers.push_back(parallelTransfer);
+    }
+    onIncomingFileTransfer(parallelTransfer);
+}
+
+bool FileTransferManagerImpl::supportsParallelRanges(const JID& jid) {
+    boost::optional<JID> fullJID = jid.isBare() ? highestPriorityJIDSupportingFileTransfer(jid) : boost::optional<JID>(jid);
+    if (!fullJID) {
+        return false;
+    }
+    std::shared_ptr<const DiscoInfo> capabilities = capsProvider->getCaps(*fullJID);
+    return capabilities && capabilities->hasFeature(DiscoInfo::JingleFTParallelRangesFeature);
 }
 
 OutgoingFileTransfer::ref FileTransferManagerImpl::createOutgoingFileTransfer(
@@ -146,12 +227,27 @@ OutgoingFileTransfer::ref FileTransferManagerImpl::createOutgoingFileTransfer(
         const boost::posix_time::ptime& lastModified,
         std::shared_ptr<ReadBytestream> bytestream,
         const FileTransferOptions& config) {
+    return createOutgoingFileTransfer(to, createFileInfo(filename, description, sizeInBytes, lastModified), bytestream, config);
+}
+
+JingleFileTransferFileInfo FileTransferManagerImpl::createFileInfo(
+        const std::string& filename,
+        const std::string& description,
+        const boost::uintmax_t sizeInBytes,
+        const boost::posix_time::ptime& lastModified) {
     JingleFileTransferFileInfo fileInfo;
     fileInfo.setDate(lastModified);
     fileInfo.setSize(sizeInBytes);
     fileInfo.setName(filename);
     fileInfo.setDescription(description);
+    return fileInfo;
+}
 
+OutgoingFileTransfer::ref FileTransferManagerImpl::createOutgoingFileTransfer(
+        const JID& to,
+        const JingleFileTransferFileInfo& fileInfo,
+        std::shared_ptr<ReadBytestream> bytestream,
+        const FileTransferOptions& config) {
     JID receipient = to;
 
     if(receipient.isBare()) {
@@ -165,7 +261,7 @@ OutgoingFileTransfer::ref FileTransferManagerImpl::createOutgoingFileTransfer(
 
     assert(!iqRouter->getJID().isBare());
 
-    DiscoInfo::ref capabilities = capsProvider->getCaps(receipient);
+    std::shared_ptr<const DiscoInfo> capabilities = capsProvider->getCaps(receipient);
 
     FileTransferOptions options = config;
     if (capabilities) {
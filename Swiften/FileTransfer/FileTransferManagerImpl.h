@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -35,14 +36,17 @@ namespace Swift {
     class CryptoProvider;
     class DomainNameResolver;
     class EntityCapsProvider;
+    class EventLoop;
     class FileTransferTransporterFactory;
     class IQRouter;
     class IncomingFileTransferManager;
     class JID;
+    class JingleFileTransferFileInfo;
     class JingleSessionManager;
     class NATTraverser;
     class NetworkEnvironment;
     class OutgoingFileTransferManager;
+    class ParallelIncomingFileTransfer;
     class PresenceOracle;
     class ReadBytestream;
     class SOCKS5BytestreamProxiesManager;
@@ -64,7 +68,8 @@ namespace Swift {
                     DomainNameResolver* domainNameResolver,
                     NetworkEnvironment* networkEnvironment,
                     NATTraverser* natTraverser,
-                    CryptoProvider* crypto);
+                    CryptoProvider* crypto,
+                    EventLoop* eventLoop);
             virtual ~FileTransferManagerImpl();
 
             OutgoingFileTransfer::ref createOutgoingFileTransfer(
@@ -86,7 +91,19 @@ namespace Swift {
             void stop();
 
         private:
+            void handleIncomingFileTransfer(IncomingFileTransfer::ref transfer);
             boost::optional<JID> highestPriorityJIDSupportingFileTransfer(const JID& bareJID);
+            bool supportsParallelRanges(const JID& jid);
+            static JingleFileTransferFileInfo createFileInfo(
+                    const std::string& filename,
+                    const std::string& description,
+                    const boost::uintmax_t sizeInBytes,
+                    const boost::posix_time::ptime& lastModified);
+            OutgoingFileTransfer::ref createOutgoingFileTransfer(
+                    const JID& to,
+                    const JingleFileTransferFileInfo& fileInfo,
+                    std::shared_ptr<ReadBytestream> bytestream,
+                    const FileTransferOptions&);
 
         private:
             OutgoingFileTransferManager* outgoingFTManager;
@@ -99,5 +116,6 @@ namespace Swift {
             SOCKS5BytestreamRegistry* bytestreamRegistry;
             SOCKS5BytestreamProxiesManager* bytestreamProxy;
             SOCKS5BytestreamServerManager* s5bServerManager;
+            std::vector<std::weak_ptr<ParallelIncomingFileTransfer> > parallelIncomingTransfers;
     };
 }
@@ -6,13 +6,19 @@
 
 #pragma once
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/Override.h>
 
 namespace Swift {
     class SWIFTEN_API FileTransferOptions {
         public:
-            FileTransferOptions() : allowInBand_(true), allowAssisted_(true), allowProxied_(true), allowDirect_(true) {
+            FileTransferOptions() : allowInBand_(true), allowAssisted_(true), allowProxied_(true), allowDirect_(true), inBandBlockSize_(16384), inBandWindowSize_(4), hashInBackground_(false), parallelStreams_(1), candidateSelectionTimeout_(1000) {
+                hashAlgorithms_.push_back("sha-1");
+                hashAlgorithms_.push_back("md5");
             }
             SWIFTEN_DEFAULT_COPY_CONSTRUCTOR(FileTransferOptions)
             ~FileTransferOptions();
@@ -53,7 +59,95 @@ namespace Swift {
                 return allowDirect_;
             }
 
+            /**
+             * Sets the block size to propose for in-band transfers, and the
+             * largest block size to accept for them.
+             */
+            FileTransferOptions& withInBandBlockSize(unsigned int blockSize) {
+                inBandBlockSize_ = blockSize;
+                return *this;
+            }
+
+            unsigned int getInBandBlockSize() const {
+                return inBandBlockSize_;
+            }
+
+            /**
+             * Sets the number of blocks an in-band transfer sends before
+             * waiting for them to be acknowledged. A window size of 0 is
+             * treated as 1.
+             */
+            FileTransferOptions& withInBandWindowSize(unsigned int windowSize) {
+                inBandWindowSize_ = std::max(1U, windowSize);
+                return *this;
+            }
+
+            unsigned int getInBandWindowSize() const {
+                return inBandWindowSize_;
+            }
+
+            /**
+             * Sets the XEP-0300 hash algorithms with which outgoing files are
+             * hashed. Algorithms not supported by the crypto provider are
+             * skipped.
+             */
+            FileTransferOptions& withHashAlgorithms(const std::vector<std::string>& algorithms) {
+                hashAlgorithms_ = algorithms;
+                return *this;
+            }
+
+            const std::vector<std::string>& getHashAlgorithms() const {
+                return hashAlgorithms_;
+            }
 
+            /**
+             * Sets whether the transferred data is hashed on a separate
+             * thread instead of on the event loop.
+             */
+            FileTransferOptions& withHashingInBackground(bool b) {
+                hashInBackground_ = b;
+                return *this;
+            }
+
+            bool isHashingInBackground() const {
+                return hashInBackground_;
+            }
+
+            /**
+             * Sets the number of streams over which a file is sent. With more
+             * than one stream, large files are split into ranges that are
+             * each sent in their own file transfer, and hashed separately.
+             * The receiver writes each range at its offset (see
+             * \ref ParallelIncomingFileTransfer).
+             *
+             * As every range is read from the file itself, a file is only
+             * split into ranges when no bytestream is passed to
+             * \ref FileTransferManager::createOutgoingFileTransfer(), and
+             * when the recipient advertises
+             * \ref DiscoInfo::JingleFTParallelRangesFeature.
+             */
+            FileTransferOptions& withParallelStreams(unsigned int streams) {
+                parallelStreams_ = streams;
+                return *this;
+            }
+
+            unsigned int getParallelStreams() const {
+                return parallelStreams_;
+            }
+
+            /**
+             * Sets how long (in milliseconds) a connected SOCKS5 candidate
+             * waits for candidates with a higher priority that are still
+             * being connected to, before it is selected.
+             */
+            FileTransferOptions& withCandidateSelectionTimeout(int milliseconds) {
+                candidateSelectionTimeout_ = milliseconds;
+                return *this;
+            }
+
+            int getCandidateSelectionTimeout() const {
+                return candidateSelectionTimeout_;
+            }
 
             SWIFTEN_DEFAULT_COPY_ASSIGMNENT_OPERATOR(FileTransferOptions)
 
@@ -62,5 +156,11 @@ namespace Swift {
             bool allowAssisted_;
             bool allowProxied_;
             bool allowDirect_;
+            unsigned int inBandBlockSize_;
+            unsigned int inBandWindowSize_;
+            std::vector<std::string> hashAlgorithms_;
+            bool hashInBackground_;
+            unsigned int parallelStreams_;
+            int candidateSelectionTimeout_;
     };
 }
@@ -27,10 +27,17 @@ class IBBReceiveSession::IBBResponder : public SetResponder<IBB> {
         virtual bool handleSetRequest(const JID& from, const JID&, const std::string& id, IBB::ref ibb) {
             if (from == session->from && ibb->getStreamID() == session->id) {
                 if (ibb->getAction() == IBB::Data) {
-                    if (sequenceNumber == ibb->getSequenceNumber()) {
+                    if (!session->active) {
+                        // The sender can have more blocks underway when the
+                        // session ends, which are all rejected.
+                        SWIFT_LOG(debug) << "Received data after session ended";
+                        sendError(from, id, ErrorPayload::ItemNotFound, ErrorPayload::Cancel);
+                    }
+                    else if (sequenceNumber == ibb->getSequenceNumber()) {
                         session->bytestream->write(ibb->getData());
                         receivedSize += ibb->getData().size();
-                        sequenceNumber++;
+                        // Sequence numbers wrap around after 65535 (XEP-0047).
+                        sequenceNumber = (sequenceNumber + 1) % 65536;
                         sendResponse(from, id, IBB::ref());
                         if (receivedSize >= session->size) {
                             if (receivedSize > session->size) {
@@ -52,7 +59,9 @@ class IBBReceiveSession::IBBResponder : public SetResponder<IBB> {
                 else if (ibb->getAction() == IBB::Close) {
                     SWIFT_LOG(debug) << "IBB close received";
                     sendResponse(from, id, IBB::ref());
-                    session->finish(FileTransferError(FileTransferError::ClosedError));
+                    if (session->active) {
+                        session->finish(FileTransferError(FileTransferError::ClosedError));
+                    }
                 }
                 return true;
             }
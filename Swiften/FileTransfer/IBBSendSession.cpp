@@ -10,6 +10,7 @@
 #include <boost/numeric/conversion/cast.hpp>
 
 #include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/foreach.h>
 #include <Swiften/FileTransfer/BytestreamException.h>
 #include <Swiften/FileTransfer/IBBRequest.h>
 #include <Swiften/Queries/IQRouter.h>
@@ -28,68 +29,98 @@ IBBSendSession::IBBSendSession(
             bytestream(bytestream),
             router(router),
             blockSize(4096),
+            windowSize(1),
             sequenceNumber(0),
             active(false),
+            paused(false),
             waitingForData(false) {
     bytestream->onDataAvailable.connect(boost::bind(&IBBSendSession::handleDataAvailable, this));
 }
 
 IBBSendSession::~IBBSendSession() {
+    cancelRequests();
     bytestream->onDataAvailable.disconnect(boost::bind(&IBBSendSession::handleDataAvailable, this));
 }
 
 void IBBSendSession::start() {
-    IBBRequest::ref request = IBBRequest::create(
-            from, to, IBB::createIBBOpen(id, boost::numeric_cast<int>(blockSize)), router);
-    request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBResponse, this, _1, _2));
     active = true;
-    request->send();
-    currentRequest = request;
+    sendRequest(IBBRequest::create(from, to, IBB::createIBBOpen(id, boost::numeric_cast<int>(blockSize)), router));
 }
 
 void IBBSendSession::stop() {
     if (active && router->isAvailable()) {
         IBBRequest::create(from, to, IBB::createIBBClose(id), router)->send();
     }
-    if (currentRequest) {
-        currentRequest->onResponse.disconnect(boost::bind(&IBBSendSession::handleIBBResponse, this, _1, _2));
-    }
+    cancelRequests();
     finish(boost::optional<FileTransferError>());
 }
 
-void IBBSendSession::handleIBBResponse(IBB::ref, ErrorPayload::ref error) {
-    currentRequest.reset();
+void IBBSendSession::pause() {
+    paused = true;
+}
+
+void IBBSendSession::resume() {
+    if (paused) {
+        paused = false;
+        sendMoreData();
+    }
+}
+
+void IBBSendSession::sendRequest(std::shared_ptr<IBBRequest> request) {
+    request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBResponse, this, request.get(), _1, _2));
+    pendingRequests.push_back(request);
+    request->send();
+}
+
+void IBBSendSession::cancelRequests() {
+    foreach (std::shared_ptr<IBBRequest> request, pendingRequests) {
+        request->onResponse.disconnect(boost::bind(&IBBSendSession::handleIBBResponse, this, request.get(), _1, _2));
+    }
+    pendingRequests.clear();
+}
+
+void IBBSendSession::handleIBBResponse(IBBRequest* request, IBB::ref, ErrorPayload::ref error) {
+    for (std::list<std::shared_ptr<IBBRequest> >::iterator i = pendingRequests.begin(); i != pendingRequests.end(); ++i) {
+        if (i->get() == request) {
+            pendingRequests.erase(i);
+            break;
+        }
+    }
 
     if (!error && active) {
         if (!bytestream->isFinished()) {
             sendMoreData();
         }
-        else {
+        else if (pendingRequests.empty()) {
             finish(boost::optional<FileTransferError>());
         }
     }
     else {
+        // The receiver rejects all data after an error, so don't wait for
+        // the responses to the blocks that are still underway.
+        cancelRequests();
         finish(FileTransferError(FileTransferError::PeerError));
     }
 }
 
 void IBBSendSession::sendMoreData() {
     try {
-        std::shared_ptr<ByteArray> data = bytestream->read(blockSize);
-        if (!data->empty()) {
+        while (active && !paused && pendingRequests.size() < windowSize && !bytestream->isFinished()) {
+            std::shared_ptr<ByteArray> data = bytestream->read(blockSize);
+            if (data->empty()) {
+                waitingForData = true;
+                return;
+            }
             waitingForData = false;
             IBBRequest::ref request = IBBRequest::create(from, to, IBB::createIBBData(id, sequenceNumber, *data), router);
-            sequenceNumber++;
-            request->onResponse.connect(boost::bind(&IBBSendSession::handleIBBResponse, this, _1, _2));
-            request->send();
-            currentRequest = request;
+            // Sequence numbers wrap around after 65535 (XEP-0047).
+            sequenceNumber = (sequenceNumber + 1) % 65536;
+            sendRequest(request);
             onBytesSent(data->size());
         }
-        else {
-            waitingForData = true;
-        }
     }
     catch (const BytestreamException&) {
+        cancelRequests();
         finish(FileTransferError(FileTransferError::ReadError));
     }
 }
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <list>
 #include <memory>
 
 #include <boost/optional.hpp>
@@ -35,6 +37,13 @@ namespace Swift {
             void start();
             void stop();
 
+            /**
+             * Stops sending data blocks until resume() is called. Blocks that
+             * were already sent are still acknowledged.
+             */
+            void pause();
+            void resume();
+
             const JID& getSender() const {
                 return from;
             }
@@ -47,11 +56,22 @@ namespace Swift {
                 this->blockSize = blockSize;
             }
 
+            /**
+             * Sets the maximum number of data blocks that are sent without
+             * having received a response for them (1 by default). A window
+             * size of 0 is treated as 1.
+             */
+            void setWindowSize(unsigned int windowSize) {
+                this->windowSize = std::max(1U, windowSize);
+            }
+
             boost::signals2::signal<void (boost::optional<FileTransferError>)> onFinished;
             boost::signals2::signal<void (size_t)> onBytesSent;
 
         private:
-            void handleIBBResponse(IBB::ref, ErrorPayload::ref);
+            void handleIBBResponse(IBBRequest* request, IBB::ref, ErrorPayload::ref);
+            void sendRequest(std::shared_ptr<IBBRequest> request);
+            void cancelRequests();
             void finish(boost::optional<FileTransferError>);
             void sendMoreData();
             void handleDataAvailable();
@@ -63,9 +83,11 @@ namespace Swift {
             std::shared_ptr<ReadBytestream> bytestream;
             IQRouter* router;
             unsigned int blockSize;
+            unsigned int windowSize;
             int sequenceNumber;
             bool active;
+            bool paused;
             bool waitingForData;
-            std::shared_ptr<IBBRequest> currentRequest;
+            std::list<std::shared_ptr<IBBRequest> > pendingRequests;
     };
 }
@@ -26,4 +26,12 @@ void IBBSendTransportSession::stop() {
     session->stop();
 }
 
+void IBBSendTransportSession::pause() {
+    session->pause();
+}
+
+void IBBSendTransportSession::resume() {
+    session->resume();
+}
+
 }
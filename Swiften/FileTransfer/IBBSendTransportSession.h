@@ -21,6 +21,8 @@ class SWIFTEN_API IBBSendTransportSession : public TransportSession {
 
         virtual void start() SWIFTEN_OVERRIDE;
         virtual void stop() SWIFTEN_OVERRIDE;
+        virtual void pause() SWIFTEN_OVERRIDE;
+        virtual void resume() SWIFTEN_OVERRIDE;
 
     private:
         std::shared_ptr<IBBSendSession> session;
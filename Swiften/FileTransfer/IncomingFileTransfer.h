@@ -8,6 +8,7 @@
 
 #include <memory>
 
+#include <boost/cstdint.hpp>
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
@@ -15,8 +16,9 @@
 #include <Swiften/FileTransfer/FileTransferOptions.h>
 
 namespace Swift {
-    class WriteBytestream;
     class JID;
+    class ReadBytestream;
+    class WriteBytestream;
 
     /**
      * @brief The IncomingFileTransfer abstract class is the general interface in Swiften
@@ -32,6 +34,23 @@ namespace Swift {
                     std::shared_ptr<WriteBytestream>,
                     const FileTransferOptions& = FileTransferOptions()) = 0;
 
+            /**
+             * Accepts the transfer, asking the sender to only send the data
+             * from \p offset on, because the data before it was received
+             * in an earlier transfer. That data is read from \p receivedData,
+             * starting at the range offset of this transfer, so that the hash
+             * verification still covers all of the data.
+             *
+             * Returns false, without accepting the transfer, if the sender
+             * does not support ranged transfers, or if \p offset is not in
+             * the offered range.
+             */
+            virtual bool resume(
+                    std::shared_ptr<WriteBytestream>,
+                    std::shared_ptr<ReadBytestream> receivedData,
+                    boost::uintmax_t offset,
+                    const FileTransferOptions& = FileTransferOptions()) = 0;
+
             virtual const JID& getSender() const = 0;
             virtual const JID& getRecipient() const = 0;
     };
@@ -23,11 +23,13 @@ IncomingFileTransferManager::IncomingFileTransferManager(
         JingleSessionManager* jingleSessionManager,
         FileTransferTransporterFactory* transporterFactory,
         TimerFactory* timerFactory,
-        CryptoProvider* crypto) :
+        CryptoProvider* crypto,
+        EventLoop* eventLoop) :
             jingleSessionManager(jingleSessionManager),
             transporterFactory(transporterFactory),
             timerFactory(timerFactory),
-            crypto(crypto) {
+            crypto(crypto),
+            eventLoop(eventLoop) {
     jingleSessionManager->addIncomingSessionHandler(this);
 }
 
@@ -44,7 +46,7 @@ bool IncomingFileTransferManager::handleIncomingJingleSession(
             JingleFileTransferDescription::ref description = content->getDescription<JingleFileTransferDescription>();
             if (description) {
                 IncomingJingleFileTransfer::ref transfer = std::make_shared<IncomingJingleFileTransfer>(
-                        recipient, session, content, transporterFactory, timerFactory, crypto);
+                        recipient, session, content, transporterFactory, timerFactory, crypto, eventLoop);
                 onIncomingFileTransfer(transfer);
             }
             else {
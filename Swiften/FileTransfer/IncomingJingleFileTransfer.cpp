@@ -6,21 +6,29 @@
 
 #include <Swiften/FileTransfer/IncomingJingleFileTransfer.h>
 
+#include <algorithm>
 #include <memory>
 #include <set>
 
 #include <boost/bind.hpp>
 
+#include <Swiften/Base/Algorithm.h>
 #include <Swiften/Base/Log.h>
 #include <Swiften/Base/foreach.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
 #include <Swiften/Elements/JingleFileTransferDescription.h>
 #include <Swiften/Elements/JingleFileTransferHash.h>
 #include <Swiften/Elements/JingleIBBTransportPayload.h>
 #include <Swiften/Elements/JingleS5BTransportPayload.h>
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/FileTransfer/BytestreamException.h>
 #include <Swiften/FileTransfer/FileTransferOptions.h>
 #include <Swiften/FileTransfer/FileTransferTransporter.h>
 #include <Swiften/FileTransfer/FileTransferTransporterFactory.h>
 #include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
+#include <Swiften/FileTransfer/ReadBytestream.h>
 #include <Swiften/FileTransfer/TransportSession.h>
 #include <Swiften/FileTransfer/WriteBytestream.h>
 #include <Swiften/Jingle/JingleSession.h>
@@ -32,23 +40,38 @@ using namespace Swift;
 
 // TODO: ALlow terminate when already terminated.
 
+namespace {
+    // XEP-0300 hash algorithms, from the most to the least preferred one
+    const char* const preferredHashAlgorithms[] = {
+        "blake2b-512", "sha3-512", "sha3-256", "sha-512", "sha-384", "sha-256", "sha-224", "sha-1", "md5"
+    };
+
+    // The block size in which data received before a resumed transfer is
+    // hashed. One block is hashed per event.
+    const boost::uintmax_t HASH_BLOCK_SIZE = 65536;
+}
+
 IncomingJingleFileTransfer::IncomingJingleFileTransfer(
         const JID& toJID,
         JingleSession::ref session,
         JingleContentPayload::ref content,
         FileTransferTransporterFactory* transporterFactory,
         TimerFactory* timerFactory,
-        CryptoProvider* crypto) :
+        CryptoProvider* crypto,
+        EventLoop* eventLoop) :
             JingleFileTransfer(session, toJID, transporterFactory),
             initialContent(content),
             crypto(crypto),
+            eventLoop(eventLoop),
+            eventOwner(std::make_shared<EventOwner>()),
             state(Initial),
             receivedBytes(0),
-            hashCalculator(nullptr) {
+            receivedDataSize(0) {
     description = initialContent->getDescription<JingleFileTransferDescription>();
     assert(description);
     JingleFileTransferFileInfo fileInfo = description->getFileInfo();
     setFileInfo(fileInfo.getName(), fileInfo.getSize(), fileInfo.getDescription());
+    setRange(fileInfo.getRangeOffset(), getTransferSize(fileInfo));
     hashes = fileInfo.getHashes();
 
     waitOnHashTimer = timerFactory->createTimer(5000);
@@ -60,9 +83,7 @@ IncomingJingleFileTransfer::~IncomingJingleFileTransfer() {
     if (waitOnHashTimer) {
         waitOnHashTimer->stop();
     }
-
-    delete hashCalculator;
-    hashCalculator = nullptr;
+    eventLoop->removeEventsFromOwner(eventOwner);
 }
 
 void IncomingJingleFileTransfer::accept(
@@ -71,14 +92,66 @@ void IncomingJingleFileTransfer::accept(
     SWIFT_LOG(debug) << std::endl;
     if (state != Initial) { SWIFT_LOG(warning) << "Incorrect state" << std::endl; return; }
 
+    startAccepting(stream, std::shared_ptr<ReadBytestream>(), 0, options);
+}
+
+bool IncomingJingleFileTransfer::resume(
+        std::shared_ptr<WriteBytestream> stream,
+        std::shared_ptr<ReadBytestream> receivedData,
+        boost::uintmax_t offset,
+        const FileTransferOptions& options) {
+    SWIFT_LOG(debug) << offset << std::endl;
+    if (state != Initial) { SWIFT_LOG(warning) << "Incorrect state" << std::endl; return false; }
+
+    JingleFileTransferFileInfo fileInfo = description->getFileInfo();
+    if (!fileInfo.getSupportsRangeRequests() || offset < getRangeOffset() || offset >= getRangeOffset() + getRangeLength()) {
+        return false;
+    }
+    boost::uintmax_t receivedSize = offset - getRangeOffset();
+    boost::uintmax_t remainingSize = getRangeLength() - receivedSize;
+
+    // Accept with the remaining part of the offered range
+    fileInfo.setRangeOffset(offset);
+    if (fileInfo.getRangeLength() > 0) {
+        fileInfo.setRangeLength(remainingSize);
+    }
+    description = std::make_shared<JingleFileTransferDescription>();
+    description->setFileInfo(fileInfo);
+    setRange(offset, remainingSize);
+
+    startAccepting(stream, receivedData, receivedSize, options);
+    return true;
+}
+
+void IncomingJingleFileTransfer::startAccepting(
+        std::shared_ptr<WriteBytestream> stream,
+        std::shared_ptr<ReadBytestream> receivedData,
+        boost::uintmax_t receivedSize,
+        const FileTransferOptions& options) {
     assert(!this->stream);
     this->stream = stream;
     this->options = options;
 
     assert(!hashCalculator);
 
-    hashCalculator = new IncrementalBytestreamHashCalculator(
-            hashes.find("md5") != hashes.end(), hashes.find("sha-1") != hashes.end(), crypto);
+    // Only calculate the strongest of the announced hashes that we support
+    std::vector<std::string> algorithms;
+    foreach (const char* algorithm, preferredHashAlgorithms) {
+        if (hashes.find(algorithm) != hashes.end() && std::shared_ptr<Hash>(crypto->createHash(algorithm))) {
+            algorithms.push_back(algorithm);
+            break;
+        }
+    }
+    hashCalculator = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto, eventLoop, options.isHashingInBackground());
+    hashCalculator->onFinished.connect(boost::bind(&IncomingJingleFileTransfer::handleHashCalculated, this));
+    hashCalculator->onReady.connect(boost::bind(&IncomingJingleFileTransfer::handleHashCalculatorReady, this));
+    if (receivedData && receivedSize > 0) {
+        // The received data needs to be hashed before the data that comes
+        // in now, so that data is held back until then.
+        this->receivedData = receivedData;
+        receivedDataSize = receivedSize;
+        eventLoop->postEvent(boost::bind(&IncomingJingleFileTransfer::hashReceivedDataBlock, this), eventOwner);
+    }
 
     writeStreamDataReceivedConnection = stream->onWrite.connect(
             boost::bind(&IncomingJingleFileTransfer::handleWriteStreamDataReceived, this, _1));
@@ -100,10 +173,10 @@ void IncomingJingleFileTransfer::accept(
 
         startTransferring(transporter->createIBBReceiveSession(
             ibbTransport->getSessionID(),
-            description->getFileInfo().getSize(),
+            getRangeLength(),
             stream));
 
-        session->sendAccept(getContentID(), initialContent->getDescriptions()[0], ibbTransport);
+        session->sendAccept(getContentID(), description, limitBlockSize(ibbTransport));
     }
     else {
         // This might happen on incoming transfer which only list transport methods we are not allowed to use due to file-transfer options.
@@ -133,7 +206,7 @@ void IncomingJingleFileTransfer::handleLocalTransportCandidatesGenerated(
     foreach(JingleS5BTransportPayload::Candidate candidate, candidates) {
         transport->addCandidate(candidate);
     }
-    session->sendAccept(getContentID(), initialContent->getDescriptions()[0], transport);
+    session->sendAccept(getContentID(), description, transport);
 
     setState(TryingCandidates);
     transporter->startTryingRemoteCandidates();
@@ -147,11 +220,8 @@ void IncomingJingleFileTransfer::handleSessionInfoReceived(JinglePayload::ref ji
     if (transferHash) {
         SWIFT_LOG(debug) << "Received hash information." << std::endl;
         waitOnHashTimer->stop();
-        if (transferHash->getFileInfo().getHashes().find("sha-1") != transferHash->getFileInfo().getHashes().end()) {
-            hashes["sha-1"] = transferHash->getFileInfo().getHash("sha-1").get();
-        }
-        if (transferHash->getFileInfo().getHashes().find("md5") != transferHash->getFileInfo().getHashes().end()) {
-            hashes["md5"] = transferHash->getFileInfo().getHash("md5").get();
+        foreach (const JingleFileTransferFileInfo::HashElementMap::value_type& hashElement, transferHash->getFileInfo().getHashes()) {
+            hashes[hashElement.first] = hashElement.second;
         }
         if (state == WaitingForHash) {
             checkHashAndTerminate();
@@ -193,37 +263,119 @@ void IncomingJingleFileTransfer::checkHashAndTerminate() {
     }
 }
 
-void IncomingJingleFileTransfer::checkIfAllDataReceived() {
-    if (receivedBytes == getFileSizeInBytes()) {
-        SWIFT_LOG(debug) << "All data received." << std::endl;
-        bool hashInfoAvailable = false;
-        foreach(const JingleFileTransferFileInfo::HashElementMap::value_type& hashElement, hashes) {
-            hashInfoAvailable |= !hashElement.second.empty();
-        }
+void IncomingJingleFileTransfer::hashReceivedDataBlock() {
+    if (state == Finished || !receivedData) {
+        return;
+    }
 
-        if (!hashInfoAvailable) {
-            SWIFT_LOG(debug) << "No hash information yet. Waiting a while on hash info." << std::endl;
-            setState(WaitingForHash);
-            waitOnHashTimer->start();
-        }
-        else {
-            checkHashAndTerminate();
+    // Missing data is not an error here, as it makes the hash verification fail
+    std::shared_ptr<ByteArray> data;
+    try {
+        data = receivedData->read(static_cast<size_t>(std::min<boost::uintmax_t>(receivedDataSize, HASH_BLOCK_SIZE)));
+    }
+    catch (const BytestreamException&) {
+        SWIFT_LOG(warning) << "Unable to read the received data" << std::endl;
+    }
+    if (data && !data->empty()) {
+        hashCalculator->feedData(*data);
+        receivedDataSize -= std::min<boost::uintmax_t>(data->size(), receivedDataSize);
+    }
+    else {
+        SWIFT_LOG(warning) << "Missing " << receivedDataSize << " bytes of received data" << std::endl;
+        receivedDataSize = 0;
+    }
+
+    if (receivedDataSize == 0) {
+        handleReceivedDataHashed();
+    }
+    else if (!hashCalculator->isBusy()) {
+        eventLoop->postEvent(boost::bind(&IncomingJingleFileTransfer::hashReceivedDataBlock, this), eventOwner);
+    }
+}
+
+void IncomingJingleFileTransfer::handleReceivedDataHashed() {
+    receivedData.reset();
+    if (!heldBackData.empty()) {
+        hashCalculator->feedData(heldBackData);
+        heldBackData.clear();
+    }
+    if (transportSession && !hashCalculator->isBusy()) {
+        // Otherwise, resumed when the calculator is ready
+        transportSession->resume();
+    }
+    checkIfAllDataReceived();
+}
+
+void IncomingJingleFileTransfer::checkIfAllDataReceived() {
+    if (receivedBytes == getRangeLength()) {
+        if (receivedData) {
+            // Finished once the data received before is hashed
+            return;
         }
+        SWIFT_LOG(debug) << "All data received." << std::endl;
+        hashCalculator->finish();
     }
-    else if (receivedBytes > getFileSizeInBytes()) {
+    else if (receivedBytes > getRangeLength()) {
         SWIFT_LOG(debug) << "We got more than we could handle!" << std::endl;
         terminate(JinglePayload::Reason::MediaError);
     }
 }
 
+void IncomingJingleFileTransfer::handleHashCalculated() {
+    SWIFT_LOG(debug) << std::endl;
+    if (state != Transferring) { SWIFT_LOG(warning) << "Incorrect state" << std::endl; return; }
+
+    bool hashInfoAvailable = false;
+    foreach(const JingleFileTransferFileInfo::HashElementMap::value_type& hashElement, hashes) {
+        hashInfoAvailable |= !hashElement.second.empty();
+    }
+
+    if (!hashInfoAvailable) {
+        SWIFT_LOG(debug) << "No hash information yet. Waiting a while on hash info." << std::endl;
+        setState(WaitingForHash);
+        waitOnHashTimer->start();
+    }
+    else {
+        checkHashAndTerminate();
+    }
+}
+
 void IncomingJingleFileTransfer::handleWriteStreamDataReceived(
         const std::vector<unsigned char>& data) {
-    hashCalculator->feedData(data);
+    if (receivedData) {
+        // Not all transports can be paused
+        append(heldBackData, data);
+    }
+    else {
+        hashCalculator->feedData(data);
+        if (hashCalculator->isBusy() && transportSession) {
+            // Don't let the data pile up if hashing can't keep up
+            transportSession->pause();
+        }
+    }
     receivedBytes += data.size();
     onProcessedBytes(data.size());
     checkIfAllDataReceived();
 }
 
+void IncomingJingleFileTransfer::handleHashCalculatorReady() {
+    if (receivedData) {
+        eventLoop->postEvent(boost::bind(&IncomingJingleFileTransfer::hashReceivedDataBlock, this), eventOwner);
+    }
+    else if (transportSession) {
+        transportSession->resume();
+    }
+}
+
+JingleIBBTransportPayload::ref IncomingJingleFileTransfer::limitBlockSize(JingleIBBTransportPayload::ref transport) const {
+    if (transport->getBlockSize() && *transport->getBlockSize() > options.getInBandBlockSize()) {
+        JingleIBBTransportPayload::ref limitedTransport = std::make_shared<JingleIBBTransportPayload>(*transport);
+        limitedTransport->setBlockSize(options.getInBandBlockSize());
+        return limitedTransport;
+    }
+    return transport;
+}
+
 void IncomingJingleFileTransfer::handleTransportReplaceReceived(
         const JingleContentID& content, JingleTransportPayload::ref transport) {
     SWIFT_LOG(debug) << std::endl;
@@ -238,9 +390,9 @@ void IncomingJingleFileTransfer::handleTransportReplaceReceived(
 
         startTransferring(transporter->createIBBReceiveSession(
             ibbTransport->getSessionID(),
-            description->getFileInfo().getSize(),
+            getRangeLength(),
             stream));
-        session->sendTransportAccept(content, ibbTransport);
+        session->sendTransportAccept(content, limitBlockSize(ibbTransport));
     }
     else {
         SWIFT_LOG(debug) << "Unknown replace transport" << std::endl;
@@ -257,18 +409,16 @@ bool IncomingJingleFileTransfer::verifyData() {
         SWIFT_LOG(debug) << "no verification possible, skipping" << std::endl;
         return true;
     }
-    if (hashes.find("sha-1") != hashes.end()) {
-        SWIFT_LOG(debug) << "Verify SHA-1 hash: " << (hashes["sha-1"] == hashCalculator->getSHA1Hash()) << std::endl;
-        return hashes["sha-1"] == hashCalculator->getSHA1Hash();
-    }
-    else if (hashes.find("md5") != hashes.end()) {
-        SWIFT_LOG(debug) << "Verify MD5 hash: " << (hashes["md5"] == hashCalculator->getMD5Hash()) << std::endl;
-        return hashes["md5"] == hashCalculator->getMD5Hash();
-    }
-    else {
-        SWIFT_LOG(debug) << "Unknown hash, skipping" << std::endl;
-        return true;
+    foreach (const char* algorithm, preferredHashAlgorithms) {
+        std::map<std::string, ByteArray>::const_iterator hash = hashes.find(algorithm);
+        if (hash != hashes.end() && !hash->second.empty() && hashCalculator->hasHash(algorithm)) {
+            bool result = hash->second == hashCalculator->getHash(algorithm);
+            SWIFT_LOG(debug) << "Verify " << algorithm << " hash: " << result << std::endl;
+            return result;
+        }
     }
+    SWIFT_LOG(debug) << "Unknown hash, skipping" << std::endl;
+    return true;
 }
 
 void IncomingJingleFileTransfer::handleWaitOnHashTimerTicked() {
@@ -324,8 +474,7 @@ FileTransfer::State::Type IncomingJingleFileTransfer::getExternalState(State sta
 void IncomingJingleFileTransfer::stopAll() {
     if (state != Initial) {
         writeStreamDataReceivedConnection.disconnect();
-        delete hashCalculator;
-        hashCalculator = nullptr;
+        hashCalculator.reset();
     }
     switch (state) {
         case Initial: break;
@@ -386,6 +535,10 @@ void IncomingJingleFileTransfer::startTransferring(std::shared_ptr<TransportSess
     transferFinishedConnection = transportSession->onFinished.connect(
             boost::bind(&IncomingJingleFileTransfer::handleTransferFinished, this, _1));
     setState(Transferring);
+    if (receivedData) {
+        // Resumed once the data received before is hashed
+        transportSession->pause();
+    }
     transportSession->start();
 }
 
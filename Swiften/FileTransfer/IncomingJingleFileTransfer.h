@@ -29,8 +29,11 @@ namespace Swift {
     class TimerFactory;
     class Timer;
     class CryptoProvider;
+    class EventLoop;
+    class EventOwner;
     class IncrementalBytestreamHashCalculator;
     class JingleFileTransferDescription;
+    class JingleIBBTransportPayload;
     class HashElement;
 
     /**
@@ -50,10 +53,12 @@ namespace Swift {
                 std::shared_ptr<JingleContentPayload> content,
                 FileTransferTransporterFactory*,
                 TimerFactory*,
-                CryptoProvider*);
+                CryptoProvider*,
+                EventLoop*);
             virtual ~IncomingJingleFileTransfer();
 
             virtual void accept(std::shared_ptr<WriteBytestream>, const FileTransferOptions& = FileTransferOptions()) SWIFTEN_OVERRIDE;
+            virtual bool resume(std::shared_ptr<WriteBytestream>, std::shared_ptr<ReadBytestream> receivedData, boost::uintmax_t offset, const FileTransferOptions& = FileTransferOptions()) SWIFTEN_OVERRIDE;
             virtual void cancel() SWIFTEN_OVERRIDE;
 
         private:
@@ -80,14 +85,20 @@ namespace Swift {
                     const std::vector<JingleS5BTransportPayload::Candidate>&,
                     const std::string& dstAddr) SWIFTEN_OVERRIDE;
 
+            void startAccepting(std::shared_ptr<WriteBytestream>, std::shared_ptr<ReadBytestream> receivedData, boost::uintmax_t receivedSize, const FileTransferOptions&);
             void handleWriteStreamDataReceived(const std::vector<unsigned char>& data);
+            void handleHashCalculatorReady();
+            void hashReceivedDataBlock();
+            void handleReceivedDataHashed();
             void stopActiveTransport();
             void checkCandidateSelected();
             virtual JingleContentID getContentID() const SWIFTEN_OVERRIDE;
             void checkIfAllDataReceived();
+            void handleHashCalculated();
             bool verifyData();
             void handleWaitOnHashTimerTicked();
             void handleTransferFinished(boost::optional<FileTransferError>);
+            std::shared_ptr<JingleIBBTransportPayload> limitBlockSize(std::shared_ptr<JingleIBBTransportPayload>) const;
 
         private:
             virtual void startTransferViaRemoteCandidate() SWIFTEN_OVERRIDE;
@@ -113,11 +124,16 @@ namespace Swift {
         private:
             std::shared_ptr<JingleContentPayload> initialContent;
             CryptoProvider* crypto;
+            EventLoop* eventLoop;
+            std::shared_ptr<EventOwner> eventOwner;
             State state;
             std::shared_ptr<JingleFileTransferDescription> description;
             std::shared_ptr<WriteBytestream> stream;
             boost::uintmax_t receivedBytes;
-            IncrementalBytestreamHashCalculator* hashCalculator;
+            std::shared_ptr<IncrementalBytestreamHashCalculator> hashCalculator;
+            std::shared_ptr<ReadBytestream> receivedData;
+            boost::uintmax_t receivedDataSize;
+            ByteArray heldBackData;
             std::shared_ptr<Timer> waitOnHashTimer;
             std::map<std::string, ByteArray> hashes;
             FileTransferOptions options;
@@ -13,28 +13,236 @@
 
 #include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
 
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Base/foreach.h>
 #include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
 #include <Swiften/StringCodecs/Hexify.h>
 
 namespace Swift {
 
-IncrementalBytestreamHashCalculator::IncrementalBytestreamHashCalculator(bool doMD5, bool doSHA1, CryptoProvider* crypto) {
-    md5Hasher = doMD5 ? crypto->createMD5() : nullptr;
-    sha1Hasher = doSHA1 ? crypto->createSHA1() : nullptr;
+namespace {
+    // Bounds the data waiting to be hashed, in case hashing is slower than
+    // the transfer.
+    const size_t maximumQueuedBytes = 16 * 1024 * 1024;
+
+    std::vector<std::string> getAlgorithms(bool doMD5, bool doSHA1) {
+        std::vector<std::string> algorithms;
+        if (doMD5) {
+            algorithms.push_back("md5");
+        }
+        if (doSHA1) {
+            algorithms.push_back("sha-1");
+        }
+        return algorithms;
+    }
+}
+
+/**
+ * A thread running the background hashing jobs of all calculators, in the
+ * order in which they were posted. It lives as long as a calculator uses it.
+ */
+class IncrementalBytestreamHashCalculator::Worker {
+    public:
+        Worker() : stopRequested(false), thread(boost::bind(&Worker::run, this)) {
+        }
+
+        ~Worker() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopRequested = true;
+            }
+            jobsChanged.notify_all();
+            thread.join();
+        }
+
+        static std::shared_ptr<Worker> getInstance() {
+            static std::mutex instanceMutex;
+            static std::weak_ptr<Worker> instance;
+            std::lock_guard<std::mutex> lock(instanceMutex);
+            std::shared_ptr<Worker> worker = instance.lock();
+            if (!worker) {
+                worker = std::make_shared<Worker>();
+                instance = worker;
+            }
+            return worker;
+        }
+
+        void post(const std::function<void ()>& job) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                jobs.push_back(job);
+            }
+            jobsChanged.notify_one();
+        }
+
+    private:
+        void run() {
+            while (true) {
+                std::function<void ()> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    while (jobs.empty() && !stopRequested) {
+                        jobsChanged.wait(lock);
+                    }
+                    if (stopRequested) {
+                        return;
+                    }
+                    job = jobs.front();
+                    jobs.pop_front();
+                }
+                job();
+            }
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable jobsChanged;
+        std::deque<std::function<void ()> > jobs;
+        bool stopRequested;
+        std::thread thread;
+};
+
+/**
+ * The hashers of a calculator. When hashing in the background, the jobs on
+ * the worker keep the state alive, so that the calculator can be destroyed
+ * while they are pending.
+ */
+class IncrementalBytestreamHashCalculator::State {
+    public:
+        typedef std::map<std::string, Hash*> HasherMap;
+
+        State(IncrementalBytestreamHashCalculator* calculator) : calculator(calculator), calculated(false), queuedBytes(0), busy(false), cancelled(false) {
+        }
+
+        ~State() {
+            foreach (HasherMap::value_type& hasher, hashers) {
+                delete hasher.second;
+            }
+        }
+
+        void update(const ByteArray& data) {
+            assert(!calculated);
+            foreach (HasherMap::value_type& hasher, hashers) {
+                hasher.second->update(data);
+            }
+        }
+
+        void calculate() {
+            foreach (HasherMap::value_type& hasher, hashers) {
+                hashes[hasher.first] = hasher.second->getHash();
+            }
+            calculated = true;
+        }
+
+        // Background jobs
+        void hashChunk(std::shared_ptr<ByteArray> chunk) {
+            if (!isCancelled()) {
+                update(*chunk);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            queuedBytes -= chunk->size();
+            if (busy && queuedBytes <= maximumQueuedBytes / 2) {
+                busy = false;
+                post(&IncrementalBytestreamHashCalculator::handleReady);
+            }
+        }
+
+        void finish() {
+            if (!isCancelled()) {
+                calculate();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            post(&IncrementalBytestreamHashCalculator::handleHashesCalculatedEvent);
+        }
+
+        bool isCancelled() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return cancelled;
+        }
+
+        // Posts to the calculator from the worker; expects the mutex to be held
+        void post(void (IncrementalBytestreamHashCalculator::*handler)()) {
+            // The calculator removes its events when it is destroyed, after
+            // which nothing must be posted anymore
+            if (!cancelled) {
+                calculator->eventLoop->postEvent(boost::bind(handler, calculator), calculator->eventOwner);
+            }
+        }
+
+    public:
+        IncrementalBytestreamHashCalculator* calculator;
+        HasherMap hashers;
+        std::map<std::string, ByteArray> hashes;
+        bool calculated;
+
+        std::mutex mutex;
+        size_t queuedBytes;
+        bool busy;
+        bool cancelled;
+};
+
+IncrementalBytestreamHashCalculator::IncrementalBytestreamHashCalculator(bool doMD5, bool doSHA1, CryptoProvider* crypto) : IncrementalBytestreamHashCalculator(Swift::getAlgorithms(doMD5, doSHA1), crypto) {
+}
+
+IncrementalBytestreamHashCalculator::IncrementalBytestreamHashCalculator(const std::vector<std::string>& algorithms, CryptoProvider* crypto, EventLoop* eventLoop, bool hashInBackground) : state(std::make_shared<State>(this)), finishRequested(false), finished(false), eventLoop(eventLoop) {
+    foreach (const std::string& algorithm, algorithms) {
+        if (state->hashers.find(algorithm) == state->hashers.end()) {
+            if (Hash* hasher = crypto->createHash(algorithm)) {
+                state->hashers[algorithm] = hasher;
+            }
+        }
+    }
+    if (eventLoop) {
+        eventOwner = std::make_shared<EventOwner>();
+    }
+    if (hashInBackground) {
+        assert(eventLoop);
+        worker = Worker::getInstance();
+    }
 }
 
 IncrementalBytestreamHashCalculator::~IncrementalBytestreamHashCalculator() {
-    delete md5Hasher;
-    delete sha1Hasher;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->cancelled = true;
+    }
+    if (eventLoop) {
+        eventLoop->removeEventsFromOwner(eventOwner);
+    }
 }
 
 void IncrementalBytestreamHashCalculator::feedData(const ByteArray& data) {
-    if (md5Hasher) {
-        md5Hasher->update(data);
+    if (!worker) {
+        state->update(data);
+        return;
     }
-    if (sha1Hasher) {
-        sha1Hasher->update(data);
+
+    assert(!finishRequested);
+    if (data.empty() || state->hashers.empty()) {
+        return;
+    }
+    // The data is copied once, and the worker only gets a reference to the
+    // copy.
+    std::shared_ptr<ByteArray> chunk = std::make_shared<ByteArray>(data);
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->queuedBytes += chunk->size();
+        if (state->queuedBytes >= maximumQueuedBytes) {
+            state->busy = true;
+        }
     }
+    worker->post(boost::bind(&State::hashChunk, state, chunk));
 }
 /*
 void IncrementalBytestreamHashCalculator::feedData(const SafeByteArray& data) {
@@ -46,30 +254,84 @@ void IncrementalBytestreamHashCalculator::feedData(const SafeByteArray& data) {
     }
 }*/
 
-ByteArray IncrementalBytestreamHashCalculator::getSHA1Hash() {
-    assert(sha1Hasher);
-    if (!sha1Hash) {
-        sha1Hash = sha1Hasher->getHash();
+bool IncrementalBytestreamHashCalculator::isBusy() const {
+    if (!worker) {
+        return false;
     }
-    return *sha1Hash;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->busy;
 }
 
-ByteArray IncrementalBytestreamHashCalculator::getMD5Hash() {
-    assert(md5Hasher);
-    if (!md5Hash) {
-        md5Hash = md5Hasher->getHash();
+void IncrementalBytestreamHashCalculator::finish() {
+    assert(!finishRequested);
+    finishRequested = true;
+    if (worker) {
+        worker->post(boost::bind(&State::finish, state));
     }
-    return *md5Hash;
+    else {
+        if (!state->calculated) {
+            state->calculate();
+        }
+        if (eventLoop) {
+            eventLoop->postEvent(boost::bind(&IncrementalBytestreamHashCalculator::handleHashesCalculatedEvent, this), eventOwner);
+        }
+        else {
+            handleHashesCalculated();
+        }
+    }
+}
+
+void IncrementalBytestreamHashCalculator::handleHashesCalculated() {
+    finished = true;
+    onFinished();
+}
+
+void IncrementalBytestreamHashCalculator::handleHashesCalculatedEvent() {
+    // Handlers of onFinished may release the last reference to us
+    std::shared_ptr<IncrementalBytestreamHashCalculator> protectedThis = shared_from_this();
+    handleHashesCalculated();
+}
+
+void IncrementalBytestreamHashCalculator::handleReady() {
+    onReady();
+}
+
+std::vector<std::string> IncrementalBytestreamHashCalculator::getAlgorithms() const {
+    std::vector<std::string> result;
+    foreach (const State::HasherMap::value_type& hasher, state->hashers) {
+        result.push_back(hasher.first);
+    }
+    return result;
+}
+
+bool IncrementalBytestreamHashCalculator::hasHash(const std::string& algorithm) const {
+    return state->hashers.find(algorithm) != state->hashers.end();
+}
+
+ByteArray IncrementalBytestreamHashCalculator::getHash(const std::string& algorithm) {
+    assert(hasHash(algorithm));
+    if (!state->calculated) {
+        // Without a worker, the hashes can be calculated on demand
+        assert(!worker);
+        state->calculate();
+    }
+    return state->hashes[algorithm];
+}
+
+ByteArray IncrementalBytestreamHashCalculator::getSHA1Hash() {
+    return getHash("sha-1");
+}
+
+ByteArray IncrementalBytestreamHashCalculator::getMD5Hash() {
+    return getHash("md5");
 }
 
 std::string IncrementalBytestreamHashCalculator::getSHA1String() {
-    assert(sha1Hasher);
-    return Hexify::hexify(getSHA1Hash());;
+    return Hexify::hexify(getSHA1Hash());
 }
 
 std::string IncrementalBytestreamHashCalculator::getMD5String() {
-    assert(md5Hasher);
-    return Hexify::hexify(getMD5Hash());;
+    return Hexify::hexify(getMD5Hash());
 }
 
 }
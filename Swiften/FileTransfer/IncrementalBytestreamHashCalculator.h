@@ -12,9 +12,12 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
 #include <string>
+#include <vector>
 
-#include <boost/optional.hpp>
+#include <boost/signals2.hpp>
 
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/SafeByteArray.h>
@@ -22,26 +25,107 @@
 namespace Swift {
     class Hash;
     class CryptoProvider;
+    class EventLoop;
+    class EventOwner;
 
-    class IncrementalBytestreamHashCalculator {
+    /**
+     * Calculates hashes over the data of a bytestream while it is being
+     * transferred.
+     *
+     * When constructed with an event loop, \ref onFinished is emitted from
+     * the event loop once the hashes of all the data fed before
+     * \ref finish() are known. The calculator must then be owned by a
+     * std::shared_ptr, so that it stays alive if a handler of
+     * \ref onFinished releases it. Otherwise, \ref onFinished is emitted
+     * from \ref finish() itself, and its handlers must not destroy the
+     * calculator.
+     */
+    class IncrementalBytestreamHashCalculator : public std::enable_shared_from_this<IncrementalBytestreamHashCalculator> {
     public:
         IncrementalBytestreamHashCalculator(bool doMD5, bool doSHA1, CryptoProvider* crypto);
+
+        /**
+         * Calculates hashes for the given XEP-0300 algorithms. Algorithms that
+         * are not supported by \p crypto are ignored.
+         *
+         * If \p hashInBackground is set, the data is hashed on a worker
+         * thread that is shared by all calculators. This requires an event
+         * loop.
+         */
+        IncrementalBytestreamHashCalculator(const std::vector<std::string>& algorithms, CryptoProvider* crypto, EventLoop* eventLoop = nullptr, bool hashInBackground = false);
         ~IncrementalBytestreamHashCalculator();
 
+        /**
+         * Feeds data to the calculator. This never blocks.
+         *
+         * When hashing in the background, the data is queued. If hashing is
+         * slower than the data comes in, \ref isBusy() becomes true, and the
+         * caller should stop feeding data until \ref onReady is emitted.
+         */
         void feedData(const ByteArray& data);
         //void feedData(const SafeByteArray& data);
 
+        /**
+         * Returns whether more data is waiting to be hashed than the
+         * calculator wants to buffer.
+         */
+        bool isBusy() const;
+
+        /**
+         * Stops accepting data, and emits \ref onFinished when the hashes
+         * are available.
+         */
+        void finish();
+
+        bool isFinished() const {
+            return finished;
+        }
+
+        /**
+         * Returns the algorithms that are being calculated.
+         */
+        std::vector<std::string> getAlgorithms() const;
+
+        bool hasHash(const std::string& algorithm) const;
+
+        /**
+         * Returns the hash for the given algorithm.
+         *
+         * When hashing on a separate thread, this can only be called
+         * after \ref onFinished was emitted.
+         */
+        ByteArray getHash(const std::string& algorithm);
+
         ByteArray getSHA1Hash();
         ByteArray getMD5Hash();
 
         std::string getSHA1String();
         std::string getMD5String();
 
+    public:
+        boost::signals2::signal<void ()> onFinished;
+
+        /**
+         * Emitted from the event loop when the calculator is no longer busy.
+         */
+        boost::signals2::signal<void ()> onReady;
+
     private:
-        Hash* md5Hasher;
-        Hash* sha1Hasher;
-        boost::optional<ByteArray> md5Hash;
-        boost::optional<ByteArray> sha1Hash;
+        class Worker;
+        class State;
+
+        void handleHashesCalculated();
+        void handleHashesCalculatedEvent();
+        void handleReady();
+
+    private:
+        std::shared_ptr<State> state;
+        bool finishRequested;
+        bool finished;
+
+        EventLoop* eventLoop;
+        std::shared_ptr<EventOwner> eventOwner;
+        std::shared_ptr<Worker> worker;
     };
 
 }
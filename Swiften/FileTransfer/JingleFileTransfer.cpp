@@ -6,11 +6,14 @@
 
 #include <Swiften/FileTransfer/JingleFileTransfer.h>
 
+#include <algorithm>
+
 #include <boost/typeof/typeof.hpp>
 
 #include <Swiften/Base/Log.h>
 #include <Swiften/Base/foreach.h>
 #include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Elements/JingleFileTransferFileInfo.h>
 #include <Swiften/FileTransfer/FileTransferTransporter.h>
 #include <Swiften/JID/JID.h>
 #include <Swiften/Jingle/JingleSession.h>
@@ -71,6 +74,14 @@ FileTransfer::State::Type JingleFileTransfer::getExternalFinishedState(JinglePay
     }
 }
 
+boost::uintmax_t JingleFileTransfer::getTransferSize(const JingleFileTransferFileInfo& fileInfo) {
+    if (fileInfo.getRangeOffset() >= fileInfo.getSize()) {
+        return 0;
+    }
+    boost::uintmax_t remaining = fileInfo.getSize() - fileInfo.getRangeOffset();
+    return fileInfo.getRangeLength() > 0 ? std::min(fileInfo.getRangeLength(), remaining) : remaining;
+}
+
 boost::optional<FileTransferError> JingleFileTransfer::getFileTransferError(JinglePayload::Reason::Type reason) {
     if (reason == JinglePayload::Reason::Success) {
         return boost::optional<FileTransferError>();
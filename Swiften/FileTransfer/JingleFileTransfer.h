@@ -21,6 +21,7 @@
 namespace Swift {
     class CryptoProvider;
     class IQRouter;
+    class JingleFileTransferFileInfo;
     class RemoteJingleTransportCandidateSelector;
     class LocalJingleTransportCandidateGenerator;
     class JingleSession;
@@ -75,6 +76,12 @@ namespace Swift {
             static FileTransfer::State::Type getExternalFinishedState(JinglePayload::Reason::Type);
             static boost::optional<FileTransferError> getFileTransferError(JinglePayload::Reason::Type);
 
+            /**
+             * Returns the number of bytes of the file that are transferred,
+             * taking the range of the file info into account.
+             */
+            static boost::uintmax_t getTransferSize(const JingleFileTransferFileInfo&);
+
             std::shared_ptr<JingleSession> session;
             JID target;
             FileTransferTransporterFactory* transporterFactory;
@@ -12,6 +12,7 @@
 
 #include <Swiften/FileTransfer/LocalJingleTransportCandidateGenerator.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -26,6 +27,7 @@
 #include <Swiften/FileTransfer/SOCKS5BytestreamServerResourceUser.h>
 
 static const unsigned int LOCAL_PREFERENCE = 0;
+static const size_t MAX_PROXY_PREFERENCE = 65535;
 
 namespace Swift {
 
@@ -170,7 +172,10 @@ void LocalJingleTransportCandidateGenerator::emitOnLocalTransportCandidatesGener
     }
 
     if (options_.isProxiedAllowed() && s5bProxy->getOrDiscoverS5BProxies().is_initialized()) {
-        foreach(S5BProxyRequest::ref proxy, s5bProxy->getOrDiscoverS5BProxies().get()) {
+        // Proxies are ordered by how fast they were to connect to, so prefer the first ones
+        const std::vector<S5BProxyRequest::ref>& proxies = s5bProxy->getOrDiscoverS5BProxies().get();
+        int proxyPreference = static_cast<int>(std::min<size_t>(proxies.size(), MAX_PROXY_PREFERENCE));
+        foreach(S5BProxyRequest::ref proxy, proxies) {
             if (proxy->getStreamHost()) { // FIXME: Added this test, because there were cases where this wasn't initialized. Investigate this. (Remko)
                 JingleS5BTransportPayload::Candidate candidate;
                 candidate.type = JingleS5BTransportPayload::Candidate::ProxyType;
@@ -178,7 +183,8 @@ void LocalJingleTransportCandidateGenerator::emitOnLocalTransportCandidatesGener
                 HostAddress address = (*proxy->getStreamHost()).host;
                 assert(address.isValid());
                 candidate.hostPort = HostAddressPort(address, (*proxy->getStreamHost()).port);
-                candidate.priority = 65536 * 10 + LOCAL_PREFERENCE;
+                candidate.priority = 65536 * 10 + LOCAL_PREFERENCE + proxyPreference;
+                proxyPreference = std::max(0, proxyPreference - 1);
                 candidate.cid = idGenerator->generateID();
                 candidates.push_back(candidate);
             }
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/MappedFileReadBytestream.h>
+
+#include <algorithm>
+#include <memory>
+
+#include <boost/filesystem.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <Swiften/FileTransfer/BytestreamException.h>
+
+namespace Swift {
+
+MappedFileReadBytestream::MappedFileReadBytestream(const boost::filesystem::path& file, size_t windowSize) : file(file), windowSize(windowSize), valid(false), size(0), position(0), windowOffset(0) {
+    boost::system::error_code error;
+    size = boost::filesystem::file_size(file, error);
+    valid = !error;
+}
+
+std::shared_ptr<ByteArray> MappedFileReadBytestream::read(size_t size) {
+    View view = readView(size);
+    return std::make_shared<ByteArray>(view.data, view.data + view.size);
+}
+
+ReadBytestream::View MappedFileReadBytestream::readView(size_t size) {
+    if (!valid) {
+        throw BytestreamException();
+    }
+    View result;
+    result.size = boost::numeric_cast<size_t>(std::min<boost::uintmax_t>(size, this->size - position));
+    if (result.size > 0) {
+        if (!window || position < windowOffset || position >= windowOffset + window->getSize()) {
+            // Map a new window instead of remapping the current one, which
+            // may still be referenced by earlier views.
+            windowOffset = position;
+            window = std::make_shared<MemoryMappedFile>();
+            if (!window->open(file, windowOffset, windowSize) || window->getSize() == 0) {
+                window.reset();
+                throw BytestreamException();
+            }
+        }
+        size_t windowPosition = boost::numeric_cast<size_t>(position - windowOffset);
+        result.size = std::min(result.size, window->getSize() - windowPosition);
+        result.data = window->getData() + windowPosition;
+        result.owner = window;
+        position += result.size;
+    }
+    if (!onRead.empty()) {
+        readData.assign(result.data, result.data + result.size);
+        onRead(readData);
+    }
+    return result;
+}
+
+bool MappedFileReadBytestream::isFinished() const {
+    return valid && position >= size;
+}
+
+}
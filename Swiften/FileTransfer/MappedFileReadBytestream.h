@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/MemoryMappedFile.h>
+#include <Swiften/FileTransfer/ReadBytestream.h>
+
+namespace Swift {
+    /**
+     * A bytestream reading from a memory mapped file.
+     *
+     * The file is mapped one window at a time, so that large files do not
+     * need to fit in the address space. readView() returns data straight
+     * from the mapping, and keeps its window mapped for as long as the view
+     * is held. The data is only copied if something is connected to onRead.
+     *
+     * The file must not be truncated while it is being read.
+     */
+    class SWIFTEN_API MappedFileReadBytestream : public ReadBytestream {
+        public:
+            MappedFileReadBytestream(const boost::filesystem::path& file, size_t windowSize = 64 * 1024 * 1024);
+
+            /**
+             * Throws BytestreamException if the file cannot be read.
+             */
+            virtual std::shared_ptr< std::vector<unsigned char> > read(size_t size);
+
+            /**
+             * Throws BytestreamException if the file cannot be read.
+             */
+            virtual View readView(size_t size);
+            virtual bool isFinished() const;
+
+        private:
+            boost::filesystem::path file;
+            size_t windowSize;
+            bool valid;
+            boost::uintmax_t size;
+            boost::uintmax_t position;
+            std::shared_ptr<MemoryMappedFile> window;
+            boost::uintmax_t windowOffset;
+            ByteArray readData;
+    };
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/MappedFileWriteBytestream.h>
+
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <Swiften/Base/Platform.h>
+
+#if !defined(SWIFTEN_PLATFORM_WINDOWS)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Swift {
+
+MappedFileWriteBytestream::MappedFileWriteBytestream(const boost::filesystem::path& file, boost::uintmax_t size, size_t windowSize) : file(file), windowSize(windowSize), valid(false), size(size), position(0), windowOffset(0) {
+#if defined(SWIFTEN_PLATFORM_WINDOWS)
+    boost::filesystem::ofstream stream(file, std::ios_base::out|std::ios_base::binary|std::ios_base::trunc);
+    if (stream.good()) {
+        stream.close();
+        boost::system::error_code error;
+        boost::filesystem::resize_file(file, size, error);
+        valid = !error;
+    }
+#else
+    int fileDescriptor = ::open(file.string().c_str(), O_RDWR|O_CREAT|O_TRUNC, 0666);
+    if (fileDescriptor >= 0) {
+#if defined(SWIFTEN_PLATFORM_LINUX)
+        // Allocate the blocks now, so that running out of disk space fails
+        // here instead of when writing to the mapping.
+        valid = size == 0 || posix_fallocate(fileDescriptor, 0, boost::numeric_cast<off_t>(size)) == 0;
+        if (!valid) {
+            valid = ftruncate(fileDescriptor, boost::numeric_cast<off_t>(size)) == 0;
+        }
+#else
+        valid = ftruncate(fileDescriptor, boost::numeric_cast<off_t>(size)) == 0;
+#endif
+        ::close(fileDescriptor);
+    }
+#endif
+}
+
+MappedFileWriteBytestream::~MappedFileWriteBytestream() {
+    close();
+}
+
+bool MappedFileWriteBytestream::write(const std::vector<unsigned char>& data) {
+    if (!valid || data.size() > size - position) {
+        return false;
+    }
+    if (data.empty()) {
+        return true;
+    }
+    size_t written = 0;
+    while (written < data.size()) {
+        if (!window.isOpen() || position >= windowOffset + window.getSize()) {
+            windowOffset = position;
+            if (!window.open(file, windowOffset, windowSize, MemoryMappedFile::ReadWrite) || window.getSize() == 0) {
+                window.close();
+                return false;
+            }
+        }
+        size_t windowPosition = boost::numeric_cast<size_t>(position - windowOffset);
+        size_t chunkSize = std::min(data.size() - written, window.getSize() - windowPosition);
+        std::copy(data.begin() + static_cast<std::ptrdiff_t>(written), data.begin() + static_cast<std::ptrdiff_t>(written + chunkSize), window.getWritableData() + windowPosition);
+        written += chunkSize;
+        position += chunkSize;
+    }
+    onWrite(data);
+    return true;
+}
+
+void MappedFileWriteBytestream::close() {
+    if (!valid) {
+        return;
+    }
+    window.close();
+    if (position < size) {
+        boost::system::error_code error;
+        boost::filesystem::resize_file(file, position, error);
+    }
+    valid = false;
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/MemoryMappedFile.h>
+#include <Swiften/FileTransfer/WriteBytestream.h>
+
+namespace Swift {
+    /**
+     * A bytestream writing a file of known size through a memory mapping.
+     *
+     * The file is created with its final size up front, and mapped one
+     * window at a time, so that large files do not need to fit in the
+     * address space.
+     */
+    class SWIFTEN_API MappedFileWriteBytestream : public WriteBytestream {
+        public:
+            /**
+             * Creates \p file, replacing any existing file, and allocates
+             * \p size bytes for it.
+             */
+            MappedFileWriteBytestream(const boost::filesystem::path& file, boost::uintmax_t size, size_t windowSize = 64 * 1024 * 1024);
+            virtual ~MappedFileWriteBytestream();
+
+            /**
+             * Returns false if the file could not be created, or if the data
+             * does not fit in the size given on construction.
+             */
+            virtual bool write(const std::vector<unsigned char>&);
+
+            /**
+             * Finishes writing. If less data was written than the size given
+             * on construction, the file is truncated to the data written.
+             */
+            void close();
+
+        private:
+            boost::filesystem::path file;
+            size_t windowSize;
+            bool valid;
+            boost::uintmax_t size;
+            boost::uintmax_t position;
+            MemoryMappedFile window;
+            boost::uintmax_t windowOffset;
+    };
+}
@@ -28,12 +28,14 @@ OutgoingFileTransferManager::OutgoingFileTransferManager(
         IQRouter* router,
         FileTransferTransporterFactory* transporterFactory,
         TimerFactory* timerFactory,
-        CryptoProvider* crypto) :
+        CryptoProvider* crypto,
+        EventLoop* eventLoop) :
             jingleSessionManager(jingleSessionManager),
             iqRouter(router),
             transporterFactory(transporterFactory),
             timerFactory(timerFactory),
-            crypto(crypto) {
+            crypto(crypto),
+            eventLoop(eventLoop) {
     idGenerator = new IDGenerator();
 }
 
@@ -59,7 +61,8 @@ std::shared_ptr<OutgoingFileTransfer> OutgoingFileTransferManager::createOutgoin
                 idGenerator,
                 fileInfo,
                 config,
-                crypto));
+                crypto,
+                eventLoop));
 }
 
 }
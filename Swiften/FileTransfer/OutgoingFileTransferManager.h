@@ -28,6 +28,7 @@ namespace Swift {
     class CryptoProvider;
     class FileTransferOptions;
     class TimerFactory;
+    class EventLoop;
 
     class SWIFTEN_API OutgoingFileTransferManager {
         public:
@@ -36,7 +37,8 @@ namespace Swift {
                     IQRouter* router,
                     FileTransferTransporterFactory* transporterFactory,
                     TimerFactory* timerFactory,
-                    CryptoProvider* crypto);
+                    CryptoProvider* crypto,
+                    EventLoop* eventLoop);
             ~OutgoingFileTransferManager();
 
             std::shared_ptr<OutgoingFileTransfer> createOutgoingFileTransfer(
@@ -53,5 +55,6 @@ namespace Swift {
             TimerFactory* timerFactory;
             IDGenerator* idGenerator;
             CryptoProvider* crypto;
+            EventLoop* eventLoop;
     };
 }
@@ -17,6 +17,7 @@
 
 #include <Swiften/FileTransfer/OutgoingJingleFileTransfer.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <boost/bind.hpp>
@@ -31,6 +32,9 @@
 #include <Swiften/Elements/JingleIBBTransportPayload.h>
 #include <Swiften/Elements/JingleS5BTransportPayload.h>
 #include <Swiften/Elements/JingleTransportPayload.h>
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+#include <Swiften/FileTransfer/BytestreamException.h>
 #include <Swiften/FileTransfer/FileTransferTransporter.h>
 #include <Swiften/FileTransfer/FileTransferTransporterFactory.h>
 #include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
@@ -42,8 +46,13 @@
 
 using namespace Swift;
 
+// The block size to use when the responder does not specify one.
 static const int DEFAULT_BLOCK_SIZE = 4096;
 
+// The block size in which the data before the accepted range offset is read
+// when resuming a transfer. One block is read per event.
+static const boost::uintmax_t SKIP_BLOCK_SIZE = 65536;
+
 OutgoingJingleFileTransfer::OutgoingJingleFileTransfer(
         const JID& toJID,
         JingleSession::ref session,
@@ -53,22 +62,32 @@ OutgoingJingleFileTransfer::OutgoingJingleFileTransfer(
         IDGenerator* idGenerator,
         const JingleFileTransferFileInfo& fileInfo,
         const FileTransferOptions& options,
-        CryptoProvider* crypto) :
+        CryptoProvider* crypto,
+        EventLoop* eventLoop) :
             JingleFileTransfer(session, toJID, transporterFactory),
+            eventLoop(eventLoop),
+            eventOwner(std::make_shared<EventOwner>()),
             idGenerator(idGenerator),
             stream(stream),
             fileInfo(fileInfo),
             options(options),
             contentID(idGenerator->generateID(), JingleContentPayload::InitiatorCreator),
             state(Initial),
-            candidateAcknowledged(false) {
+            candidateAcknowledged(false),
+            bytesToSkip(0) {
 
     setFileInfo(fileInfo.getName(), fileInfo.getSize(), fileInfo.getDescription());
+    setRange(fileInfo.getRangeOffset(), getTransferSize(fileInfo));
+
+    // Let the responder resume a transfer by accepting a range
+    this->fileInfo.setSupportsRangeRequests(true);
 
-    // calculate both, MD5 and SHA-1 since we don't know which one the other side supports
-    hashCalculator = new IncrementalBytestreamHashCalculator(true, true, crypto);
+    // calculate all configured hashes, since we don't know which one the other side supports
+    hashCalculator = std::make_shared<IncrementalBytestreamHashCalculator>(options.getHashAlgorithms(), crypto, eventLoop, options.isHashingInBackground());
+    hashCalculator->onFinished.connect(boost::bind(&OutgoingJingleFileTransfer::handleHashCalculated, this));
+    hashCalculator->onReady.connect(boost::bind(&OutgoingJingleFileTransfer::handleHashCalculatorReady, this));
     stream->onRead.connect(
-            boost::bind(&IncrementalBytestreamHashCalculator::feedData, hashCalculator, _1));
+            boost::bind(&OutgoingJingleFileTransfer::handleStreamRead, this, _1));
 
     waitForRemoteTermination = timerFactory->createTimer(5000);
     waitForRemoteTermination->onTick.connect(boost::bind(&OutgoingJingleFileTransfer::handleWaitForRemoteTerminationTimeout, this));
@@ -81,9 +100,11 @@ OutgoingJingleFileTransfer::~OutgoingJingleFileTransfer() {
     }
 
     stream->onRead.disconnect(
-            boost::bind(&IncrementalBytestreamHashCalculator::feedData, hashCalculator, _1));
-    delete hashCalculator;
-    hashCalculator = nullptr;
+            boost::bind(&OutgoingJingleFileTransfer::handleStreamRead, this, _1));
+    hashCalculator->onReady.disconnect(boost::bind(&OutgoingJingleFileTransfer::handleHashCalculatorReady, this));
+    hashCalculator->onFinished.disconnect(boost::bind(&OutgoingJingleFileTransfer::handleHashCalculated, this));
+    hashCalculator.reset();
+    eventLoop->removeEventsFromOwner(eventOwner);
     removeTransporter();
 }
 
@@ -121,11 +142,16 @@ void OutgoingJingleFileTransfer::terminate(JinglePayload::Reason::Type reason) {
 
 void OutgoingJingleFileTransfer::handleSessionAcceptReceived(
         const JingleContentID&,
-        JingleDescription::ref,
+        JingleDescription::ref description,
         JingleTransportPayload::ref transportPayload) {
     SWIFT_LOG(debug) << std::endl;
     if (state != WaitingForAccept) { SWIFT_LOG(warning) << "Incorrect state" << std::endl; return; }
 
+    if (!skipReceivedData(std::dynamic_pointer_cast<JingleFileTransferDescription>(description))) {
+        terminate(JinglePayload::Reason::FailedApplication);
+        return;
+    }
+
     if (JingleS5BTransportPayload::ref s5bPayload = std::dynamic_pointer_cast<JingleS5BTransportPayload>(transportPayload)) {
         transporter->addRemoteCandidates(s5bPayload->getCandidates(), s5bPayload->getDstAddr());
         setInternalState(TryingCandidates);
@@ -140,6 +166,61 @@ void OutgoingJingleFileTransfer::handleSessionAcceptReceived(
     }
 }
 
+bool OutgoingJingleFileTransfer::skipReceivedData(JingleFileTransferDescription::ref description) {
+    if (!description || !description->getFileInfo().getSupportsRangeRequests()) {
+        return true;
+    }
+    boost::uintmax_t offset = description->getFileInfo().getRangeOffset();
+    if (offset <= getRangeOffset()) {
+        return true;
+    }
+    if (offset >= getRangeOffset() + getRangeLength()) {
+        SWIFT_LOG(warning) << "Accepted range offset " << offset << " is outside of the offered range" << std::endl;
+        return false;
+    }
+
+    // The hash announced to the responder covers all of the offered data,
+    // so the skipped data can't just be seeked over. It is still read (and
+    // hashed), a block per event, but it is not sent: the transport stays
+    // paused until all of it is read.
+    SWIFT_LOG(debug) << "Resuming at offset " << offset << std::endl;
+    bytesToSkip = offset - getRangeOffset();
+    setRange(offset, getRangeLength() - bytesToSkip);
+    eventLoop->postEvent(boost::bind(&OutgoingJingleFileTransfer::skipReceivedDataBlock, this), eventOwner);
+    return true;
+}
+
+void OutgoingJingleFileTransfer::skipReceivedDataBlock() {
+    if (state == Finished || bytesToSkip == 0) {
+        return;
+    }
+    try {
+        std::shared_ptr<ByteArray> data = stream->read(static_cast<size_t>(std::min<boost::uintmax_t>(bytesToSkip, SKIP_BLOCK_SIZE)));
+        if (data->empty()) {
+            SWIFT_LOG(warning) << "Bytestream ended before the accepted range offset" << std::endl;
+            terminate(JinglePayload::Reason::FailedApplication);
+            return;
+        }
+        bytesToSkip -= std::min<boost::uintmax_t>(data->size(), bytesToSkip);
+    }
+    catch (const BytestreamException&) {
+        SWIFT_LOG(warning) << "Unable to read the data before the accepted range offset" << std::endl;
+        terminate(JinglePayload::Reason::FailedApplication);
+        return;
+    }
+
+    if (hashCalculator->isBusy()) {
+        // Continued when the calculator is ready
+        return;
+    }
+    if (bytesToSkip > 0) {
+        eventLoop->postEvent(boost::bind(&OutgoingJingleFileTransfer::skipReceivedDataBlock, this), eventOwner);
+    }
+    else if (transportSession) {
+        transportSession->resume();
+    }
+}
+
 void OutgoingJingleFileTransfer::handleSessionTerminateReceived(boost::optional<JinglePayload::Reason> reason) {
     SWIFT_LOG(debug) << std::endl;
     if (state == Finished) { SWIFT_LOG(warning) << "Incorrect state: " << state << std::endl; return; }
@@ -185,8 +266,11 @@ void OutgoingJingleFileTransfer::sendSessionInfoHash() {
     SWIFT_LOG(debug) << std::endl;
 
     JingleFileTransferHash::ref hashElement = std::make_shared<JingleFileTransferHash>();
-    hashElement->getFileInfo().addHash(HashElement("sha-1", hashCalculator->getSHA1Hash()));
-    hashElement->getFileInfo().addHash(HashElement("md5", hashCalculator->getMD5Hash()));
+    foreach (const std::string& algorithm, options.getHashAlgorithms()) {
+        if (hashCalculator->hasHash(algorithm)) {
+            hashElement->getFileInfo().addHash(HashElement(algorithm, hashCalculator->getHash(algorithm)));
+        }
+    }
     session->sendInfo(hashElement);
 }
 
@@ -198,15 +282,18 @@ void OutgoingJingleFileTransfer::handleLocalTransportCandidatesGenerated(
     fillCandidateMap(localCandidates, candidates);
 
     JingleFileTransferDescription::ref description = std::make_shared<JingleFileTransferDescription>();
-    fileInfo.addHash(HashElement("sha-1", ByteArray()));
-    fileInfo.addHash(HashElement("md5", ByteArray()));
+    foreach (const std::string& algorithm, options.getHashAlgorithms()) {
+        if (hashCalculator->hasHash(algorithm)) {
+            fileInfo.addHash(HashElement(algorithm, ByteArray()));
+        }
+    }
     description->setFileInfo(fileInfo);
 
     JingleTransportPayload::ref transport;
     if (candidates.empty()) {
         SWIFT_LOG(debug) << "no S5B candidates generated. Send IBB transport candidate." << std::endl;
         JingleIBBTransportPayload::ref ibbTransport = std::make_shared<JingleIBBTransportPayload>();
-        ibbTransport->setBlockSize(DEFAULT_BLOCK_SIZE);
+        ibbTransport->setBlockSize(options.getInBandBlockSize());
         ibbTransport->setSessionID(idGenerator->generateID());
         transport = ibbTransport;
     }
@@ -229,7 +316,7 @@ void OutgoingJingleFileTransfer::fallback() {
     if (options.isInBandAllowed()) {
         SWIFT_LOG(debug) << "Trying to fallback to IBB transport." << std::endl;
         JingleIBBTransportPayload::ref ibbTransport = std::make_shared<JingleIBBTransportPayload>();
-        ibbTransport->setBlockSize(DEFAULT_BLOCK_SIZE);
+        ibbTransport->setBlockSize(options.getInBandBlockSize());
         ibbTransport->setSessionID(idGenerator->generateID());
         setInternalState(FallbackRequested);
         session->sendTransportReplace(contentID, ibbTransport);
@@ -248,14 +335,38 @@ void OutgoingJingleFileTransfer::handleTransferFinished(boost::optional<FileTran
         terminate(JinglePayload::Reason::ConnectivityError);
     }
     else {
-        sendSessionInfoHash();
+        hashCalculator->finish();
+    }
+}
 
-        // wait for other party to terminate session after they have verified the hash
-        setInternalState(WaitForTermination);
-        waitForRemoteTermination->start();
+void OutgoingJingleFileTransfer::handleStreamRead(const std::vector<unsigned char>& data) {
+    hashCalculator->feedData(data);
+    if (hashCalculator->isBusy() && transportSession) {
+        // Don't read ahead of the hashing
+        transportSession->pause();
     }
 }
 
+void OutgoingJingleFileTransfer::handleHashCalculatorReady() {
+    if (bytesToSkip > 0) {
+        eventLoop->postEvent(boost::bind(&OutgoingJingleFileTransfer::skipReceivedDataBlock, this), eventOwner);
+    }
+    else if (transportSession) {
+        transportSession->resume();
+    }
+}
+
+void OutgoingJingleFileTransfer::handleHashCalculated() {
+    SWIFT_LOG(debug) << std::endl;
+    if (state != Transferring) { SWIFT_LOG(warning) << "Incorrect state: " << state << std::endl; return; }
+
+    sendSessionInfoHash();
+
+    // wait for other party to terminate session after they have verified the hash
+    setInternalState(WaitForTermination);
+    waitForRemoteTermination->start();
+}
+
 void OutgoingJingleFileTransfer::startTransferring(std::shared_ptr<TransportSession> transportSession) {
     SWIFT_LOG(debug) << std::endl;
 
@@ -265,6 +376,10 @@ void OutgoingJingleFileTransfer::startTransferring(std::shared_ptr<TransportSess
     transferFinishedConnection = transportSession->onFinished.connect(
             boost::bind(&OutgoingJingleFileTransfer::handleTransferFinished, this, _1));
     setInternalState(Transferring);
+    if (bytesToSkip > 0) {
+        // Resumed once the data before the accepted range offset is read
+        transportSession->pause();
+    }
     transportSession->start();
 }
 
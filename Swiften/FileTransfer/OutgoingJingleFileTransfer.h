@@ -14,6 +14,7 @@
 
 #include <memory>
 
+#include <boost/cstdint.hpp>
 #include <boost/optional/optional.hpp>
 
 #include <Swiften/Base/API.h>
@@ -27,10 +28,13 @@
 
 namespace Swift {
     class CryptoProvider;
+    class EventLoop;
+    class EventOwner;
     class FileTransferTransporter;
     class FileTransferTransporterFactory;
     class IDGenerator;
     class IncrementalBytestreamHashCalculator;
+    class JingleFileTransferDescription;
     class ReadBytestream;
     class TimerFactory;
     class TransportSession;
@@ -46,7 +50,8 @@ namespace Swift {
                 IDGenerator*,
                 const JingleFileTransferFileInfo&,
                 const FileTransferOptions&,
-                CryptoProvider*);
+                CryptoProvider*,
+                EventLoop*);
             virtual ~OutgoingJingleFileTransfer();
 
             virtual void start() SWIFTEN_OVERRIDE;
@@ -68,6 +73,8 @@ namespace Swift {
             };
 
             virtual void handleSessionAcceptReceived(const JingleContentID&, std::shared_ptr<JingleDescription>, std::shared_ptr<JingleTransportPayload>) SWIFTEN_OVERRIDE;
+            bool skipReceivedData(std::shared_ptr<JingleFileTransferDescription>);
+            void skipReceivedDataBlock();
             virtual void handleSessionTerminateReceived(boost::optional<JinglePayload::Reason> reason) SWIFTEN_OVERRIDE;
             virtual void handleTransportAcceptReceived(const JingleContentID&, std::shared_ptr<JingleTransportPayload>) SWIFTEN_OVERRIDE;
             virtual void handleTransportRejectReceived(const JingleContentID &, std::shared_ptr<JingleTransportPayload>) SWIFTEN_OVERRIDE;
@@ -84,6 +91,9 @@ namespace Swift {
 
             virtual void fallback() SWIFTEN_OVERRIDE;
             void handleTransferFinished(boost::optional<FileTransferError>);
+            void handleHashCalculated();
+            void handleStreamRead(const std::vector<unsigned char>& data);
+            void handleHashCalculatorReady();
 
             void sendSessionInfoHash();
 
@@ -105,14 +115,17 @@ namespace Swift {
             static FileTransfer::State::Type getExternalState(State state);
 
         private:
+            EventLoop* eventLoop;
+            std::shared_ptr<EventOwner> eventOwner;
             IDGenerator* idGenerator;
             std::shared_ptr<ReadBytestream> stream;
             JingleFileTransferFileInfo fileInfo;
             FileTransferOptions options;
             JingleContentID contentID;
-            IncrementalBytestreamHashCalculator* hashCalculator;
+            std::shared_ptr<IncrementalBytestreamHashCalculator> hashCalculator;
             State state;
             bool candidateAcknowledged;
+            boost::uintmax_t bytesToSkip;
 
             Timer::ref waitForRemoteTermination;
 
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/ParallelIncomingFileTransfer.h>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Base/Log.h>
+#include <Swiften/Base/foreach.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+
+using namespace Swift;
+
+namespace {
+    /**
+     * Writes the data of a range at its offset in the file.
+     */
+    class RangeWriteBytestream : public WriteBytestream {
+        public:
+            RangeWriteBytestream(std::shared_ptr<FileDescriptorWriteBytestream> file, boost::uint64_t offset) : file(file), position(offset) {
+            }
+
+            virtual bool write(const std::vector<unsigned char>& data) {
+                if (!file->writeAt(position, data)) {
+                    return false;
+                }
+                position += data.size();
+                onWrite(data);
+                return true;
+            }
+
+        private:
+            std::shared_ptr<FileDescriptorWriteBytestream> file;
+            boost::uint64_t position;
+    };
+}
+
+ParallelIncomingFileTransfer::ParallelIncomingFileTransfer(IncomingFileTransfer::ref transfer) :
+            sender(transfer->getSender()),
+            recipient(transfer->getRecipient()),
+            finishedTransfers(0),
+            canceled(false) {
+    setFileInfo(transfer->getFileName(), transfer->getFileSizeInBytes(), transfer->getDescription());
+    setState(transfer->getState());
+    addTransfer(transfer);
+}
+
+ParallelIncomingFileTransfer::~ParallelIncomingFileTransfer() {
+    foreach (boost::signals2::connection& connection, connections) {
+        connection.disconnect();
+    }
+}
+
+bool ParallelIncomingFileTransfer::isRangeOfSameFile(IncomingFileTransfer::ref transfer) const {
+    return transfer->getSender() == sender && transfer->getFileName() == getFileName() && transfer->getFileSizeInBytes() == getFileSizeInBytes();
+}
+
+bool ParallelIncomingFileTransfer::addTransfer(IncomingFileTransfer::ref transfer) {
+    if (isFinalState(getState().type) || failedState) {
+        return false;
+    }
+    foreach (IncomingFileTransfer::ref other, transfers) {
+        if (transfer->getRangeOffset() < other->getRangeOffset() + other->getRangeLength() && other->getRangeOffset() < transfer->getRangeOffset() + transfer->getRangeLength()) {
+            return false;
+        }
+    }
+
+    size_t index = transfers.size();
+    transfers.push_back(transfer);
+    states.push_back(transfer->getState().type);
+    rangeStreams.push_back(std::shared_ptr<WriteBytestream>());
+    connections.push_back(transfer->onStateChanged.connect(boost::bind(&ParallelIncomingFileTransfer::handleStateChanged, this, index, _1)));
+    connections.push_back(transfer->onFinished.connect(boost::bind(&ParallelIncomingFileTransfer::handleFinished, this, index, _1)));
+    connections.push_back(transfer->onProcessedBytes.connect(boost::bind(&ParallelIncomingFileTransfer::handleProcessedBytes, this, _1)));
+    if (options) {
+        acceptTransfer(index);
+    }
+    return true;
+}
+
+bool ParallelIncomingFileTransfer::isComplete() const {
+    // Ranges don't overlap, so they cover the file if their sizes add up
+    boost::uintmax_t size = 0;
+    foreach (IncomingFileTransfer::ref transfer, transfers) {
+        size += transfer->getRangeLength();
+    }
+    return size == getFileSizeInBytes();
+}
+
+void ParallelIncomingFileTransfer::accept(std::shared_ptr<WriteBytestream> stream, const FileTransferOptions& options) {
+    this->stream = std::dynamic_pointer_cast<FileDescriptorWriteBytestream>(stream);
+    if (!this->stream) {
+        SWIFT_LOG(warning) << "Ranges can only be written to a FileDescriptorWriteBytestream" << std::endl;
+        fail(FileTransferError(FileTransferError::WriteError));
+        return;
+    }
+    this->options = options;
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        acceptTransfer(i);
+    }
+}
+
+bool ParallelIncomingFileTransfer::resume(std::shared_ptr<WriteBytestream>, std::shared_ptr<ReadBytestream>, boost::uintmax_t, const FileTransferOptions&) {
+    return false;
+}
+
+void ParallelIncomingFileTransfer::acceptTransfer(size_t index) {
+    rangeStreams[index] = std::make_shared<RangeWriteBytestream>(stream, transfers[index]->getRangeOffset());
+    transfers[index]->accept(rangeStreams[index], *options);
+}
+
+void ParallelIncomingFileTransfer::cancel() {
+    canceled = true;
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        if (!isFinalState(states[i])) {
+            transfers[i]->cancel();
+        }
+    }
+}
+
+void ParallelIncomingFileTransfer::fail(const FileTransferError& error) {
+    failedState = State::Failed;
+    this->error = error;
+    cancel();
+    checkFinished();
+}
+
+bool ParallelIncomingFileTransfer::isFinalState(State::Type type) {
+    return type == State::Canceled || type == State::Failed || type == State::Finished;
+}
+
+void ParallelIncomingFileTransfer::checkFinished() {
+    // Until it failed, the transfer also waits for the ranges that were not
+    // offered yet.
+    if (finishedTransfers == transfers.size() && (failedState || isComplete()) && !isFinalState(getState().type)) {
+        if (canceled && !failedState) {
+            failedState = State::Canceled;
+        }
+        setState(failedState ? State(*failedState) : State(State::Finished));
+        onFinished(this->error);
+    }
+}
+
+void ParallelIncomingFileTransfer::handleStateChanged(size_t index, const State& state) {
+    states[index] = state.type;
+    // The overall transfer is as far along as its furthest range, until all
+    // ranges are done.
+    if (!isFinalState(state.type) && state.type > getState().type) {
+        setState(state);
+    }
+}
+
+void ParallelIncomingFileTransfer::handleFinished(size_t index, boost::optional<FileTransferError> error) {
+    ++finishedTransfers;
+    if (states[index] != State::Finished && !failedState) {
+        failedState = isFinalState(states[index]) ? states[index] : State::Failed;
+        this->error = error;
+        if (!canceled) {
+            cancel();
+        }
+    }
+    checkFinished();
+}
+
+void ParallelIncomingFileTransfer::handleProcessedBytes(size_t bytes) {
+    onProcessedBytes(bytes);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/signals2.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/Override.h>
+#include <Swiften/FileTransfer/FileTransferError.h>
+#include <Swiften/FileTransfer/FileTransferOptions.h>
+#include <Swiften/FileTransfer/IncomingFileTransfer.h>
+#include <Swiften/JID/JID.h>
+
+namespace Swift {
+    class FileDescriptorWriteBytestream;
+
+    /**
+     * An incoming file transfer that receives a file sent as a number of
+     * ranges, each in its own file transfer (see
+     * \ref ParallelOutgoingFileTransfer). Only offers from a sender that
+     * advertises \ref DiscoInfo::JingleFTParallelRangesFeature are taken
+     * to be such ranges.
+     *
+     * The ranges are offered separately, and are added to the transfer as
+     * they come in. All ranges are written into the same file, each at its
+     * offset. Every range is verified against its own hash, so the file as
+     * a whole is verified once the ranges cover all of it, and all of them
+     * finished.
+     *
+     * When one of the ranges fails or is canceled, the others are canceled as
+     * well.
+     */
+    class SWIFTEN_API ParallelIncomingFileTransfer : public IncomingFileTransfer {
+        public:
+            typedef std::shared_ptr<ParallelIncomingFileTransfer> ref;
+
+        public:
+            ParallelIncomingFileTransfer(IncomingFileTransfer::ref transfer);
+            virtual ~ParallelIncomingFileTransfer();
+
+            /**
+             * Returns whether \p transfer offers a range of the same file as
+             * this transfer.
+             */
+            bool isRangeOfSameFile(IncomingFileTransfer::ref transfer) const;
+
+            /**
+             * Adds another range of the file. If the transfer was accepted
+             * already, the range is accepted right away.
+             *
+             * Returns false, without adding it, if the range overlaps one of
+             * the ranges added before, or if the transfer is finished.
+             */
+            bool addTransfer(IncomingFileTransfer::ref transfer);
+
+            /**
+             * Returns whether the ranges added so far cover the whole file.
+             */
+            bool isComplete() const;
+
+            /**
+             * Accepts all ranges. As the ranges are written at their offsets,
+             * the bytestream must be a \ref FileDescriptorWriteBytestream;
+             * with any other bytestream, the transfer fails.
+             */
+            virtual void accept(std::shared_ptr<WriteBytestream>, const FileTransferOptions& = FileTransferOptions()) SWIFTEN_OVERRIDE;
+
+            /**
+             * Resuming a file that is sent in ranges is not supported, so this
+             * always returns false.
+             */
+            virtual bool resume(std::shared_ptr<WriteBytestream>, std::shared_ptr<ReadBytestream>, boost::uintmax_t, const FileTransferOptions& = FileTransferOptions()) SWIFTEN_OVERRIDE;
+
+            virtual void cancel() SWIFTEN_OVERRIDE;
+
+            virtual const JID& getSender() const SWIFTEN_OVERRIDE {
+                return sender;
+            }
+
+            virtual const JID& getRecipient() const SWIFTEN_OVERRIDE {
+                return recipient;
+            }
+
+            const std::vector<IncomingFileTransfer::ref>& getTransfers() const {
+                return transfers;
+            }
+
+        private:
+            static bool isFinalState(State::Type type);
+
+            void acceptTransfer(size_t index);
+            void fail(const FileTransferError& error);
+            void checkFinished();
+            void handleStateChanged(size_t index, const State& state);
+            void handleFinished(size_t index, boost::optional<FileTransferError> error);
+            void handleProcessedBytes(size_t bytes);
+
+        private:
+            JID sender;
+            JID recipient;
+            std::vector<IncomingFileTransfer::ref> transfers;
+            std::vector<State::Type> states;
+            std::vector<boost::signals2::connection> connections;
+            size_t finishedTransfers;
+            bool canceled;
+            boost::optional<State::Type> failedState;
+            boost::optional<FileTransferError> error;
+            std::shared_ptr<FileDescriptorWriteBytestream> stream;
+            std::vector<std::shared_ptr<WriteBytestream> > rangeStreams;
+            boost::optional<FileTransferOptions> options;
+    };
+}
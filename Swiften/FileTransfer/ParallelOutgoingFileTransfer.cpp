@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/ParallelOutgoingFileTransfer.h>
+
+#include <boost/bind.hpp>
+
+#include <Swiften/Base/foreach.h>
+
+using namespace Swift;
+
+ParallelOutgoingFileTransfer::ParallelOutgoingFileTransfer(
+        const std::vector<OutgoingFileTransfer::ref>& transfers,
+        const std::string& name,
+        boost::uintmax_t size,
+        const std::string& description) :
+            transfers(transfers),
+            states(transfers.size(), State::Initial),
+            finishedTransfers(0),
+            canceled(false) {
+    setFileInfo(name, size, description);
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        connections.push_back(transfers[i]->onStateChanged.connect(boost::bind(&ParallelOutgoingFileTransfer::handleStateChanged, this, i, _1)));
+        connections.push_back(transfers[i]->onFinished.connect(boost::bind(&ParallelOutgoingFileTransfer::handleFinished, this, i, _1)));
+        connections.push_back(transfers[i]->onProcessedBytes.connect(boost::bind(&ParallelOutgoingFileTransfer::handleProcessedBytes, this, _1)));
+    }
+}
+
+ParallelOutgoingFileTransfer::~ParallelOutgoingFileTransfer() {
+    foreach (boost::signals2::connection& connection, connections) {
+        connection.disconnect();
+    }
+}
+
+void ParallelOutgoingFileTransfer::start() {
+    foreach (OutgoingFileTransfer::ref transfer, transfers) {
+        transfer->start();
+    }
+}
+
+void ParallelOutgoingFileTransfer::cancel() {
+    canceled = true;
+    for (size_t i = 0; i < transfers.size(); ++i) {
+        if (!isFinalState(states[i])) {
+            transfers[i]->cancel();
+        }
+    }
+}
+
+bool ParallelOutgoingFileTransfer::isFinalState(State::Type type) {
+    return type == State::Canceled || type == State::Failed || type == State::Finished;
+}
+
+void ParallelOutgoingFileTransfer::handleStateChanged(size_t index, const State& state) {
+    states[index] = state.type;
+    // The overall transfer is as far along as its furthest range, until all
+    // ranges are done.
+    if (!isFinalState(state.type) && state.type > getState().type) {
+        setState(state);
+    }
+}
+
+void ParallelOutgoingFileTransfer::handleFinished(size_t index, boost::optional<FileTransferError> error) {
+    ++finishedTransfers;
+    if (states[index] != State::Finished && !failedState) {
+        failedState = isFinalState(states[index]) ? states[index] : State::Failed;
+        this->error = error;
+        if (!canceled) {
+            cancel();
+        }
+    }
+    // Canceling the other ranges above may already have finished the transfer
+    if (finishedTransfers == transfers.size() && !isFinalState(getState().type)) {
+        if (canceled && !failedState) {
+            failedState = State::Canceled;
+        }
+        setState(failedState ? State(*failedState) : State(State::Finished));
+        onFinished(this->error);
+    }
+}
+
+void ParallelOutgoingFileTransfer::handleProcessedBytes(size_t bytes) {
+    onProcessedBytes(bytes);
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/signals2.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/Override.h>
+#include <Swiften/FileTransfer/FileTransferError.h>
+#include <Swiften/FileTransfer/OutgoingFileTransfer.h>
+
+namespace Swift {
+    /**
+     * An outgoing file transfer that sends a file as a number of ranges, each
+     * in its own file transfer, so that the ranges are transferred in
+     * parallel.
+     *
+     * The transfer finishes when all ranges are transferred. When one of the
+     * ranges fails or is canceled, the others are canceled as well.
+     */
+    class SWIFTEN_API ParallelOutgoingFileTransfer : public OutgoingFileTransfer {
+        public:
+            typedef std::shared_ptr<ParallelOutgoingFileTransfer> ref;
+
+        public:
+            ParallelOutgoingFileTransfer(
+                    const std::vector<OutgoingFileTransfer::ref>& transfers,
+                    const std::string& name,
+                    boost::uintmax_t size,
+                    const std::string& description);
+            virtual ~ParallelOutgoingFileTransfer();
+
+            virtual void start() SWIFTEN_OVERRIDE;
+            virtual void cancel() SWIFTEN_OVERRIDE;
+
+            const std::vector<OutgoingFileTransfer::ref>& getTransfers() const {
+                return transfers;
+            }
+
+        private:
+            static bool isFinalState(State::Type type);
+
+            void handleStateChanged(size_t index, const State& state);
+            void handleFinished(size_t index, boost::optional<FileTransferError> error);
+            void handleProcessedBytes(size_t bytes);
+
+        private:
+            std::vector<OutgoingFileTransfer::ref> transfers;
+            std::vector<State::Type> states;
+            std::vector<boost::signals2::connection> connections;
+            size_t finishedTransfers;
+            bool canceled;
+            boost::optional<State::Type> failedState;
+            boost::optional<FileTransferError> error;
+    };
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/FileTransfer/PartialFileStorage.h>
+
+#include <iostream>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/Log.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/FileTransfer/BytestreamException.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+#include <Swiften/JID/JID.h>
+#include <Swiften/StringCodecs/Hexify.h>
+
+using namespace Swift;
+
+// The block size in which a partial file is copied to its destination.
+static const size_t COPY_BLOCK_SIZE = 1024 * 1024;
+
+PartialFileStorage::PartialFileStorage(const boost::filesystem::path& directory, CryptoProvider* crypto) : directory(directory), crypto(crypto) {
+    try {
+        if (!boost::filesystem::exists(directory)) {
+            boost::filesystem::create_directories(directory);
+        }
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+    }
+}
+
+PartialFileStorage::~PartialFileStorage() {
+    for (std::map<IncomingFileTransfer*, PartialTransfer>::iterator i = transfers.begin(); i != transfers.end(); ++i) {
+        i->second.finishedConnection.disconnect();
+    }
+}
+
+void PartialFileStorage::accept(IncomingFileTransfer::ref transfer, const boost::filesystem::path& destination, const FileTransferOptions& options) {
+    PartialTransfer& partialTransfer = transfers[transfer.get()];
+    partialTransfer.transfer = transfer;
+    partialTransfer.partialFile = getPartialFile(transfer);
+    partialTransfer.destination = destination;
+    partialTransfer.offset = transfer->getRangeOffset();
+    partialTransfer.length = transfer->getRangeLength();
+    partialTransfer.finishedConnection = transfer->onFinished.connect(boost::bind(&PartialFileStorage::handleTransferFinished, this, transfer.get(), _1));
+
+    boost::uintmax_t receivedSize = getReceivedSize(transfer);
+    if (receivedSize > 0 && receivedSize < partialTransfer.length) {
+        SWIFT_LOG(debug) << "Resuming " << transfer->getFileName() << " after " << receivedSize << " bytes" << std::endl;
+        if (transfer->resume(
+                std::make_shared<FileDescriptorWriteBytestream>(partialTransfer.partialFile, receivedSize),
+                std::make_shared<FileDescriptorReadBytestream>(partialTransfer.partialFile, 0, receivedSize),
+                partialTransfer.offset + receivedSize,
+                options)) {
+            return;
+        }
+    }
+
+    boost::system::error_code error;
+    boost::filesystem::remove(partialTransfer.partialFile, error);
+    transfer->accept(std::make_shared<FileDescriptorWriteBytestream>(partialTransfer.partialFile), options);
+}
+
+boost::uintmax_t PartialFileStorage::getReceivedSize(IncomingFileTransfer::ref transfer) const {
+    boost::system::error_code error;
+    boost::uintmax_t size = boost::filesystem::file_size(getPartialFile(transfer), error);
+    return error ? 0 : size;
+}
+
+boost::filesystem::path PartialFileStorage::getPartialFile(IncomingFileTransfer::ref transfer) const {
+    std::string id = transfer->getSender().toBare().toString() + "\n" + transfer->getFileName() + "\n"
+            + boost::lexical_cast<std::string>(transfer->getFileSizeInBytes()) + "\n"
+            + boost::lexical_cast<std::string>(transfer->getRangeOffset()) + "\n"
+            + boost::lexical_cast<std::string>(transfer->getRangeLength());
+    return directory / (Hexify::hexify(crypto->getSHA1Hash(createByteArray(id))) + ".part");
+}
+
+void PartialFileStorage::handleTransferFinished(IncomingFileTransfer* transfer, boost::optional<FileTransferError> error) {
+    std::map<IncomingFileTransfer*, PartialTransfer>::iterator i = transfers.find(transfer);
+    if (i == transfers.end()) {
+        return;
+    }
+    PartialTransfer partialTransfer = i->second;
+    partialTransfer.finishedConnection.disconnect();
+    transfers.erase(i);
+
+    boost::system::error_code errorCode;
+    boost::uintmax_t receivedSize = boost::filesystem::file_size(partialTransfer.partialFile, errorCode);
+    bool complete = !errorCode && receivedSize == partialTransfer.length;
+    if (!error && complete) {
+        if (!storeFile(partialTransfer)) {
+            error = FileTransferError(FileTransferError::WriteError);
+        }
+        boost::filesystem::remove(partialTransfer.partialFile, errorCode);
+    }
+    else if (complete) {
+        SWIFT_LOG(debug) << "Dropping received data of " << partialTransfer.transfer->getFileName() << std::endl;
+        boost::filesystem::remove(partialTransfer.partialFile, errorCode);
+    }
+    onTransferFinished(partialTransfer.transfer, error);
+}
+
+bool PartialFileStorage::storeFile(const PartialTransfer& partialTransfer) {
+    boost::system::error_code errorCode;
+    if (partialTransfer.offset == 0 && partialTransfer.length == partialTransfer.transfer->getFileSizeInBytes()) {
+        boost::filesystem::remove(partialTransfer.destination, errorCode);
+        boost::filesystem::rename(partialTransfer.partialFile, partialTransfer.destination, errorCode);
+        if (!errorCode) {
+            return true;
+        }
+    }
+
+    // Ranges of a file are written into place, and files are copied when they
+    // cannot be moved
+    try {
+        FileDescriptorReadBytestream input(partialTransfer.partialFile);
+        FileDescriptorWriteBytestream output(partialTransfer.destination, partialTransfer.offset);
+        if (input.getFileDescriptor() < 0) {
+            return false;
+        }
+        while (!input.isFinished()) {
+            std::shared_ptr<ByteArray> data = input.read(COPY_BLOCK_SIZE);
+            if (data->empty() || !output.write(*data)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    catch (const BytestreamException&) {
+        return false;
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <boost/cstdint.hpp>
+#include <boost/filesystem/path.hpp>
+#include <boost/optional.hpp>
+#include <boost/signals2.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/FileTransfer/FileTransferError.h>
+#include <Swiften/FileTransfer/FileTransferOptions.h>
+#include <Swiften/FileTransfer/IncomingFileTransfer.h>
+
+namespace Swift {
+    class CryptoProvider;
+
+    /**
+     * Receives incoming file transfers through a directory of partial files,
+     * so that a transfer that stops before it is complete can be resumed
+     * when the same file is offered again.
+     *
+     * A file is identified by its sender, name, size and offered range. What
+     * was received of it is kept in the storage directory, and is only moved
+     * to its destination when the transfer finishes. If all data was received
+     * but the transfer still failed, the data did not match its hash, and it
+     * is dropped.
+     */
+    class SWIFTEN_API PartialFileStorage {
+        public:
+            PartialFileStorage(const boost::filesystem::path& directory, CryptoProvider* crypto);
+            ~PartialFileStorage();
+
+            /**
+             * Accepts \p transfer, resuming it if part of the same file was
+             * received before. The received range of the file is written to
+             * \p destination when the transfer finishes.
+             */
+            void accept(IncomingFileTransfer::ref transfer, const boost::filesystem::path& destination, const FileTransferOptions& = FileTransferOptions());
+
+            /**
+             * Returns the number of bytes received before of the file offered
+             * by \p transfer.
+             */
+            boost::uintmax_t getReceivedSize(IncomingFileTransfer::ref transfer) const;
+
+        public:
+            /**
+             * Emitted when an accepted transfer finished, after its data was
+             * written to its destination.
+             */
+            boost::signals2::signal<void (IncomingFileTransfer::ref, boost::optional<FileTransferError>)> onTransferFinished;
+
+        private:
+            struct PartialTransfer {
+                IncomingFileTransfer::ref transfer;
+                boost::filesystem::path partialFile;
+                boost::filesystem::path destination;
+                boost::uintmax_t offset;
+                boost::uintmax_t length;
+                boost::signals2::connection finishedConnection;
+            };
+
+            boost::filesystem::path getPartialFile(IncomingFileTransfer::ref transfer) const;
+            void handleTransferFinished(IncomingFileTransfer* transfer, boost::optional<FileTransferError> error);
+            bool storeFile(const PartialTransfer& partialTransfer);
+
+        private:
+            boost::filesystem::path directory;
+            CryptoProvider* crypto;
+            std::map<IncomingFileTransfer*, PartialTransfer> transfers;
+    };
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -11,4 +11,13 @@ namespace Swift {
 ReadBytestream::~ReadBytestream() {
 }
 
+ReadBytestream::View ReadBytestream::readView(size_t size) {
+    std::shared_ptr< std::vector<unsigned char> > data = read(size);
+    View result;
+    result.data = data->empty() ? nullptr : &(*data)[0];
+    result.size = data->size();
+    result.owner = data;
+    return result;
+}
+
 }
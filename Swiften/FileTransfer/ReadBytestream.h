@@ -15,6 +15,19 @@
 
 namespace Swift {
     class SWIFTEN_API ReadBytestream {
+        public:
+            /**
+             * A chunk of data returned by readView(). The data stays valid
+             * for as long as the view (or a copy of it) is held.
+             */
+            struct View {
+                View() : data(nullptr), size(0) {}
+
+                const unsigned char* data;
+                size_t size;
+                std::shared_ptr<const void> owner;
+            };
+
         public:
             virtual ~ReadBytestream();
 
@@ -24,6 +37,13 @@ namespace Swift {
              */
             virtual std::shared_ptr< std::vector<unsigned char> > read(size_t size) = 0;
 
+            /**
+             * Like read(), but returns a view on the data instead of a copy.
+             *
+             * The default implementation wraps the result of read().
+             */
+            virtual View readView(size_t size);
+
             virtual bool isFinished() const = 0;
 
         public:
@@ -12,6 +12,8 @@
 
 #include <Swiften/FileTransfer/RemoteJingleTransportCandidateSelector.h>
 
+#include <algorithm>
+#include <cassert>
 #include <memory>
 
 #include <boost/bind.hpp>
@@ -22,74 +24,157 @@
 #include <Swiften/Elements/JingleS5BTransportPayload.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
 #include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/TimerFactory.h>
 
 using namespace Swift;
 
+static bool hasHigherPriority(const JingleS5BTransportPayload::Candidate& c1, const JingleS5BTransportPayload::Candidate& c2) {
+    return JingleS5BTransportPayload::CompareCandidate()(c2, c1);
+}
+
 RemoteJingleTransportCandidateSelector::RemoteJingleTransportCandidateSelector(
         ConnectionFactory* connectionFactory,
         TimerFactory* timerFactory,
         const FileTransferOptions& options) :
             connectionFactory(connectionFactory),
             timerFactory(timerFactory),
+            selectionTimedOut(false),
             options(options) {
 }
 
 RemoteJingleTransportCandidateSelector::~RemoteJingleTransportCandidateSelector() {
+    stopProbes(std::shared_ptr<SOCKS5BytestreamClientSession>());
 }
 
 void RemoteJingleTransportCandidateSelector::addCandidates(
         const std::vector<JingleS5BTransportPayload::Candidate>& candidates) {
     foreach(JingleS5BTransportPayload::Candidate c,  candidates) {
-        this->candidates.push(c);
+        this->candidates.push_back(c);
     }
 }
 
 void RemoteJingleTransportCandidateSelector::startSelectingCandidate() {
-    tryNextCandidate();
+    assert(probes.empty());
+
+    // Candidates with equal priority are tried in the order they were given
+    std::stable_sort(candidates.begin(), candidates.end(), &hasHigherPriority);
+    foreach(const JingleS5BTransportPayload::Candidate& candidate, candidates) {
+        if (isAllowed(candidate)) {
+            probes.push_back(Probe(candidate));
+        }
+        else {
+            SWIFT_LOG(debug) << "Can't handle this type of candidate" << std::endl;
+        }
+    }
+    candidates.clear();
+
+    if (probes.empty()) {
+        SWIFT_LOG(debug) << "No more candidates" << std::endl;
+        finishSelection(nullptr);
+        return;
+    }
+
+    selectionTimedOut = false;
+    selectionTimer = timerFactory->createTimer(options.getCandidateSelectionTimeout());
+    selectionTimer->onTick.connect(boost::bind(&RemoteJingleTransportCandidateSelector::handleSelectionTimeout, this));
+    selectionTimer->start();
+
+    // All sessions are created before any is started, so that a session
+    // failing right away does not end the selection early.
+    for (size_t i = 0; i < probes.size(); ++i) {
+        probes[i].session = std::make_shared<SOCKS5BytestreamClientSession>(
+                connectionFactory->createConnection(), probes[i].candidate.hostPort, socks5DstAddr, timerFactory);
+        probes[i].sessionReadyConnection = probes[i].session->onSessionReady.connect(
+                boost::bind(&RemoteJingleTransportCandidateSelector::handleSessionReady, this, i, _1));
+    }
+    std::vector<std::shared_ptr<SOCKS5BytestreamClientSession> > sessions;
+    foreach(const Probe& probe, probes) {
+        sessions.push_back(probe.session);
+    }
+    foreach(std::shared_ptr<SOCKS5BytestreamClientSession> session, sessions) {
+        if (probes.empty()) {
+            break;
+        }
+        SWIFT_LOG(debug) << "Trying candidate at " << session->getAddressPort().toString() << std::endl;
+        session->start();
+    }
 }
 
 void RemoteJingleTransportCandidateSelector::stopSelectingCandidate() {
-    if (s5bSession) {
-        sessionReadyConnection.disconnect();
-        s5bSession->stop();
-    }
+    stopProbes(std::shared_ptr<SOCKS5BytestreamClientSession>());
 }
 
-void RemoteJingleTransportCandidateSelector::tryNextCandidate() {
-    if (candidates.empty()) {
-        SWIFT_LOG(debug) << "No more candidates" << std::endl;
-        onCandidateSelectFinished(
-                boost::optional<JingleS5BTransportPayload::Candidate>(), std::shared_ptr<SOCKS5BytestreamClientSession>());
+bool RemoteJingleTransportCandidateSelector::isAllowed(const JingleS5BTransportPayload::Candidate& candidate) const {
+    return (candidate.type == JingleS5BTransportPayload::Candidate::DirectType && options.isDirectAllowed()) ||
+        (candidate.type == JingleS5BTransportPayload::Candidate::AssistedType && options.isAssistedAllowed()) ||
+        (candidate.type == JingleS5BTransportPayload::Candidate::ProxyType && options.isProxiedAllowed());
+}
+
+void RemoteJingleTransportCandidateSelector::handleSessionReady(size_t probe, bool error) {
+    if (probe >= probes.size()) {
+        return;
+    }
+    probes[probe].sessionReadyConnection.disconnect();
+    SWIFT_LOG(debug) << "Candidate " << probes[probe].candidate.cid << (error ? " failed" : " connected") << std::endl;
+    if (error) {
+        probes[probe].state = Probe::Failed;
+        probes[probe].session.reset();
     }
     else {
-        lastCandidate = candidates.top();
-        candidates.pop();
-        SWIFT_LOG(debug) << "Trying candidate " << lastCandidate.cid << std::endl;
-        if ((lastCandidate.type == JingleS5BTransportPayload::Candidate::DirectType && options.isDirectAllowed()) ||
-            (lastCandidate.type == JingleS5BTransportPayload::Candidate::AssistedType && options.isAssistedAllowed()) ||
-            (lastCandidate.type == JingleS5BTransportPayload::Candidate::ProxyType && options.isProxiedAllowed())) {
-            std::shared_ptr<Connection> connection = connectionFactory->createConnection();
-            s5bSession = std::make_shared<SOCKS5BytestreamClientSession>(
-                    connection, lastCandidate.hostPort, socks5DstAddr, timerFactory);
-            sessionReadyConnection = s5bSession->onSessionReady.connect(
-                    boost::bind(&RemoteJingleTransportCandidateSelector::handleSessionReady, this, _1));
-            s5bSession->start();
+        probes[probe].state = Probe::Connected;
+    }
+    checkProbes();
+}
+
+void RemoteJingleTransportCandidateSelector::handleSelectionTimeout() {
+    SWIFT_LOG(debug) << "Candidate selection timed out" << std::endl;
+    selectionTimedOut = true;
+    checkProbes();
+}
+
+void RemoteJingleTransportCandidateSelector::checkProbes() {
+    bool connecting = false;
+    for (size_t i = 0; i < probes.size(); ++i) {
+        if (probes[i].state == Probe::Connected) {
+            if (!connecting || selectionTimedOut) {
+                finishSelection(&probes[i]);
+                return;
+            }
         }
-        else {
-            SWIFT_LOG(debug) << "Can't handle this type of candidate" << std::endl;
-            tryNextCandidate();
+        else if (probes[i].state == Probe::Connecting) {
+            connecting = true;
         }
     }
+    if (!connecting && !probes.empty()) {
+        SWIFT_LOG(debug) << "No more candidates" << std::endl;
+        finishSelection(nullptr);
+    }
 }
 
-void RemoteJingleTransportCandidateSelector::handleSessionReady(bool error) {
-    sessionReadyConnection.disconnect();
-    if (error) {
-        s5bSession.reset();
-        tryNextCandidate();
+void RemoteJingleTransportCandidateSelector::finishSelection(Probe* selectedProbe) {
+    boost::optional<JingleS5BTransportPayload::Candidate> candidate;
+    std::shared_ptr<SOCKS5BytestreamClientSession> session;
+    if (selectedProbe) {
+        candidate = selectedProbe->candidate;
+        session = selectedProbe->session;
     }
-    else {
-        onCandidateSelectFinished(lastCandidate, s5bSession);
+    stopProbes(session);
+    onCandidateSelectFinished(candidate, session);
+}
+
+void RemoteJingleTransportCandidateSelector::stopProbes(std::shared_ptr<SOCKS5BytestreamClientSession> selectedSession) {
+    if (selectionTimer) {
+        selectionTimer->onTick.disconnect(boost::bind(&RemoteJingleTransportCandidateSelector::handleSelectionTimeout, this));
+        selectionTimer->stop();
+        selectionTimer.reset();
+    }
+    std::vector<Probe> stoppedProbes;
+    stoppedProbes.swap(probes);
+    foreach(Probe& probe, stoppedProbes) {
+        probe.sessionReadyConnection.disconnect();
+        if (probe.session && probe.session != selectedSession) {
+            probe.session->stop();
+        }
     }
 }
 
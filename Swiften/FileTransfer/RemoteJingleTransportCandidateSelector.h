@@ -15,7 +15,6 @@
 #include <Swiften/FileTransfer/RemoteJingleTransportCandidateSelector.h>
 
 #include <memory>
-#include <queue>
 #include <vector>
 
 #include <Swiften/Base/Override.h>
@@ -24,11 +23,20 @@
 #include <Swiften/FileTransfer/SOCKS5BytestreamClientSession.h>
 #include <Swiften/JID/JID.h>
 #include <Swiften/Network/Connection.h>
+#include <Swiften/Network/Timer.h>
 
 namespace Swift {
     class ConnectionFactory;
     class TimerFactory;
 
+    /**
+     * Connects to all remote candidates at once, and selects the candidate
+     * with the highest priority that could be connected to.
+     *
+     * A candidate that is connected waits for candidates with a higher
+     * priority that are still being tried, until the candidate selection
+     * timeout of the file transfer options has passed.
+     */
     class RemoteJingleTransportCandidateSelector {
         public:
             RemoteJingleTransportCandidateSelector(ConnectionFactory*, TimerFactory*, const FileTransferOptions&);
@@ -42,20 +50,32 @@ namespace Swift {
             boost::signals2::signal<void (const boost::optional<JingleS5BTransportPayload::Candidate>&, std::shared_ptr<SOCKS5BytestreamClientSession>)> onCandidateSelectFinished;
 
         private:
-            void tryNextCandidate();
-            void handleSessionReady(bool error);
+            struct Probe {
+                enum State { Connecting, Connected, Failed };
+
+                Probe(const JingleS5BTransportPayload::Candidate& candidate) : candidate(candidate), state(Connecting) {}
+
+                JingleS5BTransportPayload::Candidate candidate;
+                std::shared_ptr<SOCKS5BytestreamClientSession> session;
+                boost::signals2::connection sessionReadyConnection;
+                State state;
+            };
+
+            bool isAllowed(const JingleS5BTransportPayload::Candidate&) const;
+            void handleSessionReady(size_t probe, bool error);
+            void handleSelectionTimeout();
+            void checkProbes();
+            void finishSelection(Probe* selectedProbe);
+            void stopProbes(std::shared_ptr<SOCKS5BytestreamClientSession> selectedSession);
 
         private:
             ConnectionFactory* connectionFactory;
             TimerFactory* timerFactory;
 
-            std::priority_queue<
-                JingleS5BTransportPayload::Candidate,
-                std::vector<JingleS5BTransportPayload::Candidate>,
-                JingleS5BTransportPayload::CompareCandidate> candidates;
-            std::shared_ptr<SOCKS5BytestreamClientSession> s5bSession;
-            boost::signals2::connection sessionReadyConnection;
-            JingleS5BTransportPayload::Candidate lastCandidate;
+            std::vector<JingleS5BTransportPayload::Candidate> candidates;
+            std::vector<Probe> probes;
+            Timer::ref selectionTimer;
+            bool selectionTimedOut;
             std::string socks5DstAddr;
             FileTransferOptions options;
         };
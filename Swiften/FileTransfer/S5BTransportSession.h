@@ -51,6 +51,14 @@ class SWIFTEN_API S5BTransportSession : public TransportSession {
             session->stop();
         }
 
+        virtual void pause() SWIFTEN_OVERRIDE {
+            session->pause();
+        }
+
+        virtual void resume() SWIFTEN_OVERRIDE {
+            session->resume();
+        }
+
     private:
         void initialize() {
             finishedConnection = session->onFinished.connect(boost::bind(boost::ref(onFinished), _1));
@@ -12,6 +12,8 @@
 
 #include <Swiften/FileTransfer/SOCKS5BytestreamClientSession.h>
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -21,6 +23,7 @@
 #include <Swiften/Base/Log.h>
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/FileTransfer/BytestreamException.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
 #include <Swiften/Network/TimerFactory.h>
 #include <Swiften/StringCodecs/Hexify.h>
 
@@ -35,7 +38,9 @@ SOCKS5BytestreamClientSession::SOCKS5BytestreamClientSession(
             addressPort(addressPort),
             destination(destination),
             state(Initial),
-            chunkSize(131072) {
+            chunkSize(131072),
+            paused(false),
+            sendPending(false) {
     weFailedTimeout = timerFactory->createTimer(3000);
     weFailedTimeout->onTick.connect(
             boost::bind(&SOCKS5BytestreamClientSession::handleWeFailedTimeout, this));
@@ -164,6 +169,9 @@ void SOCKS5BytestreamClientSession::authenticate() {
 void SOCKS5BytestreamClientSession::startReceiving(std::shared_ptr<WriteBytestream> writeStream) {
     if (state == Ready) {
         state = Reading;
+        if (paused) {
+            connection->pauseReading();
+        }
         writeBytestream = writeStream;
         writeBytestream->write(unprocessedData);
         unprocessedData.clear();
@@ -184,16 +192,50 @@ void SOCKS5BytestreamClientSession::startSending(std::shared_ptr<ReadBytestream>
     }
 }
 
+void SOCKS5BytestreamClientSession::pause() {
+    if (!paused) {
+        paused = true;
+        if (state == Reading) {
+            connection->pauseReading();
+        }
+    }
+}
+
+void SOCKS5BytestreamClientSession::resume() {
+    if (paused) {
+        paused = false;
+        if (state == Reading) {
+            connection->resumeReading();
+        }
+        else if (state == Writing && sendPending) {
+            sendPending = false;
+            sendData();
+        }
+    }
+}
+
 HostAddressPort SOCKS5BytestreamClientSession::getAddressPort() const {
     return addressPort;
 }
 
 void SOCKS5BytestreamClientSession::sendData() {
+    if (paused) {
+        sendPending = true;
+        return;
+    }
     if (!readBytestream->isFinished()) {
         try {
-            std::shared_ptr<ByteArray> dataToSend = readBytestream->read(boost::numeric_cast<size_t>(chunkSize));
-            connection->write(createSafeByteArray(*dataToSend));
-            onBytesSent(dataToSend->size());
+            if (std::shared_ptr<FileDescriptorReadBytestream> fileBytestream = std::dynamic_pointer_cast<FileDescriptorReadBytestream>(readBytestream)) {
+                size_t size = boost::numeric_cast<size_t>(std::min<boost::uint64_t>(boost::numeric_cast<boost::uint64_t>(chunkSize), fileBytestream->getRemainingSize()));
+                if (fileBytestream->getFileDescriptor() >= 0 && connection->writeFile(fileBytestream->getFileDescriptor(), fileBytestream->getPosition(), size)) {
+                    fileBytestream->skip(size);
+                    onBytesSent(size);
+                    return;
+                }
+            }
+            ReadBytestream::View view = readBytestream->readView(boost::numeric_cast<size_t>(chunkSize));
+            connection->write(createSafeByteArray(view.data, view.size));
+            onBytesSent(view.size);
         }
         catch (const BytestreamException&) {
             finish(true);
@@ -65,6 +65,12 @@ public:
     void startReceiving(std::shared_ptr<WriteBytestream>);
     void startSending(std::shared_ptr<ReadBytestream>);
 
+    /**
+     * Stops sending or receiving data until resume() is called.
+     */
+    void pause();
+    void resume();
+
     HostAddressPort getAddressPort() const;
 
     boost::signals2::signal<void (bool /*error*/)> onSessionReady;
@@ -98,6 +104,8 @@ private:
     ByteArray authenticateAddress;
 
     int chunkSize;
+    bool paused;
+    bool sendPending;
     std::shared_ptr<WriteBytestream> writeBytestream;
     std::shared_ptr<ReadBytestream> readBytestream;
 
@@ -13,6 +13,7 @@
 
 #include <Swiften/FileTransfer/SOCKS5BytestreamProxiesManager.h>
 
+#include <algorithm>
 #include <memory>
 
 #include <boost/bind.hpp>
@@ -28,7 +29,17 @@
 
 namespace Swift {
 
-SOCKS5BytestreamProxiesManager::SOCKS5BytestreamProxiesManager(ConnectionFactory *connFactory, TimerFactory *timeFactory, DomainNameResolver* resolver, IQRouter* iqRouter, const JID& serviceRoot) : connectionFactory_(connFactory), timerFactory_(timeFactory), resolver_(resolver), iqRouter_(iqRouter), serviceRoot_(serviceRoot) {
+typedef std::pair<SOCKS5BytestreamProxiesManager::Latency, S5BProxyRequest::ref> ProxyLatencyPair;
+
+static HostAddressPort getProxyAddressPort(S5BProxyRequest::ref proxy) {
+    return HostAddressPort(HostAddress(proxy->getStreamHost().get().host), proxy->getStreamHost().get().port);
+}
+
+static bool isLowerLatency(const ProxyLatencyPair& a, const ProxyLatencyPair& b) {
+    return a.first < b.first;
+}
+
+SOCKS5BytestreamProxiesManager::SOCKS5BytestreamProxiesManager(ConnectionFactory *connFactory, TimerFactory *timeFactory, DomainNameResolver* resolver, IQRouter* iqRouter, const JID& serviceRoot) : connectionFactory_(connFactory), timerFactory_(timeFactory), resolver_(resolver), iqRouter_(iqRouter), serviceRoot_(serviceRoot), clock_(&std::chrono::steady_clock::now) {
 
 }
 
@@ -52,6 +63,7 @@ void SOCKS5BytestreamProxiesManager::addS5BProxy(S5BProxyRequest::ref proxy) {
             localS5BProxies_ = std::vector<S5BProxyRequest::ref>();
         }
         localS5BProxies_->push_back(proxy);
+        sortProxiesByLatency();
     }
 }
 
@@ -67,7 +79,9 @@ void SOCKS5BytestreamProxiesManager::connectToProxies(const std::string& session
     ProxyJIDClientSessionVector clientSessions;
 
     if (localS5BProxies_) {
-        foreach(S5BProxyRequest::ref proxy, localS5BProxies_.get()) {
+        // Sessions can be reordered by the latency measured while connecting
+        std::vector<S5BProxyRequest::ref> proxies = localS5BProxies_.get();
+        foreach(S5BProxyRequest::ref proxy, proxies) {
             std::shared_ptr<Connection> conn = connectionFactory_->createConnection();
 
             HostAddressPort addressPort = HostAddressPort(proxy->getStreamHost().get().host, proxy->getStreamHost().get().port);
@@ -77,6 +91,7 @@ void SOCKS5BytestreamProxiesManager::connectToProxies(const std::string& session
             clientSessions.push_back(std::pair<JID, std::shared_ptr<SOCKS5BytestreamClientSession> >(proxyJid, session));
             session->onSessionReady.connect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxySessionReady, this,sessionID, proxyJid, session, _1));
             session->onFinished.connect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxySessionFinished, this, sessionID, proxyJid, session, _1));
+            sessionStartTimes_[session] = clock_();
             session->start();
         }
     }
@@ -95,6 +110,7 @@ std::shared_ptr<SOCKS5BytestreamClientSession> SOCKS5BytestreamProxiesManager::g
     for (ProxyJIDClientSessionVector::iterator i = proxySessions_[sessionID].begin(); i != proxySessions_[sessionID].end(); i++) {
         i->second->onSessionReady.disconnect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxySessionReady, this,sessionID, proxyJID, i->second, _1));
         i->second->onFinished.disconnect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxySessionFinished, this, sessionID, proxyJID, i->second, _1));
+        sessionStartTimes_.erase(i->second);
         if (i->first == proxyJID && !activeSession) {
             activeSession = i->second;
         }
@@ -114,6 +130,14 @@ std::shared_ptr<SOCKS5BytestreamClientSession> SOCKS5BytestreamProxiesManager::c
     return connection;
 }
 
+boost::optional<SOCKS5BytestreamProxiesManager::Latency> SOCKS5BytestreamProxiesManager::getProxyLatency(const HostAddressPort& addressPort) const {
+    std::map<std::string, boost::optional<Latency> >::const_iterator i = proxyLatencies_.find(addressPort.toString());
+    if (i == proxyLatencies_.end()) {
+        return boost::optional<Latency>();
+    }
+    return i->second;
+}
+
 void SOCKS5BytestreamProxiesManager::handleProxiesFound(std::vector<S5BProxyRequest::ref> proxyHosts) {
     proxyFinder_->onProxiesFound.disconnect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxiesFound, this, _1));
     foreach(S5BProxyRequest::ref proxy, proxyHosts) {
@@ -167,11 +191,13 @@ void SOCKS5BytestreamProxiesManager::queryForProxies() {
 
 void SOCKS5BytestreamProxiesManager::handleProxySessionReady(const std::string& sessionID, const JID& jid, std::shared_ptr<SOCKS5BytestreamClientSession> session, bool error) {
     session->onSessionReady.disconnect(boost::bind(&SOCKS5BytestreamProxiesManager::handleProxySessionReady, this, boost::cref(sessionID), boost::cref(jid), session, _1));
+    updateProxyLatency(session, error);
     if (!error) {
         // The SOCKS5 bytestream session to the proxy succeeded; stop and remove other sessions.
         if (proxySessions_.find(sessionID) != proxySessions_.end()) {
             for (ProxyJIDClientSessionVector::iterator i = proxySessions_[sessionID].begin(); i != proxySessions_[sessionID].end();) {
                 if ((i->first == jid) && (i->second != session)) {
+                    sessionStartTimes_.erase(i->second);
                     i->second->stop();
                     i = proxySessions_[sessionID].erase(i);
                 }
@@ -190,6 +216,7 @@ void SOCKS5BytestreamProxiesManager::handleProxySessionFinished(const std::strin
         if (proxySessions_.find(sessionID) != proxySessions_.end()) {
             for (ProxyJIDClientSessionVector::iterator i = proxySessions_[sessionID].begin(); i != proxySessions_[sessionID].end();) {
                 if ((i->first == jid) && (i->second == session)) {
+                    sessionStartTimes_.erase(i->second);
                     i->second->stop();
                     i = proxySessions_[sessionID].erase(i);
                     break;
@@ -202,4 +229,53 @@ void SOCKS5BytestreamProxiesManager::handleProxySessionFinished(const std::strin
     }
 }
 
+void SOCKS5BytestreamProxiesManager::updateProxyLatency(std::shared_ptr<SOCKS5BytestreamClientSession> session, bool error) {
+    std::map<std::shared_ptr<SOCKS5BytestreamClientSession>, std::chrono::steady_clock::time_point>::iterator startTime = sessionStartTimes_.find(session);
+    if (startTime == sessionStartTimes_.end()) {
+        return;
+    }
+    std::string addressPort = session->getAddressPort().toString();
+    if (error) {
+        SWIFT_LOG(debug) << "Could not connect to proxy " << addressPort << std::endl;
+        proxyLatencies_[addressPort] = boost::optional<Latency>();
+    }
+    else {
+        Latency latency = clock_() - startTime->second;
+        SWIFT_LOG(debug) << "Connected to proxy " << addressPort << " in " << std::chrono::duration_cast<std::chrono::milliseconds>(latency).count() << "ms" << std::endl;
+        proxyLatencies_[addressPort] = latency;
+    }
+    sessionStartTimes_.erase(startTime);
+    sortProxiesByLatency();
+}
+
+void SOCKS5BytestreamProxiesManager::sortProxiesByLatency() {
+    if (!localS5BProxies_) {
+        return;
+    }
+    std::vector<ProxyLatencyPair> measuredProxies;
+    std::vector<S5BProxyRequest::ref> unmeasuredProxies;
+    std::vector<S5BProxyRequest::ref> failedProxies;
+    foreach(S5BProxyRequest::ref proxy, localS5BProxies_.get()) {
+        std::map<std::string, boost::optional<Latency> >::const_iterator latency = proxyLatencies_.find(getProxyAddressPort(proxy).toString());
+        if (latency == proxyLatencies_.end()) {
+            unmeasuredProxies.push_back(proxy);
+        }
+        else if (latency->second) {
+            measuredProxies.push_back(ProxyLatencyPair(*latency->second, proxy));
+        }
+        else {
+            failedProxies.push_back(proxy);
+        }
+    }
+    std::stable_sort(measuredProxies.begin(), measuredProxies.end(), &isLowerLatency);
+
+    std::vector<S5BProxyRequest::ref>& proxies = localS5BProxies_.get();
+    proxies.clear();
+    foreach(const ProxyLatencyPair& proxy, measuredProxies) {
+        proxies.push_back(proxy.second);
+    }
+    proxies.insert(proxies.end(), unmeasuredProxies.begin(), unmeasuredProxies.end());
+    proxies.insert(proxies.end(), failedProxies.begin(), failedProxies.end());
+}
+
 }
@@ -13,6 +13,8 @@
 
 #pragma once
 
+#include <chrono>
+#include <functional>
 #include <map>
 #include <string>
 #include <utility>
@@ -34,8 +36,14 @@ namespace Swift {
     /**
      *    - manages list of working S5B proxies
      *    - creates initial connections (for the candidates you provide)
+     *    - measures how long connecting to each proxy takes, and orders
+     *      the proxies by it
      */
     class SWIFTEN_API SOCKS5BytestreamProxiesManager {
+        public:
+            typedef std::chrono::steady_clock::duration Latency;
+            typedef std::function<std::chrono::steady_clock::time_point ()> Clock;
+
         public:
             SOCKS5BytestreamProxiesManager(ConnectionFactory*, TimerFactory*, DomainNameResolver*, IQRouter*, const JID&);
             ~SOCKS5BytestreamProxiesManager();
@@ -45,6 +53,8 @@ namespace Swift {
             /*
              * Returns a list of external S5B proxies. If the optinal return value is not initialized a discovery process has been started and
              * onDiscoveredProxiesChanged signal will be emitted when it is finished.
+             * Proxies are ordered by the time it last took to connect to them. Proxies that have not been connected to yet come after
+             * those, and proxies that could not be connected to last.
              */
             const boost::optional<std::vector<S5BProxyRequest::ref> >& getOrDiscoverS5BProxies();
 
@@ -53,6 +63,17 @@ namespace Swift {
 
             std::shared_ptr<SOCKS5BytestreamClientSession> createSOCKS5BytestreamClientSession(HostAddressPort addressPort, const std::string& destAddr);
 
+            /*
+             * Returns the time it last took to set up a session with the proxy at the given address. If the optional return value is
+             * not initialized, no session has been set up with it yet.
+             */
+            boost::optional<Latency> getProxyLatency(const HostAddressPort& addressPort) const;
+
+            // Mainly for testing purposes
+            void setClock(const Clock& clock) {
+                clock_ = clock;
+            }
+
         public:
             boost::signals2::signal<void ()> onDiscoveredProxiesChanged;
 
@@ -65,6 +86,9 @@ namespace Swift {
             void handleProxySessionReady(const std::string& sessionID, const JID& jid, std::shared_ptr<SOCKS5BytestreamClientSession> session, bool error);
             void handleProxySessionFinished(const std::string& sessionID, const JID& jid, std::shared_ptr<SOCKS5BytestreamClientSession> session, boost::optional<FileTransferError> error);
 
+            void updateProxyLatency(std::shared_ptr<SOCKS5BytestreamClientSession> session, bool error);
+            void sortProxiesByLatency();
+
         private:
             ConnectionFactory* connectionFactory_;
             TimerFactory* timerFactory_;
@@ -79,6 +103,11 @@ namespace Swift {
             std::shared_ptr<SOCKS5BytestreamProxyFinder> proxyFinder_;
 
             boost::optional<std::vector<S5BProxyRequest::ref> > localS5BProxies_;
+
+            // Uninitialized latencies are those of proxies that could not be connected to
+            std::map<std::string, boost::optional<Latency> > proxyLatencies_;
+            std::map<std::shared_ptr<SOCKS5BytestreamClientSession>, std::chrono::steady_clock::time_point> sessionStartTimes_;
+            Clock clock_;
     };
 
 }
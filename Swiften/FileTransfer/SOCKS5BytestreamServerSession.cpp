@@ -6,6 +6,8 @@
 
 #include <Swiften/FileTransfer/SOCKS5BytestreamServerSession.h>
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 #include <boost/numeric/conversion/cast.hpp>
 
@@ -15,6 +17,7 @@
 #include <Swiften/Base/Log.h>
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/FileTransfer/BytestreamException.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
 #include <Swiften/Network/HostAddressPort.h>
 
@@ -27,7 +30,9 @@ SOCKS5BytestreamServerSession::SOCKS5BytestreamServerSession(
             bytestreams(bytestreams),
             state(Initial),
             chunkSize(131072),
-            waitingForData(false) {
+            waitingForData(false),
+            paused(false),
+            sendPending(false) {
     disconnectedConnection = connection->onDisconnected.connect(boost::bind(&SOCKS5BytestreamServerSession::handleDisconnected, this, _1));
 }
 
@@ -66,11 +71,36 @@ void SOCKS5BytestreamServerSession::startReceiving(std::shared_ptr<WriteBytestre
 
     writeBytestream = stream;
     state = ReadingData;
+    if (paused) {
+        connection->pauseReading();
+    }
     writeBytestream->write(unprocessedData);
     // onBytesReceived(unprocessedData.size());
     unprocessedData.clear();
 }
 
+void SOCKS5BytestreamServerSession::pause() {
+    if (!paused) {
+        paused = true;
+        if (state == ReadingData) {
+            connection->pauseReading();
+        }
+    }
+}
+
+void SOCKS5BytestreamServerSession::resume() {
+    if (paused) {
+        paused = false;
+        if (state == ReadingData) {
+            connection->resumeReading();
+        }
+        else if (state == WritingData && sendPending) {
+            sendPending = false;
+            sendData();
+        }
+    }
+}
+
 HostAddressPort SOCKS5BytestreamServerSession::getAddressPort() const {
     return connection->getLocalAddress();
 }
@@ -156,9 +186,23 @@ void SOCKS5BytestreamServerSession::process() {
 }
 
 void SOCKS5BytestreamServerSession::sendData() {
+    if (paused) {
+        sendPending = true;
+        return;
+    }
     if (!readBytestream->isFinished()) {
         try {
-            SafeByteArray dataToSend = createSafeByteArray(*readBytestream->read(boost::numeric_cast<size_t>(chunkSize)));
+            if (std::shared_ptr<FileDescriptorReadBytestream> fileBytestream = std::dynamic_pointer_cast<FileDescriptorReadBytestream>(readBytestream)) {
+                size_t size = boost::numeric_cast<size_t>(std::min<boost::uint64_t>(boost::numeric_cast<boost::uint64_t>(chunkSize), fileBytestream->getRemainingSize()));
+                if (fileBytestream->getFileDescriptor() >= 0 && connection->writeFile(fileBytestream->getFileDescriptor(), fileBytestream->getPosition(), size)) {
+                    fileBytestream->skip(size);
+                    onBytesSent(size);
+                    waitingForData = false;
+                    return;
+                }
+            }
+            ReadBytestream::View view = readBytestream->readView(boost::numeric_cast<size_t>(chunkSize));
+            SafeByteArray dataToSend = createSafeByteArray(view.data, view.size);
             if (!dataToSend.empty()) {
                 connection->write(dataToSend);
                 onBytesSent(dataToSend.size());
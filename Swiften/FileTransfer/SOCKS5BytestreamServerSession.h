@@ -47,6 +47,12 @@ namespace Swift {
             void startSending(std::shared_ptr<ReadBytestream>);
             void startReceiving(std::shared_ptr<WriteBytestream>);
 
+            /**
+             * Stops sending or receiving data until resume() is called.
+             */
+            void pause();
+            void resume();
+
             HostAddressPort getAddressPort() const;
 
             boost::signals2::signal<void (boost::optional<FileTransferError>)> onFinished;
@@ -74,6 +80,8 @@ namespace Swift {
             std::shared_ptr<ReadBytestream> readBytestream;
             std::shared_ptr<WriteBytestream> writeBytestream;
             bool waitingForData;
+            bool paused;
+            bool sendPending;
 
             boost::signals2::connection disconnectedConnection;
             boost::signals2::connection dataReadConnection;
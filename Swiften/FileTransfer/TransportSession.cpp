@@ -10,3 +10,9 @@ using namespace Swift;
 
 TransportSession::~TransportSession() {
 }
+
+void TransportSession::pause() {
+}
+
+void TransportSession::resume() {
+}
@@ -20,6 +20,16 @@ namespace Swift {
             virtual void start() = 0;
             virtual void stop() = 0;
 
+            /**
+             * Stops transferring data until resume() is called. Data that is
+             * already underway may still arrive.
+             *
+             * Sessions that cannot control the pace of the peer (e.g. when
+             * receiving in-band) keep transferring.
+             */
+            virtual void pause();
+            virtual void resume();
+
             boost::signals2::signal<void (size_t)> onBytesSent;
             boost::signals2::signal<void (boost::optional<FileTransferError>)> onFinished;
     };
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+
+using namespace Swift;
+
+class FileDescriptorWriteBytestreamTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(FileDescriptorWriteBytestreamTest);
+        CPPUNIT_TEST(testWrite);
+        CPPUNIT_TEST(testWrite_Ranges);
+        CPPUNIT_TEST(testWrite_DoesNotTruncate);
+        CPPUNIT_TEST(testWrite_AfterClose);
+        CPPUNIT_TEST(testWriteAt);
+        CPPUNIT_TEST(testRead_Range);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            file = boost::filesystem::unique_path("file_descriptor_write_bytestream_test_%%%%%%%%%%%%%%%%");
+            writtenData.clear();
+        }
+
+        void tearDown() {
+            boost::filesystem::remove(file);
+        }
+
+        void testWrite() {
+            {
+                FileDescriptorWriteBytestream testling(file);
+                testling.onWrite.connect(boost::bind(&FileDescriptorWriteBytestreamTest::handleWrite, this, _1));
+
+                CPPUNIT_ASSERT(testling.write(createByteArray("abc")));
+                CPPUNIT_ASSERT(testling.write(createByteArray("def")));
+                CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(6), testling.getPosition());
+            }
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readFile());
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), writtenData);
+        }
+
+        void testWrite_Ranges() {
+            {
+                FileDescriptorWriteBytestream first(file, 0);
+                FileDescriptorWriteBytestream second(file, 4);
+
+                CPPUNIT_ASSERT(second.write(createByteArray("ef")));
+                CPPUNIT_ASSERT(first.write(createByteArray("ab")));
+                CPPUNIT_ASSERT(second.write(createByteArray("gh")));
+                CPPUNIT_ASSERT(first.write(createByteArray("cd")));
+            }
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdefgh"), readFile());
+        }
+
+        void testWrite_DoesNotTruncate() {
+            FileDescriptorWriteBytestream(file).write(createByteArray("abcdef"));
+
+            FileDescriptorWriteBytestream(file, 2).write(createByteArray("CD"));
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abCDef"), readFile());
+        }
+
+        void testWrite_AfterClose() {
+            FileDescriptorWriteBytestream testling(file);
+
+            testling.close();
+
+            CPPUNIT_ASSERT(!testling.write(createByteArray("abc")));
+        }
+
+        void testWriteAt() {
+            {
+                FileDescriptorWriteBytestream testling(file);
+                testling.onWrite.connect(boost::bind(&FileDescriptorWriteBytestreamTest::handleWrite, this, _1));
+
+                CPPUNIT_ASSERT(testling.writeAt(3, createByteArray("def")));
+                CPPUNIT_ASSERT(testling.write(createByteArray("abc")));
+                CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(3), testling.getPosition());
+            }
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readFile());
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abc"), writtenData);
+        }
+
+        void testRead_Range() {
+            FileDescriptorWriteBytestream(file).write(createByteArray("abcdefgh"));
+
+            FileDescriptorReadBytestream testling(file, 2, 4);
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("cdef"), *testling.read(100));
+            CPPUNIT_ASSERT(testling.isFinished());
+        }
+
+    private:
+        ByteArray readFile() {
+            ByteArray result;
+            readByteArrayFromFile(result, file);
+            return result;
+        }
+
+        void handleWrite(const std::vector<unsigned char>& data) {
+            append(writtenData, data);
+        }
+
+    private:
+        boost::filesystem::path file;
+        ByteArray writtenData;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileDescriptorWriteBytestreamTest);
@@ -0,0 +1,388 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Client/DummyStanzaChannel.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/Disco/DummyEntityCapsProvider.h>
+#include <Swiften/Elements/DiscoInfo.h>
+#include <Swiften/Elements/IBB.h>
+#include <Swiften/Elements/JingleContentPayload.h>
+#include <Swiften/Elements/JingleFileTransferDescription.h>
+#include <Swiften/Elements/JingleIBBTransportPayload.h>
+#include <Swiften/Elements/JinglePayload.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/FileTransfer/ByteArrayReadBytestream.h>
+#include <Swiften/FileTransfer/FileTransferManagerImpl.h>
+#include <Swiften/FileTransfer/ParallelIncomingFileTransfer.h>
+#include <Swiften/FileTransfer/ParallelOutgoingFileTransfer.h>
+#include <Swiften/FileTransfer/PartialFileStorage.h>
+#include <Swiften/Jingle/JingleSessionManager.h>
+#include <Swiften/Network/DummyConnectionFactory.h>
+#include <Swiften/Network/DummyConnectionServerFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+#include <Swiften/Network/NullNATTraverser.h>
+#include <Swiften/Network/PlatformNetworkEnvironment.h>
+#include <Swiften/Network/StaticDomainNameResolver.h>
+#include <Swiften/Presence/PresenceOracle.h>
+#include <Swiften/Queries/IQRouter.h>
+#include <Swiften/Roster/XMPPRosterImpl.h>
+
+using namespace Swift;
+
+class FileTransferManagerImplTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(FileTransferManagerImplTest);
+        CPPUNIT_TEST(testCreateOutgoingFileTransfer_SendsRanges);
+        CPPUNIT_TEST(testCreateOutgoingFileTransfer_RecipientWithoutParallelRanges);
+        CPPUNIT_TEST(testCreateOutgoingFileTransfer_WithBytestream);
+        CPPUNIT_TEST(testIncomingFileTransfer_CollectsRanges);
+        CPPUNIT_TEST(testIncomingFileTransfer_RangeFromSenderWithoutParallelRanges);
+        CPPUNIT_TEST(testPartialFileStorage_ResumesInterruptedTransfer);
+        CPPUNIT_TEST_SUITE_END();
+
+        class IDStanzaChannel : public DummyStanzaChannel {
+            public:
+                IDStanzaChannel() : nextID(0) {
+                }
+
+                virtual std::string getNewIQID() {
+                    return "id-" + boost::lexical_cast<std::string>(nextID++);
+                }
+
+            private:
+                int nextID;
+        };
+
+        /**
+         * The other side of a file transfer, whose stanzas are exchanged
+         * with the testling's.
+         */
+        struct Peer {
+            Peer(const JID& jid, FileTransferManagerImplTest* test) : jid(jid) {
+                stanzaChannel = new IDStanzaChannel();
+                iqRouter = new IQRouter(stanzaChannel);
+                iqRouter->setJID(jid);
+                jingleSessionManager = new JingleSessionManager(iqRouter);
+                capsProvider = new DummyEntityCapsProvider();
+                roster = new XMPPRosterImpl();
+                presenceOracle = new PresenceOracle(stanzaChannel, roster);
+                fileTransferManager = new FileTransferManagerImpl(jid, jingleSessionManager, iqRouter, capsProvider, presenceOracle, test->connectionFactory, test->connectionServerFactory, test->timerFactory, test->resolver, test->networkEnvironment, test->natTraverser, test->crypto.get(), test->eventLoop);
+            }
+
+            ~Peer() {
+                delete fileTransferManager;
+                delete presenceOracle;
+                delete roster;
+                delete capsProvider;
+                delete jingleSessionManager;
+                delete iqRouter;
+                delete stanzaChannel;
+            }
+
+            JID jid;
+            IDStanzaChannel* stanzaChannel;
+            IQRouter* iqRouter;
+            JingleSessionManager* jingleSessionManager;
+            DummyEntityCapsProvider* capsProvider;
+            XMPPRosterImpl* roster;
+            PresenceOracle* presenceOracle;
+            FileTransferManagerImpl* fileTransferManager;
+        };
+
+    public:
+        void setUp() {
+            ownJID = JID("foo@bar.com/baz");
+            peerJID = JID("alice@wonderland.lit/rabbithole");
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+            eventLoop = new DummyEventLoop();
+            stanzaChannel = new IDStanzaChannel();
+            iqRouter = new IQRouter(stanzaChannel);
+            iqRouter->setJID(ownJID);
+            jingleSessionManager = new JingleSessionManager(iqRouter);
+            capsProvider = new DummyEntityCapsProvider();
+            roster = new XMPPRosterImpl();
+            presenceOracle = new PresenceOracle(stanzaChannel, roster);
+            connectionFactory = new DummyConnectionFactory(eventLoop);
+            connectionServerFactory = new DummyConnectionServerFactory(eventLoop);
+            timerFactory = new DummyTimerFactory();
+            resolver = new StaticDomainNameResolver(eventLoop);
+            networkEnvironment = new PlatformNetworkEnvironment();
+            natTraverser = new NullNATTraverser(eventLoop);
+            testling = new FileTransferManagerImpl(ownJID, jingleSessionManager, iqRouter, capsProvider, presenceOracle, connectionFactory, connectionServerFactory, timerFactory, resolver, networkEnvironment, natTraverser, crypto.get(), eventLoop);
+            testling->onIncomingFileTransfer.connect(boost::bind(&FileTransferManagerImplTest::handleIncomingFileTransfer, this, _1));
+            file = boost::filesystem::unique_path("file_transfer_manager_impl_test_%%%%%%%%%%%%%%%%");
+            receivedFile = boost::filesystem::unique_path("file_transfer_manager_impl_test_%%%%%%%%%%%%%%%%");
+            partialFileDirectory = boost::filesystem::unique_path("file_transfer_manager_impl_test_%%%%%%%%%%%%%%%%");
+            incomingTransfers.clear();
+            storedTransfers = 0;
+            outgoingState = FileTransfer::State::Initial;
+        }
+
+        void tearDown() {
+            incomingTransfers.clear();
+            peer.reset();
+            delete testling;
+            delete natTraverser;
+            delete networkEnvironment;
+            delete resolver;
+            delete timerFactory;
+            delete connectionServerFactory;
+            delete connectionFactory;
+            delete presenceOracle;
+            delete roster;
+            delete capsProvider;
+            delete jingleSessionManager;
+            delete iqRouter;
+            delete stanzaChannel;
+            delete eventLoop;
+            boost::system::error_code error;
+            boost::filesystem::remove(file, error);
+            boost::filesystem::remove(receivedFile, error);
+            boost::filesystem::remove_all(partialFileDirectory, error);
+        }
+
+        void testCreateOutgoingFileTransfer_SendsRanges() {
+            setPeerCaps(true);
+            createFile(3 * 4 * 1024 * 1024);
+
+            OutgoingFileTransfer::ref transfer = testling->createOutgoingFileTransfer(peerJID, file, "", std::shared_ptr<ReadBytestream>(), FileTransferOptions().withParallelStreams(2));
+
+            ParallelOutgoingFileTransfer::ref parallelTransfer = std::dynamic_pointer_cast<ParallelOutgoingFileTransfer>(transfer);
+            CPPUNIT_ASSERT(parallelTransfer);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), parallelTransfer->getTransfers().size());
+        }
+
+        void testCreateOutgoingFileTransfer_RecipientWithoutParallelRanges() {
+            setPeerCaps(false);
+            createFile(3 * 4 * 1024 * 1024);
+
+            OutgoingFileTransfer::ref transfer = testling->createOutgoingFileTransfer(peerJID, file, "", std::shared_ptr<ReadBytestream>(), FileTransferOptions().withParallelStreams(2));
+
+            CPPUNIT_ASSERT(transfer);
+            CPPUNIT_ASSERT(!std::dynamic_pointer_cast<ParallelOutgoingFileTransfer>(transfer));
+        }
+
+        void testCreateOutgoingFileTransfer_WithBytestream() {
+            setPeerCaps(true);
+            createFile(3 * 4 * 1024 * 1024);
+
+            OutgoingFileTransfer::ref transfer = testling->createOutgoingFileTransfer(peerJID, file, "", std::make_shared<ByteArrayReadBytestream>(createByteArray("abc")), FileTransferOptions().withParallelStreams(2));
+
+            CPPUNIT_ASSERT(transfer);
+            CPPUNIT_ASSERT(!std::dynamic_pointer_cast<ParallelOutgoingFileTransfer>(transfer));
+        }
+
+        void testIncomingFileTransfer_CollectsRanges() {
+            setPeerCaps(true);
+
+            receiveOffer("session1", 0, 4);
+            receiveOffer("session2", 4, 6);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), incomingTransfers.size());
+            ParallelIncomingFileTransfer::ref parallelTransfer = std::dynamic_pointer_cast<ParallelIncomingFileTransfer>(incomingTransfers[0]);
+            CPPUNIT_ASSERT(parallelTransfer);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), parallelTransfer->getTransfers().size());
+            CPPUNIT_ASSERT(parallelTransfer->isComplete());
+        }
+
+        void testIncomingFileTransfer_RangeFromSenderWithoutParallelRanges() {
+            setPeerCaps(false);
+
+            receiveOffer("session1", 4, 6);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), incomingTransfers.size());
+            CPPUNIT_ASSERT(!std::dynamic_pointer_cast<ParallelIncomingFileTransfer>(incomingTransfers[0]));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(4), incomingTransfers[0]->getRangeOffset());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(6), incomingTransfers[0]->getRangeLength());
+        }
+
+        void testPartialFileStorage_ResumesInterruptedTransfer() {
+            ByteArray content;
+            for (size_t i = 0; i < 10000; ++i) {
+                content.push_back(static_cast<unsigned char>(i % 251));
+            }
+            boost::filesystem::ofstream(file, std::ios::binary).write(reinterpret_cast<const char*>(vecptr(content)), static_cast<std::streamsize>(content.size()));
+            peer = std::make_shared<Peer>(peerJID, this);
+            setPeerCaps(false);
+            DiscoInfo::ref caps = std::make_shared<DiscoInfo>();
+            caps->addFeature(DiscoInfo::JingleFeature);
+            caps->addFeature(DiscoInfo::JingleFTFeature);
+            caps->addFeature(DiscoInfo::JingleTransportsIBBFeature);
+            peer->capsProvider->caps[ownJID] = caps;
+            PartialFileStorage storage(partialFileDirectory, crypto.get());
+            storage.onTransferFinished.connect(boost::bind(&FileTransferManagerImplTest::handleTransferStored, this, _1, _2));
+
+            // The first transfer stops after some of the data was received
+            OutgoingFileTransfer::ref transfer = peer->fileTransferManager->createOutgoingFileTransfer(ownJID, file, "", std::shared_ptr<ReadBytestream>(), FileTransferOptions().withInBandBlockSize(1024));
+            transfer->start();
+            exchangeStanzas();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), incomingTransfers.size());
+            storage.accept(incomingTransfers[0], receivedFile);
+            size_t dataBlocks = 0;
+            while (dataBlocks < 3 && exchangeStanza(&dataBlocks)) {
+            }
+            transfer->cancel();
+            exchangeStanzas();
+            CPPUNIT_ASSERT_EQUAL(1, storedTransfers);
+            CPPUNIT_ASSERT(storedError);
+            CPPUNIT_ASSERT(!boost::filesystem::exists(receivedFile));
+
+            // The file is sent again, and only the rest of it is transferred
+            transfer = peer->fileTransferManager->createOutgoingFileTransfer(ownJID, file, "", std::shared_ptr<ReadBytestream>(), FileTransferOptions().withInBandBlockSize(1024));
+            transfer->onStateChanged.connect(boost::bind(&FileTransferManagerImplTest::handleOutgoingStateChanged, this, _1));
+            transfer->start();
+            exchangeStanzas();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), incomingTransfers.size());
+            boost::uintmax_t receivedSize = storage.getReceivedSize(incomingTransfers[1]);
+            CPPUNIT_ASSERT(receivedSize >= 3 * 1024);
+            storage.accept(incomingTransfers[1], receivedFile);
+            dataBlocks = 0;
+            while (exchangeStanza(&dataBlocks)) {
+            }
+
+            CPPUNIT_ASSERT_EQUAL(receivedSize, incomingTransfers[1]->getRangeOffset());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>((content.size() - receivedSize + 1023) / 1024), dataBlocks);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Finished, outgoingState);
+            CPPUNIT_ASSERT_EQUAL(2, storedTransfers);
+            CPPUNIT_ASSERT(!storedError);
+            ByteArray received;
+            readByteArrayFromFile(received, receivedFile);
+            CPPUNIT_ASSERT_EQUAL(content, received);
+        }
+
+    private:
+        void setPeerCaps(bool parallelRanges) {
+            DiscoInfo::ref caps = std::make_shared<DiscoInfo>();
+            caps->addFeature(DiscoInfo::JingleFeature);
+            caps->addFeature(DiscoInfo::JingleFTFeature);
+            caps->addFeature(DiscoInfo::JingleTransportsIBBFeature);
+            if (parallelRanges) {
+                caps->addFeature(DiscoInfo::JingleFTParallelRangesFeature);
+            }
+            capsProvider->caps[peerJID] = caps;
+        }
+
+        void createFile(boost::uintmax_t size) {
+            boost::filesystem::ofstream(file).close();
+            boost::filesystem::resize_file(file, size);
+        }
+
+        void receiveOffer(const std::string& sessionID, boost::uintmax_t offset, boost::uintmax_t length) {
+            JingleFileTransferFileInfo fileInfo("file", "", 10);
+            fileInfo.setRangeOffset(offset);
+            fileInfo.setRangeLength(length);
+            JingleFileTransferDescription::ref description = std::make_shared<JingleFileTransferDescription>();
+            description->setFileInfo(fileInfo);
+            JingleIBBTransportPayload::ref transport = std::make_shared<JingleIBBTransportPayload>();
+            transport->setSessionID(sessionID);
+            JingleContentPayload::ref content = std::make_shared<JingleContentPayload>();
+            content->setCreator(JingleContentPayload::InitiatorCreator);
+            content->setName("file");
+            content->addDescription(description);
+            content->addTransport(transport);
+
+            JinglePayload::ref payload = std::make_shared<JinglePayload>(JinglePayload::SessionInitiate, sessionID);
+            payload->setInitiator(peerJID);
+            payload->addContent(content);
+            IQ::ref request = IQ::createRequest(IQ::Set, ownJID, sessionID, payload);
+            request->setFrom(peerJID);
+            stanzaChannel->onIQReceived(request);
+        }
+
+        /**
+         * Delivers the next stanza sent by the peer or the testling to the
+         * other side, counting the IBB data blocks in \p dataBlocks.
+         * Returns false if there was nothing to deliver.
+         */
+        bool exchangeStanza(size_t* dataBlocks = nullptr) {
+            eventLoop->processEvents();
+            if (!peer->stanzaChannel->sentStanzas.empty()) {
+                IQ::ref iq = deliverStanza(peer->stanzaChannel, peerJID, stanzaChannel);
+                IBB::ref ibb = iq ? iq->getPayload<IBB>() : IBB::ref();
+                if (dataBlocks && ibb && ibb->getAction() == IBB::Data) {
+                    ++*dataBlocks;
+                }
+                return true;
+            }
+            if (!stanzaChannel->sentStanzas.empty()) {
+                deliverStanza(stanzaChannel, ownJID, peer->stanzaChannel);
+                return true;
+            }
+            return false;
+        }
+
+        void exchangeStanzas() {
+            while (exchangeStanza()) {
+            }
+        }
+
+        IQ::ref deliverStanza(DummyStanzaChannel* from, const JID& fromJID, DummyStanzaChannel* to) {
+            IQ::ref iq = std::dynamic_pointer_cast<IQ>(from->sentStanzas.front());
+            from->sentStanzas.erase(from->sentStanzas.begin());
+            if (iq) {
+                iq->setFrom(fromJID);
+                to->onIQReceived(iq);
+            }
+            return iq;
+        }
+
+        void handleIncomingFileTransfer(IncomingFileTransfer::ref transfer) {
+            incomingTransfers.push_back(transfer);
+        }
+
+        void handleTransferStored(IncomingFileTransfer::ref, boost::optional<FileTransferError> error) {
+            ++storedTransfers;
+            storedError = error;
+        }
+
+        void handleOutgoingStateChanged(const FileTransfer::State& state) {
+            outgoingState = state.type;
+        }
+
+    private:
+        JID ownJID;
+        JID peerJID;
+        std::shared_ptr<CryptoProvider> crypto;
+        DummyEventLoop* eventLoop;
+        IDStanzaChannel* stanzaChannel;
+        IQRouter* iqRouter;
+        JingleSessionManager* jingleSessionManager;
+        DummyEntityCapsProvider* capsProvider;
+        XMPPRosterImpl* roster;
+        PresenceOracle* presenceOracle;
+        DummyConnectionFactory* connectionFactory;
+        DummyConnectionServerFactory* connectionServerFactory;
+        DummyTimerFactory* timerFactory;
+        StaticDomainNameResolver* resolver;
+        PlatformNetworkEnvironment* networkEnvironment;
+        NullNATTraverser* natTraverser;
+        FileTransferManagerImpl* testling;
+        std::shared_ptr<Peer> peer;
+        boost::filesystem::path file;
+        boost::filesystem::path receivedFile;
+        boost::filesystem::path partialFileDirectory;
+        std::vector<IncomingFileTransfer::ref> incomingTransfers;
+        int storedTransfers;
+        FileTransfer::State::Type outgoingState;
+        boost::optional<FileTransferError> storedError;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(FileTransferManagerImplTest);
@@ -28,6 +28,7 @@ class IBBReceiveSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testReceiveMultipleData);
         CPPUNIT_TEST(testReceiveDataForOtherSession);
         CPPUNIT_TEST(testReceiveDataOutOfOrder);
+        CPPUNIT_TEST(testReceiveDataAfterError);
         CPPUNIT_TEST(testReceiveLastData);
         CPPUNIT_TEST(testReceiveClose);
         CPPUNIT_TEST(testStopWhileActive);
@@ -113,6 +114,22 @@ class IBBReceiveSessionTest : public CppUnit::TestFixture {
             testling->stop();
         }
 
+        void testReceiveDataAfterError() {
+            std::shared_ptr<IBBReceiveSession> testling(createSession("foo@bar.com/baz", "mysession"));
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBOpen("mysession", 0x10), "foo@bar.com/baz", "id-open"));
+            stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBData("mysession", 1, createByteArray("def")), "foo@bar.com/baz", "id-b"));
+            finished = false;
+
+            stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBData("mysession", 0, createByteArray("abc")), "foo@bar.com/baz", "id-a"));
+
+            CPPUNIT_ASSERT(stanzaChannel->isErrorAtIndex(2, "id-a"));
+            CPPUNIT_ASSERT(bytestream->getData().empty());
+            CPPUNIT_ASSERT(!finished);
+
+            testling->stop();
+        }
+
         void testReceiveLastData() {
             std::shared_ptr<IBBReceiveSession> testling(createSession("foo@bar.com/baz", "mysession", 6));
             testling->start();
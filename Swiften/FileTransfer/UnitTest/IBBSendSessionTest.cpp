@@ -32,6 +32,13 @@ class IBBSendSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testDataStreamResumeAfterPauseSendsData);
         CPPUNIT_TEST(testDataStreamResumeBeforePauseDoesNotSendData);
         CPPUNIT_TEST(testDataStreamResumeAfterResumeDoesNotSendData);
+        CPPUNIT_TEST(testWindow_SendsMultipleBlocks);
+        CPPUNIT_TEST(testWindow_ResponseContinuesSending);
+        CPPUNIT_TEST(testWindow_RespondToAllFinishes);
+        CPPUNIT_TEST(testWindow_ErrorResponseFinishesOnce);
+        CPPUNIT_TEST(testWindow_ZeroSendsOneBlock);
+        CPPUNIT_TEST(testPause_StopsSendingData);
+        CPPUNIT_TEST(testResume_ContinuesSendingData);
 
         CPPUNIT_TEST_SUITE_END();
 
@@ -204,7 +211,112 @@ class IBBSendSessionTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(stanzaChannel->sentStanzas.size()));
         }
 
+        void testWindow_SendsMultipleBlocks() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->setWindowSize(2);
+            testling->start();
+
+            stanzaChannel->onIQReceived(createIBBResult());
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(stanzaChannel->sentStanzas.size()));
+            CPPUNIT_ASSERT_EQUAL(0, stanzaChannel->sentStanzas[1]->getPayload<IBB>()->getSequenceNumber());
+            CPPUNIT_ASSERT_EQUAL(1, stanzaChannel->sentStanzas[2]->getPayload<IBB>()->getSequenceNumber());
+            CPPUNIT_ASSERT(createByteArray("def") == stanzaChannel->sentStanzas[2]->getPayload<IBB>()->getData());
+        }
+
+        void testWindow_ResponseContinuesSending() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->setWindowSize(2);
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBResult());
+
+            stanzaChannel->onIQReceived(createIBBResult(1));
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(stanzaChannel->sentStanzas.size()));
+            IBB::ref ibb = stanzaChannel->sentStanzas[3]->getPayload<IBB>();
+            CPPUNIT_ASSERT_EQUAL(2, ibb->getSequenceNumber());
+            CPPUNIT_ASSERT(createByteArray("g") == ibb->getData());
+        }
+
+        void testWindow_RespondToAllFinishes() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->setWindowSize(2);
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBResult());
+            stanzaChannel->onIQReceived(createIBBResult(1));
+            stanzaChannel->onIQReceived(createIBBResult(2));
+            CPPUNIT_ASSERT(!finished);
+
+            stanzaChannel->onIQReceived(createIBBResult(3));
+
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(!error);
+        }
+
+        void testWindow_ErrorResponseFinishesOnce() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->setWindowSize(2);
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBResult());
+
+            stanzaChannel->onIQReceived(IQ::createError(JID("baz@fum.com/foo"), stanzaChannel->sentStanzas[1]->getTo(), stanzaChannel->sentStanzas[1]->getID()));
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(error);
+            finished = false;
+            stanzaChannel->onIQReceived(IQ::createError(JID("baz@fum.com/foo"), stanzaChannel->sentStanzas[2]->getTo(), stanzaChannel->sentStanzas[2]->getID()));
+
+            CPPUNIT_ASSERT(!finished);
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(stanzaChannel->sentStanzas.size()));
+        }
+
+        void testWindow_ZeroSendsOneBlock() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->setWindowSize(0);
+            testling->start();
+
+            stanzaChannel->onIQReceived(createIBBResult());
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(stanzaChannel->sentStanzas.size()));
+            CPPUNIT_ASSERT(createByteArray("abc") == stanzaChannel->sentStanzas[1]->getPayload<IBB>()->getData());
+        }
+
+        void testPause_StopsSendingData() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBResult());
+
+            testling->pause();
+            stanzaChannel->onIQReceived(createIBBResult(1));
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(stanzaChannel->sentStanzas.size()));
+            CPPUNIT_ASSERT(!finished);
+        }
+
+        void testResume_ContinuesSendingData() {
+            std::shared_ptr<IBBSendSession> testling = createSession("foo@bar.com/baz");
+            testling->setBlockSize(3);
+            testling->start();
+            stanzaChannel->onIQReceived(createIBBResult());
+            testling->pause();
+            stanzaChannel->onIQReceived(createIBBResult(1));
+
+            testling->resume();
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(stanzaChannel->sentStanzas.size()));
+            CPPUNIT_ASSERT(createByteArray("def") == stanzaChannel->sentStanzas[2]->getPayload<IBB>()->getData());
+        }
+
     private:
+        IQ::ref createIBBResult(size_t index) {
+            return IQ::createResult(JID("baz@fum.com/dum"), stanzaChannel->sentStanzas[index]->getTo(), stanzaChannel->sentStanzas[index]->getID(), std::shared_ptr<IBB>());
+        }
+
         IQ::ref createIBBResult() {
             return IQ::createResult(JID("baz@fum.com/dum"), stanzaChannel->sentStanzas[stanzaChannel->sentStanzas.size()-1]->getTo(), stanzaChannel->sentStanzas[stanzaChannel->sentStanzas.size()-1]->getID(), std::shared_ptr<IBB>());
         }
@@ -12,6 +12,9 @@
 
 #include <iostream>
 #include <memory>
+#include <thread>
+
+#include <QA/Checker/IO.h>
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -24,11 +27,14 @@
 #include <Swiften/Crypto/PlatformCryptoProvider.h>
 #include <Swiften/Elements/IBB.h>
 #include <Swiften/Elements/JingleFileTransferDescription.h>
+#include <Swiften/Elements/JingleFileTransferHash.h>
 #include <Swiften/Elements/JingleIBBTransportPayload.h>
 #include <Swiften/Elements/JingleS5BTransportPayload.h>
 #include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/FileTransfer/ByteArrayReadBytestream.h>
 #include <Swiften/FileTransfer/ByteArrayWriteBytestream.h>
 #include <Swiften/FileTransfer/DefaultFileTransferTransporterFactory.h>
+#include <Swiften/FileTransfer/FileTransferOptions.h>
 #include <Swiften/FileTransfer/IncomingJingleFileTransfer.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamProxiesManager.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
@@ -49,12 +55,18 @@ class IncomingJingleFileTransferTest : public CppUnit::TestFixture {
         CPPUNIT_TEST_SUITE(IncomingJingleFileTransferTest);
         CPPUNIT_TEST(test_AcceptOnyIBBSendsSessionAccept);
         CPPUNIT_TEST(test_OnlyIBBTransferReceiveWorks);
+        CPPUNIT_TEST(test_ReceivedDataIsVerified);
+        CPPUNIT_TEST(test_ReceivedDataIsVerified_HashBeforeData);
+        CPPUNIT_TEST(test_ReceivedDataIsVerified_HashingInBackground);
+        CPPUNIT_TEST(test_ReceivedDataWithWrongHashFails);
+        CPPUNIT_TEST(test_ResumeAcceptsRemainingRange);
+        CPPUNIT_TEST(test_ResumeWithoutRangeSupportFails);
         //CPPUNIT_TEST(test_AcceptFailingS5BFallsBackToIBB);
         CPPUNIT_TEST_SUITE_END();
 public:
         std::shared_ptr<IncomingJingleFileTransfer> createTestling() {
             JID ourJID("our@jid.org/full");
-            return std::make_shared<IncomingJingleFileTransfer>(ourJID, std::shared_ptr<JingleSession>(session), jingleContentPayload, ftTransporterFactory, timerFactory, crypto.get());
+            return std::make_shared<IncomingJingleFileTransfer>(ourJID, std::shared_ptr<JingleSession>(session), jingleContentPayload, ftTransporterFactory, timerFactory, crypto.get(), eventLoop);
         }
 
         IQ::ref createIBBRequest(IBB::ref ibb, const JID& from, const std::string& id) {
@@ -145,6 +157,93 @@ public:
             CPPUNIT_ASSERT(createByteArray("abc") == byteStream->getData());
         }
 
+        void test_ReceivedDataIsVerified() {
+            addIBBTransferOfABC();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+            fileTransfer->accept(std::make_shared<ByteArrayWriteBytestream>());
+
+            receiveABC();
+            session->handleSessionInfoReceived(createHashInfo(crypto->getSHA1Hash(createByteArray("abc"))));
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::Success, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
+        void test_ReceivedDataIsVerified_HashBeforeData() {
+            addIBBTransferOfABC();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+            fileTransfer->accept(std::make_shared<ByteArrayWriteBytestream>());
+            session->handleSessionInfoReceived(createHashInfo(crypto->getSHA1Hash(createByteArray("abc"))));
+
+            receiveABC();
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::Success, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
+        void test_ReceivedDataIsVerified_HashingInBackground() {
+            addIBBTransferOfABC();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+            fileTransfer->accept(std::make_shared<ByteArrayWriteBytestream>(), FileTransferOptions().withHashingInBackground(true));
+            session->handleSessionInfoReceived(createHashInfo(crypto->getSHA1Hash(createByteArray("abc"))));
+
+            receiveABC();
+            for (int i = 0; i < 1000 && session->calledCommands.size() < 2; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                eventLoop->processEvents();
+            }
+
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::Success, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
+        void test_ReceivedDataWithWrongHashFails() {
+            addIBBTransferOfABC();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+            fileTransfer->accept(std::make_shared<ByteArrayWriteBytestream>());
+
+            receiveABC();
+            session->handleSessionInfoReceived(createHashInfo(crypto->getSHA1Hash(createByteArray("abd"))));
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::MediaError, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
+        void test_ResumeAcceptsRemainingRange() {
+            std::shared_ptr<JingleFileTransferDescription> desc = std::make_shared<JingleFileTransferDescription>();
+            JingleFileTransferFileInfo fileInfo("file.txt", "", 6);
+            fileInfo.addHash(HashElement("sha-1", ByteArray()));
+            fileInfo.setSupportsRangeRequests(true);
+            desc->setFileInfo(fileInfo);
+            jingleContentPayload->addDescription(desc);
+            addJingleIBBPayload();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+            std::shared_ptr<ByteArrayWriteBytestream> byteStream = std::make_shared<ByteArrayWriteBytestream>();
+
+            CPPUNIT_ASSERT(fileTransfer->resume(byteStream, std::make_shared<ByteArrayReadBytestream>(createByteArray("abc")), 3));
+
+            JingleFileTransferDescription::ref acceptDescription = std::dynamic_pointer_cast<JingleFileTransferDescription>(getCall<FakeJingleSession::AcceptCall>(0).description);
+            CPPUNIT_ASSERT(acceptDescription);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(3), acceptDescription->getFileInfo().getRangeOffset());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(3), fileTransfer->getRangeLength());
+
+            stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBOpen("mysession", 0x10), "foo@bar.com/baz", "id-open"));
+            stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBData("mysession", 0, createByteArray("def")), "foo@bar.com/baz", "id-a"));
+            session->handleSessionInfoReceived(createHashInfo(crypto->getSHA1Hash(createByteArray("abcdef"))));
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("def"), byteStream->getData());
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::Success, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
+        void test_ResumeWithoutRangeSupportFails() {
+            addIBBTransferOfABC();
+            std::shared_ptr<IncomingJingleFileTransfer> fileTransfer = createTestling();
+
+            CPPUNIT_ASSERT(!fileTransfer->resume(std::make_shared<ByteArrayWriteBytestream>(), std::make_shared<ByteArrayReadBytestream>(createByteArray("a")), 1));
+
+            CPPUNIT_ASSERT(session->calledCommands.empty());
+        }
+
         void test_AcceptFailingS5BFallsBackToIBB() {
             //1. create your test incoming file transfer
             addFileTransferDescription();
@@ -186,6 +285,28 @@ public:
         }
 #endif
 private:
+    void addIBBTransferOfABC() {
+        std::shared_ptr<JingleFileTransferDescription> desc = std::make_shared<JingleFileTransferDescription>();
+        JingleFileTransferFileInfo fileInfo("file.txt", "", 3);
+        fileInfo.addHash(HashElement("sha-1", ByteArray()));
+        desc->setFileInfo(fileInfo);
+        jingleContentPayload->addDescription(desc);
+        addJingleIBBPayload();
+    }
+
+    void receiveABC() {
+        stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBOpen("mysession", 0x10), "foo@bar.com/baz", "id-open"));
+        stanzaChannel->onIQReceived(createIBBRequest(IBB::createIBBData("mysession", 0, createByteArray("abc")), "foo@bar.com/baz", "id-a"));
+    }
+
+    std::shared_ptr<JinglePayload> createHashInfo(const ByteArray& sha1) {
+        std::shared_ptr<JingleFileTransferHash> hash = std::make_shared<JingleFileTransferHash>();
+        hash->getFileInfo().addHash(HashElement("sha-1", sha1));
+        std::shared_ptr<JinglePayload> payload = std::make_shared<JinglePayload>(JinglePayload::SessionInfo, "mysession");
+        payload->addPayload(hash);
+        return payload;
+    }
+
     void addFileTransferDescription() {
         std::shared_ptr<JingleFileTransferDescription> desc = std::make_shared<JingleFileTransferDescription>();
         desc->setFileInfo(JingleFileTransferFileInfo("file.txt", "", 10));
@@ -219,7 +340,7 @@ private:
     }
 
 private:
-    EventLoop* eventLoop;
+    DummyEventLoop* eventLoop;
     std::shared_ptr<CryptoProvider> crypto;
     std::shared_ptr<FakeJingleSession> session;
     std::shared_ptr<JingleContentPayload> jingleContentPayload;
@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/FileTransfer/IncrementalBytestreamHashCalculator.h>
+
+using namespace Swift;
+
+class IncrementalBytestreamHashCalculatorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(IncrementalBytestreamHashCalculatorTest);
+        CPPUNIT_TEST(testGetHash);
+        CPPUNIT_TEST(testGetHash_WithoutFinish);
+        CPPUNIT_TEST(testFinish_EmitsFinished);
+        CPPUNIT_TEST(testFinish_WithEventLoop);
+        CPPUNIT_TEST(testFinish_WithEventLoop_ReleasedFromHandler);
+        CPPUNIT_TEST(testFinish_InBackground);
+        CPPUNIT_TEST(testFinish_InBackgroundWithoutData);
+        CPPUNIT_TEST(testFeedData_InBackground_BusyUntilReady);
+        CPPUNIT_TEST(testFinish_InBackground_MultipleCalculators);
+        CPPUNIT_TEST(testUnsupportedAlgorithmIsIgnored);
+        CPPUNIT_TEST(testDestroyWhileHashingInBackground);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+            eventLoop = std::make_shared<DummyEventLoop>();
+            algorithms.clear();
+            algorithms.push_back("sha-1");
+            algorithms.push_back("md5");
+            finished = 0;
+            ready = 0;
+        }
+
+        void testGetHash() {
+            IncrementalBytestreamHashCalculator testling(algorithms, crypto.get());
+
+            testling.feedData(createByteArray("abc"));
+            testling.feedData(createByteArray("def"));
+            testling.finish();
+
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(createByteArray("abcdef")), testling.getHash("sha-1"));
+            CPPUNIT_ASSERT_EQUAL(crypto->getMD5Hash(createByteArray("abcdef")), testling.getHash("md5"));
+        }
+
+        void testGetHash_WithoutFinish() {
+            IncrementalBytestreamHashCalculator testling(false, true, crypto.get());
+
+            testling.feedData(createByteArray("abcdef"));
+
+            CPPUNIT_ASSERT(!testling.hasHash("md5"));
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(createByteArray("abcdef")), testling.getSHA1Hash());
+        }
+
+        void testFinish_EmitsFinished() {
+            IncrementalBytestreamHashCalculator testling(algorithms, crypto.get());
+            testling.onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+
+            testling.finish();
+
+            CPPUNIT_ASSERT_EQUAL(1, finished);
+            CPPUNIT_ASSERT(testling.isFinished());
+        }
+
+        void testFinish_WithEventLoop() {
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get());
+            testling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+            testling->feedData(createByteArray("abc"));
+
+            testling->finish();
+            CPPUNIT_ASSERT_EQUAL(0, finished);
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(1, finished);
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(createByteArray("abc")), testling->getHash("sha-1"));
+        }
+
+        void testFinish_WithEventLoop_ReleasedFromHandler() {
+            releasedTestling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get());
+            releasedTestling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinishedRelease, this));
+            releasedTestling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+
+            releasedTestling->finish();
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT(!releasedTestling);
+            CPPUNIT_ASSERT_EQUAL(1, finished);
+        }
+
+        void testFinish_InBackground() {
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+            testling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+            ByteArray data;
+            for (int i = 0; i < 1000; ++i) {
+                ByteArray chunk(1024, static_cast<unsigned char>(i));
+                testling->feedData(chunk);
+                data.insert(data.end(), chunk.begin(), chunk.end());
+            }
+
+            testling->finish();
+            waitForFinished();
+
+            CPPUNIT_ASSERT_EQUAL(1, finished);
+            CPPUNIT_ASSERT(testling->isFinished());
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(data), testling->getHash("sha-1"));
+            CPPUNIT_ASSERT_EQUAL(crypto->getMD5Hash(data), testling->getHash("md5"));
+        }
+
+        void testFinish_InBackgroundWithoutData() {
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+            testling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+
+            testling->finish();
+            waitForFinished();
+
+            CPPUNIT_ASSERT_EQUAL(1, finished);
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(ByteArray()), testling->getHash("sha-1"));
+        }
+
+        void testFeedData_InBackground_BusyUntilReady() {
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+            testling->onReady.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleReady, this));
+            testling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+            ByteArray data(16 * 1024 * 1024, 'a');
+
+            testling->feedData(data);
+            CPPUNIT_ASSERT(testling->isBusy());
+            for (int i = 0; i < 5000 && !ready; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                eventLoop->processEvents();
+            }
+
+            CPPUNIT_ASSERT_EQUAL(1, ready);
+            CPPUNIT_ASSERT(!testling->isBusy());
+            testling->finish();
+            waitForFinished();
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(data), testling->getHash("sha-1"));
+        }
+
+        void testFinish_InBackground_MultipleCalculators() {
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling1 = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+            std::shared_ptr<IncrementalBytestreamHashCalculator> testling2 = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+            testling1->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+            testling2->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+
+            testling1->feedData(createByteArray("abc"));
+            testling2->feedData(createByteArray("def"));
+            testling1->feedData(createByteArray("def"));
+            testling2->finish();
+            testling1->finish();
+            for (int i = 0; i < 1000 && finished < 2; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                eventLoop->processEvents();
+            }
+
+            CPPUNIT_ASSERT_EQUAL(2, finished);
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(createByteArray("abcdef")), testling1->getHash("sha-1"));
+            CPPUNIT_ASSERT_EQUAL(crypto->getSHA1Hash(createByteArray("def")), testling2->getHash("sha-1"));
+        }
+
+        void testUnsupportedAlgorithmIsIgnored() {
+            algorithms.push_back("foo-256");
+            IncrementalBytestreamHashCalculator testling(algorithms, crypto.get());
+
+            CPPUNIT_ASSERT_EQUAL(size_t(2), testling.getAlgorithms().size());
+            CPPUNIT_ASSERT(!testling.hasHash("foo-256"));
+        }
+
+        void testDestroyWhileHashingInBackground() {
+            {
+                std::shared_ptr<IncrementalBytestreamHashCalculator> testling = std::make_shared<IncrementalBytestreamHashCalculator>(algorithms, crypto.get(), eventLoop.get(), true);
+                testling->onFinished.connect(boost::bind(&IncrementalBytestreamHashCalculatorTest::handleFinished, this));
+                testling->feedData(ByteArray(1024 * 1024, 'a'));
+                testling->finish();
+            }
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(0, finished);
+        }
+
+    private:
+        void handleFinished() {
+            finished++;
+        }
+
+        void handleReady() {
+            ready++;
+        }
+
+        void handleFinishedRelease() {
+            releasedTestling.reset();
+        }
+
+        void waitForFinished() {
+            for (int i = 0; i < 1000 && !finished; ++i) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                eventLoop->processEvents();
+            }
+        }
+
+    private:
+        std::shared_ptr<CryptoProvider> crypto;
+        std::shared_ptr<DummyEventLoop> eventLoop;
+        std::vector<std::string> algorithms;
+        int finished;
+        int ready;
+        std::shared_ptr<IncrementalBytestreamHashCalculator> releasedTestling;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IncrementalBytestreamHashCalculatorTest);
@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/FileTransfer/BytestreamException.h>
+#include <Swiften/FileTransfer/MappedFileReadBytestream.h>
+
+using namespace Swift;
+
+class MappedFileReadBytestreamTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(MappedFileReadBytestreamTest);
+        CPPUNIT_TEST(testRead);
+        CPPUNIT_TEST(testReadView_AcrossWindows);
+        CPPUNIT_TEST(testReadView_EmitsRead);
+        CPPUNIT_TEST(testReadView_OutlivesWindow);
+        CPPUNIT_TEST(testRead_EmptyFile);
+        CPPUNIT_TEST(testRead_MissingFile);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            file = boost::filesystem::unique_path("mapped_file_read_bytestream_test_%%%%%%%%%%%%%%%%");
+            content.clear();
+            for (size_t i = 0; i < 10000; ++i) {
+                content.push_back(static_cast<unsigned char>(i * 7));
+            }
+            writeFile(content);
+            readData.clear();
+        }
+
+        void tearDown() {
+            boost::filesystem::remove(file);
+        }
+
+        void testRead() {
+            MappedFileReadBytestream testling(file);
+
+            std::shared_ptr<ByteArray> result = testling.read(6000);
+            CPPUNIT_ASSERT(!testling.isFinished());
+            append(*result, *testling.read(6000));
+
+            CPPUNIT_ASSERT(content == *result);
+            CPPUNIT_ASSERT(testling.isFinished());
+        }
+
+        void testReadView_AcrossWindows() {
+            MappedFileReadBytestream testling(file, 4096);
+
+            ByteArray result;
+            ReadBytestream::View view = testling.readView(3000);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3000), view.size);
+            result.insert(result.end(), view.data, view.data + view.size);
+            view = testling.readView(3000);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1096), view.size);
+            result.insert(result.end(), view.data, view.data + view.size);
+            while (!testling.isFinished()) {
+                view = testling.readView(3000);
+                result.insert(result.end(), view.data, view.data + view.size);
+            }
+
+            CPPUNIT_ASSERT(content == result);
+        }
+
+        void testReadView_EmitsRead() {
+            MappedFileReadBytestream testling(file, 4096);
+            testling.onRead.connect(boost::bind(&MappedFileReadBytestreamTest::handleRead, this, _1));
+
+            while (!testling.isFinished()) {
+                testling.readView(3000);
+            }
+
+            CPPUNIT_ASSERT(content == readData);
+        }
+
+        void testReadView_OutlivesWindow() {
+            MappedFileReadBytestream testling(file, 4096);
+
+            ReadBytestream::View first = testling.readView(4096);
+            ReadBytestream::View second = testling.readView(4096);
+
+            CPPUNIT_ASSERT(ByteArray(content.begin(), content.begin() + 4096) == ByteArray(first.data, first.data + first.size));
+            CPPUNIT_ASSERT(ByteArray(content.begin() + 4096, content.begin() + 8192) == ByteArray(second.data, second.data + second.size));
+        }
+
+        void testRead_EmptyFile() {
+            writeFile(ByteArray());
+            MappedFileReadBytestream testling(file);
+
+            CPPUNIT_ASSERT(testling.isFinished());
+            CPPUNIT_ASSERT(testling.read(100)->empty());
+        }
+
+        void testRead_MissingFile() {
+            MappedFileReadBytestream testling(file / "missing");
+
+            CPPUNIT_ASSERT(!testling.isFinished());
+            CPPUNIT_ASSERT_THROW(testling.read(100), BytestreamException);
+        }
+
+    private:
+        void writeFile(const ByteArray& data) {
+            boost::filesystem::ofstream stream(file, std::ios_base::out|std::ios_base::binary|std::ios_base::trunc);
+            stream.write(reinterpret_cast<const char*>(vecptr(data)), static_cast<std::streamsize>(data.size()));
+        }
+
+        void handleRead(const std::vector<unsigned char>& data) {
+            append(readData, data);
+        }
+
+    private:
+        boost::filesystem::path file;
+        ByteArray content;
+        ByteArray readData;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MappedFileReadBytestreamTest);
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <algorithm>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/FileTransfer/MappedFileWriteBytestream.h>
+
+using namespace Swift;
+
+class MappedFileWriteBytestreamTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(MappedFileWriteBytestreamTest);
+        CPPUNIT_TEST(testConstructor_AllocatesFile);
+        CPPUNIT_TEST(testWrite_AcrossWindows);
+        CPPUNIT_TEST(testWrite_BeyondSize);
+        CPPUNIT_TEST(testClose_TruncatesToWrittenData);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            file = boost::filesystem::unique_path("mapped_file_write_bytestream_test_%%%%%%%%%%%%%%%%");
+            content.clear();
+            for (size_t i = 0; i < 10000; ++i) {
+                content.push_back(static_cast<unsigned char>(i * 7));
+            }
+            writtenData.clear();
+        }
+
+        void tearDown() {
+            boost::filesystem::remove(file);
+        }
+
+        void testConstructor_AllocatesFile() {
+            MappedFileWriteBytestream testling(file, content.size());
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(content.size()), boost::filesystem::file_size(file));
+        }
+
+        void testWrite_AcrossWindows() {
+            {
+                MappedFileWriteBytestream testling(file, content.size(), 4096);
+                testling.onWrite.connect(boost::bind(&MappedFileWriteBytestreamTest::handleWrite, this, _1));
+
+                for (size_t i = 0; i < content.size(); i += 3000) {
+                    size_t size = std::min(static_cast<size_t>(3000), content.size() - i);
+                    CPPUNIT_ASSERT(testling.write(createByteArray(&content[i], size)));
+                }
+            }
+
+            CPPUNIT_ASSERT(content == readFile());
+            CPPUNIT_ASSERT(content == writtenData);
+        }
+
+        void testWrite_BeyondSize() {
+            MappedFileWriteBytestream testling(file, 10);
+
+            CPPUNIT_ASSERT(testling.write(createByteArray("abcdef")));
+            CPPUNIT_ASSERT(!testling.write(createByteArray("ghijk")));
+            CPPUNIT_ASSERT(testling.write(createByteArray("ghij")));
+        }
+
+        void testClose_TruncatesToWrittenData() {
+            MappedFileWriteBytestream testling(file, content.size());
+            testling.write(createByteArray("abcdef"));
+
+            testling.close();
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readFile());
+            CPPUNIT_ASSERT(!testling.write(createByteArray("ghij")));
+        }
+
+    private:
+        ByteArray readFile() {
+            ByteArray result;
+            readByteArrayFromFile(result, file);
+            return result;
+        }
+
+        void handleWrite(const std::vector<unsigned char>& data) {
+            append(writtenData, data);
+        }
+
+    private:
+        boost::filesystem::path file;
+        ByteArray content;
+        ByteArray writtenData;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(MappedFileWriteBytestreamTest);
@@ -57,6 +57,9 @@ class OutgoingJingleFileTransferTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(test_FallbackToIBBAfterFailingS5B);
         CPPUNIT_TEST(test_ReceiveSessionTerminateAfterSessionInitiate);
         CPPUNIT_TEST(test_DeclineEmitsFinishedStateCanceled);
+        CPPUNIT_TEST(test_AcceptWithRangeResumesAtOffset);
+        CPPUNIT_TEST(test_AcceptWithRangeReadsSkippedDataInEvents);
+        CPPUNIT_TEST(test_AcceptWithRangeOutsideOfferTerminates);
         CPPUNIT_TEST_SUITE_END();
 
         class FTStatusHelper {
@@ -97,7 +100,8 @@ public:
                 idGen,
                 fileInfo,
                 options,
-                crypto.get()));
+                crypto.get(),
+                eventLoop));
         }
 
         IQ::ref createIBBRequest(IBB::ref ibb, const JID& from, const std::string& id) {
@@ -158,6 +162,7 @@ public:
             JingleFileTransferDescription::ref description = std::dynamic_pointer_cast<JingleFileTransferDescription>(call.description);
             CPPUNIT_ASSERT(description);
             CPPUNIT_ASSERT(static_cast<size_t>(1048576) == description->getFileInfo().getSize());
+            CPPUNIT_ASSERT(description->getFileInfo().getSupportsRangeRequests());
 
             JingleIBBTransportPayload::ref transport = std::dynamic_pointer_cast<JingleIBBTransportPayload>(call.payload);
             CPPUNIT_ASSERT(transport);
@@ -223,9 +228,59 @@ public:
             CPPUNIT_ASSERT(FileTransfer::State::Canceled == helper.state.get().type);
         }
 
+        void test_AcceptWithRangeResumesAtOffset() {
+            std::shared_ptr<OutgoingJingleFileTransfer> transfer = createTestling();
+            transfer->start();
+            FakeJingleSession::InitiateCall call = getCall<FakeJingleSession::InitiateCall>(0);
+
+            fakeJingleSession->handleSessionAcceptReceived(call.id, createRangeDescription(call.description, 1000000), call.payload);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(1000000), transfer->getRangeOffset());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(1024 * 1024 - 1000000), transfer->getRangeLength());
+            IQ::ref iqOpenStanza = stanzaChannel->getStanzaAtIndex<IQ>(0);
+            CPPUNIT_ASSERT(iqOpenStanza);
+            CPPUNIT_ASSERT(iqOpenStanza->getPayload<IBB>());
+        }
+
+        void test_AcceptWithRangeReadsSkippedDataInEvents() {
+            std::shared_ptr<OutgoingJingleFileTransfer> transfer = createTestling();
+            transfer->start();
+            FakeJingleSession::InitiateCall call = getCall<FakeJingleSession::InitiateCall>(0);
+            size_t readBytes = 0;
+            boost::signals2::scoped_connection readConnection = stream->onRead.connect(boost::bind(&OutgoingJingleFileTransferTest::handleStreamRead, this, boost::ref(readBytes), _1));
+
+            fakeJingleSession->handleSessionAcceptReceived(call.id, createRangeDescription(call.description, 1000000), call.payload);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), readBytes);
+
+            dynamic_cast<DummyEventLoop*>(eventLoop)->processEvents();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1000000), readBytes);
+        }
+
+        void test_AcceptWithRangeOutsideOfferTerminates() {
+            std::shared_ptr<OutgoingJingleFileTransfer> transfer = createTestling();
+            transfer->start();
+            FakeJingleSession::InitiateCall call = getCall<FakeJingleSession::InitiateCall>(0);
+
+            fakeJingleSession->handleSessionAcceptReceived(call.id, createRangeDescription(call.description, 1024 * 1024), call.payload);
+
+            CPPUNIT_ASSERT_EQUAL(JinglePayload::Reason::FailedApplication, getCall<FakeJingleSession::TerminateCall>(1).reason);
+        }
+
 //TODO: some more testcases
 
 private:
+    void handleStreamRead(size_t& readBytes, const std::vector<unsigned char>& data) {
+        readBytes += data.size();
+    }
+
+    JingleDescription::ref createRangeDescription(JingleDescription::ref offer, boost::uintmax_t offset) {
+        JingleFileTransferFileInfo fileInfo = std::dynamic_pointer_cast<JingleFileTransferDescription>(offer)->getFileInfo();
+        fileInfo.setRangeOffset(offset);
+        JingleFileTransferDescription::ref description = std::make_shared<JingleFileTransferDescription>();
+        description->setFileInfo(fileInfo);
+        return description;
+    }
+
     void addFileTransferDescription() {
         std::shared_ptr<JingleFileTransferDescription> desc = std::make_shared<JingleFileTransferDescription>();
         desc->setFileInfo(JingleFileTransferFileInfo());
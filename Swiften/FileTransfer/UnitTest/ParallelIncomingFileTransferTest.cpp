@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+#include <Swiften/FileTransfer/ParallelIncomingFileTransfer.h>
+#include <Swiften/JID/JID.h>
+
+using namespace Swift;
+
+class ParallelIncomingFileTransferTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ParallelIncomingFileTransferTest);
+        CPPUNIT_TEST(testIsRangeOfSameFile);
+        CPPUNIT_TEST(testAddTransfer_Overlapping);
+        CPPUNIT_TEST(testAccept_WritesRangesAtTheirOffsets);
+        CPPUNIT_TEST(testAccept_AcceptsRangesAddedLater);
+        CPPUNIT_TEST(testAccept_OtherBytestream);
+        CPPUNIT_TEST(testFinished_AfterAllRangesFinished);
+        CPPUNIT_TEST(testFinished_WaitsForMissingRanges);
+        CPPUNIT_TEST(testFailed_CancelsOtherTransfers);
+        CPPUNIT_TEST(testCancel);
+        CPPUNIT_TEST_SUITE_END();
+
+        class FakeIncomingFileTransfer : public IncomingFileTransfer {
+            public:
+                FakeIncomingFileTransfer(const JID& sender, const std::string& name, boost::uintmax_t size, boost::uintmax_t offset, boost::uintmax_t length) : sender(sender), recipient("foo@bar.com/baz") {
+                    setFileInfo(name, size, "");
+                    setRange(offset, length);
+                    setState(State::WaitingForAccept);
+                }
+
+                virtual void accept(std::shared_ptr<WriteBytestream> stream, const FileTransferOptions&) {
+                    this->stream = stream;
+                    setState(State::Transferring);
+                }
+
+                virtual bool resume(std::shared_ptr<WriteBytestream>, std::shared_ptr<ReadBytestream>, boost::uintmax_t, const FileTransferOptions&) {
+                    return false;
+                }
+
+                virtual void cancel() {
+                    finish(State::Canceled, FileTransferError(FileTransferError::UnknownError));
+                }
+
+                virtual const JID& getSender() const {
+                    return sender;
+                }
+
+                virtual const JID& getRecipient() const {
+                    return recipient;
+                }
+
+                void finish(State::Type type, boost::optional<FileTransferError> error = boost::optional<FileTransferError>()) {
+                    setState(type);
+                    onFinished(error);
+                }
+
+                JID sender;
+                JID recipient;
+                std::shared_ptr<WriteBytestream> stream;
+        };
+
+    public:
+        void setUp() {
+            sender = JID("alice@wonderland.lit/rabbithole");
+            file = boost::filesystem::unique_path("parallel_incoming_file_transfer_test_%%%%%%%%%%%%%%%%");
+            fakeTransfers.clear();
+            for (size_t i = 0; i < 3; ++i) {
+                fakeTransfers.push_back(createTransfer(i * 4, i == 2 ? 2 : 4));
+            }
+            finishedCount = 0;
+            finishedError.reset();
+        }
+
+        void tearDown() {
+            fakeTransfers.clear();
+            boost::filesystem::remove(file);
+        }
+
+        void testIsRangeOfSameFile() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(1);
+
+            CPPUNIT_ASSERT(testling->isRangeOfSameFile(fakeTransfers[1]));
+            CPPUNIT_ASSERT(!testling->isRangeOfSameFile(std::make_shared<FakeIncomingFileTransfer>(JID("other@bar.com/baz"), "file", 10, 4, 4)));
+            CPPUNIT_ASSERT(!testling->isRangeOfSameFile(std::make_shared<FakeIncomingFileTransfer>(sender, "other", 10, 4, 4)));
+            CPPUNIT_ASSERT(!testling->isRangeOfSameFile(std::make_shared<FakeIncomingFileTransfer>(sender, "file", 11, 4, 4)));
+        }
+
+        void testAddTransfer_Overlapping() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(2);
+
+            CPPUNIT_ASSERT(!testling->addTransfer(createTransfer(6, 4)));
+            CPPUNIT_ASSERT(!testling->addTransfer(createTransfer(2, 1)));
+            CPPUNIT_ASSERT(testling->addTransfer(fakeTransfers[2]));
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), testling->getTransfers().size());
+        }
+
+        void testAccept_WritesRangesAtTheirOffsets() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(3);
+
+            testling->accept(std::make_shared<FileDescriptorWriteBytestream>(file));
+
+            CPPUNIT_ASSERT(fakeTransfers[2]->stream->write(createByteArray("ij")));
+            CPPUNIT_ASSERT(fakeTransfers[0]->stream->write(createByteArray("ab")));
+            CPPUNIT_ASSERT(fakeTransfers[1]->stream->write(createByteArray("efgh")));
+            CPPUNIT_ASSERT(fakeTransfers[0]->stream->write(createByteArray("cd")));
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdefghij"), readFile());
+        }
+
+        void testAccept_AcceptsRangesAddedLater() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(2);
+            testling->accept(std::make_shared<FileDescriptorWriteBytestream>(file));
+
+            testling->addTransfer(fakeTransfers[2]);
+
+            CPPUNIT_ASSERT(fakeTransfers[2]->stream);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Transferring, fakeTransfers[2]->getState().type);
+        }
+
+        void testAccept_OtherBytestream() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(3);
+
+            testling->accept(std::shared_ptr<WriteBytestream>());
+
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(finishedError);
+            CPPUNIT_ASSERT_EQUAL(FileTransferError::WriteError, finishedError->getType());
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Failed, testling->getState().type);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[0]->getState().type);
+        }
+
+        void testFinished_AfterAllRangesFinished() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(3);
+            testling->accept(std::make_shared<FileDescriptorWriteBytestream>(file));
+
+            fakeTransfers[1]->finish(FileTransfer::State::Finished);
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT_EQUAL(0, finishedCount);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Transferring, testling->getState().type);
+
+            fakeTransfers[2]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(!finishedError);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Finished, testling->getState().type);
+        }
+
+        void testFinished_WaitsForMissingRanges() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(2);
+            testling->accept(std::make_shared<FileDescriptorWriteBytestream>(file));
+
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+            fakeTransfers[1]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT(!testling->isComplete());
+            CPPUNIT_ASSERT_EQUAL(0, finishedCount);
+
+            testling->addTransfer(fakeTransfers[2]);
+            fakeTransfers[2]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Finished, testling->getState().type);
+        }
+
+        void testFailed_CancelsOtherTransfers() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(3);
+            testling->accept(std::make_shared<FileDescriptorWriteBytestream>(file));
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+
+            fakeTransfers[1]->finish(FileTransfer::State::Failed, FileTransferError(FileTransferError::PeerError));
+
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[2]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(finishedError);
+            CPPUNIT_ASSERT_EQUAL(FileTransferError::PeerError, finishedError->getType());
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Failed, testling->getState().type);
+            CPPUNIT_ASSERT(!testling->addTransfer(createTransfer(10, 0)));
+        }
+
+        void testCancel() {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = createTestling(3);
+
+            testling->cancel();
+
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[0]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[2]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, testling->getState().type);
+        }
+
+    private:
+        std::shared_ptr<FakeIncomingFileTransfer> createTransfer(boost::uintmax_t offset, boost::uintmax_t length) {
+            return std::make_shared<FakeIncomingFileTransfer>(sender, "file", 10, offset, length);
+        }
+
+        std::shared_ptr<ParallelIncomingFileTransfer> createTestling(size_t ranges) {
+            std::shared_ptr<ParallelIncomingFileTransfer> testling = std::make_shared<ParallelIncomingFileTransfer>(fakeTransfers[0]);
+            for (size_t i = 1; i < ranges; ++i) {
+                testling->addTransfer(fakeTransfers[i]);
+            }
+            testling->onFinished.connect(boost::bind(&ParallelIncomingFileTransferTest::handleFinished, this, _1));
+            return testling;
+        }
+
+        ByteArray readFile() {
+            ByteArray result;
+            readByteArrayFromFile(result, file);
+            return result;
+        }
+
+        void handleFinished(boost::optional<FileTransferError> error) {
+            ++finishedCount;
+            finishedError = error;
+        }
+
+    private:
+        JID sender;
+        boost::filesystem::path file;
+        std::vector<std::shared_ptr<FakeIncomingFileTransfer> > fakeTransfers;
+        int finishedCount;
+        boost::optional<FileTransferError> finishedError;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ParallelIncomingFileTransferTest);
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/FileTransfer/ParallelOutgoingFileTransfer.h>
+
+using namespace Swift;
+
+class ParallelOutgoingFileTransferTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ParallelOutgoingFileTransferTest);
+        CPPUNIT_TEST(testStart_StartsAllTransfers);
+        CPPUNIT_TEST(testProcessedBytes);
+        CPPUNIT_TEST(testFinished_AfterAllTransfersFinished);
+        CPPUNIT_TEST(testFailed_CancelsOtherTransfers);
+        CPPUNIT_TEST(testCancel);
+        CPPUNIT_TEST_SUITE_END();
+
+        class FakeOutgoingFileTransfer : public OutgoingFileTransfer {
+            public:
+                FakeOutgoingFileTransfer() : started(false) {
+                }
+
+                virtual void start() {
+                    started = true;
+                    setState(State::Transferring);
+                }
+
+                virtual void cancel() {
+                    finish(State::Canceled, FileTransferError(FileTransferError::UnknownError));
+                }
+
+                void finish(State::Type type, boost::optional<FileTransferError> error = boost::optional<FileTransferError>()) {
+                    setState(type);
+                    onFinished(error);
+                }
+
+                bool started;
+        };
+
+    public:
+        void setUp() {
+            transfers.clear();
+            for (size_t i = 0; i < 3; ++i) {
+                fakeTransfers.push_back(std::make_shared<FakeOutgoingFileTransfer>());
+                transfers.push_back(fakeTransfers.back());
+            }
+            finishedCount = 0;
+            finishedError.reset();
+            processedBytes = 0;
+        }
+
+        void tearDown() {
+            fakeTransfers.clear();
+            transfers.clear();
+        }
+
+        void testStart_StartsAllTransfers() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = createTestling();
+
+            testling->start();
+
+            for (size_t i = 0; i < fakeTransfers.size(); ++i) {
+                CPPUNIT_ASSERT(fakeTransfers[i]->started);
+            }
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Transferring, testling->getState().type);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(3000), testling->getFileSizeInBytes());
+        }
+
+        void testProcessedBytes() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = createTestling();
+            testling->start();
+
+            fakeTransfers[0]->onProcessedBytes(100);
+            fakeTransfers[2]->onProcessedBytes(200);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(300), processedBytes);
+        }
+
+        void testFinished_AfterAllTransfersFinished() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = createTestling();
+            testling->start();
+
+            fakeTransfers[1]->finish(FileTransfer::State::Finished);
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT_EQUAL(0, finishedCount);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Transferring, testling->getState().type);
+
+            fakeTransfers[2]->finish(FileTransfer::State::Finished);
+
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(!finishedError);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Finished, testling->getState().type);
+        }
+
+        void testFailed_CancelsOtherTransfers() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = createTestling();
+            testling->start();
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+
+            fakeTransfers[1]->finish(FileTransfer::State::Failed, FileTransferError(FileTransferError::PeerError));
+
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[2]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(finishedError);
+            CPPUNIT_ASSERT_EQUAL(FileTransferError::PeerError, finishedError->getType());
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Failed, testling->getState().type);
+        }
+
+        void testCancel() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = createTestling();
+            testling->start();
+            fakeTransfers[0]->finish(FileTransfer::State::Finished);
+
+            testling->cancel();
+
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[1]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, fakeTransfers[2]->getState().type);
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT_EQUAL(FileTransfer::State::Canceled, testling->getState().type);
+        }
+
+    private:
+        std::shared_ptr<ParallelOutgoingFileTransfer> createTestling() {
+            std::shared_ptr<ParallelOutgoingFileTransfer> testling = std::make_shared<ParallelOutgoingFileTransfer>(transfers, "file", 3000, "");
+            testling->onFinished.connect(boost::bind(&ParallelOutgoingFileTransferTest::handleFinished, this, _1));
+            testling->onProcessedBytes.connect(boost::bind(&ParallelOutgoingFileTransferTest::handleProcessedBytes, this, _1));
+            return testling;
+        }
+
+        void handleFinished(boost::optional<FileTransferError> error) {
+            ++finishedCount;
+            finishedError = error;
+        }
+
+        void handleProcessedBytes(size_t bytes) {
+            processedBytes += bytes;
+        }
+
+    private:
+        std::vector<std::shared_ptr<FakeOutgoingFileTransfer> > fakeTransfers;
+        std::vector<OutgoingFileTransfer::ref> transfers;
+        int finishedCount;
+        boost::optional<FileTransferError> finishedError;
+        size_t processedBytes;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ParallelOutgoingFileTransferTest);
@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/optional.hpp>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/FileTransfer/PartialFileStorage.h>
+#include <Swiften/FileTransfer/ReadBytestream.h>
+#include <Swiften/FileTransfer/WriteBytestream.h>
+#include <Swiften/JID/JID.h>
+
+using namespace Swift;
+
+class PartialFileStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(PartialFileStorageTest);
+        CPPUNIT_TEST(testAccept_StoresFileAtDestination);
+        CPPUNIT_TEST(testAccept_ResumesInterruptedTransfer);
+        CPPUNIT_TEST(testAccept_RestartsWithoutRangeSupport);
+        CPPUNIT_TEST(testAccept_DropsDataThatFailedVerification);
+        CPPUNIT_TEST(testAccept_WritesRangeAtOffset);
+        CPPUNIT_TEST_SUITE_END();
+
+        class FakeIncomingFileTransfer : public IncomingFileTransfer {
+            public:
+                FakeIncomingFileTransfer(boost::uintmax_t size, bool supportsRanges) : sender("alice@wonderland.lit/rabbithole"), recipient("bob@wonderland.lit/hole"), supportsRanges(supportsRanges), resumeOffset(0) {
+                    setFileInfo("file.txt", size, "");
+                }
+
+                void setRange(boost::uintmax_t offset, boost::uintmax_t length) {
+                    FileTransfer::setRange(offset, length);
+                }
+
+                virtual void accept(std::shared_ptr<WriteBytestream> stream, const FileTransferOptions&) {
+                    this->stream = stream;
+                }
+
+                virtual bool resume(std::shared_ptr<WriteBytestream> stream, std::shared_ptr<ReadBytestream> receivedData, boost::uintmax_t offset, const FileTransferOptions&) {
+                    if (!supportsRanges) {
+                        return false;
+                    }
+                    this->stream = stream;
+                    this->receivedData = receivedData;
+                    resumeOffset = offset;
+                    return true;
+                }
+
+                virtual void cancel() {
+                }
+
+                virtual const JID& getSender() const {
+                    return sender;
+                }
+
+                virtual const JID& getRecipient() const {
+                    return recipient;
+                }
+
+                void receive(const std::string& data) {
+                    stream->write(createByteArray(data));
+                }
+
+                void finish(boost::optional<FileTransferError> error = boost::optional<FileTransferError>()) {
+                    onFinished(error);
+                }
+
+            public:
+                JID sender;
+                JID recipient;
+                bool supportsRanges;
+                std::shared_ptr<WriteBytestream> stream;
+                std::shared_ptr<ReadBytestream> receivedData;
+                boost::uintmax_t resumeOffset;
+        };
+
+    public:
+        void setUp() {
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+            baseDir = boost::filesystem::unique_path("partial_file_storage_test_%%%%%%%%%%%%%%%%");
+            boost::filesystem::create_directories(baseDir);
+            destination = baseDir / "file.txt";
+            finishedCount = 0;
+            finishedError.reset();
+        }
+
+        void tearDown() {
+            boost::filesystem::remove_all(baseDir);
+        }
+
+        void testAccept_StoresFileAtDestination() {
+            std::shared_ptr<PartialFileStorage> testling = createTestling();
+            std::shared_ptr<FakeIncomingFileTransfer> transfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+
+            testling->accept(transfer, destination);
+            transfer->receive("abcdef");
+            transfer->finish();
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readDestination());
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(!finishedError);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(0), testling->getReceivedSize(transfer));
+        }
+
+        void testAccept_ResumesInterruptedTransfer() {
+            std::shared_ptr<PartialFileStorage> testling = createTestling();
+            std::shared_ptr<FakeIncomingFileTransfer> transfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+            testling->accept(transfer, destination);
+            transfer->receive("abc");
+            transfer->finish(FileTransferError(FileTransferError::PeerError));
+            CPPUNIT_ASSERT(!boost::filesystem::exists(destination));
+
+            std::shared_ptr<FakeIncomingFileTransfer> resumedTransfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+            testling = createTestling();
+            testling->accept(resumedTransfer, destination);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(3), resumedTransfer->resumeOffset);
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abc"), *resumedTransfer->receivedData->read(100));
+            resumedTransfer->receive("def");
+            resumedTransfer->finish();
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readDestination());
+        }
+
+        void testAccept_RestartsWithoutRangeSupport() {
+            std::shared_ptr<PartialFileStorage> testling = createTestling();
+            std::shared_ptr<FakeIncomingFileTransfer> transfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+            testling->accept(transfer, destination);
+            transfer->receive("abc");
+            transfer->finish(FileTransferError(FileTransferError::PeerError));
+
+            std::shared_ptr<FakeIncomingFileTransfer> restartedTransfer = std::make_shared<FakeIncomingFileTransfer>(6, false);
+            testling->accept(restartedTransfer, destination);
+            restartedTransfer->receive("abcdef");
+            restartedTransfer->finish();
+
+            CPPUNIT_ASSERT(restartedTransfer->stream);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(0), restartedTransfer->resumeOffset);
+            CPPUNIT_ASSERT_EQUAL(createByteArray("abcdef"), readDestination());
+        }
+
+        void testAccept_DropsDataThatFailedVerification() {
+            std::shared_ptr<PartialFileStorage> testling = createTestling();
+            std::shared_ptr<FakeIncomingFileTransfer> transfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+            testling->accept(transfer, destination);
+            transfer->receive("abcdef");
+
+            transfer->finish(FileTransferError(FileTransferError::PeerError));
+
+            CPPUNIT_ASSERT(!boost::filesystem::exists(destination));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(0), testling->getReceivedSize(std::make_shared<FakeIncomingFileTransfer>(6, true)));
+            CPPUNIT_ASSERT_EQUAL(1, finishedCount);
+            CPPUNIT_ASSERT(finishedError);
+        }
+
+        void testAccept_WritesRangeAtOffset() {
+            std::shared_ptr<PartialFileStorage> testling = createTestling();
+            std::shared_ptr<FakeIncomingFileTransfer> transfer = std::make_shared<FakeIncomingFileTransfer>(6, true);
+            transfer->setRange(4, 2);
+
+            testling->accept(transfer, destination);
+            transfer->receive("ef");
+            transfer->finish();
+
+            ByteArray data = readDestination();
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(6), data.size());
+            CPPUNIT_ASSERT_EQUAL(createByteArray("ef"), ByteArray(data.begin() + 4, data.end()));
+        }
+
+    private:
+        std::shared_ptr<PartialFileStorage> createTestling() {
+            std::shared_ptr<PartialFileStorage> testling = std::make_shared<PartialFileStorage>(baseDir / "partial", crypto.get());
+            testling->onTransferFinished.connect(boost::bind(&PartialFileStorageTest::handleTransferFinished, this, _2));
+            return testling;
+        }
+
+        void handleTransferFinished(boost::optional<FileTransferError> error) {
+            ++finishedCount;
+            finishedError = error;
+        }
+
+        ByteArray readDestination() {
+            ByteArray result;
+            readByteArrayFromFile(result, destination);
+            return result;
+        }
+
+    private:
+        std::shared_ptr<CryptoProvider> crypto;
+        boost::filesystem::path baseDir;
+        boost::filesystem::path destination;
+        int finishedCount;
+        boost::optional<FileTransferError> finishedError;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(PartialFileStorageTest);
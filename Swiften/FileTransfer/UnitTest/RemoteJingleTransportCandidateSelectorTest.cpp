@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/optional.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/Concat.h>
+#include <Swiften/Elements/JingleS5BTransportPayload.h>
+#include <Swiften/FileTransfer/FileTransferOptions.h>
+#include <Swiften/FileTransfer/RemoteJingleTransportCandidateSelector.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamClientSession.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+
+using namespace Swift;
+
+class RemoteJingleTransportCandidateSelectorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(RemoteJingleTransportCandidateSelectorTest);
+        CPPUNIT_TEST(testStartSelecting_ConnectsToAllCandidates);
+        CPPUNIT_TEST(testStartSelecting_SkipsCandidatesOfDisallowedTypes);
+        CPPUNIT_TEST(testConnected_WaitsForHigherPriorityCandidates);
+        CPPUNIT_TEST(testConnected_SelectsHighestPriorityCandidate);
+        CPPUNIT_TEST(testTimeout_SelectsConnectedCandidate);
+        CPPUNIT_TEST(testAllFailed_FinishesWithoutCandidate);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            timerFactory = new DummyTimerFactory();
+            connectionFactory = new MockConnectionFactory();
+            finished = false;
+        }
+
+        void tearDown() {
+            selectedSession.reset();
+            delete connectionFactory;
+            delete timerFactory;
+        }
+
+        void testStartSelecting_ConnectsToAllCandidates() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling();
+
+            testling->startSelectingCandidate();
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), connectionFactory->connections.size());
+            CPPUNIT_ASSERT(connectionFactory->connections[0]->address == HostAddressPort(HostAddress("10.0.0.1"), 1000));
+            CPPUNIT_ASSERT(connectionFactory->connections[1]->address == HostAddressPort(HostAddress("10.0.0.2"), 1000));
+            CPPUNIT_ASSERT(connectionFactory->connections[2]->address == HostAddressPort(HostAddress("10.0.0.3"), 1000));
+            CPPUNIT_ASSERT(!finished);
+        }
+
+        void testStartSelecting_SkipsCandidatesOfDisallowedTypes() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling(FileTransferOptions().withDirectAllowed(false));
+
+            testling->startSelectingCandidate();
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(2), connectionFactory->connections.size());
+            CPPUNIT_ASSERT(connectionFactory->connections[0]->address == HostAddressPort(HostAddress("10.0.0.2"), 1000));
+            CPPUNIT_ASSERT(connectionFactory->connections[1]->address == HostAddressPort(HostAddress("10.0.0.3"), 1000));
+        }
+
+        void testConnected_WaitsForHigherPriorityCandidates() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling();
+            testling->startSelectingCandidate();
+
+            connectSession(connectionFactory->connections[2]);
+
+            CPPUNIT_ASSERT(!finished);
+        }
+
+        void testConnected_SelectsHighestPriorityCandidate() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling();
+            testling->startSelectingCandidate();
+
+            connectSession(connectionFactory->connections[2]);
+            connectionFactory->connections[0]->onConnectFinished(true);
+            connectSession(connectionFactory->connections[1]);
+
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(selectedCandidate);
+            CPPUNIT_ASSERT_EQUAL(std::string("assisted"), selectedCandidate->cid);
+            CPPUNIT_ASSERT(selectedSession);
+            CPPUNIT_ASSERT(selectedSession->getAddressPort() == HostAddressPort(HostAddress("10.0.0.2"), 1000));
+            CPPUNIT_ASSERT(!connectionFactory->connections[1]->disconnected);
+            CPPUNIT_ASSERT(connectionFactory->connections[2]->disconnected);
+        }
+
+        void testTimeout_SelectsConnectedCandidate() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling(FileTransferOptions().withCandidateSelectionTimeout(500));
+            testling->startSelectingCandidate();
+
+            connectSession(connectionFactory->connections[2]);
+            timerFactory->setTime(500);
+
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(selectedCandidate);
+            CPPUNIT_ASSERT_EQUAL(std::string("proxy"), selectedCandidate->cid);
+            CPPUNIT_ASSERT(connectionFactory->connections[0]->disconnected);
+            CPPUNIT_ASSERT(connectionFactory->connections[1]->disconnected);
+            CPPUNIT_ASSERT(!connectionFactory->connections[2]->disconnected);
+        }
+
+        void testAllFailed_FinishesWithoutCandidate() {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = createTestling();
+            testling->startSelectingCandidate();
+
+            connectionFactory->connections[1]->onConnectFinished(true);
+            connectionFactory->connections[0]->onConnectFinished(true);
+            CPPUNIT_ASSERT(!finished);
+            connectionFactory->connections[2]->onConnectFinished(true);
+
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(!selectedCandidate);
+            CPPUNIT_ASSERT(!selectedSession);
+        }
+
+    private:
+        struct MockConnection : public Connection {
+            MockConnection() : disconnected(false) {}
+
+            void listen() { assert(false); }
+            void connect(const HostAddressPort& address) { this->address = address; }
+            void disconnect() { disconnected = true; }
+            void write(const SafeByteArray& data) { append(dataWritten, data); }
+            HostAddressPort getLocalAddress() const { return HostAddressPort(); }
+            HostAddressPort getRemoteAddress() const { return address; }
+
+            HostAddressPort address;
+            SafeByteArray dataWritten;
+            bool disconnected;
+        };
+
+        struct MockConnectionFactory : public ConnectionFactory {
+            std::shared_ptr<Connection> createConnection() {
+                std::shared_ptr<MockConnection> connection = std::make_shared<MockConnection>();
+                connections.push_back(connection);
+                return connection;
+            }
+
+            std::vector<std::shared_ptr<MockConnection> > connections;
+        };
+
+        std::shared_ptr<RemoteJingleTransportCandidateSelector> createTestling(const FileTransferOptions& options = FileTransferOptions()) {
+            std::shared_ptr<RemoteJingleTransportCandidateSelector> testling = std::make_shared<RemoteJingleTransportCandidateSelector>(connectionFactory, timerFactory, options);
+            testling->onCandidateSelectFinished.connect(boost::bind(&RemoteJingleTransportCandidateSelectorTest::handleCandidateSelectFinished, this, _1, _2));
+            testling->setSOCKS5DstAddr("dstaddr");
+
+            std::vector<JingleS5BTransportPayload::Candidate> candidates;
+            candidates.push_back(createCandidate("proxy", JingleS5BTransportPayload::Candidate::ProxyType, 65536 * 10, "10.0.0.3"));
+            candidates.push_back(createCandidate("direct", JingleS5BTransportPayload::Candidate::DirectType, 65536 * 126, "10.0.0.1"));
+            candidates.push_back(createCandidate("assisted", JingleS5BTransportPayload::Candidate::AssistedType, 65536 * 120, "10.0.0.2"));
+            testling->addCandidates(candidates);
+            return testling;
+        }
+
+        static JingleS5BTransportPayload::Candidate createCandidate(const std::string& cid, JingleS5BTransportPayload::Candidate::Type type, int priority, const std::string& address) {
+            JingleS5BTransportPayload::Candidate candidate;
+            candidate.cid = cid;
+            candidate.type = type;
+            candidate.priority = priority;
+            candidate.hostPort = HostAddressPort(HostAddress(address), 1000);
+            return candidate;
+        }
+
+        static void connectSession(std::shared_ptr<MockConnection> connection) {
+            connection->onConnectFinished(false);
+            connection->onDataRead(createSafeByteArrayRef("\x05\x00", 2));
+            std::shared_ptr<SafeByteArray> reply = createSafeByteArrayRef("\x05\x00\x00\x03\x07", 5);
+            append(*reply, createSafeByteArray("dstaddr"));
+            append(*reply, createSafeByteArray("\x00\x00", 2));
+            connection->onDataRead(reply);
+        }
+
+        void handleCandidateSelectFinished(const boost::optional<JingleS5BTransportPayload::Candidate>& candidate, std::shared_ptr<SOCKS5BytestreamClientSession> session) {
+            finished = true;
+            selectedCandidate = candidate;
+            selectedSession = session;
+        }
+
+    private:
+        DummyTimerFactory* timerFactory;
+        MockConnectionFactory* connectionFactory;
+        bool finished;
+        boost::optional<JingleS5BTransportPayload::Candidate> selectedCandidate;
+        std::shared_ptr<SOCKS5BytestreamClientSession> selectedSession;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(RemoteJingleTransportCandidateSelectorTest);
@@ -50,6 +50,7 @@ class SOCKS5BytestreamClientSessionTest : public CppUnit::TestFixture {
     CPPUNIT_TEST(testErrorHandlingRequest);
     CPPUNIT_TEST(testWriteBytestream);
     CPPUNIT_TEST(testReadBytestream);
+    CPPUNIT_TEST(testReadBytestream_Paused);
     CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -203,6 +204,34 @@ public:
         CPPUNIT_ASSERT_EQUAL(createByteArray(vecptr(transferData), transferData.size()), helper.unprocessedInput);
     }
 
+    void testReadBytestream_Paused() {
+        TestHelper helper;
+        connection->onDataSent.connect(boost::bind(&TestHelper::handleConnectionDataWritten, &helper, _1));
+
+        SOCKS5BytestreamClientSession::ref clientSession = std::make_shared<SOCKS5BytestreamClientSession>(connection, destinationAddressPort, destination, timerFactory);
+        clientSession->onSessionReady.connect(boost::bind(&TestHelper::handleSessionReady, &helper, _1));
+
+        clientSession->start();
+        eventLoop->processEvents();
+        serverRespondHelloOK();
+        eventLoop->processEvents();
+        serverRespondRequestOK();
+        eventLoop->processEvents();
+
+        helper.unprocessedInput.clear();
+        ByteArray transferData = generateRandomByteArray(1024);
+        std::shared_ptr<ByteArrayReadBytestream> input = std::make_shared<ByteArrayReadBytestream>(transferData);
+        clientSession->pause();
+        clientSession->startSending(input);
+        eventLoop->processEvents();
+        CPPUNIT_ASSERT(helper.unprocessedInput.empty());
+
+        clientSession->resume();
+        eventLoop->processEvents();
+
+        CPPUNIT_ASSERT_EQUAL(createByteArray(vecptr(transferData), transferData.size()), helper.unprocessedInput);
+    }
+
 
 
 private:
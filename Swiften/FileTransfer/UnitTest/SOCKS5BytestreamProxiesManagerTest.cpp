@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <boost/bind.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/Concat.h>
+#include <Swiften/Elements/S5BProxyRequest.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamProxiesManager.h>
+#include <Swiften/Network/Connection.h>
+#include <Swiften/Network/ConnectionFactory.h>
+#include <Swiften/Network/DummyTimerFactory.h>
+
+using namespace Swift;
+
+class SOCKS5BytestreamProxiesManagerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SOCKS5BytestreamProxiesManagerTest);
+        CPPUNIT_TEST(testConnectToProxies_MeasuresLatency);
+        CPPUNIT_TEST(testConnectToProxies_OrdersProxiesByLatency);
+        CPPUNIT_TEST(testConnectToProxies_OrdersFailedProxiesLast);
+        CPPUNIT_TEST(testAddS5BProxy_KeepsLatencyOrder);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            timerFactory = new DummyTimerFactory();
+            connectionFactory = new MockConnectionFactory();
+            testling = new SOCKS5BytestreamProxiesManager(connectionFactory, timerFactory, nullptr, nullptr, JID("example.com"));
+            testling->setClock(boost::bind(&SOCKS5BytestreamProxiesManagerTest::getTime, this));
+            testling->addS5BProxy(createProxy("proxy1.example.com", "10.0.0.1"));
+            testling->addS5BProxy(createProxy("proxy2.example.com", "10.0.0.2"));
+        }
+
+        void tearDown() {
+            delete testling;
+            delete connectionFactory;
+            delete timerFactory;
+        }
+
+        void testConnectToProxies_MeasuresLatency() {
+            testling->connectToProxies("dstaddr");
+
+            connectSession(connectionFactory->connections[1]);
+
+            CPPUNIT_ASSERT(!testling->getProxyLatency(HostAddressPort(HostAddress("10.0.0.1"), 7777)));
+            CPPUNIT_ASSERT(testling->getProxyLatency(HostAddressPort(HostAddress("10.0.0.2"), 7777)));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy2.example.com"), getProxy(0));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy1.example.com"), getProxy(1));
+        }
+
+        void testConnectToProxies_OrdersProxiesByLatency() {
+            testling->connectToProxies("dstaddr");
+
+            time += std::chrono::milliseconds(5);
+            connectSession(connectionFactory->connections[1]);
+            time += std::chrono::milliseconds(10);
+            connectSession(connectionFactory->connections[0]);
+
+            CPPUNIT_ASSERT(std::chrono::milliseconds(5) == *testling->getProxyLatency(HostAddressPort(HostAddress("10.0.0.2"), 7777)));
+            CPPUNIT_ASSERT(std::chrono::milliseconds(15) == *testling->getProxyLatency(HostAddressPort(HostAddress("10.0.0.1"), 7777)));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy2.example.com"), getProxy(0));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy1.example.com"), getProxy(1));
+        }
+
+        void testConnectToProxies_OrdersFailedProxiesLast() {
+            testling->connectToProxies("dstaddr");
+
+            connectionFactory->connections[0]->onConnectFinished(true);
+
+            CPPUNIT_ASSERT(!testling->getProxyLatency(HostAddressPort(HostAddress("10.0.0.1"), 7777)));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy2.example.com"), getProxy(0));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy1.example.com"), getProxy(1));
+        }
+
+        void testAddS5BProxy_KeepsLatencyOrder() {
+            testling->connectToProxies("dstaddr");
+            connectSession(connectionFactory->connections[1]);
+
+            testling->addS5BProxy(createProxy("proxy3.example.com", "10.0.0.3"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), testling->getOrDiscoverS5BProxies()->size());
+            CPPUNIT_ASSERT_EQUAL(JID("proxy2.example.com"), getProxy(0));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy1.example.com"), getProxy(1));
+            CPPUNIT_ASSERT_EQUAL(JID("proxy3.example.com"), getProxy(2));
+        }
+
+    private:
+        struct MockConnection : public Connection {
+            void listen() { assert(false); }
+            void connect(const HostAddressPort&) {}
+            void disconnect() {}
+            void write(const SafeByteArray&) {}
+            HostAddressPort getLocalAddress() const { return HostAddressPort(); }
+            HostAddressPort getRemoteAddress() const { return HostAddressPort(); }
+        };
+
+        struct MockConnectionFactory : public ConnectionFactory {
+            std::shared_ptr<Connection> createConnection() {
+                std::shared_ptr<MockConnection> connection = std::make_shared<MockConnection>();
+                connections.push_back(connection);
+                return connection;
+            }
+
+            std::vector<std::shared_ptr<MockConnection> > connections;
+        };
+
+        static S5BProxyRequest::ref createProxy(const std::string& jid, const std::string& host) {
+            S5BProxyRequest::StreamHost streamHost;
+            streamHost.host = host;
+            streamHost.port = 7777;
+            streamHost.jid = JID(jid);
+            S5BProxyRequest::ref proxy = std::make_shared<S5BProxyRequest>();
+            proxy->setStreamHost(streamHost);
+            return proxy;
+        }
+
+        static void connectSession(std::shared_ptr<MockConnection> connection) {
+            connection->onConnectFinished(false);
+            connection->onDataRead(createSafeByteArrayRef("\x05\x00", 2));
+            std::shared_ptr<SafeByteArray> reply = createSafeByteArrayRef("\x05\x00\x00\x03\x07", 5);
+            append(*reply, createSafeByteArray("dstaddr"));
+            append(*reply, createSafeByteArray("\x00\x00", 2));
+            connection->onDataRead(reply);
+        }
+
+        std::chrono::steady_clock::time_point getTime() const {
+            return time;
+        }
+
+        JID getProxy(size_t index) {
+            return testling->getOrDiscoverS5BProxies()->at(index)->getStreamHost()->jid;
+        }
+
+    private:
+        DummyTimerFactory* timerFactory;
+        MockConnectionFactory* connectionFactory;
+        SOCKS5BytestreamProxiesManager* testling;
+        std::chrono::steady_clock::time_point time;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SOCKS5BytestreamProxiesManagerTest);
@@ -5,6 +5,8 @@
  */
 
 #include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cppunit/extensions/TestFactoryRegistry.h>
@@ -14,6 +16,7 @@
 #include <Swiften/Base/StartStopper.h>
 #include <Swiften/EventLoop/DummyEventLoop.h>
 #include <Swiften/FileTransfer/ByteArrayReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
 #include <Swiften/FileTransfer/SOCKS5BytestreamServerSession.h>
 #include <Swiften/Network/DummyConnection.h>
@@ -30,6 +33,9 @@ class SOCKS5BytestreamServerSessionTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testReceiveData_Chunked);
         CPPUNIT_TEST(testDataStreamPauseStopsSendingData);
         CPPUNIT_TEST(testDataStreamResumeAfterPauseSendsData);
+        CPPUNIT_TEST(testSendData_FromFile);
+        CPPUNIT_TEST(testSendData_FromFileWithoutWriteFile);
+        CPPUNIT_TEST(testSendData_FromFileEmitsRead);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -41,9 +47,15 @@ class SOCKS5BytestreamServerSessionTest : public CppUnit::TestFixture {
             connection->onDataSent.connect(boost::bind(&SOCKS5BytestreamServerSessionTest::handleDataWritten, this, _1));
             stream1 = std::make_shared<ByteArrayReadBytestream>(createByteArray("abcdefg"));
             finished = false;
+            file = boost::filesystem::unique_path("socks5_bytestream_server_session_test_%%%%%%%%%%%%%%%%");
+            {
+                boost::filesystem::ofstream fileStream(file);
+                fileStream << "abcdefg";
+            }
         }
 
         void tearDown() {
+            boost::filesystem::remove(file);
             connection.reset();
             delete bytestreams;
             delete eventLoop;
@@ -160,6 +172,70 @@ class SOCKS5BytestreamServerSessionTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(!error);
         }
 
+        void testSendData_FromFile() {
+            connection->writeFileSupported = true;
+            connection->onFileDataSent.connect(boost::bind(&SOCKS5BytestreamServerSessionTest::handleFileDataWritten, this, _1, _2, _3));
+            std::shared_ptr<SOCKS5BytestreamServerSession> testling(createSession());
+            testling->setChunkSize(3);
+            StartStopper<SOCKS5BytestreamServerSession> stopper(testling.get());
+            bytestreams->setHasBytestream("abcdef", true);
+            authenticate();
+            request("abcdef");
+            eventLoop->processEvents();
+            skipHeader("abcdef");
+
+            testling->startSending(std::make_shared<FileDescriptorReadBytestream>(file));
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT(receivedData.empty());
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(fileDataChunks.size()));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(0), fileDataChunks[0].first);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), fileDataChunks[0].second);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(3), fileDataChunks[1].first);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(3), fileDataChunks[1].second);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(6), fileDataChunks[2].first);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(1), fileDataChunks[2].second);
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(!error);
+        }
+
+        void testSendData_FromFileWithoutWriteFile() {
+            std::shared_ptr<SOCKS5BytestreamServerSession> testling(createSession());
+            testling->setChunkSize(3);
+            StartStopper<SOCKS5BytestreamServerSession> stopper(testling.get());
+            bytestreams->setHasBytestream("abcdef", true);
+            authenticate();
+            request("abcdef");
+            eventLoop->processEvents();
+
+            testling->startSending(std::make_shared<FileDescriptorReadBytestream>(file));
+            eventLoop->processEvents();
+            skipHeader("abcdef");
+
+            CPPUNIT_ASSERT(createByteArray("abcdefg") == receivedData);
+            CPPUNIT_ASSERT(finished);
+            CPPUNIT_ASSERT(!error);
+        }
+
+        void testSendData_FromFileEmitsRead() {
+            connection->writeFileSupported = true;
+            std::shared_ptr<SOCKS5BytestreamServerSession> testling(createSession());
+            testling->setChunkSize(3);
+            StartStopper<SOCKS5BytestreamServerSession> stopper(testling.get());
+            bytestreams->setHasBytestream("abcdef", true);
+            authenticate();
+            request("abcdef");
+            eventLoop->processEvents();
+            std::shared_ptr<FileDescriptorReadBytestream> stream = std::make_shared<FileDescriptorReadBytestream>(file);
+            stream->onRead.connect(boost::bind(&SOCKS5BytestreamServerSessionTest::handleStreamRead, this, _1));
+
+            testling->startSending(stream);
+            eventLoop->processEvents();
+
+            CPPUNIT_ASSERT(createByteArray("abcdefg") == readData);
+            CPPUNIT_ASSERT(finished);
+        }
+
     private:
         void receive(const SafeByteArray& data) {
             connection->receive(data);
@@ -187,6 +263,14 @@ class SOCKS5BytestreamServerSessionTest : public CppUnit::TestFixture {
             receivedDataChunks++;
         }
 
+        void handleFileDataWritten(int, boost::uint64_t offset, size_t size) {
+            fileDataChunks.push_back(std::make_pair(offset, size));
+        }
+
+        void handleStreamRead(const std::vector<unsigned char>& data) {
+            readData.insert(readData.end(), data.begin(), data.end());
+        }
+
     private:
         SOCKS5BytestreamServerSession* createSession() {
             SOCKS5BytestreamServerSession* session = new SOCKS5BytestreamServerSession(connection, bytestreams);
@@ -206,6 +290,9 @@ class SOCKS5BytestreamServerSessionTest : public CppUnit::TestFixture {
         std::vector<unsigned char> receivedData;
         int receivedDataChunks;
         std::shared_ptr<ByteArrayReadBytestream> stream1;
+        boost::filesystem::path file;
+        std::vector<std::pair<boost::uint64_t, size_t> > fileDataChunks;
+        std::vector<unsigned char> readData;
         bool finished;
         boost::optional<FileTransferError> error;
 };
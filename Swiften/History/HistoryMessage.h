@@ -32,7 +32,8 @@ namespace Swift {
                     toJID_(toJID),
                     type_(type),
                     time_(time),
-                    utcOffset_(utcOffset) {
+                    utcOffset_(utcOffset),
+                    id_(0) {
             }
 
             const std::string& getMessage() const {
@@ -59,6 +60,18 @@ namespace Swift {
                 return utcOffset_;
             }
 
+            /**
+             * The storage-assigned ID of the message, usable as a cursor for
+             * paged retrieval. 0 for messages that were not read from a storage.
+             */
+            long long getID() const {
+                return id_;
+            }
+
+            void setID(long long id) {
+                id_ = id;
+            }
+
             bool operator==(const HistoryMessage& o) const {
                 return message_ == o.message_ && fromJID_ == o.fromJID_ && toJID_ == o.toJID_ && type_ == o.type_ && time_ == o.time_;
             }
@@ -70,5 +83,6 @@ namespace Swift {
             Type type_;
             boost::posix_time::ptime time_;
             int utcOffset_;
+            long long id_;
     };
 }
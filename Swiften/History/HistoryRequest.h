@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <memory>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/signals2.hpp>
+
+#include <Swiften/EventLoop/EventLoop.h>
+#include <Swiften/EventLoop/EventOwner.h>
+
+namespace Swift {
+    /**
+     * A query on a \ref HistoryStorage.
+     *
+     * Connect to \ref onResponse before calling \ref send. If the storage
+     * executes queries on a worker thread, \ref onResponse is emitted from
+     * the storage's \ref EventLoop; otherwise it is emitted from within
+     * \ref send.
+     */
+    template<typename Result>
+    class HistoryRequest : public EventOwner, public std::enable_shared_from_this<HistoryRequest<Result> > {
+        public:
+            typedef std::shared_ptr<HistoryRequest<Result> > ref;
+            typedef boost::function<void (const boost::function<void ()>&)> Executor;
+
+            HistoryRequest(const boost::function<Result ()>& query, const Executor& executor, EventLoop* eventLoop) : query_(query), executor_(executor), eventLoop_(eventLoop) {
+            }
+
+            void send() {
+                executor_(boost::bind(&HistoryRequest::run, this->shared_from_this()));
+            }
+
+        public:
+            boost::signals2::signal<void (const Result&)> onResponse;
+
+        private:
+            void run() {
+                Result result = query_();
+                if (eventLoop_) {
+                    eventLoop_->postEvent(boost::bind(&HistoryRequest::handleResponse, this->shared_from_this(), result), this->shared_from_this());
+                }
+                else {
+                    handleResponse(result);
+                }
+            }
+
+            void handleResponse(const Result& result) {
+                onResponse(result);
+            }
+
+        private:
+            boost::function<Result ()> query_;
+            Executor executor_;
+            EventLoop* eventLoop_;
+    };
+}
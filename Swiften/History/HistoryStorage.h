@@ -7,17 +7,28 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <set>
+#include <string>
 #include <vector>
 
+#include <boost/bind.hpp>
 #include <boost/date_time/gregorian/gregorian_types.hpp>
+#include <boost/function.hpp>
+#include <boost/optional.hpp>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/History/HistoryMessage.h>
+#include <Swiften/History/HistoryRequest.h>
 #include <Swiften/JID/JID.h>
 
 namespace Swift {
+    class EventLoop;
+
     typedef std::map<JID, std::set<boost::gregorian::date> > ContactsMap;
+    typedef HistoryRequest<std::vector<HistoryMessage> > HistoryMessagesRequest;
+    typedef HistoryRequest<ContactsMap> HistoryContactsRequest;
+    typedef HistoryRequest<boost::posix_time::ptime> HistoryTimeStampRequest;
 
     class SWIFTEN_API HistoryStorage {
         /**
@@ -32,5 +43,62 @@ namespace Swift {
             virtual std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const = 0;
             virtual ContactsMap getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const = 0;
             virtual boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const = 0;
+
+            /**
+             * Returns at most \p limit messages of a conversation, in the order they
+             * were stored, restricted to \p date unless it is not_a_date_time.
+             * Without \p beforeID and \p afterID, the first messages are returned.
+             * With \p afterID, the page starts right after that message; with only
+             * \p beforeID, the page ends right before that message.
+             */
+            virtual std::vector<HistoryMessage> getMessagesPage(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) const = 0;
+
+            /**
+             * Asynchronous variants of the queries above. The returned requests
+             * still need to be sent, see \ref HistoryRequest.
+             */
+            HistoryMessagesRequest::ref createMessagesFromDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) {
+                return createRequest<std::vector<HistoryMessage> >(boost::bind(&HistoryStorage::getMessagesFromDate, this, selfJID, contactJID, type, date));
+            }
+
+            HistoryMessagesRequest::ref createMessagesFromNextDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) {
+                return createRequest<std::vector<HistoryMessage> >(boost::bind(&HistoryStorage::getMessagesFromNextDate, this, selfJID, contactJID, type, date));
+            }
+
+            HistoryMessagesRequest::ref createMessagesFromPreviousDateRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) {
+                return createRequest<std::vector<HistoryMessage> >(boost::bind(&HistoryStorage::getMessagesFromPreviousDate, this, selfJID, contactJID, type, date));
+            }
+
+            HistoryMessagesRequest::ref createMessagesPageRequest(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) {
+                return createRequest<std::vector<HistoryMessage> >(boost::bind(&HistoryStorage::getMessagesPage, this, selfJID, contactJID, type, date, limit, beforeID, afterID));
+            }
+
+            HistoryContactsRequest::ref createContactsRequest(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) {
+                return createRequest<ContactsMap>(boost::bind(&HistoryStorage::getContacts, this, selfJID, type, keyword));
+            }
+
+            HistoryTimeStampRequest::ref createLastTimeStampFromMUCRequest(const JID& selfJID, const JID& mucJID) {
+                return createRequest<boost::posix_time::ptime>(boost::bind(&HistoryStorage::getLastTimeStampFromMUC, this, selfJID, mucJID));
+            }
+
+        protected:
+            /**
+             * Executes the query of a request. The default implementation runs it
+             * directly; implementations with a worker thread can queue it there,
+             * and return the loop to deliver responses on from \ref getEventLoop.
+             */
+            virtual void executeRequest(const boost::function<void ()>& query) {
+                query();
+            }
+
+            virtual EventLoop* getEventLoop() const {
+                return nullptr;
+            }
+
+        private:
+            template<typename Result>
+            std::shared_ptr<HistoryRequest<Result> > createRequest(const boost::function<Result ()>& query) {
+                return std::make_shared<HistoryRequest<Result> >(query, boost::bind(&HistoryStorage::executeRequest, this, _1), getEventLoop());
+            }
     };
 }
@@ -6,8 +6,12 @@
 
 #include <Swiften/History/SQLiteHistoryStorage.h>
 
+#include <algorithm>
+#include <cctype>
 #include <iostream>
 
+#include <boost/algorithm/string/case_conv.hpp>
+#include <boost/bind.hpp>
 #include <boost/date_time/gregorian/gregorian.hpp>
 #include <boost/lexical_cast.hpp>
 #include <boost/numeric/conversion/cast.hpp>
@@ -27,18 +31,53 @@ inline std::string getEscapedString(const std::string& s) {
     return result;
 }
 
+/**
+ * Turns a free-text keyword into a single full-text search phrase, so
+ * that FTS query operators in the keyword are matched literally. The last
+ * word of the phrase is matched as a prefix, so that a partially typed word
+ * still finds the messages containing it.
+ */
+inline std::string getFullTextPrefixPhrase(const std::string& s, bool fts5) {
+    std::string result(s);
+    result.erase(std::remove(result.begin(), result.end(), '"'), result.end());
+    // FTS5 puts the prefix operator after the phrase, FTS3/4 inside it
+    return fts5 ? "\"" + result + "\" *" : "\"" + result + "*\"";
+}
+
+/**
+ * Whether the tokenizer finds any word in the keyword to match on.
+ */
+inline bool hasFullTextTokens(const std::string& s) {
+    return std::find_if(s.begin(), s.end(), [](char c) { return std::isalnum(static_cast<unsigned char>(c)) || (c & 0x80); }) != s.end();
+}
+
 namespace Swift {
 
-SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file) : db_(nullptr) {
-    thread_ = new std::thread(boost::bind(&SQLiteHistoryStorage::run, this));
+/**
+ * Version 1 adds indexes for the per-contact and per-MUC lookups and a
+ * full-text index on the message text.
+ * Version 2 adds an explicit id column to the messages. The full-text index
+ * and the paging cursors refer to messages by id, and unlike the implicit
+ * rowid, an INTEGER PRIMARY KEY is never renumbered by a VACUUM.
+ */
+static const int currentSchemaVersion = 2;
+
+static const char* messagesTableDefinition = "('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)";
+static const char* fullTextTrigger = "CREATE TRIGGER IF NOT EXISTS messages_fts_insert AFTER INSERT ON messages BEGIN "
+    "INSERT INTO messages_fts(rowid, message) VALUES(new.id, new.message); END";
+static const char* messagesIndexes[] = {
+    "CREATE INDEX IF NOT EXISTS messages_conversation ON messages(fromBare, toBare, type, time)",
+    "CREATE INDEX IF NOT EXISTS messages_recipient ON messages(toBare, type, time)"
+};
 
+SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file, EventLoop* eventLoop) : db_(nullptr), hasFullTextIndex_(false), hasFTS5Index_(false), eventLoop_(eventLoop), thread_(nullptr) {
     sqlite3_open(pathToString(file).c_str(), &db_);
     if (!db_) {
         std::cerr << "Error opening database " << pathToString(file) << std::endl;
     }
 
     char* errorMessage;
-    int result = sqlite3_exec(db_, "CREATE TABLE IF NOT EXISTS messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)", nullptr, nullptr, &errorMessage);
+    int result = sqlite3_exec(db_, (std::string("CREATE TABLE IF NOT EXISTS messages") + messagesTableDefinition).c_str(), nullptr, nullptr, &errorMessage);
     if (result != SQLITE_OK) {
         std::cerr << "SQL Error: " << errorMessage << std::endl;
         sqlite3_free(errorMessage);
@@ -49,14 +88,35 @@ SQLiteHistoryStorage::SQLiteHistoryStorage(const boost::filesystem::path& file)
         std::cerr << "SQL Error: " << errorMessage << std::endl;
         sqlite3_free(errorMessage);
     }
+
+    upgradeSchema();
+
+    if (eventLoop_) {
+        thread_ = new std::thread(boost::bind(&SQLiteHistoryStorage::run, this));
+    }
 }
 
 SQLiteHistoryStorage::~SQLiteHistoryStorage() {
+    if (thread_) {
+        // An empty task stops the worker after all queued messages are stored
+        addToQueue(boost::function<void ()>());
+        thread_->join();
+        delete thread_;
+    }
     sqlite3_close(db_);
-    delete thread_;
 }
 
 void SQLiteHistoryStorage::addMessage(const HistoryMessage& message) {
+    if (thread_) {
+        addToQueue(boost::bind(&SQLiteHistoryStorage::storeMessage, this, message));
+    }
+    else {
+        storeMessage(message);
+    }
+}
+
+void SQLiteHistoryStorage::storeMessage(const HistoryMessage& message) {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     int secondsSinceEpoch = (message.getTime() - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
 
     std::string statement = std::string("INSERT INTO messages('message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') VALUES(") +
@@ -77,8 +137,22 @@ void SQLiteHistoryStorage::addMessage(const HistoryMessage& message) {
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
-    sqlite3_stmt* selectStatement;
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
+    boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
+    boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
+
+    if (!selfID || !contactID) {
+        // JIDs missing from the database
+        return std::vector<HistoryMessage>();
+    }
 
+    std::string selectQuery = "SELECT * FROM messages WHERE " + getConversationCondition(*selfID, contactJID, *contactID, type) +
+            getDateCondition(date) + " ORDER BY id ASC";
+    return selectMessages(selectQuery);
+}
+
+std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesPage(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) const {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> contactID = getIDFromJID(contactJID.toBare());
 
@@ -87,31 +161,58 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
         return std::vector<HistoryMessage>();
     }
 
-    std::string selectQuery = "SELECT * FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
+    std::string selectQuery = "SELECT * FROM messages WHERE " + getConversationCondition(*selfID, contactJID, *contactID, type) + getDateCondition(date);
+    if (beforeID) {
+        selectQuery += " AND id<" + boost::lexical_cast<std::string>(*beforeID);
+    }
+    if (afterID) {
+        selectQuery += " AND id>" + boost::lexical_cast<std::string>(*afterID);
+    }
+
+    // A page before a message ends right before it, so walk backwards from there
+    selectQuery += " ORDER BY id " + (beforeID && !afterID ? std::string("DESC") : std::string("ASC")) +
+            " LIMIT " + boost::lexical_cast<std::string>(limit);
+
+    std::vector<HistoryMessage> result = selectMessages(selectQuery);
+    if (beforeID && !afterID) {
+        std::reverse(result.begin(), result.end());
+    }
+    return result;
+}
+
+std::string SQLiteHistoryStorage::getConversationCondition(long long selfID, const JID& contactJID, long long contactID, HistoryMessage::Type type) const {
+    std::string condition = "(type=" + boost::lexical_cast<std::string>(type);
     if (contactJID.isBare()) {
         // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
+        condition += " AND ((fromBare=" + boost::lexical_cast<std::string>(selfID) + " AND toBare=" +
+                boost::lexical_cast<std::string>(contactID) + ") OR (fromBare=" +
+                boost::lexical_cast<std::string>(contactID) + " AND toBare=" + boost::lexical_cast<std::string>(selfID) + ")))";
     }
     else {
         // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
+        condition += " AND ((fromBare=" + boost::lexical_cast<std::string>(selfID) + " AND (toBare=" +
+                boost::lexical_cast<std::string>(contactID) +" AND toResource='" +
                 getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
+                boost::lexical_cast<std::string>(contactID) + " AND fromResource='" +
                 getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
+                boost::lexical_cast<std::string>(selfID) + ")))";
     }
+    return condition;
+}
 
-    if (!date.is_not_a_date()) {
-        int lowerBound = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
-        int upperBound = lowerBound + 86400;
-
-        selectQuery += " AND (time>=" + boost::lexical_cast<std::string>(lowerBound) +
-                " AND time<" + boost::lexical_cast<std::string>(upperBound) + ")";
+std::string SQLiteHistoryStorage::getDateCondition(const boost::gregorian::date& date) const {
+    if (date.is_not_a_date()) {
+        return std::string();
     }
+    int lowerBound = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
+    int upperBound = lowerBound + 86400;
 
+    return " AND (time>=" + boost::lexical_cast<std::string>(lowerBound) +
+            " AND time<" + boost::lexical_cast<std::string>(upperBound) + ")";
+}
+
+std::vector<HistoryMessage> SQLiteHistoryStorage::selectMessages(const std::string& selectQuery) const {
+    sqlite3_stmt* selectStatement;
     int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
     if (r != SQLITE_OK) {
         std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
@@ -121,33 +222,35 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromDate(const JID&
     // Retrieve result
     std::vector<HistoryMessage> result;
     while (r == SQLITE_ROW) {
-        std::string message(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+        long long id = sqlite3_column_int64(selectStatement, 0);
+        std::string message(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1)));
 
         // fromJID
-        boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int(selectStatement, 1)));
-        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 2)));
+        boost::optional<JID> fromJID(getJIDFromID(sqlite3_column_int(selectStatement, 2)));
+        std::string fromResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 3)));
         if (fromJID) {
             fromJID = boost::optional<JID>(JID(fromJID->getNode(), fromJID->getDomain(), fromResource));
         }
 
         // toJID
-        boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int(selectStatement, 3)));
-        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 4)));
+        boost::optional<JID> toJID(getJIDFromID(sqlite3_column_int(selectStatement, 4)));
+        std::string toResource(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 5)));
         if (toJID) {
             toJID = boost::optional<JID>(JID(toJID->getNode(), toJID->getDomain(), toResource));
         }
 
         // message type
-        HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(selectStatement, 5));
+        HistoryMessage::Type type = static_cast<HistoryMessage::Type>(sqlite3_column_int(selectStatement, 6));
 
         // timestamp
-        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 6));
+        int secondsSinceEpoch(sqlite3_column_int(selectStatement, 7));
         boost::posix_time::ptime time(boost::gregorian::date(1970, 1, 1), boost::posix_time::seconds(secondsSinceEpoch));
 
         // offset from utc
-        int offset = sqlite3_column_int(selectStatement, 7);
+        int offset = sqlite3_column_int(selectStatement, 8);
 
         result.push_back(HistoryMessage(message, (fromJID ? *fromJID : JID()), (toJID ? *toJID : JID()), type, time, offset));
+        result.back().setID(id);
         r = sqlite3_step(selectStatement);
     }
     if (r != SQLITE_DONE) {
@@ -180,6 +283,12 @@ long long SQLiteHistoryStorage::addJID(const JID& jid) {
 }
 
 boost::optional<JID> SQLiteHistoryStorage::getJIDFromID(long long id) const {
+    // IDs are never reassigned, so looked up JIDs can be kept for good
+    std::map<long long, JID>::const_iterator cached = jidCache_.find(id);
+    if (cached != jidCache_.end()) {
+        return cached->second;
+    }
+
     boost::optional<JID> result;
     sqlite3_stmt* selectStatement;
     std::string selectQuery("SELECT jid FROM jids WHERE id=" + boost::lexical_cast<std::string>(id));
@@ -190,6 +299,7 @@ boost::optional<JID> SQLiteHistoryStorage::getJIDFromID(long long id) const {
     r = sqlite3_step(selectStatement);
     if (r == SQLITE_ROW) {
         result = boost::optional<JID>(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0)));
+        jidCache_[id] = *result;
     }
     sqlite3_finalize(selectStatement);
     return result;
@@ -212,6 +322,7 @@ boost::optional<long long> SQLiteHistoryStorage::getIDFromJID(const JID& jid) co
 }
 
 ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage::Type type, const std::string& keyword) const {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     ContactsMap result;
     sqlite3_stmt* selectStatement;
 
@@ -229,7 +340,12 @@ ContactsMap SQLiteHistoryStorage::getContacts(const JID& selfJID, HistoryMessage
 
     // match keyword
     if (getEscapedString(keyword).length()) {
-        query += " AND message LIKE '%" + getEscapedString(keyword) + "%'";
+        if (hasFullTextIndex_ && hasFullTextTokens(keyword)) {
+            query += " AND id IN (SELECT rowid FROM messages_fts WHERE message MATCH '" + getEscapedString(getFullTextPrefixPhrase(keyword, hasFTS5Index_)) + "')";
+        }
+        else {
+            query += " AND message LIKE '%" + getEscapedString(keyword) + "%'";
+        }
     }
 
     int r = sqlite3_prepare(db_, query.c_str(), boost::numeric_cast<int>(query.size()), &selectStatement, nullptr);
@@ -289,22 +405,7 @@ boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& self
         return boost::gregorian::date(boost::gregorian::not_a_date_time);
     }
 
-    std::string selectQuery = "SELECT time FROM messages WHERE (type=" + boost::lexical_cast<std::string>(type);
-    if (contactJID.isBare()) {
-        // match only bare jid
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND toBare=" +
-                boost::lexical_cast<std::string>(*contactID) + ") OR (fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND toBare=" + boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
-    else {
-        // match resource too
-        selectQuery += " AND ((fromBare=" + boost::lexical_cast<std::string>(*selfID) + " AND (toBare=" +
-                boost::lexical_cast<std::string>(*contactID) +" AND toResource='" +
-                getEscapedString(contactJID.getResource()) + "')) OR ((fromBare=" +
-                boost::lexical_cast<std::string>(*contactID) + " AND fromResource='" +
-                getEscapedString(contactJID.getResource()) + "') AND toBare=" +
-                boost::lexical_cast<std::string>(*selfID) + ")))";
-    }
+    std::string selectQuery = "SELECT time FROM messages WHERE " + getConversationCondition(*selfID, contactJID, *contactID, type);
 
     int timeStamp = (boost::posix_time::ptime(date) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds() + (reverseOrder ? 0 : 86400);
 
@@ -328,6 +429,7 @@ boost::gregorian::date SQLiteHistoryStorage::getNextDateWithLogs(const JID& self
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     boost::gregorian::date nextDate = getNextDateWithLogs(selfJID, contactJID, type, date, false);
 
     if (nextDate.is_not_a_date()) {
@@ -338,6 +440,7 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromNextDate(const
 }
 
 std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     boost::gregorian::date previousDate = getNextDateWithLogs(selfJID, contactJID, type, date, true);
 
     if (previousDate.is_not_a_date()) {
@@ -348,6 +451,7 @@ std::vector<HistoryMessage> SQLiteHistoryStorage::getMessagesFromPreviousDate(co
 }
 
 boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const {
+    std::lock_guard<std::recursive_mutex> lock(dbMutex_);
     boost::optional<long long> selfID = getIDFromJID(selfJID.toBare());
     boost::optional<long long> mucID = getIDFromJID(mucJID.toBare());
 
@@ -379,7 +483,188 @@ boost::posix_time::ptime SQLiteHistoryStorage::getLastTimeStampFromMUC(const JID
     return boost::posix_time::ptime(boost::posix_time::not_a_date_time);
 }
 
+void SQLiteHistoryStorage::upgradeSchema() {
+    int version = getSchemaVersion();
+    if (version < 1) {
+        executeStatement("BEGIN TRANSACTION");
+        for (const char* index : messagesIndexes) {
+            executeStatement(index);
+        }
+        executeStatement("PRAGMA user_version=1");
+        executeStatement("COMMIT TRANSACTION");
+    }
+    if (version < 2) {
+        // Databases created before version 2 lack the id column. SQLite can't
+        // add a primary key to an existing table, so copy the messages into a
+        // new one, keeping their rowid as id.
+        executeStatement("BEGIN TRANSACTION");
+        bool upgraded = hasColumn("messages", "id") || (
+            executeStatement(std::string("CREATE TABLE messages_v2") + messagesTableDefinition) &&
+            executeStatement("INSERT INTO messages_v2('id', 'message', 'fromBare', 'fromResource', 'toBare', 'toResource', 'type', 'time', 'offset') "
+                "SELECT rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset FROM messages") &&
+            executeStatement("DROP TABLE messages") &&
+            executeStatement("ALTER TABLE messages_v2 RENAME TO messages"));
+        if (upgraded) {
+            for (const char* index : messagesIndexes) {
+                executeStatement(index);
+            }
+            executeStatement("PRAGMA user_version=" + boost::lexical_cast<std::string>(currentSchemaVersion));
+        }
+        executeStatement(upgraded ? "COMMIT TRANSACTION" : "ROLLBACK TRANSACTION");
+    }
+
+    // The full-text index depends on the FTS modules compiled into SQLite, so it
+    // is (re)checked on every open instead of being tied to the schema version.
+    // Dropping the old messages table above also dropped its trigger.
+    if (hasTable("messages_fts")) {
+        hasFullTextIndex_ = executeStatement(fullTextTrigger);
+    }
+    else {
+        hasFullTextIndex_ = createFullTextIndex();
+    }
+    hasFTS5Index_ = hasFullTextIndex_ && getTableDefinition("messages_fts").find("fts5") != std::string::npos;
+}
+
+int SQLiteHistoryStorage::getSchemaVersion() const {
+    int version = 0;
+    sqlite3_stmt* selectStatement;
+    std::string selectQuery("PRAGMA user_version");
+    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
+    if (r != SQLITE_OK) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        return version;
+    }
+    r = sqlite3_step(selectStatement);
+    if (r == SQLITE_ROW) {
+        version = sqlite3_column_int(selectStatement, 0);
+    }
+    sqlite3_finalize(selectStatement);
+    return version;
+}
+
+bool SQLiteHistoryStorage::hasColumn(const std::string& table, const std::string& column) const {
+    bool result = false;
+    sqlite3_stmt* selectStatement;
+    std::string selectQuery("PRAGMA table_info(" + table + ")");
+    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
+    if (r != SQLITE_OK) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        return result;
+    }
+    r = sqlite3_step(selectStatement);
+    while (r == SQLITE_ROW && !result) {
+        result = (column == reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 1)));
+        r = sqlite3_step(selectStatement);
+    }
+    sqlite3_finalize(selectStatement);
+    return result;
+}
+
+std::string SQLiteHistoryStorage::getTableDefinition(const std::string& name) const {
+    std::string result;
+    sqlite3_stmt* selectStatement;
+    std::string selectQuery("SELECT sql FROM sqlite_master WHERE type='table' AND name='" + getEscapedString(name) + "'");
+    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
+    if (r != SQLITE_OK) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        return result;
+    }
+    r = sqlite3_step(selectStatement);
+    if (r == SQLITE_ROW && sqlite3_column_text(selectStatement, 0)) {
+        result = boost::algorithm::to_lower_copy(std::string(reinterpret_cast<const char*>(sqlite3_column_text(selectStatement, 0))));
+    }
+    sqlite3_finalize(selectStatement);
+    return result;
+}
+
+bool SQLiteHistoryStorage::hasTable(const std::string& name) const {
+    bool result = false;
+    sqlite3_stmt* selectStatement;
+    std::string selectQuery("SELECT name FROM sqlite_master WHERE type='table' AND name='" + getEscapedString(name) + "'");
+    int r = sqlite3_prepare(db_, selectQuery.c_str(), boost::numeric_cast<int>(selectQuery.size()), &selectStatement, nullptr);
+    if (r != SQLITE_OK) {
+        std::cout << "Error: " << sqlite3_errmsg(db_) << std::endl;
+        return result;
+    }
+    r = sqlite3_step(selectStatement);
+    result = (r == SQLITE_ROW);
+    sqlite3_finalize(selectStatement);
+    return result;
+}
+
+bool SQLiteHistoryStorage::createFullTextIndex() {
+    // Use the most recent FTS module this SQLite build provides
+    const char* modules[] = { "fts5", "fts4", "fts3" };
+    bool created = false;
+    executeStatement("BEGIN TRANSACTION");
+    for (const char* module : modules) {
+        if (executeStatement(std::string("CREATE VIRTUAL TABLE messages_fts USING ") + module + "(message)", false)) {
+            created = true;
+            break;
+        }
+    }
+    if (!created) {
+        executeStatement("ROLLBACK TRANSACTION");
+        return false;
+    }
+
+    // Index the existing history, and keep the index up to date from now on
+    created = executeStatement("INSERT INTO messages_fts(rowid, message) SELECT id, message FROM messages") &&
+        executeStatement(fullTextTrigger);
+    executeStatement(created ? "COMMIT TRANSACTION" : "ROLLBACK TRANSACTION");
+    return created;
+}
+
+bool SQLiteHistoryStorage::executeStatement(const std::string& statement, bool reportErrors) {
+    char* errorMessage = nullptr;
+    int result = sqlite3_exec(db_, statement.c_str(), nullptr, nullptr, &errorMessage);
+    if (result != SQLITE_OK) {
+        if (reportErrors) {
+            std::cerr << "SQL Error: " << (errorMessage ? errorMessage : sqlite3_errmsg(db_)) << std::endl;
+        }
+        sqlite3_free(errorMessage);
+        return false;
+    }
+    return true;
+}
+
+void SQLiteHistoryStorage::executeRequest(const boost::function<void ()>& query) {
+    if (thread_) {
+        addToQueue(query);
+    }
+    else {
+        query();
+    }
+}
+
+EventLoop* SQLiteHistoryStorage::getEventLoop() const {
+    return thread_ ? eventLoop_ : nullptr;
+}
+
 void SQLiteHistoryStorage::run() {
+    while (true) {
+        boost::function<void ()> task;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            while (queue_.empty()) {
+                queueNonEmpty_.wait(lock);
+            }
+            task = queue_.front();
+            queue_.pop_front();
+        }
+        if (!task) {
+            break;
+        }
+        task();
+    }
+}
+
+void SQLiteHistoryStorage::addToQueue(const boost::function<void ()>& task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        queue_.push_back(task);
+    }
+    queueNonEmpty_.notify_one();
 }
 
 }
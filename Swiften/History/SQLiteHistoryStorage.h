@@ -6,9 +6,14 @@
 
 #pragma once
 
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
 #include <thread>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/function.hpp>
 #include <boost/optional.hpp>
 
 #include <Swiften/Base/API.h>
@@ -17,9 +22,17 @@
 struct sqlite3;
 
 namespace Swift {
+    class EventLoop;
+
     class SWIFTEN_API SQLiteHistoryStorage : public HistoryStorage {
         public:
-            SQLiteHistoryStorage(const boost::filesystem::path& file);
+            /**
+             * If an event loop is given, the requests created by this storage
+             * are executed on a worker thread, and their responses are posted
+             * to the event loop. In that case addMessage() also only queues the
+             * message, so synchronous queries might not see it yet.
+             */
+            SQLiteHistoryStorage(const boost::filesystem::path& file, EventLoop* eventLoop = nullptr);
             ~SQLiteHistoryStorage();
 
             void addMessage(const HistoryMessage& message);
@@ -28,9 +41,26 @@ namespace Swift {
             std::vector<HistoryMessage> getMessagesFromNextDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             std::vector<HistoryMessage> getMessagesFromPreviousDate(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date) const;
             boost::posix_time::ptime getLastTimeStampFromMUC(const JID& selfJID, const JID& mucJID) const;
+            std::vector<HistoryMessage> getMessagesPage(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) const;
+
+        protected:
+            virtual void executeRequest(const boost::function<void ()>& query);
+            virtual EventLoop* getEventLoop() const;
 
         private:
             void run();
+            void addToQueue(const boost::function<void ()>& task);
+            void storeMessage(const HistoryMessage& message);
+            void upgradeSchema();
+            int getSchemaVersion() const;
+            bool hasTable(const std::string& name) const;
+            bool hasColumn(const std::string& table, const std::string& column) const;
+            std::string getTableDefinition(const std::string& name) const;
+            bool createFullTextIndex();
+            bool executeStatement(const std::string& statement, bool reportErrors = true);
+            std::string getConversationCondition(long long selfID, const JID& contactJID, long long contactID, HistoryMessage::Type type) const;
+            std::string getDateCondition(const boost::gregorian::date& date) const;
+            std::vector<HistoryMessage> selectMessages(const std::string& selectQuery) const;
             boost::gregorian::date getNextDateWithLogs(const JID& selfJID, const JID& contactJID, HistoryMessage::Type type, const boost::gregorian::date& date, bool reverseOrder) const;
             long long getIDForJID(const JID&);
             long long addJID(const JID&);
@@ -39,6 +69,14 @@ namespace Swift {
             boost::optional<long long> getIDFromJID(const JID& jid) const;
 
             sqlite3* db_;
+            mutable std::recursive_mutex dbMutex_;
+            mutable std::map<long long, JID> jidCache_;
+            bool hasFullTextIndex_;
+            bool hasFTS5Index_;
+            EventLoop* eventLoop_;
             std::thread* thread_;
+            std::deque<boost::function<void ()> > queue_;
+            std::mutex queueMutex_;
+            std::condition_variable queueNonEmpty_;
     };
 }
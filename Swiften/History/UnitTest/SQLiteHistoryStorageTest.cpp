@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/date_time/gregorian/gregorian.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <sqlite3.h>
+
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+class SQLiteHistoryStorageTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SQLiteHistoryStorageTest);
+        CPPUNIT_TEST(testGetMessagesPage_FirstPage);
+        CPPUNIT_TEST(testGetMessagesPage_AfterID);
+        CPPUNIT_TEST(testGetMessagesPage_AfterID_LastPartialPage);
+        CPPUNIT_TEST(testGetMessagesPage_AfterID_EmptyLastPage);
+        CPPUNIT_TEST(testGetMessagesPage_BeforeID);
+        CPPUNIT_TEST(testGetMessagesPage_BeforeID_FirstPartialPage);
+        CPPUNIT_TEST(testGetMessagesPage_BeforeID_EmptyFirstPage);
+        CPPUNIT_TEST(testGetMessagesPage_BeforeAndAfterID);
+        CPPUNIT_TEST(testGetMessagesPage_Date);
+        CPPUNIT_TEST(testGetMessagesPage_OtherConversation);
+        CPPUNIT_TEST(testGetMessagesPage_UnknownContact);
+        CPPUNIT_TEST(testGetContacts_Keyword);
+        CPPUNIT_TEST(testGetContacts_KeywordPrefix);
+        CPPUNIT_TEST(testGetContacts_KeywordWithoutWords);
+        CPPUNIT_TEST(testUpgradeSchema_KeepsMessageIDs);
+        CPPUNIT_TEST(testUpgradeSchema_IndexesExistingMessages);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            self = JID("foo@bar.com");
+            contact = JID("fum@baz.org");
+            testling = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(":memory:"));
+            day1 = boost::gregorian::date(1980, 1, 21);
+            day2 = boost::gregorian::date(1980, 1, 22);
+            for (int i = 0; i < 5; ++i) {
+                addMessage(i, day1);
+            }
+            for (int i = 5; i < 10; ++i) {
+                addMessage(i, day2);
+            }
+            testling->addMessage(HistoryMessage("Other", JID("other@baz.org"), self, HistoryMessage::Chat, boost::posix_time::ptime(day1)));
+            ids = getIDs(testling->getMessagesPage(self, contact, HistoryMessage::Chat, boost::gregorian::date(), 100, boost::optional<long long>(), boost::optional<long long>()));
+        }
+
+        void tearDown() {
+            testling.reset();
+        }
+
+        void testGetMessagesPage_FirstPage() {
+            std::vector<HistoryMessage> result = getPage(4, boost::optional<long long>(), boost::optional<long long>());
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 0"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 3"), result[3].getMessage());
+        }
+
+        void testGetMessagesPage_AfterID() {
+            std::vector<HistoryMessage> result = getPage(4, boost::optional<long long>(), ids[3]);
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 4"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 7"), result[3].getMessage());
+        }
+
+        void testGetMessagesPage_AfterID_LastPartialPage() {
+            std::vector<HistoryMessage> result = getPage(4, boost::optional<long long>(), ids[7]);
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 8"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 9"), result[1].getMessage());
+        }
+
+        void testGetMessagesPage_AfterID_EmptyLastPage() {
+            std::vector<HistoryMessage> result = getPage(4, boost::optional<long long>(), ids[9]);
+
+            CPPUNIT_ASSERT(result.empty());
+        }
+
+        void testGetMessagesPage_BeforeID() {
+            std::vector<HistoryMessage> result = getPage(4, ids[6], boost::optional<long long>());
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 2"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 5"), result[3].getMessage());
+        }
+
+        void testGetMessagesPage_BeforeID_FirstPartialPage() {
+            std::vector<HistoryMessage> result = getPage(4, ids[2], boost::optional<long long>());
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 0"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 1"), result[1].getMessage());
+        }
+
+        void testGetMessagesPage_BeforeID_EmptyFirstPage() {
+            std::vector<HistoryMessage> result = getPage(4, ids[0], boost::optional<long long>());
+
+            CPPUNIT_ASSERT(result.empty());
+        }
+
+        void testGetMessagesPage_BeforeAndAfterID() {
+            std::vector<HistoryMessage> result = getPage(100, ids[5], ids[2]);
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 3"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 4"), result[1].getMessage());
+        }
+
+        void testGetMessagesPage_Date() {
+            std::vector<HistoryMessage> result = testling->getMessagesPage(self, contact, HistoryMessage::Chat, day2, 100, boost::optional<long long>(), ids[2]);
+
+            CPPUNIT_ASSERT_EQUAL(5, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 5"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(std::string("Message 9"), result[4].getMessage());
+        }
+
+        void testGetMessagesPage_OtherConversation() {
+            std::vector<HistoryMessage> result = testling->getMessagesPage(self, JID("other@baz.org"), HistoryMessage::Chat, boost::gregorian::date(), 100, boost::optional<long long>(), boost::optional<long long>());
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("Other"), result[0].getMessage());
+        }
+
+        void testGetMessagesPage_UnknownContact() {
+            std::vector<HistoryMessage> result = testling->getMessagesPage(self, JID("unknown@baz.org"), HistoryMessage::Chat, boost::gregorian::date(), 100, boost::optional<long long>(), boost::optional<long long>());
+
+            CPPUNIT_ASSERT(result.empty());
+        }
+
+        void testGetContacts_Keyword() {
+            ContactsMap result = testling->getContacts(self, HistoryMessage::Chat, "other");
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT(result.find(JID("other@baz.org")) != result.end());
+            CPPUNIT_ASSERT(testling->getContacts(self, HistoryMessage::Chat, "unknown").empty());
+        }
+
+        void testGetContacts_KeywordPrefix() {
+            testling->addMessage(HistoryMessage("hello world", contact, self, HistoryMessage::Chat, boost::posix_time::ptime(day2)));
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->getContacts(self, HistoryMessage::Chat, "hel").size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->getContacts(self, HistoryMessage::Chat, "hello wor").size()));
+            CPPUNIT_ASSERT(testling->getContacts(self, HistoryMessage::Chat, "world hel").empty());
+        }
+
+        void testGetContacts_KeywordWithoutWords() {
+            testling->addMessage(HistoryMessage(":-)", contact, self, HistoryMessage::Chat, boost::posix_time::ptime(day2)));
+
+            ContactsMap result = testling->getContacts(self, HistoryMessage::Chat, ":-)");
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT(result.find(contact) != result.end());
+        }
+
+        void testUpgradeSchema_KeepsMessageIDs() {
+            boost::filesystem::path file = createVersion0Database();
+            testling = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(file));
+
+            std::vector<HistoryMessage> result = testling->getMessagesPage(self, contact, HistoryMessage::Chat, boost::gregorian::date(), 100, boost::optional<long long>(), boost::optional<long long>());
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("hello"), result[0].getMessage());
+            CPPUNIT_ASSERT_EQUAL(3LL, result[0].getID());
+            CPPUNIT_ASSERT_EQUAL(std::string("goodbye"), result[1].getMessage());
+            CPPUNIT_ASSERT_EQUAL(7LL, result[1].getID());
+            CPPUNIT_ASSERT_EQUAL(JID("fum@baz.org/res"), result[1].getFromJID());
+
+            testling->addMessage(HistoryMessage("again", self, contact, HistoryMessage::Chat, boost::posix_time::ptime(day2)));
+            result = testling->getMessagesPage(self, contact, HistoryMessage::Chat, boost::gregorian::date(), 100, boost::optional<long long>(), result[1].getID());
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(result.size()));
+            CPPUNIT_ASSERT_EQUAL(std::string("again"), result[0].getMessage());
+            CPPUNIT_ASSERT(result[0].getID() > 7);
+
+            testling.reset();
+            boost::filesystem::remove(file);
+        }
+
+        void testUpgradeSchema_IndexesExistingMessages() {
+            boost::filesystem::path file = createVersion0Database();
+            testling = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(file));
+            testling->addMessage(HistoryMessage("welcome back", contact, self, HistoryMessage::Chat, boost::posix_time::ptime(day2)));
+
+            // Reopening must keep using the upgraded schema and index
+            testling = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(file));
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->getContacts(self, HistoryMessage::Chat, "goodb").size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(testling->getContacts(self, HistoryMessage::Chat, "welc").size()));
+            CPPUNIT_ASSERT(testling->getContacts(self, HistoryMessage::Chat, "removed").empty());
+
+            testling.reset();
+            boost::filesystem::remove(file);
+        }
+
+    private:
+        /**
+         * Creates a database with the schema from before indexes, full-text
+         * search and explicit message ids were added. The message rowids
+         * have a gap, as left by deleting a message.
+         */
+        boost::filesystem::path createVersion0Database() {
+            boost::filesystem::path file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("sqlite_history_storage_test_%%%%%%%%%%%%%%%%");
+            sqlite3* db = nullptr;
+            CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_open(file.string().c_str(), &db));
+            const char* statements =
+                "CREATE TABLE messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER);"
+                "CREATE TABLE jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL);"
+                "INSERT INTO jids('id', 'jid') VALUES(1, 'foo@bar.com');"
+                "INSERT INTO jids('id', 'jid') VALUES(2, 'fum@baz.org');"
+                "INSERT INTO messages(rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset) VALUES(3, 'hello', 1, '', 2, '', 0, 317260800, 0);"
+                "INSERT INTO messages(rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset) VALUES(5, 'removed', 1, '', 2, '', 0, 317260860, 0);"
+                "INSERT INTO messages(rowid, message, fromBare, fromResource, toBare, toResource, type, time, offset) VALUES(7, 'goodbye', 2, 'res', 1, '', 0, 317260920, 0);"
+                "DELETE FROM messages WHERE rowid=5;";
+            CPPUNIT_ASSERT_EQUAL(SQLITE_OK, sqlite3_exec(db, statements, nullptr, nullptr, nullptr));
+            sqlite3_close(db);
+            return file;
+        }
+
+        void addMessage(int index, const boost::gregorian::date& date) {
+            bool incoming = index % 2 == 0;
+            testling->addMessage(HistoryMessage("Message " + boost::lexical_cast<std::string>(index), incoming ? contact : self, incoming ? self : contact, HistoryMessage::Chat, boost::posix_time::ptime(date, boost::posix_time::minutes(index))));
+        }
+
+        std::vector<HistoryMessage> getPage(size_t limit, const boost::optional<long long>& beforeID, const boost::optional<long long>& afterID) {
+            return testling->getMessagesPage(self, contact, HistoryMessage::Chat, boost::gregorian::date(), limit, beforeID, afterID);
+        }
+
+        static std::vector<long long> getIDs(const std::vector<HistoryMessage>& messages) {
+            std::vector<long long> result;
+            for (const auto& message : messages) {
+                result.push_back(message.getID());
+            }
+            return result;
+        }
+
+    private:
+        JID self;
+        JID contact;
+        boost::gregorian::date day1;
+        boost::gregorian::date day2;
+        std::unique_ptr<SQLiteHistoryStorage> testling;
+        std::vector<long long> ids;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SQLiteHistoryStorageTest);
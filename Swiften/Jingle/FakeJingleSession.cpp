@@ -74,6 +74,10 @@ void FakeJingleSession::handleSessionTerminateReceived(boost::optional<JinglePay
     notifyListeners(&JingleSessionListener::handleSessionTerminateReceived, reason);
 }
 
+void FakeJingleSession::handleSessionInfoReceived(std::shared_ptr<JinglePayload> payload) {
+    notifyListeners(&JingleSessionListener::handleSessionInfoReceived, payload);
+}
+
 void FakeJingleSession::handleSessionAcceptReceived(const JingleContentID& contentID, std::shared_ptr<JingleDescription> desc, std::shared_ptr<JingleTransportPayload> payload) {
     notifyListeners(&JingleSessionListener::handleSessionAcceptReceived, contentID, desc, payload);
 }
@@ -19,11 +19,18 @@
 #include <Swiften/Base/Algorithm.h>
 #include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/Log.h>
+#include <Swiften/Base/Platform.h>
 #include <Swiften/Base/SafeAllocator.h>
 #include <Swiften/Base/sleep.h>
 #include <Swiften/EventLoop/EventLoop.h>
 #include <Swiften/Network/HostAddressPort.h>
 
+#if defined(SWIFTEN_PLATFORM_LINUX)
+#include <cerrno>
+#include <sys/sendfile.h>
+#include <unistd.h>
+#endif
+
 namespace Swift {
 
 static const size_t BUFFER_SIZE = 4096;
@@ -52,7 +59,7 @@ class SharedBuffer {
 // -----------------------------------------------------------------------------
 
 BoostConnection::BoostConnection(std::shared_ptr<boost::asio::io_service> ioService, EventLoop* eventLoop) :
-    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), writing_(false), closeSocketAfterNextWrite_(false) {
+    eventLoop(eventLoop), ioService(ioService), socket_(*ioService), writing_(false), closeSocketAfterNextWrite_(false), readingPaused_(false), readStopped_(false), nonBlocking_(false) {
 }
 
 BoostConnection::~BoostConnection() {
@@ -107,6 +114,87 @@ void BoostConnection::doWrite(const SafeByteArray& data) {
             boost::bind(&BoostConnection::handleDataWritten, shared_from_this(), boost::asio::placeholders::error));
 }
 
+bool BoostConnection::writeFile(int file, boost::uint64_t offset, size_t size) {
+#if defined(SWIFTEN_PLATFORM_LINUX)
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (writing_) {
+        // Keep the data in order by not overtaking queued writes.
+        return false;
+    }
+    // Write from our own descriptor, so the caller's bytestream may go away
+    // before the asynchronous write completes.
+    int ownFile = dup(file);
+    if (ownFile < 0) {
+        return false;
+    }
+    writing_ = true;
+    doWriteFile(ownFile, offset, size);
+    return true;
+#else
+    (void) file;
+    (void) offset;
+    (void) size;
+    return false;
+#endif
+}
+
+void BoostConnection::doWriteFile(int file, boost::uint64_t offset, size_t size) {
+    socket_.async_write_some(boost::asio::null_buffers(),
+            boost::bind(&BoostConnection::handleSocketWritable, shared_from_this(), boost::asio::placeholders::error, file, offset, size));
+}
+
+void BoostConnection::handleSocketWritable(const boost::system::error_code& error, int file, boost::uint64_t offset, size_t size) {
+#if defined(SWIFTEN_PLATFORM_LINUX)
+    boost::system::error_code result = error;
+    if (!error) {
+        if (!nonBlocking_) {
+            boost::system::error_code nonBlockingError;
+            socket_.native_non_blocking(true, nonBlockingError);
+            nonBlocking_ = !nonBlockingError;
+        }
+        off_t fileOffset = boost::numeric_cast<off_t>(offset);
+        ssize_t written = sendfile(socket_.native_handle(), file, &fileOffset, size);
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            doWriteFile(file, offset, size);
+            return;
+        }
+        if (written > 0 && static_cast<size_t>(written) < size) {
+            doWriteFile(file, offset + static_cast<boost::uint64_t>(written), size - static_cast<size_t>(written));
+            return;
+        }
+        if (written < 0) {
+            result = boost::system::error_code(errno, boost::system::system_category());
+        }
+        else if (written == 0) {
+            // The file is shorter than the caller expected
+            result = boost::asio::error::eof;
+        }
+    }
+    // Release the descriptor duplicated in writeFile()
+    close(file);
+    handleDataWritten(result);
+#else
+    (void) file;
+    (void) offset;
+    (void) size;
+    handleDataWritten(error);
+#endif
+}
+
+void BoostConnection::pauseReading() {
+    std::lock_guard<std::mutex> lock(readCloseMutex_);
+    readingPaused_ = true;
+}
+
+void BoostConnection::resumeReading() {
+    std::lock_guard<std::mutex> lock(readCloseMutex_);
+    readingPaused_ = false;
+    if (readStopped_) {
+        readStopped_ = false;
+        ioService->post(boost::bind(&BoostConnection::doRead, shared_from_this()));
+    }
+}
+
 void BoostConnection::handleConnectFinished(const boost::system::error_code& error) {
     SWIFT_LOG(debug) << "Connect finished: " << error << std::endl;
     if (!error) {
@@ -131,6 +219,14 @@ void BoostConnection::handleSocketRead(const boost::system::error_code& error, s
     if (!error) {
         readBuffer_->resize(bytesTransferred);
         eventLoop->postEvent(boost::bind(boost::ref(onDataRead), readBuffer_), shared_from_this());
+        {
+            std::lock_guard<std::mutex> lock(readCloseMutex_);
+            if (readingPaused_) {
+                // resumeReading() starts the next read
+                readStopped_ = true;
+                return;
+            }
+        }
         doRead();
     }
     else if (/*error == boost::asio::error::eof ||*/ error == boost::asio::error::operation_aborted) {
@@ -44,6 +44,9 @@ namespace Swift {
             virtual void connect(const HostAddressPort& address);
             virtual void disconnect();
             virtual void write(const SafeByteArray& data);
+            virtual bool writeFile(int file, boost::uint64_t offset, size_t size);
+            virtual void pauseReading();
+            virtual void resumeReading();
 
             boost::asio::ip::tcp::socket& getSocket() {
                 return socket_;
@@ -66,6 +69,8 @@ namespace Swift {
             void handleDataWritten(const boost::system::error_code& error);
             void doRead();
             void doWrite(const SafeByteArray& data);
+            void doWriteFile(int file, boost::uint64_t offset, size_t size);
+            void handleSocketWritable(const boost::system::error_code& error, int file, boost::uint64_t offset, size_t size);
             void closeSocket();
 
         private:
@@ -78,5 +83,8 @@ namespace Swift {
             SafeByteArray writeQueue_;
             bool closeSocketAfterNextWrite_;
             std::mutex readCloseMutex_;
+            bool readingPaused_;
+            bool readStopped_;
+            bool nonBlocking_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010 Isode Limited.
+ * Copyright (c) 2010-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -13,3 +13,13 @@ Connection::Connection() {
 
 Connection::~Connection() {
 }
+
+bool Connection::writeFile(int, boost::uint64_t, size_t) {
+    return false;
+}
+
+void Connection::pauseReading() {
+}
+
+void Connection::resumeReading() {
+}
@@ -8,6 +8,7 @@
 
 #include <memory>
 
+#include <boost/cstdint.hpp>
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
@@ -33,6 +34,28 @@ namespace Swift {
             virtual void disconnect() = 0;
             virtual void write(const SafeByteArray& data) = 0;
 
+            /**
+             * Writes \p size bytes of the open file \p file, starting at
+             * \p offset, without copying them through user space.
+             *
+             * Returns false if the connection cannot do this (e.g. because it
+             * encrypts or wraps the data), in which case nothing is written
+             * and write() should be used instead. Otherwise, onDataWritten
+             * is emitted once the data has been written. The connection keeps
+             * its own reference to \p file until then, so the caller may
+             * close it right away.
+             */
+            virtual bool writeFile(int file, boost::uint64_t offset, size_t size);
+
+            /**
+             * Stops reading from the network until resumeReading() is called.
+             * Data that was already read may still be emitted.
+             *
+             * Connections that cannot do this keep reading.
+             */
+            virtual void pauseReading();
+            virtual void resumeReading();
+
             virtual HostAddressPort getLocalAddress() const = 0;
             virtual HostAddressPort getRemoteAddress() const = 0;
 
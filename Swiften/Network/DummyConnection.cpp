@@ -13,7 +13,7 @@
 
 namespace Swift {
 
-DummyConnection::DummyConnection(EventLoop* eventLoop) : eventLoop(eventLoop) {
+DummyConnection::DummyConnection(EventLoop* eventLoop) : eventLoop(eventLoop), writeFileSupported(false) {
 }
 
 void DummyConnection::receive(const SafeByteArray& data) {
@@ -31,6 +31,15 @@ namespace Swift {
                 onDataSent(data);
             }
 
+            bool writeFile(int file, boost::uint64_t offset, size_t size) {
+                if (!writeFileSupported) {
+                    return false;
+                }
+                eventLoop->postEvent(boost::ref(onDataWritten), shared_from_this());
+                onFileDataSent(file, offset, size);
+                return true;
+            }
+
             void receive(const SafeByteArray& data);
 
             HostAddressPort getLocalAddress() const {
@@ -42,9 +51,11 @@ namespace Swift {
             }
 
             boost::signals2::signal<void (const SafeByteArray&)> onDataSent;
+            boost::signals2::signal<void (int, boost::uint64_t, size_t)> onFileDataSent;
 
             EventLoop* eventLoop;
             HostAddressPort localAddress;
             HostAddressPort remoteAddress;
+            bool writeFileSupported;
     };
 }
@@ -78,6 +78,18 @@ void ProxiedConnection::write(const SafeByteArray& data) {
     connection_->write(data);
 }
 
+void ProxiedConnection::pauseReading() {
+    if (connection_) {
+        connection_->pauseReading();
+    }
+}
+
+void ProxiedConnection::resumeReading() {
+    if (connection_) {
+        connection_->resumeReading();
+    }
+}
+
 void ProxiedConnection::handleConnectFinished(Connection::ref connection) {
     cancelConnector();
     if (connection) {
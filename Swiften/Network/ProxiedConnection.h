@@ -34,6 +34,8 @@ namespace Swift {
             virtual void connect(const HostAddressPort& address);
             virtual void disconnect();
             virtual void write(const SafeByteArray& data);
+            virtual void pauseReading();
+            virtual void resumeReading();
 
             virtual HostAddressPort getLocalAddress() const;
             virtual HostAddressPort getRemoteAddress() const;
@@ -30,6 +30,13 @@ namespace Swift {
                 return stanza_;
             }
 
+            /**
+             * Prepares the parser for parsing a new element.
+             */
+            virtual void reset() {
+                stanza_ = std::make_shared<ElementType>();
+            }
+
         private:
             virtual void handleStartElement(const std::string&, const std::string&, const AttributeMap&) {
             }
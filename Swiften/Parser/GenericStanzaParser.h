@@ -31,6 +31,11 @@ namespace Swift {
                 return stanza_;
             }
 
+            virtual void reset() {
+                StanzaParser::reset();
+                stanza_ = std::make_shared<STANZA_TYPE>();
+            }
+
         private:
             std::shared_ptr<STANZA_TYPE> stanza_;
     };
@@ -34,6 +34,7 @@ void JingleFileTransferFileInfoParser::handleStartElement(const std::string& ele
     }
     else if (element == "range") {
         rangeOffset = safeLexicalCast<boost::uintmax_t>(attributes.getAttributeValue("offset").get_value_or(""));
+        rangeLength = safeLexicalCast<boost::uintmax_t>(attributes.getAttributeValue("length").get_value_or(""));
     }
 
     ++level;
@@ -65,6 +66,9 @@ void JingleFileTransferFileInfoParser::handleEndElement(const std::string& eleme
             if (rangeOffset) {
                 getPayloadInternal()->setRangeOffset(rangeOffset.get_value_or(0));
             }
+            if (rangeLength) {
+                getPayloadInternal()->setRangeLength(rangeLength.get_value_or(0));
+            }
         }
         else if (element == "hash") {
             getPayloadInternal()->addHash(HashElement(hashAlg, Base64::decode(charData)));
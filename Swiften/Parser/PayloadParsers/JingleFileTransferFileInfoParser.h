@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2015 Isode Limited.
+ * Copyright (c) 2014-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -25,6 +25,7 @@ class SWIFTEN_API JingleFileTransferFileInfoParser : public GenericPayloadParser
         std::string charData;
         std::string hashAlg;
         boost::optional<boost::uintmax_t> rangeOffset;
+        boost::optional<boost::uintmax_t> rangeLength;
 };
 
 }
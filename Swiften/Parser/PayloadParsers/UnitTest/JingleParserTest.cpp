@@ -40,6 +40,7 @@ class JingleParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_Xep0234_Example5);
         CPPUNIT_TEST(testParse_Xep0234_Example8);
         CPPUNIT_TEST(testParse_Xep0234_Example10);
+        CPPUNIT_TEST(testParse_FileInfoRangeWithLength);
 
         CPPUNIT_TEST(testParse_Xep0260_Example1);
         CPPUNIT_TEST(testParse_Xep0260_Example3);
@@ -467,6 +468,26 @@ class JingleParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(true, file.getSupportsRangeRequests());
         }
 
+        void testParse_FileInfoRangeWithLength() {
+            PayloadsParserTester parser;
+            CPPUNIT_ASSERT(parser.parse(
+                "<description xmlns='urn:xmpp:jingle:apps:file-transfer:4'>\n"
+                "  <file>\n"
+                "    <name>test.txt</name>\n"
+                "    <range offset='270336' length='1000'/>\n"
+                "    <size>1022</size>\n"
+                "  </file>\n"
+                "</description>\n"
+            ));
+
+            JingleFileTransferDescription::ref description = parser.getPayload<JingleFileTransferDescription>();
+            CPPUNIT_ASSERT(description);
+            JingleFileTransferFileInfo file = description->getFileInfo();
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(270336), file.getRangeOffset());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uintmax_t>(1000), file.getRangeLength());
+            CPPUNIT_ASSERT_EQUAL(true, file.getSupportsRangeRequests());
+        }
+
         // http://xmpp.org/extensions/xep-0260.html#example-1
         void testParse_Xep0260_Example1() {
             PayloadsParserTester parser;
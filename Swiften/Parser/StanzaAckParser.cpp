@@ -29,4 +29,9 @@ void StanzaAckParser::handleEndElement(const std::string&, const std::string&) {
     --depth;
 }
 
+void StanzaAckParser::reset() {
+    GenericElementParser<StanzaAck>::reset();
+    depth = 0;
+}
+
 }
@@ -18,6 +18,8 @@ namespace Swift {
             virtual void handleStartElement(const std::string&, const std::string& ns, const AttributeMap&);
             virtual void handleEndElement(const std::string&, const std::string& ns);
 
+            virtual void reset();
+
         private:
             int depth;
     };
@@ -76,6 +76,11 @@ void StanzaParser::handleEndElement(const std::string& element, const std::strin
     }
 }
 
+void StanzaParser::reset() {
+    currentDepth_ = 0;
+    currentPayloadParser_.reset();
+}
+
 void StanzaParser::handleCharacterData(const std::string& data) {
     if (currentPayloadParser_) {
         currentPayloadParser_->handleCharacterData(data);
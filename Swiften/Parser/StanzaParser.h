@@ -36,6 +36,11 @@ namespace Swift {
                 return std::dynamic_pointer_cast<Stanza>(getElement());
             }
 
+            /**
+             * Prepares the parser for parsing a new stanza.
+             */
+            virtual void reset();
+
         private:
             bool inPayload() const {
                 return currentDepth_ > 1;
@@ -14,6 +14,7 @@
 #include <Swiften/Elements/Message.h>
 #include <Swiften/Elements/Presence.h>
 #include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/Elements/StanzaAck.h>
 #include <Swiften/Elements/StreamFeatures.h>
 #include <Swiften/Elements/UnknownElement.h>
 #include <Swiften/Parser/ElementParser.h>
@@ -31,6 +32,8 @@ class XMPPParserTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testParse_Presence);
         CPPUNIT_TEST(testParse_IQ);
         CPPUNIT_TEST(testParse_Message);
+        CPPUNIT_TEST(testParse_MultipleStanzasOfSameType);
+        CPPUNIT_TEST(testParse_StanzaAcks);
         CPPUNIT_TEST(testParse_StreamFeatures);
         CPPUNIT_TEST(testParse_UnknownElement);
         CPPUNIT_TEST(testParse_StrayCharacterData);
@@ -104,6 +107,44 @@ class XMPPParserTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(dynamic_cast<Message*>(client_.events[1].element.get()));
         }
 
+        void testParse_MultipleStanzasOfSameType() {
+            XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
+
+            CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns:stream='http://etherx.jabber.org/streams'>"));
+            CPPUNIT_ASSERT(testling.parse("<message type='headline' id='1'><body>foo</body></message>"));
+            CPPUNIT_ASSERT(testling.parse("<message id='2'/>"));
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(client_.events.size()));
+            std::shared_ptr<Message> message1 = std::dynamic_pointer_cast<Message>(client_.events[1].element);
+            std::shared_ptr<Message> message2 = std::dynamic_pointer_cast<Message>(client_.events[2].element);
+            CPPUNIT_ASSERT(message1);
+            CPPUNIT_ASSERT(message2);
+            CPPUNIT_ASSERT(message1 != message2);
+            CPPUNIT_ASSERT_EQUAL(std::string("1"), message1->getID());
+            CPPUNIT_ASSERT_EQUAL(Message::Headline, message1->getType());
+            CPPUNIT_ASSERT_EQUAL(std::string("2"), message2->getID());
+            CPPUNIT_ASSERT_EQUAL(Message::Chat, message2->getType());
+            CPPUNIT_ASSERT(message2->getPayloads().empty());
+        }
+
+        void testParse_StanzaAcks() {
+            XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
+
+            CPPUNIT_ASSERT(testling.parse("<stream:stream xmlns:stream='http://etherx.jabber.org/streams'>"));
+            CPPUNIT_ASSERT(testling.parse("<a xmlns='urn:xmpp:sm:2' h='1'/>"));
+            CPPUNIT_ASSERT(testling.parse("<a xmlns='urn:xmpp:sm:2' h='2'/>"));
+            CPPUNIT_ASSERT(testling.parse("<a xmlns='urn:xmpp:sm:3' h='3'/>"));
+
+            CPPUNIT_ASSERT_EQUAL(4, static_cast<int>(client_.events.size()));
+            std::shared_ptr<StanzaAck> ack1 = std::dynamic_pointer_cast<StanzaAck>(client_.events[1].element);
+            std::shared_ptr<StanzaAck> ack2 = std::dynamic_pointer_cast<StanzaAck>(client_.events[2].element);
+            CPPUNIT_ASSERT(ack1);
+            CPPUNIT_ASSERT(ack2);
+            CPPUNIT_ASSERT_EQUAL(1U, ack1->getHandledStanzasCount());
+            CPPUNIT_ASSERT_EQUAL(2U, ack2->getHandledStanzasCount());
+            CPPUNIT_ASSERT(dynamic_cast<UnknownElement*>(client_.events[3].element.get()));
+        }
+
         void testParse_StreamFeatures() {
             XMPPParser testling(&client_, &factories_, &xmlParserFactory_);
 
@@ -8,6 +8,9 @@
 
 #include <cassert>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Parser/AuthChallengeParser.h>
@@ -45,6 +48,85 @@
 
 namespace Swift {
 
+namespace {
+    enum ElementType {
+        PresenceElementType,
+        IQElementType,
+        MessageElementType,
+        StreamFeaturesElementType,
+        StreamErrorElementType,
+        AuthRequestElementType,
+        AuthSuccessElementType,
+        AuthFailureElementType,
+        AuthChallengeElementType,
+        AuthResponseElementType,
+        StartTLSElementType,
+        StartTLSFailureElementType,
+        CompressElementType,
+        CompressedElementType,
+        CompressFailureElementType,
+        TLSProceedElementType,
+        EnableStreamManagementElementType,
+        StreamManagementEnabledElementType,
+        StreamManagementFailedElementType,
+        StreamResumeElementType,
+        StreamResumedElementType,
+        StanzaAckElementType,
+        StanzaAckRequestElementType,
+        ComponentHandshakeElementType,
+        UnknownElementType
+    };
+
+    // Maps an element name to the namespaces it can have, together with the
+    // corresponding element type. An empty namespace matches any namespace.
+    typedef std::unordered_map<std::string, std::vector<std::pair<std::string, ElementType> > > ElementTypeMap;
+
+    ElementTypeMap createElementTypeMap() {
+        const std::string streamsNS = "http://etherx.jabber.org/streams";
+        const std::string saslNS = "urn:ietf:params:xml:ns:xmpp-sasl";
+        const std::string streamManagementNS = "urn:xmpp:sm:2";
+        ElementTypeMap map;
+        map["presence"].push_back(std::make_pair("", PresenceElementType));
+        map["iq"].push_back(std::make_pair("", IQElementType));
+        map["message"].push_back(std::make_pair("", MessageElementType));
+        map["features"].push_back(std::make_pair(streamsNS, StreamFeaturesElementType));
+        map["error"].push_back(std::make_pair(streamsNS, StreamErrorElementType));
+        map["auth"].push_back(std::make_pair("", AuthRequestElementType));
+        map["success"].push_back(std::make_pair("", AuthSuccessElementType));
+        map["failure"].push_back(std::make_pair(saslNS, AuthFailureElementType));
+        map["challenge"].push_back(std::make_pair(saslNS, AuthChallengeElementType));
+        map["response"].push_back(std::make_pair(saslNS, AuthResponseElementType));
+        map["starttls"].push_back(std::make_pair("", StartTLSElementType));
+        map["failure"].push_back(std::make_pair("urn:ietf:params:xml:ns:xmpp-tls", StartTLSFailureElementType));
+        map["compress"].push_back(std::make_pair("", CompressElementType));
+        map["compressed"].push_back(std::make_pair("", CompressedElementType));
+        map["failure"].push_back(std::make_pair("http://jabber.org/protocol/compress", CompressFailureElementType));
+        map["proceed"].push_back(std::make_pair("", TLSProceedElementType));
+        map["enable"].push_back(std::make_pair(streamManagementNS, EnableStreamManagementElementType));
+        map["enabled"].push_back(std::make_pair(streamManagementNS, StreamManagementEnabledElementType));
+        map["failed"].push_back(std::make_pair(streamManagementNS, StreamManagementFailedElementType));
+        map["resume"].push_back(std::make_pair(streamManagementNS, StreamResumeElementType));
+        map["resumed"].push_back(std::make_pair(streamManagementNS, StreamResumedElementType));
+        map["a"].push_back(std::make_pair(streamManagementNS, StanzaAckElementType));
+        map["r"].push_back(std::make_pair(streamManagementNS, StanzaAckRequestElementType));
+        map["handshake"].push_back(std::make_pair("", ComponentHandshakeElementType));
+        return map;
+    }
+
+    ElementType getElementType(const std::string& element, const std::string& ns) {
+        static const ElementTypeMap elementTypes = createElementTypeMap();
+        ElementTypeMap::const_iterator i = elementTypes.find(element);
+        if (i != elementTypes.end()) {
+            for (const auto& candidate : i->second) {
+                if (candidate.first.empty() || candidate.first == ns) {
+                    return candidate.second;
+                }
+            }
+        }
+        return UnknownElementType;
+    }
+}
+
 XMPPParser::XMPPParser(
         XMPPParserClient* client,
         PayloadParserFactoryCollection* payloadParserFactories,
@@ -54,12 +136,24 @@ XMPPParser::XMPPParser(
                 payloadParserFactories_(payloadParserFactories),
                 level_(0),
                 currentElementParser_(nullptr),
-                parseErrorOccurred_(false) {
+                parseErrorOccurred_(false),
+                presenceParser_(nullptr),
+                iqParser_(nullptr),
+                messageParser_(nullptr),
+                stanzaAckParser_(nullptr),
+                stanzaAckRequestParser_(nullptr) {
     xmlParser_ = xmlParserFactory->createXMLParser(this);
 }
 
 XMPPParser::~XMPPParser() {
-    delete currentElementParser_;
+    if (!isPooledElementParser(currentElementParser_)) {
+        delete currentElementParser_;
+    }
+    delete stanzaAckRequestParser_;
+    delete stanzaAckParser_;
+    delete messageParser_;
+    delete iqParser_;
+    delete presenceParser_;
     delete xmlParser_;
 }
 
@@ -107,7 +201,7 @@ void XMPPParser::handleEndElement(const std::string& element, const std::string&
             currentElementParser_->handleEndElement(element, ns);
             if (level_ == StreamLevel) {
                 client_->handleElement(currentElementParser_->getElement());
-                delete currentElementParser_;
+                releaseElementParser(currentElementParser_);
                 currentElementParser_ = nullptr;
             }
         }
@@ -126,79 +220,79 @@ void XMPPParser::handleCharacterData(const std::string& data) {
 }
 
 ElementParser* XMPPParser::createElementParser(const std::string& element, const std::string& ns) {
-    if (element == "presence") {
-        return new PresenceParser(payloadParserFactories_);
-    }
-    else if (element == "iq") {
-        return new IQParser(payloadParserFactories_);
-    }
-    else if (element == "message") {
-        return new MessageParser(payloadParserFactories_);
-    }
-    else if (element == "features"  && ns == "http://etherx.jabber.org/streams") {
-        return new StreamFeaturesParser();
-    }
-    else if (element == "error" && ns == "http://etherx.jabber.org/streams") {
-        return new StreamErrorParser();
-    }
-    else if (element == "auth") {
-        return new AuthRequestParser();
-    }
-    else if (element == "success") {
-        return new AuthSuccessParser();
-    }
-    else if (element == "failure" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthFailureParser();
-    }
-    else if (element == "challenge" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthChallengeParser();
-    }
-    else if (element == "response" && ns == "urn:ietf:params:xml:ns:xmpp-sasl") {
-        return new AuthResponseParser();
-    }
-    else if (element == "starttls") {
-        return new StartTLSParser();
-    }
-    else if (element == "failure" && ns == "urn:ietf:params:xml:ns:xmpp-tls") {
-        return new StartTLSFailureParser();
-    }
-    else if (element == "compress") {
-        return new CompressParser();
-    }
-    else if (element == "compressed") {
-        return new CompressedParser();
-    }
-    else if (element == "failure" && ns == "http://jabber.org/protocol/compress") {
-        return new CompressFailureParser();
-    }
-    else if (element == "proceed") {
-        return new TLSProceedParser();
-    }
-    else if (element == "enable" && ns == "urn:xmpp:sm:2") {
-        return new EnableStreamManagementParser();
-    }
-    else if (element == "enabled" && ns == "urn:xmpp:sm:2") {
-        return new StreamManagementEnabledParser();
+    switch (getElementType(element, ns)) {
+        case PresenceElementType:
+            if (!presenceParser_) {
+                presenceParser_ = new PresenceParser(payloadParserFactories_);
+            }
+            return presenceParser_;
+        case IQElementType:
+            if (!iqParser_) {
+                iqParser_ = new IQParser(payloadParserFactories_);
+            }
+            return iqParser_;
+        case MessageElementType:
+            if (!messageParser_) {
+                messageParser_ = new MessageParser(payloadParserFactories_);
+            }
+            return messageParser_;
+        case StanzaAckElementType:
+            if (!stanzaAckParser_) {
+                stanzaAckParser_ = new StanzaAckParser();
+            }
+            return stanzaAckParser_;
+        case StanzaAckRequestElementType:
+            if (!stanzaAckRequestParser_) {
+                stanzaAckRequestParser_ = new StanzaAckRequestParser();
+            }
+            return stanzaAckRequestParser_;
+        case StreamFeaturesElementType: return new StreamFeaturesParser();
+        case StreamErrorElementType: return new StreamErrorParser();
+        case AuthRequestElementType: return new AuthRequestParser();
+        case AuthSuccessElementType: return new AuthSuccessParser();
+        case AuthFailureElementType: return new AuthFailureParser();
+        case AuthChallengeElementType: return new AuthChallengeParser();
+        case AuthResponseElementType: return new AuthResponseParser();
+        case StartTLSElementType: return new StartTLSParser();
+        case StartTLSFailureElementType: return new StartTLSFailureParser();
+        case CompressElementType: return new CompressParser();
+        case CompressedElementType: return new CompressedParser();
+        case CompressFailureElementType: return new CompressFailureParser();
+        case TLSProceedElementType: return new TLSProceedParser();
+        case EnableStreamManagementElementType: return new EnableStreamManagementParser();
+        case StreamManagementEnabledElementType: return new StreamManagementEnabledParser();
+        case StreamManagementFailedElementType: return new StreamManagementFailedParser();
+        case StreamResumeElementType: return new StreamResumeParser();
+        case StreamResumedElementType: return new StreamResumedParser();
+        case ComponentHandshakeElementType: return new ComponentHandshakeParser();
+        case UnknownElementType: break;
     }
-    else if (element == "failed" && ns == "urn:xmpp:sm:2") {
-        return new StreamManagementFailedParser();
+    return new UnknownElementParser();
+}
+
+void XMPPParser::releaseElementParser(ElementParser* parser) {
+    if (parser == presenceParser_) {
+        presenceParser_->reset();
     }
-    else if (element == "resume" && ns == "urn:xmpp:sm:2") {
-        return new StreamResumeParser();
+    else if (parser == iqParser_) {
+        iqParser_->reset();
     }
-    else if (element == "resumed" && ns == "urn:xmpp:sm:2") {
-        return new StreamResumedParser();
+    else if (parser == messageParser_) {
+        messageParser_->reset();
     }
-    else if (element == "a" && ns == "urn:xmpp:sm:2") {
-        return new StanzaAckParser();
+    else if (parser == stanzaAckParser_) {
+        stanzaAckParser_->reset();
     }
-    else if (element == "r" && ns == "urn:xmpp:sm:2") {
-        return new StanzaAckRequestParser();
+    else if (parser == stanzaAckRequestParser_) {
+        stanzaAckRequestParser_->reset();
     }
-    else if (element == "handshake") {
-        return new ComponentHandshakeParser();
+    else {
+        delete parser;
     }
-    return new UnknownElementParser();
+}
+
+bool XMPPParser::isPooledElementParser(ElementParser* parser) const {
+    return parser == presenceParser_ || parser == iqParser_ || parser == messageParser_ || parser == stanzaAckParser_ || parser == stanzaAckRequestParser_;
 }
 
 }
@@ -20,6 +20,11 @@ namespace Swift {
     class XMLParserFactory;
     class ElementParser;
     class PayloadParserFactoryCollection;
+    class PresenceParser;
+    class IQParser;
+    class MessageParser;
+    class StanzaAckParser;
+    class StanzaAckRequestParser;
 
     class SWIFTEN_API XMPPParser : public XMLParserClient, boost::noncopyable {
         public:
@@ -40,6 +45,8 @@ namespace Swift {
             virtual void handleCharacterData(const std::string& data);
 
             ElementParser* createElementParser(const std::string& element, const std::string& xmlns);
+            void releaseElementParser(ElementParser* parser);
+            bool isPooledElementParser(ElementParser* parser) const;
 
         private:
             XMLParser* xmlParser_;
@@ -53,5 +60,13 @@ namespace Swift {
             int level_;
             ElementParser* currentElementParser_;
             bool parseErrorOccurred_;
+
+            // Parsers for the most common elements, reused for every element
+            // of their type.
+            PresenceParser* presenceParser_;
+            IQParser* iqParser_;
+            MessageParser* messageParser_;
+            StanzaAckParser* stanzaAckParser_;
+            StanzaAckRequestParser* stanzaAckRequestParser_;
     };
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2010-2015 Isode Limited.
+ * Copyright (c) 2010-2016 Isode Limited.
  * All rights reserved.
  * See the COPYING file for more information.
  */
@@ -9,6 +9,7 @@
 #include <queue>
 
 #include <boost/bind.hpp>
+#include <boost/functional/hash.hpp>
 
 #include <Swiften/Base/foreach.h>
 #include <Swiften/Client/StanzaChannel.h>
@@ -17,24 +18,60 @@
 
 namespace Swift {
 
-PresenceOracle::PresenceOracle(StanzaChannel* stanzaChannel, XMPPRoster* roster) : stanzaChannel_(stanzaChannel), xmppRoster_(roster) {
+PresenceOracle::PresenceOracle(StanzaChannel* stanzaChannel, XMPPRoster* roster) : stanzaChannel_(stanzaChannel), xmppRoster_(roster), batchDepth_(0) {
     stanzaChannel_->onPresenceReceived.connect(boost::bind(&PresenceOracle::handleIncomingPresence, this, _1));
     stanzaChannel_->onAvailableChanged.connect(boost::bind(&PresenceOracle::handleStanzaChannelAvailableChanged, this, _1));
+    stanzaChannel_->onStanzaBatchStarted.connect(boost::bind(&PresenceOracle::handleStanzaBatchStarted, this));
+    stanzaChannel_->onStanzaBatchFinished.connect(boost::bind(&PresenceOracle::handleStanzaBatchFinished, this));
     xmppRoster_->onJIDRemoved.connect(boost::bind(&PresenceOracle::handleJIDRemoved, this, _1));
 }
 
 PresenceOracle::~PresenceOracle() {
     stanzaChannel_->onPresenceReceived.disconnect(boost::bind(&PresenceOracle::handleIncomingPresence, this, _1));
     stanzaChannel_->onAvailableChanged.disconnect(boost::bind(&PresenceOracle::handleStanzaChannelAvailableChanged, this, _1));
+    stanzaChannel_->onStanzaBatchStarted.disconnect(boost::bind(&PresenceOracle::handleStanzaBatchStarted, this));
+    stanzaChannel_->onStanzaBatchFinished.disconnect(boost::bind(&PresenceOracle::handleStanzaBatchFinished, this));
     xmppRoster_->onJIDRemoved.disconnect(boost::bind(&PresenceOracle::handleJIDRemoved, this, _1));
 }
 
 void PresenceOracle::handleStanzaChannelAvailableChanged(bool available) {
+    /* A batch that was interrupted by the session going away will never be finished */
+    batchDepth_ = 0;
+    flushPendingPresenceChanges();
     if (available) {
         entries_.clear();
     }
 }
 
+void PresenceOracle::handleStanzaBatchStarted() {
+    batchDepth_++;
+}
+
+void PresenceOracle::handleStanzaBatchFinished() {
+    if (batchDepth_ > 0 && --batchDepth_ == 0) {
+        flushPendingPresenceChanges();
+    }
+}
+
+void PresenceOracle::notifyPresenceChange(Presence::ref presence) {
+    onPresenceChange(presence);
+    if (batchDepth_ > 0) {
+        pendingChanges_.push_back(presence);
+    }
+    else {
+        onPresencesChanged(std::vector<Presence::ref>(1, presence));
+    }
+}
+
+void PresenceOracle::flushPendingPresenceChanges() {
+    if (pendingChanges_.empty()) {
+        return;
+    }
+    std::vector<Presence::ref> changes;
+    changes.swap(pendingChanges_);
+    onPresencesChanged(changes);
+}
+
 void PresenceOracle::handleIncomingPresence(Presence::ref presence) {
     JID bareJID(presence->getFrom().toBare());
     if (presence->getType() == Presence::Subscribe) {
@@ -48,7 +85,8 @@ void PresenceOracle::handleIncomingPresence(Presence::ref presence) {
             passedPresence->setFrom(bareJID);
             passedPresence->setStatus(presence->getStatus());
         }
-        PresenceMap jidMap = entries_[bareJID];
+        Entry& entry = entries_[bareJID];
+        PresenceMap& jidMap = entry.presences;
         if (passedPresence->getFrom().isBare() && presence->getType() == Presence::Unavailable) {
             /* Have a bare-JID only presence of offline */
             jidMap.clear();
@@ -61,8 +99,8 @@ void PresenceOracle::handleIncomingPresence(Presence::ref presence) {
         } else {
             jidMap[passedPresence->getFrom()] = passedPresence;
         }
-        entries_[bareJID] = jidMap;
-        onPresenceChange(passedPresence);
+        entry.update();
+        notifyPresenceChange(passedPresence);
     }
 }
 
@@ -72,22 +110,28 @@ void PresenceOracle::handleJIDRemoved(const JID& removedJID) {
     unavailablePresence->setType(Presence::Unavailable);
     unavailablePresence->setFrom(removedJID);
 
-    if (entries_.find(removedJID) != entries_.end()) {
-        entries_[removedJID].clear();
-        entries_[removedJID][removedJID] = unavailablePresence;
+    PresencesMap::iterator i = entries_.find(removedJID);
+    if (i != entries_.end()) {
+        i->second.presences.clear();
+        i->second.presences[removedJID] = unavailablePresence;
+        i->second.update();
     }
 
-    onPresenceChange(unavailablePresence);
+    notifyPresenceChange(unavailablePresence);
+}
+
+const PresenceOracle::Entry* PresenceOracle::getEntry(const JID& bareJID) const {
+    PresencesMap::const_iterator i = entries_.find(bareJID);
+    return i != entries_.end() ? &i->second : nullptr;
 }
 
 Presence::ref PresenceOracle::getLastPresence(const JID& jid) const {
-    PresencesMap::const_iterator i = entries_.find(jid.toBare());
-    if (i == entries_.end()) {
+    const Entry* entry = getEntry(jid.toBare());
+    if (!entry) {
         return Presence::ref();
     }
-    PresenceMap presenceMap = i->second;
-    PresenceMap::const_iterator j = presenceMap.find(jid);
-    if (j != presenceMap.end()) {
+    PresenceMap::const_iterator j = entry->presences.find(jid);
+    if (j != entry->presences.end()) {
         return j->second;
     }
     else {
@@ -97,15 +141,13 @@ Presence::ref PresenceOracle::getLastPresence(const JID& jid) const {
 
 std::vector<Presence::ref> PresenceOracle::getAllPresence(const JID& bareJID) const {
     std::vector<Presence::ref> results;
-    PresencesMap::const_iterator i = entries_.find(bareJID);
-    if (i == entries_.end()) {
+    const Entry* entry = getEntry(bareJID);
+    if (!entry) {
         return results;
     }
-    PresenceMap presenceMap = i->second;
-    PresenceMap::const_iterator j = presenceMap.begin();
-    for (; j != presenceMap.end(); ++j) {
-        Presence::ref current = j->second;
-        results.push_back(current);
+    results.reserve(entry->presences.size());
+    for (PresenceMap::const_iterator j = entry->presences.begin(); j != entry->presences.end(); ++j) {
+        results.push_back(j->second);
     }
     return results;
 }
@@ -189,31 +231,37 @@ Presence::ref PresenceOracle::getActivePresence(const std::vector<Presence::ref>
 }
 
 Presence::ref PresenceOracle::getAccountPresence(const JID& jid) const {
-    Presence::ref accountPresence;
-    std::vector<Presence::ref> allPresences = getAllPresence(jid.toBare());
-    accountPresence = getActivePresence(allPresences);
-    return accountPresence;
+    const Entry* entry = getEntry(jid.toBare());
+    return entry ? entry->accountPresence : Presence::ref();
 }
 
 Presence::ref PresenceOracle::getHighestPriorityPresence(const JID& bareJID) const {
-    PresencesMap::const_iterator i = entries_.find(bareJID);
-    if (i == entries_.end()) {
-        return Presence::ref();
-    }
-    PresenceMap presenceMap = i->second;
-    PresenceMap::const_iterator j = presenceMap.begin();
-    Presence::ref highest;
-    for (; j != presenceMap.end(); ++j) {
+    const Entry* entry = getEntry(bareJID);
+    return entry ? entry->highestPriorityPresence : Presence::ref();
+}
+
+void PresenceOracle::Entry::update() {
+    std::vector<Presence::ref> allPresences;
+    allPresences.reserve(presences.size());
+    highestPriorityPresence.reset();
+    for (PresenceMap::const_iterator j = presences.begin(); j != presences.end(); ++j) {
         Presence::ref current = j->second;
-        if (!highest
-                || current->getPriority() > highest->getPriority()
-                || (current->getPriority() == highest->getPriority()
-                        && StatusShow::typeToAvailabilityOrdering(current->getShow()) > StatusShow::typeToAvailabilityOrdering(highest->getShow()))) {
-            highest = current;
+        allPresences.push_back(current);
+        if (!highestPriorityPresence
+                || current->getPriority() > highestPriorityPresence->getPriority()
+                || (current->getPriority() == highestPriorityPresence->getPriority()
+                        && StatusShow::typeToAvailabilityOrdering(current->getShow()) > StatusShow::typeToAvailabilityOrdering(highestPriorityPresence->getShow()))) {
+            highestPriorityPresence = current;
         }
-
     }
-    return highest;
+    accountPresence = getActivePresence(allPresences);
+}
+
+size_t PresenceOracle::BareJIDHash::operator()(const JID& jid) const {
+    size_t seed = 0;
+    boost::hash_combine(seed, jid.getNode());
+    boost::hash_combine(seed, jid.getDomain());
+    return seed;
 }
 
 }
@@ -8,6 +8,8 @@
 
 #include <map>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <boost/signals2.hpp>
 
@@ -29,6 +31,12 @@ namespace Swift {
             ~PresenceOracle();
 
             Presence::ref getLastPresence(const JID&) const;
+
+            /**
+             * Returns the presence with the highest priority of all resources of
+             * \p bareJID. This is kept up to date on every incoming presence, so
+             * it is cheap to call.
+             */
             Presence::ref getHighestPriorityPresence(const JID& bareJID) const;
             std::vector<Presence::ref> getAllPresence(const JID& bareJID) const;
 
@@ -57,23 +65,57 @@ namespace Swift {
             /**
              * \brief This considers all online resources of a bare JID and returns
              * the value returned by \ref getActivePresence when passing this list.
+             *
+             * Like \ref getHighestPriorityPresence, this is kept up to date on every
+             * incoming presence.
              */
             Presence::ref getAccountPresence(const JID& jid) const;
 
         public:
             boost::signals2::signal<void (Presence::ref)> onPresenceChange;
 
+            /**
+             * Emitted with all presence changes of a batch of stanzas received
+             * together (such as the initial presence burst after login), after
+             * the whole batch has been processed. Outside of a batch, this is
+             * emitted for every single change, right after \ref onPresenceChange.
+             */
+            boost::signals2::signal<void (const std::vector<Presence::ref>&)> onPresencesChanged;
+
         private:
             void handleIncomingPresence(Presence::ref presence);
             void handleStanzaChannelAvailableChanged(bool);
+            void handleStanzaBatchStarted();
+            void handleStanzaBatchFinished();
             void handleJIDRemoved(const JID& removedJID);
+            void notifyPresenceChange(Presence::ref presence);
+            void flushPendingPresenceChanges();
 
         private:
             typedef std::map<JID, Presence::ref> PresenceMap;
-            typedef std::map<JID, PresenceMap> PresencesMap;
+
+            struct Entry {
+                void update();
+
+                PresenceMap presences;
+                Presence::ref highestPriorityPresence;
+                Presence::ref accountPresence;
+            };
+
+            struct BareJIDHash {
+                size_t operator()(const JID& jid) const;
+            };
+
+            typedef std::unordered_map<JID, Entry, BareJIDHash> PresencesMap;
+
+            const Entry* getEntry(const JID& bareJID) const;
+
+        private:
             PresencesMap entries_;
             StanzaChannel* stanzaChannel_;
             XMPPRoster* xmppRoster_;
+            int batchDepth_;
+            std::vector<Presence::ref> pendingChanges_;
     };
 }
 
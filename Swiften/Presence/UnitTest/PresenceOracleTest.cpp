@@ -30,6 +30,11 @@ class PresenceOracleTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testHighestPresenceGlobal);
         CPPUNIT_TEST(testHighestPresenceChangePriority);
         CPPUNIT_TEST(testGetActivePresence);
+        CPPUNIT_TEST(testAccountPresenceChanges);
+        CPPUNIT_TEST(testJIDRemovedUpdatesHighestPresence);
+        CPPUNIT_TEST(testPresencesChanged_OutsideBatch);
+        CPPUNIT_TEST(testPresencesChanged_Batch);
+        CPPUNIT_TEST(testPresencesChanged_BatchInterruptedByDisconnect);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -39,6 +44,7 @@ class PresenceOracleTest : public CppUnit::TestFixture {
 
             oracle_ = new PresenceOracle(stanzaChannel_, xmppRoster_);
             oracle_->onPresenceChange.connect(boost::bind(&PresenceOracleTest::handlePresenceChange, this, _1));
+            oracle_->onPresencesChanged.connect(boost::bind(&PresenceOracleTest::handlePresencesChanged, this, _1));
             subscriptionManager_ = new SubscriptionManager(stanzaChannel_);
             subscriptionManager_->onPresenceSubscriptionRequest.connect(boost::bind(&PresenceOracleTest::handlePresenceSubscriptionRequest, this, _1, _2));
             user1 = JID("user1@foo.com/Foo");
@@ -154,6 +160,45 @@ class PresenceOracleTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(!oracle_->getLastPresence(user1));
         }
 
+        void testPresencesChanged_OutsideBatch() {
+            stanzaChannel_->onPresenceReceived(createPresence(user1));
+            stanzaChannel_->onPresenceReceived(createPresence(user2));
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(batches.size()));
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(batches[0].size()));
+            CPPUNIT_ASSERT_EQUAL(user2, batches[1][0]->getFrom());
+        }
+
+        void testPresencesChanged_Batch() {
+            stanzaChannel_->onStanzaBatchStarted();
+            stanzaChannel_->onPresenceReceived(createPresence(user1));
+            stanzaChannel_->onPresenceReceived(createPresence(user1alt));
+            stanzaChannel_->onPresenceReceived(createPresence(user2));
+
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(changes.size()));
+            CPPUNIT_ASSERT_EQUAL(0, static_cast<int>(batches.size()));
+            CPPUNIT_ASSERT(oracle_->getLastPresence(user2));
+
+            stanzaChannel_->onStanzaBatchFinished();
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(batches.size()));
+            CPPUNIT_ASSERT_EQUAL(3, static_cast<int>(batches[0].size()));
+            CPPUNIT_ASSERT_EQUAL(user1alt, batches[0][1]->getFrom());
+        }
+
+        void testPresencesChanged_BatchInterruptedByDisconnect() {
+            stanzaChannel_->onStanzaBatchStarted();
+            stanzaChannel_->onPresenceReceived(createPresence(user1));
+            stanzaChannel_->setAvailable(false);
+
+            CPPUNIT_ASSERT_EQUAL(1, static_cast<int>(batches.size()));
+
+            stanzaChannel_->setAvailable(true);
+            stanzaChannel_->onPresenceReceived(createPresence(user2));
+
+            CPPUNIT_ASSERT_EQUAL(2, static_cast<int>(batches.size()));
+        }
+
         void testGetActivePresence() {
             {
                 std::vector<Presence::ref> presenceList;
@@ -188,6 +233,32 @@ class PresenceOracleTest : public CppUnit::TestFixture {
             }
         }
 
+        void testAccountPresenceChanges() {
+            Presence::ref away = createPresence("alice@wonderland.lit/resourceA", 10, Presence::Available, StatusShow::Away);
+            Presence::ref online = createPresence("alice@wonderland.lit/resourceB", 5, Presence::Available, StatusShow::Online);
+            Presence::ref offline = createPresence("alice@wonderland.lit/resourceB", 0, Presence::Unavailable, StatusShow::None);
+            CPPUNIT_ASSERT_EQUAL(Presence::ref(), oracle_->getAccountPresence(JID("alice@wonderland.lit")));
+
+            stanzaChannel_->onPresenceReceived(away);
+            stanzaChannel_->onPresenceReceived(online);
+            CPPUNIT_ASSERT_EQUAL(online, oracle_->getAccountPresence(JID("alice@wonderland.lit/resourceA")));
+
+            stanzaChannel_->onPresenceReceived(offline);
+            CPPUNIT_ASSERT_EQUAL(away, oracle_->getAccountPresence(JID("alice@wonderland.lit")));
+        }
+
+        void testJIDRemovedUpdatesHighestPresence() {
+            JID bareJID("alice@wonderland.lit");
+            stanzaChannel_->onPresenceReceived(makeOnline("blah", 5));
+
+            xmppRoster_->onJIDRemoved(bareJID);
+
+            Presence::ref highest = oracle_->getHighestPriorityPresence(bareJID);
+            CPPUNIT_ASSERT(highest);
+            CPPUNIT_ASSERT_EQUAL(Presence::Unavailable, highest->getType());
+            CPPUNIT_ASSERT_EQUAL(highest, oracle_->getAccountPresence(bareJID));
+        }
+
     private:
         Presence::ref createPresence(const JID &jid, int priority, Presence::Type type, const StatusShow::Type& statusShow) {
             Presence::ref presence = std::make_shared<Presence>();
@@ -217,6 +288,10 @@ class PresenceOracleTest : public CppUnit::TestFixture {
             changes.push_back(newPresence);
         }
 
+        void handlePresencesChanged(const std::vector<Presence::ref>& presences) {
+            batches.push_back(presences);
+        }
+
         void handlePresenceSubscriptionRequest(const JID& jid, const std::string& reason) {
             SubscriptionRequestInfo subscriptionRequest;
             subscriptionRequest.jid = jid;
@@ -240,6 +315,7 @@ class PresenceOracleTest : public CppUnit::TestFixture {
         DummyStanzaChannel* stanzaChannel_;
         XMPPRoster* xmppRoster_;
         std::vector<Presence::ref> changes;
+        std::vector<std::vector<Presence::ref> > batches;
         std::vector<SubscriptionRequestInfo> subscriptionRequests;
         JID user1;
         JID user1alt;
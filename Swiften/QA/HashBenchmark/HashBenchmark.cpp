@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures hashing throughput on small inputs, as hashed for entity
+ * capabilities and SASL.
+ *
+ * Every input size is hashed with CryptoProvider::getSHA1Hash(), which creates
+ * a new Hash and returns its digest in a new ByteArray, and with a reused
+ * SHA1Hasher, which does neither.
+ *
+ * Usage: HashBenchmark [hashes per run]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hasher.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+
+using namespace Swift;
+
+typedef std::chrono::steady_clock Clock;
+
+static const size_t inputSizes[] = { 16, 64, 256 };
+
+static void report(const std::string& name, size_t inputSize, size_t count, Clock::duration duration, unsigned char check) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << std::setw(12) << name << std::setw(5) << inputSize << " bytes";
+    std::cout << std::fixed << std::setprecision(0) << std::setw(12) << static_cast<double>(count) / seconds << " hashes/s";
+    // Printing part of the digests keeps the hashing from being optimized away
+    std::cout << "  (" << static_cast<int>(check) << ")" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 1000000;
+    try {
+        if (argc > 1) {
+            count = boost::lexical_cast<size_t>(argv[1]);
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Usage: " << argv[0] << " [hashes per run]" << std::endl;
+        return -1;
+    }
+
+    std::unique_ptr<CryptoProvider> crypto(PlatformCryptoProvider::create());
+    for (size_t inputSize : inputSizes) {
+        ByteArray input(inputSize);
+        for (size_t i = 0; i < inputSize; ++i) {
+            input[i] = static_cast<unsigned char>(i * 7);
+        }
+
+        unsigned char check = 0;
+        Clock::time_point start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            input[0] = static_cast<unsigned char>(i);
+            check ^= crypto->getSHA1Hash(input)[0];
+        }
+        report("getSHA1Hash", inputSize, count, Clock::now() - start, check);
+
+        SHA1Hasher hasher(crypto.get());
+        check = 0;
+        start = Clock::now();
+        for (size_t i = 0; i < count; ++i) {
+            input[0] = static_cast<unsigned char>(i);
+            check ^= hasher.getHash(input)[0];
+        }
+        report("SHA1Hasher", inputSize, count, Clock::now() - start, check);
+    }
+    return 0;
+}
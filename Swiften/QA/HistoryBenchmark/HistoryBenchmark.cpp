@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures SQLiteHistoryStorage lookups on a large history file.
+ *
+ * The file is populated with the original (unindexed) schema, so opening it
+ * through SQLiteHistoryStorage also measures the schema migration.
+ *
+ * Usage: HistoryBenchmark <database file> [number of messages]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <sqlite3.h>
+
+#include <Swiften/Base/Path.h>
+#include <Swiften/History/SQLiteHistoryStorage.h>
+
+using namespace Swift;
+
+static const int numberOfContacts = 500;
+static const int numberOfMUCs = 20;
+static const int messagesPerDay = 2000;
+static const int iterations = 100;
+
+static JID getSelfJID() {
+    return JID("self@example.com");
+}
+
+static JID getContactJID(int i) {
+    return JID("contact" + boost::lexical_cast<std::string>(i) + "@example.com");
+}
+
+static JID getMUCJID(int i) {
+    return JID("room" + boost::lexical_cast<std::string>(i) + "@conference.example.com");
+}
+
+static void populate(const boost::filesystem::path& file, int numberOfMessages) {
+    sqlite3* db = nullptr;
+    sqlite3_open(pathToString(file).c_str(), &db);
+    sqlite3_exec(db, "CREATE TABLE messages('message' STRING, 'fromBare' INTEGER, 'fromResource' STRING, 'toBare' INTEGER, 'toResource' STRING, 'type' INTEGER, 'time' INTEGER, 'offset' INTEGER)", nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "CREATE TABLE jids('id' INTEGER PRIMARY KEY ASC AUTOINCREMENT, 'jid' STRING UNIQUE NOT NULL)", nullptr, nullptr, nullptr);
+    sqlite3_exec(db, "BEGIN TRANSACTION", nullptr, nullptr, nullptr);
+
+    sqlite3_stmt* jidStatement;
+    sqlite3_prepare(db, "INSERT INTO jids('id', 'jid') VALUES(?, ?)", -1, &jidStatement, nullptr);
+    for (int i = 0; i <= numberOfContacts + numberOfMUCs; ++i) {
+        std::string jid = (i == 0 ? getSelfJID() : (i <= numberOfContacts ? getContactJID(i) : getMUCJID(i - numberOfContacts))).toString();
+        sqlite3_bind_int(jidStatement, 1, i + 1);
+        sqlite3_bind_text(jidStatement, 2, jid.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_step(jidStatement);
+        sqlite3_reset(jidStatement);
+    }
+    sqlite3_finalize(jidStatement);
+
+    sqlite3_stmt* messageStatement;
+    sqlite3_prepare(db, "INSERT INTO messages VALUES(?, ?, ?, ?, ?, ?, ?, 0)", -1, &messageStatement, nullptr);
+    int startTime = (boost::posix_time::ptime(boost::gregorian::date(2010, 1, 1)) - boost::posix_time::ptime(boost::gregorian::date(1970, 1, 1))).total_seconds();
+    for (int i = 0; i < numberOfMessages; ++i) {
+        int peer = 2 + (i % (numberOfContacts + numberOfMUCs));
+        bool isMUC = peer > numberOfContacts + 1;
+        bool incoming = isMUC || (i % 2 == 0);
+        std::string text = "Message number " + boost::lexical_cast<std::string>(i) + " about topic" + boost::lexical_cast<std::string>(i % 1000);
+        sqlite3_bind_text(messageStatement, 1, text.c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(messageStatement, 2, incoming ? peer : 1);
+        sqlite3_bind_text(messageStatement, 3, incoming ? "nick" : "resource", -1, SQLITE_STATIC);
+        sqlite3_bind_int(messageStatement, 4, incoming ? 1 : peer);
+        sqlite3_bind_text(messageStatement, 5, incoming ? "resource" : "", -1, SQLITE_STATIC);
+        sqlite3_bind_int(messageStatement, 6, isMUC ? HistoryMessage::Groupchat : HistoryMessage::Chat);
+        sqlite3_bind_int(messageStatement, 7, startTime + (i / messagesPerDay) * 86400 + (i % messagesPerDay) * (86400 / messagesPerDay));
+        sqlite3_step(messageStatement);
+        sqlite3_reset(messageStatement);
+    }
+    sqlite3_finalize(messageStatement);
+
+    sqlite3_exec(db, "COMMIT TRANSACTION", nullptr, nullptr, nullptr);
+    sqlite3_close(db);
+}
+
+template<typename Function>
+static void measure(const std::string& name, int count, Function function) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        function(i);
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() / count << " us/call" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <database file> [number of messages]" << std::endl;
+        return -1;
+    }
+    boost::filesystem::path file = stringToPath(argv[1]);
+    int numberOfMessages = argc > 2 ? boost::lexical_cast<int>(argv[2]) : 2000000;
+
+    if (!boost::filesystem::exists(file)) {
+        std::cout << "Populating " << argv[1] << " with " << numberOfMessages << " messages" << std::endl;
+        populate(file, numberOfMessages);
+    }
+
+    std::unique_ptr<SQLiteHistoryStorage> storage;
+    measure("open (including schema migration)", 1, [&](int) {
+        storage = std::unique_ptr<SQLiteHistoryStorage>(new SQLiteHistoryStorage(file));
+    });
+
+    boost::gregorian::date date(2010, 6, 1);
+    measure("getMessagesFromDate", iterations, [&](int i) {
+        storage->getMessagesFromDate(getSelfJID(), getContactJID(1 + i % numberOfContacts), HistoryMessage::Chat, date);
+    });
+    measure("getMessagesFromNextDate", iterations, [&](int i) {
+        storage->getMessagesFromNextDate(getSelfJID(), getContactJID(1 + i % numberOfContacts), HistoryMessage::Chat, date);
+    });
+    measure("getMessagesFromPreviousDate", iterations, [&](int i) {
+        storage->getMessagesFromPreviousDate(getSelfJID(), getContactJID(1 + i % numberOfContacts), HistoryMessage::Chat, date);
+    });
+    measure("getLastTimeStampFromMUC", iterations, [&](int i) {
+        storage->getLastTimeStampFromMUC(getSelfJID(), getMUCJID(1 + i % numberOfMUCs));
+    });
+    measure("getContacts (keyword)", 10, [&](int i) {
+        storage->getContacts(getSelfJID(), HistoryMessage::Chat, "topic" + boost::lexical_cast<std::string>(i));
+    });
+
+    return 0;
+}
@@ -0,0 +1,232 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures in-band bytestream transfers over a simulated loopback link.
+ *
+ * Both ends of the transfer run in the same process, and stanzas between
+ * them are delivered on a virtual clock, taking the configured one-way
+ * latency plus their size divided by the link bandwidth. The reported
+ * transfer time is the simulated one; the CPU time is the real time spent
+ * by the sessions and the IQ routing.
+ *
+ * Usage: IBBBenchmark [size in bytes] [one-way latency in ms] [bandwidth in kB/s]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Elements/IBB.h>
+#include <Swiften/Elements/IQ.h>
+#include <Swiften/FileTransfer/ByteArrayReadBytestream.h>
+#include <Swiften/FileTransfer/ByteArrayWriteBytestream.h>
+#include <Swiften/FileTransfer/IBBReceiveSession.h>
+#include <Swiften/FileTransfer/IBBSendSession.h>
+#include <Swiften/Queries/IQChannel.h>
+#include <Swiften/Queries/IQRouter.h>
+
+using namespace Swift;
+
+// Rough size of an IQ on the wire, excluding the base64 encoded data.
+static const size_t stanzaOverhead = 200;
+
+/*
+ * A simulated link, delivering stanzas in order in each direction.
+ */
+class Link {
+    public:
+        Link(double latency, double bandwidth) : latency(latency), bandwidth(bandwidth), now(0), sequence(0), stanzas(0) {
+        }
+
+        void send(int direction, const std::function<void ()>& deliver, size_t size) {
+            double& freeAt = linkFreeAt[direction];
+            double departure = std::max(now, freeAt);
+            freeAt = departure + static_cast<double>(size) / bandwidth;
+            queue.insert(std::make_pair(std::make_pair(freeAt + latency, sequence++), deliver));
+            stanzas++;
+        }
+
+        bool deliverNext() {
+            if (queue.empty()) {
+                return false;
+            }
+            std::map<std::pair<double, size_t>, std::function<void ()> >::iterator next = queue.begin();
+            now = next->first.first;
+            std::function<void ()> deliver = next->second;
+            queue.erase(next);
+            deliver();
+            return true;
+        }
+
+        double getTime() const {
+            return now;
+        }
+
+        size_t getStanzaCount() const {
+            return stanzas;
+        }
+
+    private:
+        double latency;
+        double bandwidth;
+        double now;
+        double linkFreeAt[2] = {0, 0};
+        size_t sequence;
+        size_t stanzas;
+        std::map<std::pair<double, size_t>, std::function<void ()> > queue;
+};
+
+/*
+ * One end of the link. Outgoing IQs are stamped with the JID of this end,
+ * as a server would do.
+ */
+class LoopbackIQChannel : public IQChannel {
+    public:
+        LoopbackIQChannel(const JID& jid, Link* link, int direction) : jid(jid), link(link), direction(direction), peer(nullptr), nextID(0) {
+        }
+
+        void setPeer(LoopbackIQChannel* peer) {
+            this->peer = peer;
+        }
+
+        virtual void sendIQ(std::shared_ptr<IQ> iq) {
+            iq->setFrom(jid);
+            size_t size = stanzaOverhead;
+            if (std::shared_ptr<IBB> ibb = iq->getPayload<IBB>()) {
+                size += (ibb->getData().size() + 2) / 3 * 4;
+            }
+            LoopbackIQChannel* receiver = peer;
+            link->send(direction, [receiver, iq]() { receiver->onIQReceived(iq); }, size);
+        }
+
+        virtual std::string getNewIQID() {
+            return jid.toString() + "-" + boost::lexical_cast<std::string>(nextID++);
+        }
+
+        virtual bool isAvailable() const {
+            return true;
+        }
+
+    private:
+        JID jid;
+        Link* link;
+        int direction;
+        LoopbackIQChannel* peer;
+        size_t nextID;
+};
+
+struct Result {
+    Result() : succeeded(false), transferTime(0), cpuTime(0), stanzas(0) {}
+
+    bool succeeded;
+    double transferTime;
+    double cpuTime;
+    size_t stanzas;
+};
+
+static void handleFinished(boost::optional<FileTransferError> error, boost::optional<bool>* result) {
+    *result = !error;
+}
+
+static Result transfer(const ByteArray& data, unsigned int blockSize, unsigned int windowSize, double latency, double bandwidth) {
+    JID senderJID("sender@example.com/benchmark");
+    JID receiverJID("receiver@example.com/benchmark");
+    Link link(latency, bandwidth);
+    LoopbackIQChannel senderChannel(senderJID, &link, 0);
+    LoopbackIQChannel receiverChannel(receiverJID, &link, 1);
+    senderChannel.setPeer(&receiverChannel);
+    receiverChannel.setPeer(&senderChannel);
+    IQRouter senderRouter(&senderChannel);
+    IQRouter receiverRouter(&receiverChannel);
+
+    std::shared_ptr<ByteArrayWriteBytestream> output = std::make_shared<ByteArrayWriteBytestream>();
+    IBBReceiveSession receiveSession("benchmark", senderJID, receiverJID, data.size(), output, &receiverRouter);
+    IBBSendSession sendSession("benchmark", senderJID, receiverJID, std::make_shared<ByteArrayReadBytestream>(data), &senderRouter);
+    sendSession.setBlockSize(blockSize);
+    sendSession.setWindowSize(windowSize);
+
+    boost::optional<bool> sendResult;
+    boost::optional<bool> receiveResult;
+    sendSession.onFinished.connect(boost::bind(&handleFinished, _1, &sendResult));
+    receiveSession.onFinished.connect(boost::bind(&handleFinished, _1, &receiveResult));
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    receiveSession.start();
+    sendSession.start();
+    while (link.deliverNext()) {
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    sendSession.onFinished.disconnect(boost::bind(&handleFinished, _1, &sendResult));
+    receiveSession.onFinished.disconnect(boost::bind(&handleFinished, _1, &receiveResult));
+
+    Result result;
+    result.succeeded = sendResult && *sendResult && receiveResult && *receiveResult && output->getData() == data;
+    result.transferTime = link.getTime();
+    result.cpuTime = std::chrono::duration<double>(end - start).count();
+    result.stanzas = link.getStanzaCount();
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    size_t size = 4 * 1024 * 1024;
+    double latency = 0.05;
+    double bandwidth = 1024.0 * 1024.0;
+    try {
+        if (argc > 1) {
+            size = boost::lexical_cast<size_t>(argv[1]);
+        }
+        if (argc > 2) {
+            latency = boost::lexical_cast<double>(argv[2]) / 1000.0;
+        }
+        if (argc > 3) {
+            bandwidth = boost::lexical_cast<double>(argv[3]) * 1024.0;
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Usage: " << argv[0] << " [size in bytes] [one-way latency in ms] [bandwidth in kB/s]" << std::endl;
+        return -1;
+    }
+
+    ByteArray data(size);
+    for (size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<unsigned char>(std::rand());
+    }
+
+    std::cout << "Transferring " << size << " bytes, " << latency * 1000.0 << "ms one-way latency, " << bandwidth / 1024.0 << "kB/s" << std::endl;
+    std::cout << std::setw(8) << "block" << std::setw(8) << "window" << std::setw(12) << "time (s)" << std::setw(14) << "kB/s" << std::setw(10) << "stanzas" << std::setw(14) << "cpu (ms)" << std::endl;
+
+    const unsigned int blockSizes[] = { 4096, 16384 };
+    const unsigned int windowSizes[] = { 1, 2, 4, 8, 16 };
+    bool succeeded = true;
+    for (unsigned int blockSize : blockSizes) {
+        for (unsigned int windowSize : windowSizes) {
+            Result result = transfer(data, blockSize, windowSize, latency, bandwidth);
+            succeeded = succeeded && result.succeeded;
+            std::cout << std::setw(8) << blockSize << std::setw(8) << windowSize;
+            std::cout << std::fixed << std::setprecision(2) << std::setw(12) << result.transferTime;
+            std::cout << std::setw(14) << static_cast<double>(size) / 1024.0 / result.transferTime;
+            std::cout << std::setw(10) << result.stanzas;
+            std::cout << std::setw(14) << result.cpuTime * 1000.0;
+            std::cout << (result.succeeded ? "" : "  FAILED") << std::endl;
+        }
+    }
+    return succeeded ? 0 : 1;
+}
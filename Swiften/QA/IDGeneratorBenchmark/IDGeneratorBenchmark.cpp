@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures how many IDs per second IDGenerator generates, on one thread and
+ * on several threads with a generator each, against the random UUIDs
+ * converted with boost::lexical_cast that IDGenerator used to generate.
+ *
+ * Usage: IDGeneratorBenchmark [IDs per run] [threads]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/lexical_cast.hpp>
+#include <boost/uuid/uuid.hpp>
+#include <boost/uuid/uuid_generators.hpp>
+#include <boost/uuid/uuid_io.hpp>
+
+#include <Swiften/Base/IDGenerator.h>
+#include <Swiften/Base/foreach.h>
+
+using namespace Swift;
+
+typedef std::chrono::steady_clock Clock;
+
+static void report(const std::string& name, size_t count, Clock::duration duration, size_t check) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << std::setw(24) << name;
+    std::cout << std::fixed << std::setprecision(0) << std::setw(12) << static_cast<double>(count) / seconds << " IDs/s";
+    // Printing part of the IDs keeps the generation from being optimized away
+    std::cout << "  (" << check << ")" << std::endl;
+}
+
+static void generateIDs(size_t count, size_t* check) {
+    IDGenerator generator;
+    for (size_t i = 0; i < count; ++i) {
+        *check += generator.generateID()[0];
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = 1000000;
+    size_t threadCount = 4;
+    try {
+        if (argc > 1) {
+            count = boost::lexical_cast<size_t>(argv[1]);
+        }
+        if (argc > 2) {
+            threadCount = boost::lexical_cast<size_t>(argv[2]);
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Usage: " << argv[0] << " [IDs per run] [threads]" << std::endl;
+        return -1;
+    }
+
+    size_t check = 0;
+    Clock::time_point start = Clock::now();
+    boost::uuids::random_generator uuidGenerator;
+    for (size_t i = 0; i < count; ++i) {
+        check += boost::lexical_cast<std::string>(uuidGenerator())[0];
+    }
+    report("UUID + lexical_cast", count, Clock::now() - start, check);
+
+    check = 0;
+    start = Clock::now();
+    generateIDs(count, &check);
+    report("IDGenerator", count, Clock::now() - start, check);
+
+    std::vector<size_t> checks(threadCount, 0);
+    std::vector<std::thread*> threads;
+    start = Clock::now();
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.push_back(new std::thread(&generateIDs, count, &checks[i]));
+    }
+    foreach (std::thread* thread, threads) {
+        thread->join();
+        delete thread;
+    }
+    Clock::duration duration = Clock::now() - start;
+    check = 0;
+    foreach (size_t threadCheck, checks) {
+        check += threadCheck;
+    }
+    report("IDGenerator x " + boost::lexical_cast<std::string>(threadCount) + " threads", count * threadCount, duration, check);
+    return 0;
+}
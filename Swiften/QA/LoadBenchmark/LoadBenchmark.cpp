@@ -0,0 +1,366 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Connects a number of clients to a server, and measures:
+ * - how long it takes the clients to log in
+ * - the round-trip latency of messages that clients send to themselves
+ * - how many messages per second get through when every client sends
+ *   messages to the next one
+ * - the memory used per session, by the clients and (on Linux, when its
+ *   process ID is given) by the server
+ *
+ * The clients log in as user<n>@localhost with password "password", which
+ * is what Limber creates when it is given a number of load test users:
+ *
+ *   limber <number of threads> <number of clients>
+ *
+ * The results can also be written as JSON, to keep track of them over
+ * releases. Run with --help for all options.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/program_options.hpp>
+
+#include <Swiften/Base/Platform.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Client/ClientError.h>
+#include <Swiften/Client/ClientOptions.h>
+#include <Swiften/Client/CoreClient.h>
+#include <Swiften/Elements/Message.h>
+#include <Swiften/Elements/Presence.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/Network/BoostNetworkFactories.h>
+#include <Swiften/Network/Timer.h>
+#include <Swiften/Network/TimerFactory.h>
+
+#if defined(SWIFTEN_PLATFORM_LINUX)
+#include <unistd.h>
+#endif
+
+using namespace Swift;
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    enum Stage {
+        Connecting,
+        MeasuringRoundTrips,
+        MeasuringThroughput,
+        Finished
+    };
+
+    struct BenchmarkClient {
+        std::shared_ptr<CoreClient> client;
+        Clock::time_point connectStartTime;
+        int roundTripsLeft;
+        Clock::time_point roundTripStartTime;
+    };
+
+    struct Percentiles {
+        Percentiles() : count(0), p50(0), p90(0), p99(0), max(0) {}
+
+        size_t count;
+        double p50;
+        double p90;
+        double p99;
+        double max;
+    };
+
+    struct Results {
+        Results() : clientMemoryPerSession(-1), serverMemoryPerSession(-1), throughputMessages(0), throughputMilliseconds(0) {}
+
+        Percentiles loginTimes;
+        Percentiles roundTripTimes;
+        double clientMemoryPerSession;
+        double serverMemoryPerSession;
+        int throughputMessages;
+        long long throughputMilliseconds;
+    };
+}
+
+static const int timeoutMilliseconds = 300000;
+
+static SimpleEventLoop eventLoop;
+static BoostNetworkFactories networkFactories(&eventLoop);
+
+static std::vector<BenchmarkClient> clients;
+static std::map<CoreClient*, size_t> clientIndexes;
+static Stage stage = Connecting;
+static int roundTripsPerClient = 10;
+static int messagesPerClient = 100;
+static int connectedClients = 0;
+static int clientsWithRoundTripsLeft = 0;
+static int receivedMessages = 0;
+static bool failed = false;
+static std::vector<double> loginTimes;
+static std::vector<double> roundTripTimes;
+static Clock::time_point throughputStartTime;
+static Clock::time_point throughputFinishedTime;
+
+static double getMilliseconds(Clock::duration duration) {
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count()) / 1000.0;
+}
+
+static Percentiles getPercentiles(std::vector<double> values) {
+    Percentiles result;
+    if (values.empty()) {
+        return result;
+    }
+    std::sort(values.begin(), values.end());
+    result.count = values.size();
+    result.p50 = values[static_cast<size_t>(std::ceil(0.50 * static_cast<double>(values.size()))) - 1];
+    result.p90 = values[static_cast<size_t>(std::ceil(0.90 * static_cast<double>(values.size()))) - 1];
+    result.p99 = values[static_cast<size_t>(std::ceil(0.99 * static_cast<double>(values.size()))) - 1];
+    result.max = values.back();
+    return result;
+}
+
+/**
+ * Returns the resident memory of a process in bytes, or -1 if unknown.
+ */
+static double getResidentMemory(const std::string& pid) {
+#if defined(SWIFTEN_PLATFORM_LINUX)
+    std::ifstream statm(("/proc/" + pid + "/statm").c_str());
+    double size = 0;
+    double resident = 0;
+    if (statm >> size >> resident) {
+        return resident * static_cast<double>(sysconf(_SC_PAGESIZE));
+    }
+#else
+    (void) pid;
+#endif
+    return -1;
+}
+
+static void sendRoundTripMessage(BenchmarkClient& client) {
+    std::shared_ptr<Message> message = std::make_shared<Message>();
+    message->setTo(client.client->getJID());
+    message->setBody("Ping");
+    client.roundTripStartTime = Clock::now();
+    client.client->sendMessage(message);
+}
+
+static void startThroughput() {
+    stage = MeasuringThroughput;
+    throughputStartTime = Clock::now();
+    for (size_t i = 0; i < clients.size(); ++i) {
+        JID to = clients[(i + 1) % clients.size()].client->getJID();
+        for (int j = 0; j < messagesPerClient; ++j) {
+            std::shared_ptr<Message> message = std::make_shared<Message>();
+            message->setTo(to);
+            message->setBody("Message " + boost::lexical_cast<std::string>(j));
+            clients[i].client->sendMessage(message);
+        }
+    }
+}
+
+static void startRoundTrips() {
+    stage = MeasuringRoundTrips;
+    if (roundTripsPerClient == 0) {
+        startThroughput();
+        return;
+    }
+    clientsWithRoundTripsLeft = static_cast<int>(clients.size());
+    for (size_t i = 0; i < clients.size(); ++i) {
+        clients[i].roundTripsLeft = roundTripsPerClient;
+        sendRoundTripMessage(clients[i]);
+    }
+}
+
+static void handleConnected(CoreClient* coreClient) {
+    BenchmarkClient& client = clients[clientIndexes[coreClient]];
+    loginTimes.push_back(getMilliseconds(Clock::now() - client.connectStartTime));
+    coreClient->sendPresence(std::make_shared<Presence>());
+    if (++connectedClients == static_cast<int>(clients.size())) {
+        startRoundTrips();
+    }
+}
+
+static void handleDisconnected(const boost::optional<ClientError>& error) {
+    if (error && stage != Finished) {
+        failed = true;
+        std::cerr << "Client disconnected with error " << error->getType() << std::endl;
+        eventLoop.stop();
+    }
+}
+
+static void handleMessageReceived(CoreClient* coreClient) {
+    if (stage == MeasuringRoundTrips) {
+        BenchmarkClient& client = clients[clientIndexes[coreClient]];
+        roundTripTimes.push_back(getMilliseconds(Clock::now() - client.roundTripStartTime));
+        if (--client.roundTripsLeft > 0) {
+            sendRoundTripMessage(client);
+        }
+        else if (--clientsWithRoundTripsLeft == 0) {
+            startThroughput();
+        }
+    }
+    else if (stage == MeasuringThroughput) {
+        if (++receivedMessages == static_cast<int>(clients.size()) * messagesPerClient) {
+            throughputFinishedTime = Clock::now();
+            stage = Finished;
+            eventLoop.stop();
+        }
+    }
+}
+
+static void printPercentiles(const std::string& name, const Percentiles& percentiles) {
+    std::cout << name << ": p50 " << percentiles.p50 << "ms, p90 " << percentiles.p90 << "ms, p99 " << percentiles.p99 << "ms, max " << percentiles.max << "ms (" << percentiles.count << " samples)" << std::endl;
+}
+
+static void writeJSONPercentiles(std::ostream& out, const std::string& name, const Percentiles& percentiles) {
+    out << "  \"" << name << "\": {\"count\": " << percentiles.count << ", \"p50\": " << percentiles.p50 << ", \"p90\": " << percentiles.p90 << ", \"p99\": " << percentiles.p99 << ", \"max\": " << percentiles.max << "}," << std::endl;
+}
+
+static void writeJSONNumber(std::ostream& out, double value) {
+    if (value < 0) {
+        out << "null";
+    }
+    else {
+        out << value;
+    }
+}
+
+static void writeJSON(std::ostream& out, const Results& results, int numberOfClients) {
+    out << "{" << std::endl;
+    out << "  \"clients\": " << numberOfClients << "," << std::endl;
+    out << "  \"roundTripsPerClient\": " << roundTripsPerClient << "," << std::endl;
+    out << "  \"messagesPerClient\": " << messagesPerClient << "," << std::endl;
+    writeJSONPercentiles(out, "loginTimeMs", results.loginTimes);
+    writeJSONPercentiles(out, "roundTripTimeMs", results.roundTripTimes);
+    out << "  \"throughputMessages\": " << results.throughputMessages << "," << std::endl;
+    out << "  \"throughputMs\": " << results.throughputMilliseconds << "," << std::endl;
+    out << "  \"messagesPerSecond\": ";
+    writeJSONNumber(out, results.throughputMilliseconds > 0 ? 1000.0 * results.throughputMessages / static_cast<double>(results.throughputMilliseconds) : -1);
+    out << "," << std::endl;
+    out << "  \"clientMemoryPerSessionBytes\": ";
+    writeJSONNumber(out, results.clientMemoryPerSession);
+    out << "," << std::endl;
+    out << "  \"serverMemoryPerSessionBytes\": ";
+    writeJSONNumber(out, results.serverMemoryPerSession);
+    out << std::endl;
+    out << "}" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    boost::program_options::options_description description("Options");
+    description.add_options()
+        ("help", "Show this help message")
+        ("clients", boost::program_options::value<int>()->default_value(100), "Number of clients")
+        ("round-trips", boost::program_options::value<int>(&roundTripsPerClient)->default_value(10), "Number of round trips to measure per client")
+        ("messages", boost::program_options::value<int>(&messagesPerClient)->default_value(100), "Number of messages per client for the throughput measurement")
+        ("host", boost::program_options::value<std::string>()->default_value("localhost"), "Host to connect to")
+        ("port", boost::program_options::value<int>()->default_value(5222), "Port to connect to")
+        ("server-pid", boost::program_options::value<std::string>(), "Process ID of the server, to measure its memory use")
+        ("json", boost::program_options::value<std::string>(), "File to write the results to as JSON, or - for standard output")
+    ;
+    boost::program_options::variables_map vm;
+    try {
+        boost::program_options::store(boost::program_options::parse_command_line(argc, argv, description), vm);
+        boost::program_options::notify(vm);
+    }
+    catch (const boost::program_options::error& e) {
+        std::cerr << e.what() << std::endl << description << std::endl;
+        return -1;
+    }
+    int numberOfClients = vm["clients"].as<int>();
+    if (vm.count("help") || numberOfClients < 2 || roundTripsPerClient < 0 || messagesPerClient <= 0) {
+        std::cout << description << std::endl;
+        return vm.count("help") ? 0 : -1;
+    }
+    std::string serverPID = vm.count("server-pid") ? vm["server-pid"].as<std::string>() : "";
+
+    ClientOptions options;
+    options.useTLS = ClientOptions::NeverUseTLS;
+    options.allowPLAINWithoutTLS = true;
+    options.useStreamCompression = false;
+    options.useAcks = false;
+    options.manualHostname = vm["host"].as<std::string>();
+    options.manualPort = vm["port"].as<int>();
+
+    double clientMemoryBefore = getResidentMemory("self");
+    double serverMemoryBefore = serverPID.empty() ? -1 : getResidentMemory(serverPID);
+
+    clients.resize(static_cast<size_t>(numberOfClients));
+    for (size_t i = 0; i < clients.size(); ++i) {
+        BenchmarkClient& client = clients[i];
+        client.client = std::make_shared<CoreClient>(JID("user" + boost::lexical_cast<std::string>(i), "localhost", "load"), createSafeByteArray("password"), &networkFactories);
+        clientIndexes[client.client.get()] = i;
+        client.client->onConnected.connect(boost::bind(&handleConnected, client.client.get()));
+        client.client->onDisconnected.connect(boost::bind(&handleDisconnected, _1));
+        client.client->onMessageReceived.connect(boost::bind(&handleMessageReceived, client.client.get()));
+        client.connectStartTime = Clock::now();
+        client.client->connect(options);
+    }
+
+    Timer::ref timer = networkFactories.getTimerFactory()->createTimer(timeoutMilliseconds);
+    timer->onTick.connect(boost::bind(&SimpleEventLoop::stop, &eventLoop));
+    timer->start();
+    eventLoop.run();
+    timer->stop();
+
+    Results results;
+    results.loginTimes = getPercentiles(loginTimes);
+    results.roundTripTimes = getPercentiles(roundTripTimes);
+    double clientMemoryAfter = getResidentMemory("self");
+    if (clientMemoryBefore >= 0 && clientMemoryAfter >= 0) {
+        results.clientMemoryPerSession = (clientMemoryAfter - clientMemoryBefore) / numberOfClients;
+    }
+    double serverMemoryAfter = serverPID.empty() ? -1 : getResidentMemory(serverPID);
+    if (serverMemoryBefore >= 0 && serverMemoryAfter >= 0) {
+        results.serverMemoryPerSession = (serverMemoryAfter - serverMemoryBefore) / numberOfClients;
+    }
+    if (stage == Finished) {
+        results.throughputMessages = numberOfClients * messagesPerClient;
+        results.throughputMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(throughputFinishedTime - throughputStartTime).count();
+    }
+    else if (!failed) {
+        std::cerr << "Timed out: " << connectedClients << " of " << numberOfClients << " clients connected, " << receivedMessages << " of " << numberOfClients * messagesPerClient << " messages received" << std::endl;
+    }
+
+    printPercentiles("Login time", results.loginTimes);
+    printPercentiles("Round-trip time", results.roundTripTimes);
+    if (results.throughputMilliseconds > 0) {
+        std::cout << "Delivered " << results.throughputMessages << " messages in " << results.throughputMilliseconds << "ms (" << 1000.0 * results.throughputMessages / static_cast<double>(results.throughputMilliseconds) << " messages/s)" << std::endl;
+    }
+    if (results.clientMemoryPerSession >= 0) {
+        std::cout << "Client memory per session: " << results.clientMemoryPerSession / 1024 << "KiB" << std::endl;
+    }
+    if (results.serverMemoryPerSession >= 0) {
+        std::cout << "Server memory per session: " << results.serverMemoryPerSession / 1024 << "KiB" << std::endl;
+    }
+
+    if (vm.count("json")) {
+        std::string jsonFile = vm["json"].as<std::string>();
+        if (jsonFile == "-") {
+            writeJSON(std::cout, results, numberOfClients);
+        }
+        else {
+            std::ofstream out(jsonFile.c_str());
+            writeJSON(out, results, numberOfClients);
+        }
+    }
+
+    for (size_t i = 0; i < clients.size(); ++i) {
+        if (clients[i].client->isActive()) {
+            clients[i].client->disconnect();
+        }
+    }
+    clients.clear();
+    return stage == Finished ? 0 : 1;
+}
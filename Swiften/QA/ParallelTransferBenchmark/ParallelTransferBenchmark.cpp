@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures sending a file over one SOCKS5 bytestream against sending it as
+ * ranges over several bytestreams in parallel, as done by
+ * ParallelOutgoingFileTransfer.
+ *
+ * Each range is sent through a SOCKS5BytestreamServerSession reading from a
+ * FileDescriptorReadBytestream, and received on its own thread, which writes
+ * it to the output file at its offset through a FileDescriptorWriteBytestream.
+ * To model a link with latency over localhost, a receiver only reads one
+ * window of data per round trip, which limits every stream to window / latency,
+ * as a TCP connection with that window would be.
+ *
+ * Usage: ParallelTransferBenchmark [size in MB] [latency in ms] [window in KB]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/foreach.h>
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileDescriptorWriteBytestream.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamServerSession.h>
+#include <Swiften/Network/BoostNetworkFactories.h>
+#include <Swiften/Network/ConnectionServer.h>
+#include <Swiften/Network/ConnectionServerFactory.h>
+#include <Swiften/Network/HostAddress.h>
+
+using namespace Swift;
+
+typedef std::chrono::steady_clock Clock;
+
+struct Range {
+    Range(const std::string& streamID, boost::uintmax_t offset, boost::uintmax_t length) : streamID(streamID), offset(offset), length(length), received(false) {}
+
+    std::string streamID;
+    boost::uintmax_t offset;
+    boost::uintmax_t length;
+    bool received;
+};
+
+static const size_t streamCounts[] = { 1, 2, 4, 8 };
+static const size_t runCount = sizeof(streamCounts) / sizeof(streamCounts[0]);
+
+static SimpleEventLoop eventLoop;
+static BoostNetworkFactories networkFactories(&eventLoop);
+static SOCKS5BytestreamRegistry registry;
+static std::shared_ptr<ConnectionServer> server;
+static std::vector<std::shared_ptr<SOCKS5BytestreamServerSession> > sessions;
+static boost::filesystem::path file;
+static boost::filesystem::path outputFile;
+static boost::uintmax_t fileSize = 0;
+static std::chrono::milliseconds latency(20);
+static size_t windowSize = 256 * 1024;
+static size_t run = 0;
+static std::vector<Range> ranges;
+static std::vector<std::thread*> receivers;
+static size_t finishedReceivers = 0;
+static Clock::time_point startTime;
+static bool sendFailed = false;
+static bool failed = false;
+
+static void startRun();
+
+static void handleSessionFinished(boost::optional<FileTransferError> error) {
+    if (error) {
+        sendFailed = true;
+    }
+}
+
+static void handleNewConnection(std::shared_ptr<Connection> connection) {
+    std::shared_ptr<SOCKS5BytestreamServerSession> session = std::make_shared<SOCKS5BytestreamServerSession>(connection, &registry);
+    session->onFinished.connect(&handleSessionFinished);
+    session->start();
+    sessions.push_back(session);
+}
+
+static void startSending(size_t index) {
+    foreach (std::shared_ptr<SOCKS5BytestreamServerSession> session, sessions) {
+        if (session->getStreamID() == ranges[index].streamID) {
+            session->startSending(std::make_shared<FileDescriptorReadBytestream>(file, ranges[index].offset, ranges[index].length));
+            return;
+        }
+    }
+    std::cerr << "No session for " << ranges[index].streamID << std::endl;
+}
+
+static bool outputMatchesInput() {
+    boost::filesystem::ifstream input(file, std::ios_base::in | std::ios_base::binary);
+    boost::filesystem::ifstream output(outputFile, std::ios_base::in | std::ios_base::binary);
+    std::vector<char> inputBlock(1024 * 1024);
+    std::vector<char> outputBlock(1024 * 1024);
+    while (input) {
+        input.read(&inputBlock[0], static_cast<std::streamsize>(inputBlock.size()));
+        output.read(&outputBlock[0], static_cast<std::streamsize>(outputBlock.size()));
+        if (input.gcount() != output.gcount() || !std::equal(inputBlock.begin(), inputBlock.begin() + input.gcount(), outputBlock.begin())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handleReceiverFinished() {
+    if (++finishedReceivers < receivers.size()) {
+        return;
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - startTime).count();
+    foreach (std::thread* receiver, receivers) {
+        receiver->join();
+        delete receiver;
+    }
+    receivers.clear();
+    foreach (std::shared_ptr<SOCKS5BytestreamServerSession> session, sessions) {
+        session->onFinished.disconnect(&handleSessionFinished);
+        session->stop();
+    }
+    sessions.clear();
+    foreach (const Range& range, ranges) {
+        registry.setHasBytestream(range.streamID, false);
+    }
+
+    bool succeeded = !sendFailed && outputMatchesInput();
+    foreach (const Range& range, ranges) {
+        succeeded = succeeded && range.received;
+    }
+    failed = failed || !succeeded;
+    boost::filesystem::remove(outputFile);
+
+    std::cout << std::setw(2) << streamCounts[run] << " stream(s)";
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10) << seconds << "s";
+    std::cout << std::setw(10) << static_cast<double>(fileSize) / seconds / (1024.0 * 1024.0) << " MB/s";
+    std::cout << (succeeded ? "" : "  FAILED") << std::endl;
+
+    if (++run < runCount) {
+        startRun();
+    }
+    else {
+        eventLoop.stop();
+    }
+}
+
+static void receive(HostAddressPort address, size_t index) {
+    Range& range = ranges[index];
+    try {
+        boost::asio::io_service ioService;
+        boost::asio::ip::tcp::socket socket(ioService);
+        socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(address.getAddress().toString()), static_cast<unsigned short>(address.getPort())));
+
+        std::vector<unsigned char> buffer(windowSize);
+        boost::asio::write(socket, boost::asio::buffer("\x05\x01\x00", 3));
+        boost::asio::read(socket, boost::asio::buffer(&buffer[0], 2));
+        std::string request = std::string("\x05\x01\x00\x03", 4) + static_cast<char>(range.streamID.size()) + range.streamID + std::string("\x00\x00", 2);
+        boost::asio::write(socket, boost::asio::buffer(request));
+        boost::asio::read(socket, boost::asio::buffer(&buffer[0], 7 + range.streamID.size()));
+
+        FileDescriptorWriteBytestream output(outputFile, range.offset);
+        eventLoop.postEvent(boost::bind(&startSending, index));
+        boost::uintmax_t receivedBytes = 0;
+        while (receivedBytes < range.length) {
+            std::this_thread::sleep_for(latency);
+            size_t windowBytes = static_cast<size_t>(std::min<boost::uintmax_t>(windowSize, range.length - receivedBytes));
+            boost::asio::read(socket, boost::asio::buffer(&buffer[0], windowBytes));
+            if (!output.write(std::vector<unsigned char>(buffer.begin(), buffer.begin() + static_cast<std::ptrdiff_t>(windowBytes)))) {
+                std::cerr << "Write error" << std::endl;
+                break;
+            }
+            receivedBytes += windowBytes;
+        }
+        range.received = receivedBytes == range.length;
+    }
+    catch (const boost::system::system_error& e) {
+        std::cerr << "Receive error: " << e.what() << std::endl;
+    }
+    eventLoop.postEvent(&handleReceiverFinished);
+}
+
+static void startRun() {
+    sendFailed = false;
+    finishedReceivers = 0;
+    ranges.clear();
+    boost::uintmax_t rangeSize = (fileSize + streamCounts[run] - 1) / streamCounts[run];
+    for (boost::uintmax_t offset = 0; offset < fileSize; offset += rangeSize) {
+        ranges.push_back(Range("benchmark-" + boost::lexical_cast<std::string>(ranges.size()), offset, std::min(rangeSize, fileSize - offset)));
+        registry.setHasBytestream(ranges.back().streamID, true);
+    }
+    startTime = Clock::now();
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        receivers.push_back(new std::thread(&receive, server->getAddressPort(), i));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    boost::uintmax_t size = 64;
+    try {
+        if (argc > 1) {
+            size = boost::lexical_cast<boost::uintmax_t>(argv[1]);
+        }
+        if (argc > 2) {
+            latency = std::chrono::milliseconds(boost::lexical_cast<int>(argv[2]));
+        }
+        if (argc > 3) {
+            windowSize = boost::lexical_cast<size_t>(argv[3]) * 1024;
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Usage: " << argv[0] << " [size in MB] [latency in ms] [window in KB]" << std::endl;
+        return -1;
+    }
+
+    file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("parallel_transfer_benchmark_%%%%%%%%%%%%%%%%");
+    outputFile = file.string() + ".out";
+    {
+        boost::filesystem::ofstream output(file, std::ios_base::out | std::ios_base::binary);
+        std::vector<char> block(1024 * 1024);
+        for (boost::uintmax_t i = 0; i < size; ++i) {
+            for (size_t j = 0; j < block.size(); ++j) {
+                block[j] = static_cast<char>(j * 7 + i);
+            }
+            output.write(&block[0], static_cast<std::streamsize>(block.size()));
+        }
+    }
+    fileSize = boost::filesystem::file_size(file);
+    std::cout << "Sending " << fileSize / (1024 * 1024) << "MB with " << latency.count() << "ms latency and a " << windowSize / 1024 << "KB window" << std::endl;
+
+    server = networkFactories.getConnectionServerFactory()->createConnectionServer(HostAddress("127.0.0.1"), 0);
+    server->onNewConnection.connect(&handleNewConnection);
+    server->start();
+    startRun();
+    eventLoop.run();
+    server->onNewConnection.disconnect(&handleNewConnection);
+    server->stop();
+
+    boost::filesystem::remove(file);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures the cost of parsing stanzas with XMPPParser and serializing them
+ * again with XMPPSerializer, per type of stanza.
+ *
+ * A built-in corpus of representative stanzas is used, unless a directory
+ * with captured stanzas is given. In that case, every <type>.xml file in it
+ * holds one or more stanzas of that type (without a stream header).
+ *
+ * Usage: ParserBenchmark [iterations] [corpus directory]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/Path.h>
+#include <Swiften/Elements/ProtocolHeader.h>
+#include <Swiften/Elements/StreamType.h>
+#include <Swiften/Parser/PayloadParsers/FullPayloadParserFactoryCollection.h>
+#include <Swiften/Parser/PlatformXMLParserFactory.h>
+#include <Swiften/Parser/XMPPParser.h>
+#include <Swiften/Parser/XMPPParserClient.h>
+#include <Swiften/Serializer/PayloadSerializers/FullPayloadSerializerCollection.h>
+#include <Swiften/Serializer/XMPPSerializer.h>
+
+using namespace Swift;
+
+static std::atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    allocationCount++;
+    void* result = std::malloc(size ? size : 1);
+    if (!result) {
+        throw std::bad_alloc();
+    }
+    return result;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+namespace {
+    struct CorpusEntry {
+        CorpusEntry(const std::string& type, const std::string& data) : type(type), data(data) {}
+
+        std::string type;
+        std::string data;
+    };
+
+    class CollectingParserClient : public XMPPParserClient {
+        public:
+            virtual void handleStreamStart(const ProtocolHeader&) {}
+            virtual void handleElement(std::shared_ptr<ToplevelElement> element) {
+                elements.push_back(element);
+            }
+            virtual void handleStreamEnd() {}
+
+            std::vector<std::shared_ptr<ToplevelElement> > elements;
+    };
+}
+
+static const char* streamHeader = "<stream:stream xmlns='jabber:client' xmlns:stream='http://etherx.jabber.org/streams' from='capulet.lit' to='juliet@capulet.lit' id='benchmark' version='1.0'>";
+
+static std::vector<CorpusEntry> getBuiltinCorpus() {
+    std::vector<CorpusEntry> corpus;
+    corpus.push_back(CorpusEntry("message-receipt",
+        "<message to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat' id='msg1'>"
+            "<body>Wherefore art thou, Romeo?</body>"
+            "<request xmlns='urn:xmpp:receipts'/>"
+            "<active xmlns='http://jabber.org/protocol/chatstates'/>"
+        "</message>"));
+    corpus.push_back(CorpusEntry("message-carbon",
+        "<message from='juliet@capulet.lit' to='juliet@capulet.lit/balcony' type='chat'>"
+            "<received xmlns='urn:xmpp:carbons:2'>"
+                "<forwarded xmlns='urn:xmpp:forward:0'>"
+                    "<message xmlns='jabber:client' from='romeo@montague.lit/home' to='juliet@capulet.lit/garden' type='chat'>"
+                        "<body>What man art thou that, thus bescreen'd in night, so stumblest on my counsel?</body>"
+                        "<thread>0e3141cd80894871a68e6fe6b1ec56fa</thread>"
+                    "</message>"
+                "</forwarded>"
+            "</received>"
+        "</message>"));
+    corpus.push_back(CorpusEntry("presence-caps",
+        "<presence from='romeo@montague.lit/orchard'>"
+            "<show>away</show>"
+            "<status>Out in the garden</status>"
+            "<priority>5</priority>"
+            "<c xmlns='http://jabber.org/protocol/caps' hash='sha-1' node='https://swift.im' ver='QgayPKawpkPSDYmwT/WM94uAlu0='/>"
+            "<x xmlns='vcard-temp:x:update'><photo>01b87fcd030b72895ff8e88db57ec525450f000d</photo></x>"
+        "</presence>"));
+    corpus.push_back(CorpusEntry("roster-push",
+        "<iq type='set' id='push1' to='juliet@capulet.lit/balcony'>"
+            "<query xmlns='jabber:iq:roster' ver='ver14'>"
+                "<item jid='nurse@capulet.lit' name='Nurse' subscription='both'><group>Servants</group></item>"
+            "</query>"
+        "</iq>"));
+    corpus.push_back(CorpusEntry("mam-result",
+        "<message to='juliet@capulet.lit/balcony' id='aeb213'>"
+            "<result xmlns='urn:xmpp:mam:0' queryid='f27' id='28482-98726-73623'>"
+                "<forwarded xmlns='urn:xmpp:forward:0'>"
+                    "<delay xmlns='urn:xmpp:delay' stamp='2010-07-10T23:08:25Z'/>"
+                    "<message xmlns='jabber:client' to='juliet@capulet.lit/balcony' from='romeo@montague.lit/orchard' type='chat'>"
+                        "<body>Call me but love, and I'll be new baptized; henceforth I never will be Romeo.</body>"
+                    "</message>"
+                "</forwarded>"
+            "</result>"
+        "</message>"));
+    corpus.push_back(CorpusEntry("pubsub-event",
+        "<message from='pubsub.shakespeare.lit' to='francisco@denmark.lit' id='foo'>"
+            "<event xmlns='http://jabber.org/protocol/pubsub#event'>"
+                "<items node='princely_musings'>"
+                    "<item id='ae890ac52d0df67ed7cfdf51b644e901'>"
+                        "<entry xmlns='http://www.w3.org/2005/Atom'><title>Soliloquy</title><summary>To be, or not to be: that is the question</summary></entry>"
+                    "</item>"
+                "</items>"
+            "</event>"
+        "</message>"));
+    return corpus;
+}
+
+static std::vector<CorpusEntry> loadCorpus(const boost::filesystem::path& directory) {
+    std::vector<CorpusEntry> corpus;
+    for (boost::filesystem::directory_iterator i(directory); i != boost::filesystem::directory_iterator(); ++i) {
+        if (i->path().extension() == ".xml") {
+            ByteArray data;
+            readByteArrayFromFile(data, i->path());
+            corpus.push_back(CorpusEntry(pathToString(i->path().stem()), byteArrayToString(data)));
+        }
+    }
+    return corpus;
+}
+
+static bool benchmark(const CorpusEntry& entry, int iterations, PayloadParserFactoryCollection* parserFactories, PayloadSerializerCollection* serializers, XMLParserFactory* xmlParserFactory) {
+    CollectingParserClient client;
+    XMPPParser parser(&client, parserFactories, xmlParserFactory);
+    if (!parser.parse(streamHeader) || !parser.parse(entry.data) || client.elements.empty()) {
+        std::cerr << entry.type << ": Unable to parse" << std::endl;
+        return false;
+    }
+    std::vector<std::shared_ptr<ToplevelElement> > elements = client.elements;
+    size_t stanzas = static_cast<size_t>(iterations) * elements.size();
+
+    client.elements.clear();
+    client.elements.reserve(elements.size());
+    size_t allocationsBefore = allocationCount;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        parser.parse(entry.data);
+        client.elements.clear();
+    }
+    std::chrono::steady_clock::duration parseDuration = std::chrono::steady_clock::now() - start;
+    size_t parseAllocations = allocationCount - allocationsBefore;
+
+    XMPPSerializer serializer(serializers, ClientStreamType, false);
+    size_t serializedSize = 0;
+    allocationsBefore = allocationCount;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (size_t j = 0; j < elements.size(); ++j) {
+            serializedSize += serializer.serializeElement(elements[j]).size();
+        }
+    }
+    std::chrono::steady_clock::duration serializeDuration = std::chrono::steady_clock::now() - start;
+    size_t serializeAllocations = allocationCount - allocationsBefore;
+
+    std::cout << std::left << std::setw(20) << entry.type << std::right
+        << std::setw(10) << std::chrono::duration_cast<std::chrono::nanoseconds>(parseDuration).count() / static_cast<long long>(stanzas)
+        << std::setw(10) << parseAllocations / stanzas
+        << std::setw(12) << std::chrono::duration_cast<std::chrono::nanoseconds>(serializeDuration).count() / static_cast<long long>(stanzas)
+        << std::setw(10) << serializeAllocations / stanzas
+        << std::setw(10) << serializedSize / stanzas
+        << std::endl;
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    int iterations = 10000;
+    std::vector<CorpusEntry> corpus;
+    try {
+        if (argc > 1) {
+            iterations = boost::lexical_cast<int>(argv[1]);
+        }
+        corpus = argc > 2 ? loadCorpus(stringToPath(argv[2])) : getBuiltinCorpus();
+    }
+    catch (const boost::bad_lexical_cast&) {
+        iterations = 0;
+    }
+    catch (const boost::filesystem::filesystem_error& e) {
+        std::cerr << "ERROR: " << e.what() << std::endl;
+        return -1;
+    }
+    if (iterations <= 0 || corpus.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [iterations] [corpus directory]" << std::endl;
+        return -1;
+    }
+
+    FullPayloadParserFactoryCollection parserFactories;
+    FullPayloadSerializerCollection serializers;
+    PlatformXMLParserFactory xmlParserFactory;
+
+    std::cout << std::left << std::setw(20) << "Type" << std::right
+        << std::setw(10) << "parse ns" << std::setw(10) << "allocs"
+        << std::setw(12) << "serial. ns" << std::setw(10) << "allocs"
+        << std::setw(10) << "bytes" << std::endl;
+    bool result = true;
+    for (size_t i = 0; i < corpus.size(); ++i) {
+        result = benchmark(corpus[i], iterations, &parserFactories, &serializers, &xmlParserFactory) && result;
+    }
+    return result ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+/*
+ * Measures SOCKS5 bytestream sending throughput over localhost.
+ *
+ * A file is sent through a SOCKS5BytestreamServerSession, read through
+ * FileReadBytestream (copying the data through memory), through
+ * MappedFileReadBytestream (copying the data from a memory mapping), and
+ * through FileDescriptorReadBytestream (letting the connection send directly
+ * from the file where the platform supports it). The receiving end reads from a
+ * plain socket on its own thread, so only the sending side is measured.
+ *
+ * Usage: SOCKS5Benchmark [size in MB] [file]
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/asio.hpp>
+#include <boost/bind.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/optional.hpp>
+
+#include <Swiften/EventLoop/SimpleEventLoop.h>
+#include <Swiften/FileTransfer/FileDescriptorReadBytestream.h>
+#include <Swiften/FileTransfer/FileReadBytestream.h>
+#include <Swiften/FileTransfer/MappedFileReadBytestream.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamRegistry.h>
+#include <Swiften/FileTransfer/SOCKS5BytestreamServerSession.h>
+#include <Swiften/Network/BoostNetworkFactories.h>
+#include <Swiften/Network/ConnectionServer.h>
+#include <Swiften/Network/ConnectionServerFactory.h>
+#include <Swiften/Network/HostAddress.h>
+
+using namespace Swift;
+
+typedef std::chrono::steady_clock Clock;
+
+static const std::string streamID = "benchmark";
+static const size_t receiveBufferSize = 1024 * 1024;
+static const char* runNames[] = { "FileReadBytestream", "MappedFileReadBytestream", "FileDescriptorReadBytestream" };
+
+static SimpleEventLoop eventLoop;
+static BoostNetworkFactories networkFactories(&eventLoop);
+static SOCKS5BytestreamRegistry registry;
+static std::shared_ptr<ConnectionServer> server;
+static std::shared_ptr<SOCKS5BytestreamServerSession> session;
+static boost::filesystem::path file;
+static boost::uintmax_t fileSize = 0;
+static int run = 0;
+static std::thread* receiver = nullptr;
+static Clock::time_point startTime;
+static Clock::time_point finishTime;
+static boost::uintmax_t receivedBytes = 0;
+static boost::optional<FileTransferError> sendError;
+static bool failed = false;
+
+static void startRun();
+
+static void handleSessionFinished(boost::optional<FileTransferError> error) {
+    sendError = error;
+}
+
+static void handleNewConnection(std::shared_ptr<Connection> connection) {
+    session = std::make_shared<SOCKS5BytestreamServerSession>(connection, &registry);
+    session->onFinished.connect(&handleSessionFinished);
+    session->start();
+}
+
+static void startSending() {
+    std::shared_ptr<ReadBytestream> stream;
+    if (run == 0) {
+        stream = std::make_shared<FileReadBytestream>(file);
+    }
+    else if (run == 1) {
+        stream = std::make_shared<MappedFileReadBytestream>(file);
+    }
+    else {
+        stream = std::make_shared<FileDescriptorReadBytestream>(file);
+    }
+    startTime = Clock::now();
+    session->startSending(stream);
+}
+
+static void handleRunFinished() {
+    receiver->join();
+    delete receiver;
+    receiver = nullptr;
+    session->onFinished.disconnect(&handleSessionFinished);
+    session->stop();
+    session.reset();
+
+    double seconds = std::chrono::duration<double>(finishTime - startTime).count();
+    bool succeeded = receivedBytes == fileSize && !sendError;
+    failed = failed || !succeeded;
+    std::cout << std::setw(30) << std::left << runNames[run] << std::right;
+    std::cout << std::fixed << std::setprecision(3) << std::setw(10) << seconds << "s";
+    std::cout << std::setw(10) << static_cast<double>(fileSize) / seconds / (1024.0 * 1024.0 * 1024.0) << " GB/s";
+    std::cout << (succeeded ? "" : "  FAILED") << std::endl;
+
+    if (++run < 3) {
+        startRun();
+    }
+    else {
+        eventLoop.stop();
+    }
+}
+
+static void receive(HostAddressPort address) {
+    try {
+        boost::asio::io_service ioService;
+        boost::asio::ip::tcp::socket socket(ioService);
+        socket.connect(boost::asio::ip::tcp::endpoint(boost::asio::ip::address::from_string(address.getAddress().toString()), static_cast<unsigned short>(address.getPort())));
+
+        std::vector<unsigned char> buffer(receiveBufferSize);
+        boost::asio::write(socket, boost::asio::buffer("\x05\x01\x00", 3));
+        boost::asio::read(socket, boost::asio::buffer(&buffer[0], 2));
+        std::string request = std::string("\x05\x01\x00\x03", 4) + static_cast<char>(streamID.size()) + streamID + std::string("\x00\x00", 2);
+        boost::asio::write(socket, boost::asio::buffer(request));
+        boost::asio::read(socket, boost::asio::buffer(&buffer[0], 7 + streamID.size()));
+
+        eventLoop.postEvent(&startSending);
+        receivedBytes = 0;
+        while (receivedBytes < fileSize) {
+            receivedBytes += socket.read_some(boost::asio::buffer(buffer));
+        }
+        finishTime = Clock::now();
+    }
+    catch (const boost::system::system_error& e) {
+        std::cerr << "Receive error: " << e.what() << std::endl;
+    }
+    eventLoop.postEvent(&handleRunFinished);
+}
+
+static void startRun() {
+    sendError.reset();
+    receiver = new std::thread(&receive, server->getAddressPort());
+}
+
+int main(int argc, char* argv[]) {
+    boost::uintmax_t size = 1024;
+    bool createdFile = false;
+    try {
+        if (argc > 1) {
+            size = boost::lexical_cast<boost::uintmax_t>(argv[1]);
+        }
+    }
+    catch (const boost::bad_lexical_cast&) {
+        std::cerr << "Usage: " << argv[0] << " [size in MB] [file]" << std::endl;
+        return -1;
+    }
+    if (argc > 2) {
+        file = argv[2];
+    }
+    else {
+        file = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("socks5_benchmark_%%%%%%%%%%%%%%%%");
+        boost::filesystem::ofstream output(file, std::ios_base::out | std::ios_base::binary);
+        std::vector<char> block(1024 * 1024);
+        for (size_t i = 0; i < block.size(); ++i) {
+            block[i] = static_cast<char>(i * 7);
+        }
+        for (boost::uintmax_t i = 0; i < size; ++i) {
+            output.write(&block[0], static_cast<std::streamsize>(block.size()));
+        }
+        createdFile = true;
+    }
+    fileSize = boost::filesystem::file_size(file);
+    std::cout << "Sending " << fileSize / (1024 * 1024) << "MB over localhost" << std::endl;
+
+    registry.setHasBytestream(streamID, true);
+    server = networkFactories.getConnectionServerFactory()->createConnectionServer(HostAddress("127.0.0.1"), 0);
+    server->onNewConnection.connect(&handleNewConnection);
+    server->start();
+    startRun();
+    eventLoop.run();
+    server->onNewConnection.disconnect(&handleNewConnection);
+    server->stop();
+
+    if (createdFile) {
+        boost::filesystem::remove(file);
+    }
+    return failed ? 1 : 0;
+}
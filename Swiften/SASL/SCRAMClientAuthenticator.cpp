@@ -4,17 +4,21 @@
  * See the COPYING file for more information.
  */
 
-#include <Swiften/SASL/SCRAMSHA1ClientAuthenticator.h>
+#include <Swiften/SASL/SCRAMClientAuthenticator.h>
 
 #include <cassert>
 #include <map>
+#include <memory>
 
+#include <boost/algorithm/string/case_conv.hpp>
 #include <boost/lexical_cast.hpp>
 
 #include <Swiften/Base/Concat.h>
 #include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/Hash.h>
 #include <Swiften/IDN/IDNConverter.h>
 #include <Swiften/StringCodecs/Base64.h>
+#include <Swiften/SASL/SCRAMKeyCache.h>
 #include <Swiften/StringCodecs/PBKDF2.h>
 
 namespace Swift {
@@ -36,20 +40,30 @@ static std::string escape(const std::string& s) {
 }
 
 
-SCRAMSHA1ClientAuthenticator::SCRAMSHA1ClientAuthenticator(const std::string& nonce, bool useChannelBinding, IDNConverter* idnConverter, CryptoProvider* crypto) : ClientAuthenticator(useChannelBinding ? "SCRAM-SHA-1-PLUS" : "SCRAM-SHA-1"), step(Initial), clientnonce(nonce), useChannelBinding(useChannelBinding), idnConverter(idnConverter), crypto(crypto) {
+SCRAMClientAuthenticator::SCRAMClientAuthenticator(const std::string& algorithm, const std::string& nonce, bool useChannelBinding, IDNConverter* idnConverter, CryptoProvider* crypto) : ClientAuthenticator(getMechanismName(algorithm, useChannelBinding)), step(Initial), algorithm(algorithm), clientnonce(nonce), useChannelBinding(useChannelBinding), idnConverter(idnConverter), crypto(crypto), keyCache(nullptr) {
 }
 
-boost::optional<SafeByteArray> SCRAMSHA1ClientAuthenticator::getResponse() const {
+void SCRAMClientAuthenticator::setKeyCache(SCRAMKeyCache* keyCache) {
+    this->keyCache = keyCache;
+}
+
+bool SCRAMClientAuthenticator::isAlgorithmSupported(const std::string& algorithm, CryptoProvider* crypto) {
+    return !!std::unique_ptr<Hash>(crypto->createHash(algorithm));
+}
+
+std::string SCRAMClientAuthenticator::getMechanismName(const std::string& algorithm, bool useChannelBinding) {
+    return "SCRAM-" + boost::to_upper_copy(algorithm) + (useChannelBinding ? "-PLUS" : "");
+}
+
+boost::optional<SafeByteArray> SCRAMClientAuthenticator::getResponse() const {
     if (step == Initial) {
         return createSafeByteArray(concat(getGS2Header(), getInitialBareClientMessage()));
     }
     else if (step == Proof) {
-        ByteArray clientKey = crypto->getHMACSHA1(saltedPassword, createByteArray("Client Key"));
-        ByteArray storedKey = crypto->getSHA1Hash(clientKey);
-        ByteArray clientSignature = crypto->getHMACSHA1(createSafeByteArray(storedKey), authMessage);
-        ByteArray clientProof = clientKey;
+        SafeByteArray storedKey = createSafeByteArray(std::unique_ptr<Hash>(crypto->createHash(algorithm))->update(clientKey).getHash());
+        ByteArray clientProof = crypto->getHMAC(algorithm, storedKey, authMessage);
         for (unsigned int i = 0; i < clientProof.size(); ++i) {
-            clientProof[i] ^= clientSignature[i];
+            clientProof[i] ^= clientKey[i];
         }
         ByteArray result = concat(getFinalMessageWithoutProof(), createByteArray(",p="), createByteArray(Base64::encode(clientProof)));
         return createSafeByteArray(result);
@@ -59,7 +73,7 @@ boost::optional<SafeByteArray> SCRAMSHA1ClientAuthenticator::getResponse() const
     }
 }
 
-bool SCRAMSHA1ClientAuthenticator::setChallenge(const boost::optional<ByteArray>& challenge) {
+bool SCRAMClientAuthenticator::setChallenge(const boost::optional<ByteArray>& challenge) {
     if (step == Initial) {
         if (!challenge) {
             return false;
@@ -94,15 +108,28 @@ bool SCRAMSHA1ClientAuthenticator::setChallenge(const boost::optional<ByteArray>
             return false;
         }
 
-        // Compute all the values needed for the server signature
-        try {
-            saltedPassword = PBKDF2::encode(idnConverter->getStringPrepared(getPassword(), IDNConverter::SASLPrep), salt, iterations, crypto);
+        // Derive the keys from the password, unless they are cached
+        boost::optional<SCRAMKeyCache::Keys> derivedKeys;
+        if (keyCache) {
+            derivedKeys = keyCache->getKeys(algorithm, getPassword(), salt, iterations);
         }
-        catch (const std::exception&) {
+        if (!derivedKeys) {
+            SafeByteArray saltedPassword;
+            try {
+                saltedPassword = createSafeByteArray(PBKDF2::encode(algorithm, idnConverter->getStringPrepared(getPassword(), IDNConverter::SASLPrep), salt, iterations, crypto));
+            }
+            catch (const std::exception&) {
+            }
+            derivedKeys = SCRAMKeyCache::Keys(createSafeByteArray(crypto->getHMAC(algorithm, saltedPassword, createByteArray("Client Key"))), createSafeByteArray(crypto->getHMAC(algorithm, saltedPassword, createByteArray("Server Key"))));
+            if (keyCache) {
+                keyCache->setKeys(algorithm, getPassword(), salt, iterations, *derivedKeys);
+            }
         }
+        clientKey = derivedKeys->clientKey;
+
+        // Compute all the values needed for the server signature
         authMessage = concat(getInitialBareClientMessage(), createByteArray(","), initialServerMessage, createByteArray(","), getFinalMessageWithoutProof());
-        ByteArray serverKey = crypto->getHMACSHA1(saltedPassword, createByteArray("Server Key"));
-        serverSignature = crypto->getHMACSHA1(serverKey, authMessage);
+        serverSignature = crypto->getHMAC(algorithm, derivedKeys->serverKey, authMessage);
 
         step = Proof;
         return true;
@@ -117,7 +144,7 @@ bool SCRAMSHA1ClientAuthenticator::setChallenge(const boost::optional<ByteArray>
     }
 }
 
-std::map<char, std::string> SCRAMSHA1ClientAuthenticator::parseMap(const std::string& s) {
+std::map<char, std::string> SCRAMClientAuthenticator::parseMap(const std::string& s) {
     std::map<char, std::string> result;
     if (s.size() > 0) {
         char key = 0;
@@ -145,7 +172,7 @@ std::map<char, std::string> SCRAMSHA1ClientAuthenticator::parseMap(const std::st
     return result;
 }
 
-ByteArray SCRAMSHA1ClientAuthenticator::getInitialBareClientMessage() const {
+ByteArray SCRAMClientAuthenticator::getInitialBareClientMessage() const {
     std::string authenticationID;
     try {
         authenticationID = idnConverter->getStringPrepared(getAuthenticationID(), IDNConverter::SASLPrep);
@@ -155,7 +182,7 @@ ByteArray SCRAMSHA1ClientAuthenticator::getInitialBareClientMessage() const {
     return createByteArray(std::string("n=" + escape(authenticationID) + ",r=" + clientnonce));
 }
 
-ByteArray SCRAMSHA1ClientAuthenticator::getGS2Header() const {
+ByteArray SCRAMClientAuthenticator::getGS2Header() const {
     ByteArray channelBindingHeader(createByteArray("n"));
     if (tlsChannelBindingData) {
         if (useChannelBinding) {
@@ -168,11 +195,11 @@ ByteArray SCRAMSHA1ClientAuthenticator::getGS2Header() const {
     return concat(channelBindingHeader, createByteArray(","), (getAuthorizationID().empty() ? ByteArray() : createByteArray("a=" + escape(getAuthorizationID()))), createByteArray(","));
 }
 
-void SCRAMSHA1ClientAuthenticator::setTLSChannelBindingData(const ByteArray& channelBindingData) {
+void SCRAMClientAuthenticator::setTLSChannelBindingData(const ByteArray& channelBindingData) {
     this->tlsChannelBindingData = channelBindingData;
 }
 
-ByteArray SCRAMSHA1ClientAuthenticator::getFinalMessageWithoutProof() const {
+ByteArray SCRAMClientAuthenticator::getFinalMessageWithoutProof() const {
     ByteArray channelBindData;
     if (useChannelBinding && tlsChannelBindingData) {
         channelBindData = *tlsChannelBindingData;
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2010-2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/SASL/ClientAuthenticator.h>
+
+namespace Swift {
+    class IDNConverter;
+    class CryptoProvider;
+    class SCRAMKeyCache;
+
+    /**
+     * Authenticates with SCRAM (RFC 5802), using the hash algorithm given
+     * (named as in CryptoProvider::createHash()). The mechanism name is
+     * derived from the algorithm, e.g. "SCRAM-SHA-256" for "sha-256".
+     */
+    class SWIFTEN_API SCRAMClientAuthenticator : public ClientAuthenticator {
+        public:
+            SCRAMClientAuthenticator(const std::string& algorithm, const std::string& nonce, bool useChannelBinding, IDNConverter*, CryptoProvider*);
+
+            void setTLSChannelBindingData(const ByteArray& channelBindingData);
+
+            /**
+             * Sets a cache for the keys derived from the password. The cache
+             * must outlive the authenticator, and is typically kept across
+             * sessions of a client, so that reconnecting does not need to
+             * derive the keys again.
+             */
+            void setKeyCache(SCRAMKeyCache* keyCache);
+
+            virtual boost::optional<SafeByteArray> getResponse() const;
+            virtual bool setChallenge(const boost::optional<ByteArray>&);
+
+            /**
+             * Returns whether the crypto provider supports the hashes needed
+             * to authenticate with the algorithm.
+             */
+            static bool isAlgorithmSupported(const std::string& algorithm, CryptoProvider*);
+
+        private:
+            ByteArray getInitialBareClientMessage() const;
+            ByteArray getGS2Header() const;
+            ByteArray getFinalMessageWithoutProof() const;
+
+            static std::map<char, std::string> parseMap(const std::string&);
+            static std::string getMechanismName(const std::string& algorithm, bool useChannelBinding);
+
+        private:
+            enum Step {
+                Initial,
+                Proof,
+                Final
+            } step;
+            std::string algorithm;
+            std::string clientnonce;
+            ByteArray initialServerMessage;
+            ByteArray serverNonce;
+            ByteArray authMessage;
+            SafeByteArray clientKey;
+            ByteArray serverSignature;
+            bool useChannelBinding;
+            IDNConverter* idnConverter;
+            CryptoProvider* crypto;
+            SCRAMKeyCache* keyCache;
+            boost::optional<ByteArray> tlsChannelBindingData;
+    };
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <Swiften/SASL/SCRAMKeyCache.h>
+
+#include <algorithm>
+
+namespace Swift {
+
+SCRAMKeyCache::SCRAMKeyCache(size_t maxEntries) : maxEntries(maxEntries) {
+}
+
+boost::optional<SCRAMKeyCache::Keys> SCRAMKeyCache::getKeys(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations) {
+    std::vector<Entry>::iterator i = findEntry(algorithm, password, salt, iterations);
+    if (i == entries.end()) {
+        return boost::optional<Keys>();
+    }
+    std::rotate(entries.begin(), i, i + 1);
+    return entries.front().keys;
+}
+
+void SCRAMKeyCache::setKeys(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations, const Keys& keys) {
+    std::vector<Entry>::iterator i = findEntry(algorithm, password, salt, iterations);
+    if (i != entries.end()) {
+        entries.erase(i);
+    }
+    Entry entry;
+    entry.algorithm = algorithm;
+    entry.password = password;
+    entry.salt = salt;
+    entry.iterations = iterations;
+    entry.keys = keys;
+    entries.insert(entries.begin(), entry);
+    if (entries.size() > maxEntries) {
+        entries.resize(maxEntries);
+    }
+}
+
+void SCRAMKeyCache::clear() {
+    entries.clear();
+}
+
+std::vector<SCRAMKeyCache::Entry>::iterator SCRAMKeyCache::findEntry(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations) {
+    for (std::vector<Entry>::iterator i = entries.begin(); i != entries.end(); ++i) {
+        if (i->algorithm == algorithm && i->iterations == iterations && i->salt == salt && i->password == password) {
+            return i;
+        }
+    }
+    return entries.end();
+}
+
+}
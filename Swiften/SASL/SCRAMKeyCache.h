@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Base/SafeByteArray.h>
+
+namespace Swift {
+    /**
+     * Remembers the keys that SCRAM derives from a password, so that
+     * authenticating again with the same password, salt and iteration count
+     * does not need to run PBKDF2 again.
+     *
+     * Only the most recently used keys are kept. Like the passwords, the
+     * keys are kept in SafeByteArrays, as they are enough to authenticate.
+     */
+    class SWIFTEN_API SCRAMKeyCache {
+        public:
+            struct Keys {
+                Keys() {}
+                Keys(const SafeByteArray& clientKey, const SafeByteArray& serverKey) : clientKey(clientKey), serverKey(serverKey) {}
+
+                SafeByteArray clientKey;
+                SafeByteArray serverKey;
+            };
+
+            SCRAMKeyCache(size_t maxEntries = 4);
+
+            boost::optional<Keys> getKeys(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations);
+            void setKeys(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations, const Keys& keys);
+            void clear();
+
+        private:
+            struct Entry {
+                std::string algorithm;
+                SafeByteArray password;
+                ByteArray salt;
+                int iterations;
+                Keys keys;
+            };
+
+            std::vector<Entry>::iterator findEntry(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations);
+
+        private:
+            size_t maxEntries;
+            // Most recently used first
+            std::vector<Entry> entries;
+    };
+}
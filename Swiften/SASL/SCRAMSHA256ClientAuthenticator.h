@@ -0,0 +1,20 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <string>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/SASL/SCRAMClientAuthenticator.h>
+
+namespace Swift {
+    class SWIFTEN_API SCRAMSHA256ClientAuthenticator : public SCRAMClientAuthenticator {
+        public:
+            SCRAMSHA256ClientAuthenticator(const std::string& nonce, bool useChannelBinding, IDNConverter* idnConverter, CryptoProvider* crypto) : SCRAMClientAuthenticator("sha-256", nonce, useChannelBinding, idnConverter, crypto) {
+            }
+    };
+}
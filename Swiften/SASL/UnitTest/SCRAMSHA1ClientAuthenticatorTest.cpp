@@ -14,6 +14,7 @@
 #include <Swiften/Crypto/PlatformCryptoProvider.h>
 #include <Swiften/IDN/IDNConverter.h>
 #include <Swiften/IDN/PlatformIDNConverter.h>
+#include <Swiften/SASL/SCRAMKeyCache.h>
 #include <Swiften/SASL/SCRAMSHA1ClientAuthenticator.h>
 
 using namespace Swift;
@@ -29,6 +30,8 @@ class SCRAMSHA1ClientAuthenticatorTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testGetFinalResponse);
         CPPUNIT_TEST(testGetFinalResponse_WithoutChannelBindingWithTLSChannelBindingData);
         CPPUNIT_TEST(testGetFinalResponse_WithChannelBindingWithTLSChannelBindingData);
+        CPPUNIT_TEST(testGetFinalResponse_WithKeyCache);
+        CPPUNIT_TEST(testGetFinalResponse_UsesCachedKeys);
         CPPUNIT_TEST(testSetChallenge);
         CPPUNIT_TEST(testSetChallenge_InvalidClientNonce);
         CPPUNIT_TEST(testSetChallenge_OnlyClientNonce);
@@ -145,6 +148,41 @@ class SCRAMSHA1ClientAuthenticatorTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT(result);
         }
 
+        void testGetFinalResponse_WithKeyCache() {
+            SCRAMKeyCache keyCache;
+            SCRAMSHA1ClientAuthenticator testling("abcdefgh", false, idnConverter.get(), crypto.get());
+            testling.setKeyCache(&keyCache);
+            testling.setCredentials("user", createSafeByteArray("pass"), "");
+            testling.setChallenge(createByteArray("r=abcdefghABCDEFGH,s=MTIzNDU2NzgK,i=4096"));
+
+            SafeByteArray response = *testling.getResponse();
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("c=biws,r=abcdefghABCDEFGH,p=CZbjGDpIteIJwQNBgO0P8pKkMGY="), response);
+            boost::optional<SCRAMKeyCache::Keys> keys = keyCache.getKeys("sha-1", createSafeByteArray("pass"), createByteArray("12345678\n"), 4096);
+            CPPUNIT_ASSERT(keys);
+            SafeByteArray clientKey = keys->clientKey;
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(20), clientKey.size());
+            CPPUNIT_ASSERT(!keyCache.getKeys("sha-1", createSafeByteArray("pass"), createByteArray("12345678\n"), 4095));
+        }
+
+        void testGetFinalResponse_UsesCachedKeys() {
+            SCRAMKeyCache keyCache;
+            SCRAMSHA1ClientAuthenticator first("abcdefgh", false, idnConverter.get(), crypto.get());
+            first.setKeyCache(&keyCache);
+            first.setCredentials("user", createSafeByteArray("pass"), "");
+            first.setChallenge(createByteArray("r=abcdefghABCDEFGH,s=MTIzNDU2NzgK,i=4096"));
+            keyCache.setKeys("sha-1", createSafeByteArray("other"), createByteArray("12345678\n"), 4096, *keyCache.getKeys("sha-1", createSafeByteArray("pass"), createByteArray("12345678\n"), 4096));
+
+            SCRAMSHA1ClientAuthenticator testling("abcdefgh", false, idnConverter.get(), crypto.get());
+            testling.setKeyCache(&keyCache);
+            testling.setCredentials("user", createSafeByteArray("other"), "");
+            testling.setChallenge(createByteArray("r=abcdefghABCDEFGH,s=MTIzNDU2NzgK,i=4096"));
+
+            SafeByteArray response = *testling.getResponse();
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("c=biws,r=abcdefghABCDEFGH,p=CZbjGDpIteIJwQNBgO0P8pKkMGY="), response);
+        }
+
         void testSetChallenge() {
             SCRAMSHA1ClientAuthenticator testling("abcdefgh", false, idnConverter.get(), crypto.get());
             testling.setCredentials("user", createSafeByteArray("pass"), "");
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/ByteArray.h>
+#include <Swiften/Crypto/CryptoProvider.h>
+#include <Swiften/Crypto/PlatformCryptoProvider.h>
+#include <Swiften/IDN/IDNConverter.h>
+#include <Swiften/IDN/PlatformIDNConverter.h>
+#include <Swiften/SASL/SCRAMSHA256ClientAuthenticator.h>
+
+using namespace Swift;
+
+// Test vectors from RFC 7677
+class SCRAMSHA256ClientAuthenticatorTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(SCRAMSHA256ClientAuthenticatorTest);
+        CPPUNIT_TEST(testGetName);
+        CPPUNIT_TEST(testGetInitialResponse);
+        CPPUNIT_TEST(testGetFinalResponse);
+        CPPUNIT_TEST(testSetFinalChallenge);
+        CPPUNIT_TEST(testSetFinalChallenge_InvalidChallenge);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            idnConverter = std::shared_ptr<IDNConverter>(PlatformIDNConverter::create());
+            crypto = std::shared_ptr<CryptoProvider>(PlatformCryptoProvider::create());
+        }
+
+        void testGetName() {
+            CPPUNIT_ASSERT_EQUAL(std::string("SCRAM-SHA-256"), SCRAMSHA256ClientAuthenticator("rOprNGfwEbeRWgbNEkqO", false, idnConverter.get(), crypto.get()).getName());
+            CPPUNIT_ASSERT_EQUAL(std::string("SCRAM-SHA-256-PLUS"), SCRAMSHA256ClientAuthenticator("rOprNGfwEbeRWgbNEkqO", true, idnConverter.get(), crypto.get()).getName());
+        }
+
+        void testGetInitialResponse() {
+            SCRAMSHA256ClientAuthenticator testling("rOprNGfwEbeRWgbNEkqO", false, idnConverter.get(), crypto.get());
+            testling.setCredentials("user", createSafeByteArray("pencil"), "");
+
+            SafeByteArray response = *testling.getResponse();
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("n,,n=user,r=rOprNGfwEbeRWgbNEkqO"), response);
+        }
+
+        void testGetFinalResponse() {
+            SCRAMSHA256ClientAuthenticator testling("rOprNGfwEbeRWgbNEkqO", false, idnConverter.get(), crypto.get());
+            testling.setCredentials("user", createSafeByteArray("pencil"), "");
+            testling.setChallenge(createByteArray("r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096"));
+
+            SafeByteArray response = *testling.getResponse();
+
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("c=biws,r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,p=dHzbZapWIk4jUhN+Ute9ytag9zjfMHgsqmmiz7AndVQ="), response);
+        }
+
+        void testSetFinalChallenge() {
+            SCRAMSHA256ClientAuthenticator testling("rOprNGfwEbeRWgbNEkqO", false, idnConverter.get(), crypto.get());
+            testling.setCredentials("user", createSafeByteArray("pencil"), "");
+            testling.setChallenge(createByteArray("r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096"));
+
+            bool result = testling.setChallenge(createByteArray("v=6rriTRBi23WpRR/wtup+mMhUZUn/dB5nLTJRsjl95G4="));
+
+            CPPUNIT_ASSERT(result);
+        }
+
+        void testSetFinalChallenge_InvalidChallenge() {
+            SCRAMSHA256ClientAuthenticator testling("rOprNGfwEbeRWgbNEkqO", false, idnConverter.get(), crypto.get());
+            testling.setCredentials("user", createSafeByteArray("pencil"), "");
+            testling.setChallenge(createByteArray("r=rOprNGfwEbeRWgbNEkqO%hvYDpWUa2RaTCAfuxFIlj)hNlF$k0,s=W22ZaJ0SNY7soEsUEjb6gQ==,i=4096"));
+
+            bool result = testling.setChallenge(createByteArray("v=Dd+Q20knZs9jeeK0pi1Mx1Se+yo="));
+
+            CPPUNIT_ASSERT(!result);
+        }
+
+        std::shared_ptr<IDNConverter> idnConverter;
+        std::shared_ptr<CryptoProvider> crypto;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(SCRAMSHA256ClientAuthenticatorTest);
@@ -47,6 +47,9 @@ std::string JingleFileTransferFileInfoSerializer::serializePayload(std::shared_p
         if (fileInfo->getRangeOffset() != 0) {
             range->setAttribute("offset", boost::lexical_cast<std::string>(fileInfo->getRangeOffset()));
         }
+        if (fileInfo->getRangeLength() != 0) {
+            range->setAttribute("length", boost::lexical_cast<std::string>(fileInfo->getRangeLength()));
+        }
         fileElement.addNode(range);
     }
 
@@ -43,6 +43,7 @@ class JingleSerializersTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testSerialize_Xep0234_Example3);
         CPPUNIT_TEST(testSerialize_Xep0234_Example5);
         CPPUNIT_TEST(testSerialize_Xep0234_Example8);
+        CPPUNIT_TEST(testSerialize_FileInfoRangeWithLength);
 
         CPPUNIT_TEST(testSerialize_Xep0260_Example1);
 
@@ -207,6 +208,25 @@ class JingleSerializersTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(expected, std::make_shared<JingleFileTransferDescriptionSerializer>()->serialize(desc));
         }
 
+        void testSerialize_FileInfoRangeWithLength() {
+            std::string expected =    "<description xmlns=\"urn:xmpp:jingle:apps:file-transfer:4\">"
+                    "<file>"
+                        "<name>test.txt</name>"
+                        "<range length=\"1000\" offset=\"270336\"/>"
+                        "<size>1022</size>"
+                    "</file>"
+                "</description>";
+            JingleFileTransferDescription::ref desc = std::make_shared<JingleFileTransferDescription>();
+            JingleFileTransferFileInfo fileInfo;
+            fileInfo.setName("test.txt");
+            fileInfo.setSize(1022);
+            fileInfo.setRangeOffset(270336);
+            fileInfo.setRangeLength(1000);
+            desc->setFileInfo(fileInfo);
+
+            CPPUNIT_ASSERT_EQUAL(expected, std::make_shared<JingleFileTransferDescriptionSerializer>()->serialize(desc));
+        }
+
         // http://xmpp.org/extensions/xep-0234.html#example-3
         void testSerialize_Xep0234_Example3() {
             std::string expected =
@@ -62,6 +62,8 @@ BOSHSessionStream::BOSHSessionStream(const URL& boshURL,
     xmppLayer->onElement.connect(boost::bind(&BOSHSessionStream::handleElementReceived, this, _1));
     xmppLayer->onError.connect(boost::bind(&BOSHSessionStream::handleXMPPError, this));
     xmppLayer->onWriteData.connect(boost::bind(&BOSHSessionStream::handleXMPPLayerDataWritten, this, _1));
+    xmppLayer->onElementBatchStarted.connect(boost::ref(onElementBatchStarted));
+    xmppLayer->onElementBatchFinished.connect(boost::ref(onElementBatchFinished));
 
     available = true;
 }
@@ -142,6 +144,12 @@ ByteArray BOSHSessionStream::getTLSFinishMessage() const {
     return ByteArray();
 }
 
+StreamStatistics BOSHSessionStream::getStatistics() const {
+    StreamStatistics statistics;
+    statistics.xmpp = xmppLayer->getStatistics();
+    return statistics;
+}
+
 bool BOSHSessionStream::supportsZLibCompression() {
     return false;
 }
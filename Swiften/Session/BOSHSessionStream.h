@@ -71,6 +71,8 @@ namespace Swift {
             virtual std::shared_ptr<CertificateVerificationError> getPeerCertificateVerificationError() const;
             virtual ByteArray getTLSFinishMessage() const;
 
+            virtual StreamStatistics getStatistics() const;
+
             virtual void setWhitespacePingEnabled(bool);
 
             virtual void resetXMPPParser();
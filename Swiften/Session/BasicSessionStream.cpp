@@ -44,6 +44,8 @@ BasicSessionStream::BasicSessionStream(
     xmppLayer->onError.connect(boost::bind(&BasicSessionStream::handleXMPPError, this));
     xmppLayer->onDataRead.connect(boost::bind(&BasicSessionStream::handleDataRead, this, _1));
     xmppLayer->onWriteData.connect(boost::bind(&BasicSessionStream::handleDataWritten, this, _1));
+    xmppLayer->onElementBatchStarted.connect(boost::ref(onElementBatchStarted));
+    xmppLayer->onElementBatchFinished.connect(boost::ref(onElementBatchFinished));
 
     connection->onDisconnected.connect(boost::bind(&BasicSessionStream::handleConnectionFinished, this, _1));
     connectionLayer = new ConnectionLayer(connection);
@@ -141,6 +143,19 @@ ByteArray BasicSessionStream::getTLSFinishMessage() const {
     return tlsLayer->getContext()->getFinishMessage();
 }
 
+StreamStatistics BasicSessionStream::getStatistics() const {
+    StreamStatistics statistics;
+    statistics.connection = connectionLayer->getStatistics();
+    if (tlsLayer) {
+        statistics.tls = tlsLayer->getStatistics();
+    }
+    if (compressionLayer) {
+        statistics.compression = compressionLayer->getStatistics();
+    }
+    statistics.xmpp = xmppLayer->getStatistics();
+    return statistics;
+}
+
 bool BasicSessionStream::supportsZLibCompression() {
     return true;
 }
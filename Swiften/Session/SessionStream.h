@@ -16,6 +16,7 @@
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/Elements/ProtocolHeader.h>
 #include <Swiften/Elements/ToplevelElement.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 #include <Swiften/TLS/Certificate.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
 #include <Swiften/TLS/CertificateWithKey.h>
@@ -74,8 +75,17 @@ namespace Swift {
 
             virtual ByteArray getTLSFinishMessage() const = 0;
 
+            /**
+             * Returns a snapshot of the counters of the layers of the stream.
+             */
+            virtual StreamStatistics getStatistics() const {
+                return StreamStatistics();
+            }
+
             boost::signals2::signal<void (const ProtocolHeader&)> onStreamStartReceived;
             boost::signals2::signal<void (std::shared_ptr<ToplevelElement>)> onElementReceived;
+            boost::signals2::signal<void ()> onElementBatchStarted;
+            boost::signals2::signal<void ()> onElementBatchFinished;
             boost::signals2::signal<void (std::shared_ptr<Error>)> onClosed;
             boost::signals2::signal<void ()> onTLSEncrypted;
             boost::signals2::signal<void (const SafeByteArray&)> onDataRead;
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <boost/noncopyable.hpp>
 #include <boost/signals2.hpp>
 
@@ -15,6 +17,7 @@
 #include <Swiften/Compress/ZLibDecompressor.h>
 #include <Swiften/Compress/ZLibException.h>
 #include <Swiften/StreamStack/StreamLayer.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 
 namespace Swift {
     class ZLibCompressor;
@@ -26,7 +29,12 @@ namespace Swift {
 
             virtual void writeData(const SafeByteArray& data) {
                 try {
-                    writeDataToChildLayer(compressor_.process(data));
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    SafeByteArray compressed = compressor_.process(data);
+                    statistics_.compressionTime.add(std::chrono::steady_clock::now() - start);
+                    statistics_.uncompressedBytesWritten += data.size();
+                    statistics_.compressedBytesWritten += compressed.size();
+                    writeDataToChildLayer(compressed);
                 }
                 catch (const ZLibException&) {
                     onError();
@@ -35,18 +43,28 @@ namespace Swift {
 
             virtual void handleDataRead(const SafeByteArray& data) {
                 try {
-                    writeDataToParentLayer(decompressor_.process(data));
+                    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                    SafeByteArray decompressed = decompressor_.process(data);
+                    statistics_.decompressionTime.add(std::chrono::steady_clock::now() - start);
+                    statistics_.compressedBytesRead += data.size();
+                    statistics_.uncompressedBytesRead += decompressed.size();
+                    writeDataToParentLayer(decompressed);
                 }
                 catch (const ZLibException&) {
                     onError();
                 }
             }
 
+            const CompressionLayerStatistics& getStatistics() const {
+                return statistics_;
+            }
+
         public:
             boost::signals2::signal<void ()> onError;
 
         private:
             ZLibCompressor compressor_;
             ZLibDecompressor decompressor_;
+            CompressionLayerStatistics statistics_;
     };
 }
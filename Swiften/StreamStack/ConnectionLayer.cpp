@@ -19,6 +19,8 @@ ConnectionLayer::~ConnectionLayer() {
 }
 
 void ConnectionLayer::handleDataRead(std::shared_ptr<SafeByteArray> data) {
+    statistics.bytesRead += data->size();
+    ++statistics.reads;
     writeDataToParentLayer(*data);
 }
 
@@ -11,6 +11,7 @@
 #include <Swiften/Base/API.h>
 #include <Swiften/Network/Connection.h>
 #include <Swiften/StreamStack/LowLayer.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 
 namespace Swift {
     class SWIFTEN_API ConnectionLayer : public LowLayer {
@@ -19,13 +20,20 @@ namespace Swift {
             virtual ~ConnectionLayer();
 
             void writeData(const SafeByteArray& data) {
+                statistics.bytesWritten += data.size();
+                ++statistics.writes;
                 connection->write(data);
             }
 
+            const ConnectionLayerStatistics& getStatistics() const {
+                return statistics;
+            }
+
         private:
             void handleDataRead(std::shared_ptr<SafeByteArray>);
 
         private:
             std::shared_ptr<Connection> connection;
+            ConnectionLayerStatistics statistics;
     };
 }
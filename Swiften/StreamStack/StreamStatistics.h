@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#pragma once
+
+#include <boost/cstdint.hpp>
+#include <boost/optional.hpp>
+
+#include <Swiften/Base/API.h>
+#include <Swiften/Base/LatencyHistogram.h>
+
+namespace Swift {
+    struct SWIFTEN_API ConnectionLayerStatistics {
+        ConnectionLayerStatistics() : bytesRead(0), bytesWritten(0), reads(0), writes(0) {}
+
+        boost::uint64_t bytesRead;
+        boost::uint64_t bytesWritten;
+        boost::uint64_t reads;
+        boost::uint64_t writes;
+    };
+
+    struct SWIFTEN_API TLSLayerStatistics {
+        TLSLayerStatistics() : recordsRead(0), recordsWritten(0), encryptedBytesRead(0), encryptedBytesWritten(0), plainBytesRead(0), plainBytesWritten(0) {}
+
+        boost::uint64_t recordsRead;
+        boost::uint64_t recordsWritten;
+        boost::uint64_t encryptedBytesRead;
+        boost::uint64_t encryptedBytesWritten;
+        boost::uint64_t plainBytesRead;
+        boost::uint64_t plainBytesWritten;
+
+        /**
+         * The time between the start of the handshake and the connection
+         * being established, if the handshake finished.
+         */
+        boost::optional<LatencyHistogram::Duration> handshakeTime;
+    };
+
+    struct SWIFTEN_API CompressionLayerStatistics {
+        CompressionLayerStatistics() : uncompressedBytesWritten(0), compressedBytesWritten(0), compressedBytesRead(0), uncompressedBytesRead(0) {}
+
+        /**
+         * Returns the number of uncompressed bytes per compressed byte,
+         * in both directions together.
+         */
+        double getCompressionRatio() const {
+            boost::uint64_t compressed = compressedBytesWritten + compressedBytesRead;
+            return compressed == 0 ? 1.0 : static_cast<double>(uncompressedBytesWritten + uncompressedBytesRead) / static_cast<double>(compressed);
+        }
+
+        boost::uint64_t uncompressedBytesWritten;
+        boost::uint64_t compressedBytesWritten;
+        boost::uint64_t compressedBytesRead;
+        boost::uint64_t uncompressedBytesRead;
+        LatencyHistogram compressionTime;
+        LatencyHistogram decompressionTime;
+    };
+
+    struct SWIFTEN_API XMPPLayerStatistics {
+        XMPPLayerStatistics() : elementsParsed(0), elementsSerialized(0), bytesParsed(0), bytesSerialized(0) {}
+
+        boost::uint64_t elementsParsed;
+        boost::uint64_t elementsSerialized;
+        boost::uint64_t bytesParsed;
+        boost::uint64_t bytesSerialized;
+
+        /**
+         * The time spent parsing each chunk of received data, not including
+         * the time spent handling the parsed elements.
+         */
+        LatencyHistogram parseTime;
+
+        /** The time spent serializing each element. */
+        LatencyHistogram serializationTime;
+    };
+
+    /**
+     * A snapshot of the counters of the layers of a stream.
+     *
+     * Layers that are not (yet) part of the stream are not set.
+     */
+    struct SWIFTEN_API StreamStatistics {
+        boost::optional<ConnectionLayerStatistics> connection;
+        boost::optional<TLSLayerStatistics> tls;
+        boost::optional<CompressionLayerStatistics> compression;
+        boost::optional<XMPPLayerStatistics> xmpp;
+    };
+}
@@ -6,6 +6,8 @@
 
 #include <Swiften/StreamStack/TLSLayer.h>
 
+#include <algorithm>
+
 #include <boost/bind.hpp>
 
 #include <Swiften/TLS/TLSContext.h>
@@ -15,9 +17,9 @@ namespace Swift {
 
 TLSLayer::TLSLayer(TLSContextFactory* factory, const TLSOptions& tlsOptions) {
     context = factory->createTLSContext(tlsOptions);
-    context->onDataForNetwork.connect(boost::bind(&TLSLayer::writeDataToChildLayer, this, _1));
-    context->onDataForApplication.connect(boost::bind(&TLSLayer::writeDataToParentLayer, this, _1));
-    context->onConnected.connect(onConnected);
+    context->onDataForNetwork.connect(boost::bind(&TLSLayer::handleDataForNetwork, this, _1));
+    context->onDataForApplication.connect(boost::bind(&TLSLayer::handleDataForApplication, this, _1));
+    context->onConnected.connect(boost::bind(&TLSLayer::handleConnected, this));
     context->onError.connect(onError);
 }
 
@@ -26,17 +28,69 @@ TLSLayer::~TLSLayer() {
 }
 
 void TLSLayer::connect() {
+    startHandshake();
     context->connect();
 }
 
 void TLSLayer::writeData(const SafeByteArray& data) {
+    statistics.plainBytesWritten += data.size();
     context->handleDataFromApplication(data);
 }
 
 void TLSLayer::handleDataRead(const SafeByteArray& data) {
+    startHandshake();
+    statistics.encryptedBytesRead += data.size();
+    statistics.recordsRead += readRecords.process(data);
     context->handleDataFromNetwork(data);
 }
 
+void TLSLayer::handleDataForNetwork(const SafeByteArray& data) {
+    statistics.encryptedBytesWritten += data.size();
+    statistics.recordsWritten += writtenRecords.process(data);
+    writeDataToChildLayer(data);
+}
+
+void TLSLayer::handleDataForApplication(const SafeByteArray& data) {
+    statistics.plainBytesRead += data.size();
+    writeDataToParentLayer(data);
+}
+
+void TLSLayer::startHandshake() {
+    if (!handshakeStart) {
+        handshakeStart = std::chrono::steady_clock::now();
+    }
+}
+
+void TLSLayer::handleConnected() {
+    if (handshakeStart && !statistics.handshakeTime) {
+        statistics.handshakeTime = std::chrono::steady_clock::now() - *handshakeStart;
+    }
+    onConnected();
+}
+
+boost::uint64_t TLSLayer::RecordCounter::process(const SafeByteArray& data) {
+    boost::uint64_t records = 0;
+    size_t i = 0;
+    while (i < data.size()) {
+        if (headerSize < sizeof(header)) {
+            header[headerSize++] = data[i++];
+            if (headerSize == sizeof(header)) {
+                ++records;
+                remaining = (static_cast<size_t>(header[3]) << 8) | header[4];
+            }
+        }
+        else {
+            size_t skipped = std::min(remaining, data.size() - i);
+            i += skipped;
+            remaining -= skipped;
+        }
+        if (headerSize == sizeof(header) && remaining == 0) {
+            headerSize = 0;
+        }
+    }
+    return records;
+}
+
 bool TLSLayer::setClientCertificate(CertificateWithKey::ref certificate) {
     return context->setClientCertificate(certificate);
 }
@@ -6,11 +6,14 @@
 
 #pragma once
 
+#include <chrono>
+
 #include <boost/signals2.hpp>
 
 #include <Swiften/Base/API.h>
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/StreamStack/StreamLayer.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 #include <Swiften/TLS/Certificate.h>
 #include <Swiften/TLS/CertificateVerificationError.h>
 #include <Swiften/TLS/CertificateWithKey.h>
@@ -40,11 +43,41 @@ namespace Swift {
                 return context;
             }
 
+            const TLSLayerStatistics& getStatistics() const {
+                return statistics;
+            }
+
         public:
             boost::signals2::signal<void (std::shared_ptr<TLSError>)> onError;
             boost::signals2::signal<void ()> onConnected;
 
+        private:
+            /**
+             * Counts TLS records by following the record headers in the
+             * encrypted data.
+             */
+            class RecordCounter {
+                public:
+                    RecordCounter() : headerSize(0), remaining(0) {}
+
+                    boost::uint64_t process(const SafeByteArray& data);
+
+                private:
+                    unsigned char header[5];
+                    size_t headerSize;
+                    size_t remaining;
+            };
+
+            void startHandshake();
+            void handleConnected();
+            void handleDataForNetwork(const SafeByteArray& data);
+            void handleDataForApplication(const SafeByteArray& data);
+
         private:
             TLSContext* context;
+            TLSLayerStatistics statistics;
+            RecordCounter readRecords;
+            RecordCounter writtenRecords;
+            boost::optional<std::chrono::steady_clock::time_point> handshakeStart;
     };
 }
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/Compress/ZLibCompressor.h>
+#include <Swiften/Compress/ZLibDecompressor.h>
+#include <Swiften/StreamStack/CompressionLayer.h>
+#include <Swiften/StreamStack/HighLayer.h>
+#include <Swiften/StreamStack/LowLayer.h>
+
+using namespace Swift;
+
+class CompressionLayerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(CompressionLayerTest);
+        CPPUNIT_TEST(testWriteData_CountsBytes);
+        CPPUNIT_TEST(testHandleDataRead_CountsBytes);
+        CPPUNIT_TEST(testGetCompressionRatio);
+        CPPUNIT_TEST(testGetCompressionRatio_NoData);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            lowLayer_ = new DummyLowLayer();
+            highLayer_ = new DummyHighLayer();
+            testling_ = new CompressionLayerExposed();
+            testling_->setChildLayer(lowLayer_);
+            testling_->setParentLayer(highLayer_);
+        }
+
+        void tearDown() {
+            delete testling_;
+            delete highLayer_;
+            delete lowLayer_;
+        }
+
+        void testWriteData_CountsBytes() {
+            testling_->writeData(createSafeByteArray("<presence/>"));
+            testling_->writeData(createSafeByteArray("<presence/>"));
+
+            const CompressionLayerStatistics& statistics = testling_->getStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(22), statistics.uncompressedBytesWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(lowLayer_->data.size()), statistics.compressedBytesWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), statistics.compressionTime.getCount());
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<presence/><presence/>"), ZLibDecompressor().process(lowLayer_->data));
+        }
+
+        void testHandleDataRead_CountsBytes() {
+            ZLibCompressor compressor;
+            SafeByteArray compressed = compressor.process(createSafeByteArray("<message><body>Hello Hello Hello Hello</body></message>"));
+
+            testling_->handleDataRead(compressed);
+
+            const CompressionLayerStatistics& statistics = testling_->getStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(compressed.size()), statistics.compressedBytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(55), statistics.uncompressedBytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.decompressionTime.getCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(55), highLayer_->data.size());
+        }
+
+        void testGetCompressionRatio() {
+            CompressionLayerStatistics statistics;
+            statistics.uncompressedBytesWritten = 300;
+            statistics.compressedBytesWritten = 100;
+            statistics.compressedBytesRead = 50;
+            statistics.uncompressedBytesRead = 300;
+
+            CPPUNIT_ASSERT_EQUAL(4.0, statistics.getCompressionRatio());
+        }
+
+        void testGetCompressionRatio_NoData() {
+            CPPUNIT_ASSERT_EQUAL(1.0, CompressionLayerStatistics().getCompressionRatio());
+        }
+
+    private:
+        class CompressionLayerExposed : public CompressionLayer {
+            public:
+                using HighLayer::setChildLayer;
+                using LowLayer::setParentLayer;
+        };
+
+        class DummyLowLayer : public LowLayer {
+            public:
+                virtual void writeData(const SafeByteArray& data) {
+                    append(this->data, data);
+                }
+
+                SafeByteArray data;
+        };
+
+        class DummyHighLayer : public HighLayer {
+            public:
+                virtual void handleDataRead(const SafeByteArray& data) {
+                    append(this->data, data);
+                }
+
+                SafeByteArray data;
+        };
+
+    private:
+        DummyLowLayer* lowLayer_;
+        DummyHighLayer* highLayer_;
+        CompressionLayerExposed* testling_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(CompressionLayerTest);
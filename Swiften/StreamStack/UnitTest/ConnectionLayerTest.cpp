@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <memory>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/EventLoop/DummyEventLoop.h>
+#include <Swiften/Network/DummyConnection.h>
+#include <Swiften/StreamStack/ConnectionLayer.h>
+#include <Swiften/StreamStack/HighLayer.h>
+
+using namespace Swift;
+
+class ConnectionLayerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(ConnectionLayerTest);
+        CPPUNIT_TEST(testWriteData_CountsBytesAndWrites);
+        CPPUNIT_TEST(testHandleDataRead_CountsBytesAndReads);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            eventLoop_ = new DummyEventLoop();
+            connection_ = std::make_shared<DummyConnection>(eventLoop_);
+            highLayer_ = new DummyHighLayer();
+            testling_ = new ConnectionLayerExposed(connection_);
+            testling_->setParentLayer(highLayer_);
+        }
+
+        void tearDown() {
+            delete testling_;
+            delete highLayer_;
+            connection_.reset();
+            eventLoop_->processEvents();
+            delete eventLoop_;
+        }
+
+        void testWriteData_CountsBytesAndWrites() {
+            testling_->writeData(createSafeByteArray("<presence/>"));
+            testling_->writeData(createSafeByteArray("<message/>"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(21), testling_->getStatistics().bytesWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().writes);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(0), testling_->getStatistics().reads);
+        }
+
+        void testHandleDataRead_CountsBytesAndReads() {
+            connection_->receive(createSafeByteArray("<presence/>"));
+            connection_->receive(createSafeByteArray("<message/>"));
+            connection_->receive(createSafeByteArray("<iq/>"));
+            eventLoop_->processEvents();
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(26), testling_->getStatistics().bytesRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(3), testling_->getStatistics().reads);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(0), testling_->getStatistics().writes);
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<presence/><message/><iq/>"), highLayer_->data);
+        }
+
+    private:
+        class ConnectionLayerExposed : public ConnectionLayer {
+            public:
+                ConnectionLayerExposed(std::shared_ptr<Connection> connection) : ConnectionLayer(connection) {}
+
+                using LowLayer::setParentLayer;
+        };
+
+        class DummyHighLayer : public HighLayer {
+            public:
+                virtual void handleDataRead(const SafeByteArray& data) {
+                    append(this->data, data);
+                }
+
+                SafeByteArray data;
+        };
+
+    private:
+        DummyEventLoop* eventLoop_;
+        std::shared_ptr<DummyConnection> connection_;
+        DummyHighLayer* highLayer_;
+        ConnectionLayerExposed* testling_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(ConnectionLayerTest);
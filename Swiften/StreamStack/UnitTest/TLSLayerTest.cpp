@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2016 Isode Limited.
+ * All rights reserved.
+ * See the COPYING file for more information.
+ */
+
+#include <vector>
+
+#include <QA/Checker/IO.h>
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cppunit/extensions/TestFactoryRegistry.h>
+
+#include <Swiften/Base/Algorithm.h>
+#include <Swiften/Base/SafeByteArray.h>
+#include <Swiften/StreamStack/HighLayer.h>
+#include <Swiften/StreamStack/LowLayer.h>
+#include <Swiften/StreamStack/TLSLayer.h>
+#include <Swiften/TLS/TLSContext.h>
+#include <Swiften/TLS/TLSContextFactory.h>
+
+using namespace Swift;
+
+class TLSLayerTest : public CppUnit::TestFixture {
+        CPPUNIT_TEST_SUITE(TLSLayerTest);
+        CPPUNIT_TEST(testHandleDataRead_CountsRecords);
+        CPPUNIT_TEST(testHandleDataRead_HeaderSplitAcrossReads);
+        CPPUNIT_TEST(testHandleDataRead_RecordSplitAcrossReads);
+        CPPUNIT_TEST(testHandleDataRead_RecordEndAndNextRecordInOneRead);
+        CPPUNIT_TEST(testHandleDataRead_EmptyRecord);
+        CPPUNIT_TEST(testHandleDataRead_CountsPlainBytes);
+        CPPUNIT_TEST(testWriteData_CountsRecordsAndBytes);
+        CPPUNIT_TEST(testConnect_SetsHandshakeTime);
+        CPPUNIT_TEST_SUITE_END();
+
+    public:
+        void setUp() {
+            contextFactory_ = new MockTLSContextFactory();
+            lowLayer_ = new DummyLowLayer();
+            highLayer_ = new DummyHighLayer();
+            testling_ = new TLSLayerExposed(contextFactory_);
+            testling_->setChildLayer(lowLayer_);
+            testling_->setParentLayer(highLayer_);
+        }
+
+        void tearDown() {
+            delete testling_;
+            delete highLayer_;
+            delete lowLayer_;
+            delete contextFactory_;
+        }
+
+        void testHandleDataRead_CountsRecords() {
+            SafeByteArray data = createRecord(10);
+            append(data, createRecord(300));
+
+            testling_->handleDataRead(data);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().recordsRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(data.size()), testling_->getStatistics().encryptedBytesRead);
+            CPPUNIT_ASSERT_EQUAL(data, contextFactory_->context->dataFromNetwork);
+        }
+
+        void testHandleDataRead_HeaderSplitAcrossReads() {
+            SafeByteArray record = createRecord(10);
+
+            testling_->handleDataRead(SafeByteArray(record.begin(), record.begin() + 3));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(0), testling_->getStatistics().recordsRead);
+            testling_->handleDataRead(SafeByteArray(record.begin() + 3, record.end()));
+            testling_->handleDataRead(createRecord(10));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().recordsRead);
+        }
+
+        void testHandleDataRead_RecordSplitAcrossReads() {
+            SafeByteArray record = createRecord(300);
+
+            testling_->handleDataRead(SafeByteArray(record.begin(), record.begin() + 100));
+            testling_->handleDataRead(SafeByteArray(record.begin() + 100, record.begin() + 200));
+            testling_->handleDataRead(SafeByteArray(record.begin() + 200, record.end()));
+            testling_->handleDataRead(createRecord(1));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().recordsRead);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(record.size() + 6), testling_->getStatistics().encryptedBytesRead);
+        }
+
+        void testHandleDataRead_RecordEndAndNextRecordInOneRead() {
+            SafeByteArray data = createRecord(20);
+            append(data, createRecord(20));
+            append(data, createRecord(20));
+
+            testling_->handleDataRead(SafeByteArray(data.begin(), data.begin() + 15));
+            testling_->handleDataRead(SafeByteArray(data.begin() + 15, data.begin() + 30));
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().recordsRead);
+            testling_->handleDataRead(SafeByteArray(data.begin() + 30, data.end()));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(3), testling_->getStatistics().recordsRead);
+        }
+
+        void testHandleDataRead_EmptyRecord() {
+            SafeByteArray data = createRecord(0);
+            append(data, createRecord(5));
+
+            testling_->handleDataRead(data);
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), testling_->getStatistics().recordsRead);
+        }
+
+        void testHandleDataRead_CountsPlainBytes() {
+            contextFactory_->context->onDataForApplication(createSafeByteArray("<presence/>"));
+
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(11), testling_->getStatistics().plainBytesRead);
+            CPPUNIT_ASSERT_EQUAL(createSafeByteArray("<presence/>"), highLayer_->data);
+        }
+
+        void testWriteData_CountsRecordsAndBytes() {
+            contextFactory_->context->encryptedRecordSize = 100;
+
+            testling_->writeData(createSafeByteArray("<presence/>"));
+            testling_->writeData(createSafeByteArray("<message/>"));
+
+            const TLSLayerStatistics& statistics = testling_->getStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(21), statistics.plainBytesWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), statistics.recordsWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(lowLayer_->data.size()), statistics.encryptedBytesWritten);
+            CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(210), lowLayer_->data.size());
+        }
+
+        void testConnect_SetsHandshakeTime() {
+            testling_->connect();
+            CPPUNIT_ASSERT(!testling_->getStatistics().handshakeTime);
+
+            contextFactory_->context->onConnected();
+
+            CPPUNIT_ASSERT(testling_->getStatistics().handshakeTime);
+        }
+
+    private:
+        static SafeByteArray createRecord(size_t payloadSize) {
+            SafeByteArray record;
+            record.push_back(0x17);
+            record.push_back(0x03);
+            record.push_back(0x03);
+            record.push_back(static_cast<unsigned char>((payloadSize >> 8) & 0xFF));
+            record.push_back(static_cast<unsigned char>(payloadSize & 0xFF));
+            record.resize(record.size() + payloadSize, 0xAB);
+            return record;
+        }
+
+        class MockTLSContext : public TLSContext {
+            public:
+                MockTLSContext() : encryptedRecordSize(0) {}
+
+                virtual void connect() {}
+                virtual bool setClientCertificate(CertificateWithKey::ref) { return false; }
+
+                virtual void handleDataFromNetwork(const SafeByteArray& data) {
+                    append(dataFromNetwork, data);
+                }
+
+                virtual void handleDataFromApplication(const SafeByteArray&) {
+                    onDataForNetwork(createRecord(encryptedRecordSize));
+                }
+
+                virtual std::vector<Certificate::ref> getPeerCertificateChain() const { return std::vector<Certificate::ref>(); }
+                virtual CertificateVerificationError::ref getPeerCertificateVerificationError() const { return CertificateVerificationError::ref(); }
+                virtual ByteArray getFinishMessage() const { return ByteArray(); }
+
+                SafeByteArray dataFromNetwork;
+                size_t encryptedRecordSize;
+        };
+
+        class MockTLSContextFactory : public TLSContextFactory {
+            public:
+                MockTLSContextFactory() : context(nullptr) {}
+
+                virtual bool canCreate() const { return true; }
+
+                virtual TLSContext* createTLSContext(const TLSOptions&) {
+                    context = new MockTLSContext();
+                    return context;
+                }
+
+                virtual void setCheckCertificateRevocation(bool) {}
+                virtual void setDisconnectOnCardRemoval(bool) {}
+
+                MockTLSContext* context;
+        };
+
+        class TLSLayerExposed : public TLSLayer {
+            public:
+                TLSLayerExposed(TLSContextFactory* factory) : TLSLayer(factory, TLSOptions()) {}
+
+                using HighLayer::setChildLayer;
+                using LowLayer::setParentLayer;
+        };
+
+        class DummyLowLayer : public LowLayer {
+            public:
+                virtual void writeData(const SafeByteArray& data) {
+                    append(this->data, data);
+                }
+
+                SafeByteArray data;
+        };
+
+        class DummyHighLayer : public HighLayer {
+            public:
+                virtual void handleDataRead(const SafeByteArray& data) {
+                    append(this->data, data);
+                }
+
+                SafeByteArray data;
+        };
+
+    private:
+        MockTLSContextFactory* contextFactory_;
+        DummyLowLayer* lowLayer_;
+        DummyHighLayer* highLayer_;
+        TLSLayerExposed* testling_;
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TLSLayerTest);
@@ -30,6 +30,7 @@ class XMPPLayerTest : public CppUnit::TestFixture {
         CPPUNIT_TEST(testWriteHeader);
         CPPUNIT_TEST(testWriteElement);
         CPPUNIT_TEST(testWriteFooter);
+        CPPUNIT_TEST(testGetStatistics);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -96,6 +97,19 @@ class XMPPLayerTest : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(std::string("</stream:stream>"), lowLayer_->writtenData);
         }
 
+        void testGetStatistics() {
+            testling_->handleDataRead(createSafeByteArray("<stream:stream to=\"example.com\" xmlns=\"jabber:client\" xmlns:stream=\"http://etherx.jabber.org/streams\" >"));
+            testling_->handleDataRead(createSafeByteArray("<presence/><message/>"));
+            testling_->writeElement(std::make_shared<Presence>());
+
+            const XMPPLayerStatistics& statistics = testling_->getStatistics();
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), statistics.elementsParsed);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.elementsSerialized);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(11), statistics.bytesSerialized);
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(2), statistics.parseTime.getCount());
+            CPPUNIT_ASSERT_EQUAL(static_cast<boost::uint64_t>(1), statistics.serializationTime.getCount());
+        }
+
         void handleElement(std::shared_ptr<ToplevelElement>) {
             ++elementsReceived_;
         }
@@ -23,7 +23,8 @@ XMPPLayer::XMPPLayer(
             xmlParserFactory_(xmlParserFactory),
             setExplictNSonTopLevelElements_(setExplictNSonTopLevelElements),
             resetParserAfterParse_(false),
-            inParser_(false) {
+            inParser_(false),
+            elementHandlingTime_(std::chrono::steady_clock::duration::zero()) {
     xmppParser_ = new XMPPParser(this, payloadParserFactories_, xmlParserFactory);
     xmppSerializer_ = new XMPPSerializer(payloadSerializers_, streamType, setExplictNSonTopLevelElements);
 }
@@ -42,7 +43,12 @@ void XMPPLayer::writeFooter() {
 }
 
 void XMPPLayer::writeElement(std::shared_ptr<ToplevelElement> element) {
-    writeDataInternal(xmppSerializer_->serializeElement(element));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    SafeByteArray data = xmppSerializer_->serializeElement(element);
+    statistics_.serializationTime.add(std::chrono::steady_clock::now() - start);
+    ++statistics_.elementsSerialized;
+    statistics_.bytesSerialized += data.size();
+    writeDataInternal(data);
 }
 
 void XMPPLayer::writeData(const std::string& data) {
@@ -56,16 +62,24 @@ void XMPPLayer::writeDataInternal(const SafeByteArray& data) {
 
 void XMPPLayer::handleDataRead(const SafeByteArray& data) {
     onDataRead(data);
+    onElementBatchStarted();
     inParser_ = true;
+    statistics_.bytesParsed += data.size();
+    elementHandlingTime_ = std::chrono::steady_clock::duration::zero();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     // FIXME: Converting to unsafe string. Should be ok, since we don't take passwords
     // from the stream in clients. If servers start using this, and require safe storage,
     // we need to fix this.
-    if (!xmppParser_->parse(byteArrayToString(ByteArray(data.begin(), data.end())))) {
+    bool parsed = xmppParser_->parse(byteArrayToString(ByteArray(data.begin(), data.end())));
+    statistics_.parseTime.add(std::chrono::steady_clock::now() - start - elementHandlingTime_);
+    if (!parsed) {
         inParser_ = false;
+        onElementBatchFinished();
         onError();
         return;
     }
     inParser_ = false;
+    onElementBatchFinished();
     if (resetParserAfterParse_) {
         doResetParser();
     }
@@ -82,7 +96,10 @@ void XMPPLayer::handleStreamStart(const ProtocolHeader& header) {
 }
 
 void XMPPLayer::handleElement(std::shared_ptr<ToplevelElement> stanza) {
+    ++statistics_.elementsParsed;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
     onElement(stanza);
+    elementHandlingTime_ += std::chrono::steady_clock::now() - start;
 }
 
 void XMPPLayer::handleStreamEnd() {
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
 
 #include <boost/noncopyable.hpp>
@@ -17,6 +18,7 @@
 #include <Swiften/Elements/ToplevelElement.h>
 #include <Swiften/Parser/XMPPParserClient.h>
 #include <Swiften/StreamStack/HighLayer.h>
+#include <Swiften/StreamStack/StreamStatistics.h>
 
 namespace Swift {
     class ProtocolHeader;
@@ -45,6 +47,10 @@ namespace Swift {
 
             void resetParser();
 
+            const XMPPLayerStatistics& getStatistics() const {
+                return statistics_;
+            }
+
         protected:
             void handleDataRead(const SafeByteArray& data);
             void writeDataInternal(const SafeByteArray& data);
@@ -56,6 +62,14 @@ namespace Swift {
             boost::signals2::signal<void (const SafeByteArray&)> onDataRead;
             boost::signals2::signal<void ()> onError;
 
+            /**
+             * Emitted before and after the elements of a single chunk of
+             * received data are emitted, so that subscribers can process the
+             * elements of a chunk in one go.
+             */
+            boost::signals2::signal<void ()> onElementBatchStarted;
+            boost::signals2::signal<void ()> onElementBatchFinished;
+
         private:
             void handleStreamStart(const ProtocolHeader&);
             void handleElement(std::shared_ptr<ToplevelElement>);
@@ -72,5 +86,7 @@ namespace Swift {
             bool setExplictNSonTopLevelElements_;
             bool resetParserAfterParse_;
             bool inParser_;
+            XMPPLayerStatistics statistics_;
+            std::chrono::steady_clock::duration elementHandlingTime_;
     };
 }
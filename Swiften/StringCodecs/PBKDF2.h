@@ -6,8 +6,10 @@
 
 #pragma once
 
+#include <string>
+
 #include <Swiften/Base/API.h>
-#include <Swiften/Base/Concat.h>
+#include <Swiften/Base/ByteArray.h>
 #include <Swiften/Base/SafeByteArray.h>
 #include <Swiften/Crypto/CryptoProvider.h>
 
@@ -15,17 +17,15 @@ namespace Swift {
     class SWIFTEN_API PBKDF2 {
         public:
             static ByteArray encode(const SafeByteArray& password, const ByteArray& salt, int iterations, CryptoProvider* crypto) {
-                ByteArray u = crypto->getHMACSHA1(password, concat(salt, createByteArray("\0\0\0\1", 4)));
-                ByteArray result(u);
-                int i = 1;
-                while (i < iterations) {
-                    u = crypto->getHMACSHA1(password, u);
-                    for (unsigned int j = 0; j < u.size(); ++j) {
-                        result[j] ^= u[j];
-                    }
-                    ++i;
-                }
-                return result;
+                return encode("sha-1", password, salt, iterations, crypto);
+            }
+
+            /**
+             * Derives a key with PBKDF2, using HMAC with the hash algorithm
+             * (named as in CryptoProvider::createHash()).
+             */
+            static ByteArray encode(const std::string& algorithm, const SafeByteArray& password, const ByteArray& salt, int iterations, CryptoProvider* crypto) {
+                return crypto->getPBKDF2(algorithm, password, salt, iterations);
             }
     };
 }
@@ -21,6 +21,7 @@ class PBKDF2Test : public CppUnit::TestFixture {
         CPPUNIT_TEST(testGetResult_I1);
         CPPUNIT_TEST(testGetResult_I2);
         CPPUNIT_TEST(testGetResult_I4096);
+        CPPUNIT_TEST(testGetResult_SHA256_I4096);
         CPPUNIT_TEST_SUITE_END();
 
     public:
@@ -46,6 +47,12 @@ class PBKDF2Test : public CppUnit::TestFixture {
             CPPUNIT_ASSERT_EQUAL(createByteArray("\x4b\x00\x79\x1\xb7\x65\x48\x9a\xbe\xad\x49\xd9\x26\xf7\x21\xd0\x65\xa4\x29\xc1", 20), result);
         }
 
+        void testGetResult_SHA256_I4096() {
+            ByteArray result(PBKDF2::encode("sha-256", createSafeByteArray("password"), createByteArray("salt"), 4096, crypto.get()));
+
+            CPPUNIT_ASSERT_EQUAL(createByteArray("\xc5\xe4\x78\xd5\x92\x88\xc8\x41\xaa\x53\x0d\xb6\x84\x5c\x4c\x8d\x96\x28\x93\xa0\x01\xce\x4e\x11\xa4\x96\x38\x73\xaa\x98\x13\x4a", 32), result);
+        }
+
     private:
         std::shared_ptr<CryptoProvider> crypto;
 };
@@ -83,7 +83,7 @@ namespace Swift {
         foreach(Presence::ref pres, presences) {
             if (pres->getPriority() > priority) {
                 // look up caps from the jid
-                DiscoInfo::ref info = capsProvider_->getCaps(pres->getFrom());
+                std::shared_ptr<const DiscoInfo> info = capsProvider_->getCaps(pres->getFrom());
                 if (info && info->hasFeature(DiscoInfo::WhiteboardFeature)) {
                     priority = pres->getPriority();
                     fullReceipientJID = pres->getFrom();